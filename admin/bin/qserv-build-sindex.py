@@ -0,0 +1,213 @@
+#!/usr/bin/env python
+
+# LSST Data Management System
+# Copyright 2016 AURA/LSST.
+#
+# This product includes software developed by the
+# LSST Project (http://www.lsst.org/).
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the LSST License Statement and
+# the GNU General Public License along with this program.  If not,
+# see <http://www.lsstcorp.org/LegalNotices/>.
+
+"""
+Build local secondary index file from the secondary index table.
+
+Script reads (key, chunkId, subChunkId) rows of the secondary index table
+of a director table, e.g. qservMeta.LSST__Object, in key order and writes
+them to file DIR/LSST__Object.sindex. Czar uses files in the directory
+defined by its tuning.secondaryIndexDir option instead of the index table.
+
+File format is described in core/modules/qproc/SecondaryIndexFile.h. The
+file is written under a temporary name and renamed when complete, so it
+can be rebuilt while czar is running, czar needs a restart to see the new
+contents of a file it already uses.
+
+"""
+
+# -------------------------------
+#  Imports of standard modules --
+# -------------------------------
+import argparse
+import logging
+import os
+import re
+import struct
+import sys
+
+# ----------------------------
+# Imports for other modules --
+# ----------------------------
+from lsst.db.engineFactory import getEngineFromArgs
+
+# ---------------------------------
+# Local non-exported definitions --
+# ---------------------------------
+
+_MAGIC = b"QSVSIDX1"
+_HEADER_SIZE = 32
+
+
+def _sanitize(name):
+    """Remove characters that qserv strips from index table names"""
+    return re.sub(r'[^A-Za-z0-9_]', '', name)
+
+
+def _varint(value):
+    """Encode non-negative integer as unsigned LEB128"""
+    out = bytearray()
+    while True:
+        byte = value & 0x7f
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+class _IndexWriter(object):
+    """Writes entries in non-decreasing key order into index file"""
+
+    def __init__(self, path, blockSize):
+        self.file = open(path, 'wb')
+        self.blockSize = blockSize
+        self.nEntries = 0
+        self.prevKey = None
+        self.directory = []
+        self.block = []
+        self.file.write(b'\0' * _HEADER_SIZE)
+
+    def add(self, key, chunkId, subChunkId):
+        if self.prevKey is not None and key < self.prevKey:
+            raise ValueError('index keys are not sorted: %d follows %d' % (key, self.prevKey))
+        if chunkId < 0 or subChunkId < 0:
+            raise ValueError('negative chunk number for key %d' % key)
+        if self.nEntries % self.blockSize == 0:
+            self._flush()
+            self.directory.append((key, self.file.tell()))
+            self.prevKey = key
+        self.block.append(_varint(key - self.prevKey) + _varint(chunkId) + _varint(subChunkId))
+        self.prevKey = key
+        self.nEntries += 1
+
+    def close(self):
+        self._flush()
+        dirOffset = self.file.tell()
+        for firstKey, offset in self.directory:
+            self.file.write(struct.pack('<qQ', firstKey, offset))
+        self.file.seek(0)
+        self.file.write(_MAGIC + struct.pack('<IIQQ', self.blockSize, 0, self.nEntries, dirOffset))
+        self.file.close()
+
+    def _flush(self):
+        self.file.write(b''.join(self.block))
+        self.block = []
+
+# -----------------------
+# Exported definitions --
+# -----------------------
+
+
+class BuildIndex(object):
+    """
+    Application class for secondary index builder
+    """
+
+    def __init__(self):
+        """
+        Constructor parse all arguments and prepares for execution.
+        """
+
+        parser = argparse.ArgumentParser(description='Build local secondary index file for czar.')
+
+        parser.add_argument('-v', '--verbose', dest='verbose', default=[], action='append_const',
+                            const=None, help='More verbose output, can use several times.')
+
+        group = parser.add_argument_group('Database options', 'Options for database connection')
+        group.add_argument('-H', '--host', dest='host', default=None, metavar='HOST',
+                           help='Host name of czar MySQL server.')
+        group.add_argument('-P', '--port', dest='port', default=None, metavar='PORT_NUMBER', type=int,
+                           help='Port number of czar MySQL server.')
+        group.add_argument('-S', '--socket', dest='socket', default=None, metavar='PATH',
+                           help='Socket of czar MySQL server, used instead of host and port.')
+        group.add_argument('-u', '--user', dest='user', default='qsmaster', metavar='USER',
+                           help='MySQL user name, def: %(default)s.')
+        group.add_argument('-p', '--password', dest='password', default=None, metavar='PASSWORD',
+                           help='MySQL password.')
+        group.add_argument('-i', '--index-db', dest='indexDb', default='qservMeta', metavar='DB_NAME',
+                           help='Name of the database which keeps secondary index, def: %(default)s.')
+
+        group = parser.add_argument_group('Output options')
+        group.add_argument('-o', '--output-dir', dest='outputDir', default='.', metavar='PATH',
+                           help='Directory for index file, def: %(default)s.')
+        group.add_argument('-b', '--block-size', dest='blockSize', default=256, type=int,
+                           metavar='NUMBER', help='Number of entries per block, def: %(default)s.')
+
+        parser.add_argument('database', help='Database name.')
+        parser.add_argument('table', help='Director table name.')
+        parser.add_argument('keyColumn', help='Name of director table key column, e.g. objectId.')
+
+        self.args = parser.parse_args()
+
+        verbosity = len(self.args.verbose)
+        levels = {0: logging.WARNING, 1: logging.INFO, 2: logging.DEBUG}
+        logging.basicConfig(format="[%(levelname)s] %(name)s: %(message)s",
+                            level=levels.get(verbosity, logging.DEBUG))
+
+    def run(self):
+        """
+        Build index file, throws exception if anything goes wrong.
+        """
+        log = logging.getLogger('BuildIndex')
+        args = self.args
+        if args.blockSize < 1:
+            raise ValueError('block size must be positive')
+
+        kwargs = dict(username=args.user, query={})
+        if args.host: kwargs['host'] = args.host
+        if args.port: kwargs['port'] = args.port
+        if args.socket: kwargs['query']['unix_socket'] = args.socket
+        if args.password: kwargs['password'] = args.password
+        conn = getEngineFromArgs(**kwargs).connect()
+
+        name = _sanitize(args.database) + '__' + _sanitize(args.table)
+        keyColumn = _sanitize(args.keyColumn)
+        query = "SELECT %s, chunkId, subChunkId FROM %s.%s ORDER BY %s" % \
+            (keyColumn, _sanitize(args.indexDb), name, keyColumn)
+        log.info('reading index: %s', query)
+
+        path = os.path.join(args.outputDir, name + '.sindex')
+        tmpPath = path + '.tmp'
+        writer = _IndexWriter(tmpPath, args.blockSize)
+        try:
+            result = conn.execution_options(stream_results=True).execute(query)
+            for key, chunkId, subChunkId in result:
+                writer.add(key, chunkId, subChunkId)
+            writer.close()
+        except Exception:
+            writer.file.close()
+            os.remove(tmpPath)
+            raise
+        os.rename(tmpPath, path)
+        log.info('wrote %d entries to %s', writer.nEntries, path)
+        return 0
+
+
+if __name__ == "__main__":
+    try:
+        app = BuildIndex()
+        sys.exit(app.run())
+    except Exception as exc:
+        logging.critical('Exception occured: %s', exc, exc_info=True)
+        sys.exit(1)
@@ -41,7 +41,6 @@
 #include "qdisp/JobQuery.h"
 #include "rproc/InfileMerger.h"
 #include "util/common.h"
-#include "util/StringHash.h"
 
 using lsst::qserv::proto::ProtoImporter;
 using lsst::qserv::proto::ProtoHeader;
@@ -220,7 +219,7 @@ bool MergingHandler::_merge() {
         bool success = _infileMerger->merge(_response);
         if (!success) {
             LOGS(_log, LOG_LVL_WARN, "_merge() failed");
-            rproc::InfileMergerError const& err = _infileMerger->getError();
+            rproc::InfileMergerError const err = _infileMerger->getError();
             _setError(ccontrol::MSG_RESULT_ERROR, err.getMsg());
             _state = MsgState::RESULT_ERR;
         }
@@ -249,9 +248,15 @@ bool MergingHandler::_setResult() {
     LOGS(_log, LOG_LVL_DEBUG, "protoDur=" << protoDur.count());
     return true;
 }
+
+/// Check the raw result message against the checksum in its header, before
+/// anything is decoded from it.
 bool MergingHandler::_verifyResult() {
-    if (_response->protoHeader.md5() != util::StringHash::getMd5(_buffer.data(), _buffer.size())) {
-        _setError(ccontrol::MSG_RESULT_MD5, "Result message MD5 mismatch");
+    auto const& header = _response->protoHeader;
+    if (!proto::ProtoHeaderWrap::verifyChecksum(header, _buffer.data(), _buffer.size())) {
+        int code = (header.checksumtype() == proto::ProtoHeader::MD5) ? ccontrol::MSG_RESULT_MD5
+                                                                     : ccontrol::MSG_RESULT_CHECKSUM;
+        _setError(code, "From:" + _wName + " Result message checksum mismatch");
         _state = MsgState::RESULT_ERR;
         return false;
     }
@@ -0,0 +1,216 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "ccontrol/ResultCache.h"
+
+// System headers
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+
+// LSST headers
+#include "lsst/log/Log.h"
+
+// Qserv headers
+#include "sql/SqlConnection.h"
+#include "sql/SqlErrorObject.h"
+#include "sql/SqlResults.h"
+
+namespace {
+LOG_LOGGER _log = LOG_GET("lsst.qserv.ccontrol.ResultCache");
+}
+
+namespace lsst {
+namespace qserv {
+namespace ccontrol {
+
+ResultCache::Entry::Entry(mysql::MySqlConfig const& resultConfig, std::string const& table_,
+                          std::string const& orderBy_, uint64_t rows_, Versions const& versions_)
+    : table(table_), orderBy(orderBy_), rows(rows_), versions(versions_),
+      created(std::chrono::steady_clock::now()), _resultConfig(resultConfig) {
+}
+
+ResultCache::Entry::~Entry() {
+    sql::SqlConnection conn(_resultConfig);
+    sql::SqlErrorObject errObj;
+    if (not conn.dropTable(table, errObj, false)) {
+        LOGS(_log, LOG_LVL_WARN, "Failed to drop cached result " << table << ": " << errObj.errMsg());
+    }
+}
+
+ResultCache::ResultCache(mysql::MySqlConfig const& resultConfig, std::string const& tablePrefix,
+                         uint64_t maxRows, unsigned ttlSec)
+    : _resultConfig(resultConfig), _tablePrefix(tablePrefix), _maxRows(maxRows), _ttl(ttlSec) {
+    // tables of a previous run are of no use, no query can hold them
+    sql::SqlConnection conn(_resultConfig);
+    sql::SqlErrorObject errObj;
+    std::vector<std::string> tables;
+    if (not conn.listTables(tables, errObj, _tablePrefix)) {
+        LOGS(_log, LOG_LVL_WARN, "Failed to list cached results: " << errObj.errMsg());
+        return;
+    }
+    for (auto const& table : tables) {
+        // '_' in prefix is a wildcard for LIKE
+        if (table.compare(0, _tablePrefix.size(), _tablePrefix) != 0) continue;
+        LOGS(_log, LOG_LVL_DEBUG, "Dropping stale cached result " << table);
+        errObj.reset();
+        if (not conn.dropTable(table, errObj, false)) {
+            LOGS(_log, LOG_LVL_WARN, "Failed to drop " << table << ": " << errObj.errMsg());
+        }
+    }
+}
+
+ResultCache::Entry::CPtr
+ResultCache::get(std::string const& key, Versions const& versions) {
+    std::vector<Entry::CPtr> dropped; // released after unlocking
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto iter = _index.find(key);
+    if (iter == _index.end()) {
+        ++_misses;
+        return nullptr;
+    }
+    Entry::CPtr entry = iter->second->second;
+    if (entry->versions != versions or std::chrono::steady_clock::now() - entry->created > _ttl) {
+        LOGS(_log, LOG_LVL_DEBUG, "Cached result " << entry->table << " is stale");
+        _erase(iter->second, dropped);
+        ++_misses;
+        return nullptr;
+    }
+    _lru.splice(_lru.begin(), _lru, iter->second);
+    ++_hits;
+    return entry;
+}
+
+void
+ResultCache::put(std::string const& key, Versions const& versions,
+                 std::string const& resultTable, std::string const& orderBy) {
+    {
+        // a hash collision only caches a result early
+        size_t const hash = std::hash<std::string>()(key);
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto iter = _seenIndex.find(hash);
+        if (iter == _seenIndex.end()) {
+            _seen.push_front(hash);
+            _seenIndex[hash] = _seen.begin();
+            if (_seen.size() > _maxSeen) {
+                _seenIndex.erase(_seen.back());
+                _seen.pop_back();
+            }
+            LOGS(_log, LOG_LVL_DEBUG, resultTable << " not cached, first run of its query");
+            return;
+        }
+        _seen.erase(iter->second);
+        _seenIndex.erase(iter);
+    }
+
+    sql::SqlConnection conn(_resultConfig);
+    sql::SqlErrorObject errObj;
+    sql::SqlResults results;
+    std::string count;
+    if (not conn.runQuery("SELECT COUNT(*) FROM " + resultTable, results, errObj)
+            or not results.extractFirstValue(count, errObj)) {
+        LOGS(_log, LOG_LVL_WARN, "Failed to count rows of " << resultTable << ": " << errObj.errMsg());
+        return;
+    }
+    uint64_t const rows = std::strtoull(count.c_str(), nullptr, 10);
+    if (rows > _maxRows) {
+        LOGS(_log, LOG_LVL_DEBUG, resultTable << " too large to cache, rows=" << rows);
+        return;
+    }
+    std::string const table = _tablePrefix + resultTable;
+    if (not copyTable(conn, resultTable, table, errObj)) {
+        LOGS(_log, LOG_LVL_WARN, "Failed to cache " << resultTable << ": " << errObj.errMsg());
+        errObj.reset();
+        conn.dropTable(table, errObj, false);
+        return;
+    }
+    auto entry = std::make_shared<Entry const>(_resultConfig, table, orderBy, rows, versions);
+
+    std::vector<Entry::CPtr> dropped; // released after unlocking
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto iter = _index.find(key);
+    if (iter != _index.end()) {
+        // same query finished twice
+        _erase(iter->second, dropped);
+    }
+    _lru.emplace_front(key, entry);
+    _index[key] = _lru.begin();
+    _rows += rows;
+    while (_rows > _maxRows) {
+        _erase(std::prev(_lru.end()), dropped);
+    }
+    LOGS(_log, LOG_LVL_DEBUG, "Cached " << resultTable << " as " << table << ", rows=" << rows);
+}
+
+void
+ResultCache::invalidate(std::string const& dbName) {
+    std::vector<Entry::CPtr> dropped; // released after unlocking
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto iter = _lru.begin(); iter != _lru.end(); ) {
+        auto next = std::next(iter);
+        if (iter->second->versions.count(dbName) != 0) {
+            _erase(iter, dropped);
+        }
+        iter = next;
+    }
+    LOGS(_log, LOG_LVL_DEBUG, "Invalidated " << dropped.size() << " cached results of " << dbName);
+}
+
+std::string
+ResultCache::newTableName() {
+    return _tablePrefix + "r" + std::to_string(++_tableCounter);
+}
+
+bool
+ResultCache::copyTable(sql::SqlConnection& conn, std::string const& from,
+                       std::string const& to, sql::SqlErrorObject& errObj) {
+    // LIKE keeps column types and engine, a MyISAM copy keeps row order
+    return conn.runQuery("CREATE TABLE " + to + " LIKE " + from, errObj)
+        and conn.runQuery("INSERT INTO " + to + " SELECT * FROM " + from, errObj);
+}
+
+ResultCache::Stats
+ResultCache::getStats() const {
+    Stats stats;
+    stats.hits = _hits;
+    stats.misses = _misses;
+    stats.evictions = _evictions;
+    std::lock_guard<std::mutex> lock(_mutex);
+    stats.entries = _lru.size();
+    stats.rows = _rows;
+    return stats;
+}
+
+/// Remove an entry, its table is dropped when 'dropped' is destroyed
+/// unless a query still holds it. Must be called with _mutex held.
+void
+ResultCache::_erase(EntryList::iterator iter, std::vector<Entry::CPtr>& dropped) {
+    _rows -= iter->second->rows;
+    dropped.push_back(iter->second);
+    _index.erase(iter->first);
+    _lru.erase(iter);
+    ++_evictions;
+}
+
+}}} // namespace lsst::qserv::ccontrol
@@ -0,0 +1,169 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef LSST_QSERV_CCONTROL_RESULTCACHE_H
+#define LSST_QSERV_CCONTROL_RESULTCACHE_H
+
+// System headers
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Qserv headers
+#include "mysql/MySqlConfig.h"
+
+// Forward decl
+namespace lsst {
+namespace qserv {
+namespace sql {
+class SqlConnection;
+class SqlErrorObject;
+}}}
+
+namespace lsst {
+namespace qserv {
+namespace ccontrol {
+
+/// ResultCache keeps copies of the result tables of recent SELECT queries in
+/// the result database, so that a query repeated while the data of its
+/// databases is unchanged gets a copy of the cached table instead of being
+/// dispatched to the workers (mysql-proxy drops the table it reads). Only
+/// the results of queries that already ran once are copied, most queries
+/// are never repeated and would only pay for the copy.
+///
+/// Entries are keyed by the analysed query text and hold the CSS data
+/// versions of the databases the result was computed from, an entry whose
+/// versions differ from the current ones is stale. Entries also expire
+/// after a fixed time, and the least recently used ones are evicted when
+/// the cached tables hold more rows than allowed. The table of an entry is
+/// dropped once the entry is evicted and no query copies it any more.
+/// All methods are thread-safe.
+class ResultCache {
+public:
+    typedef std::shared_ptr<ResultCache> Ptr;
+
+    /// Data versions of the databases used by a query, by database name.
+    typedef std::map<std::string, std::string> Versions;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0; ///< Entries dropped for size, age or data change
+        size_t entries = 0;
+        uint64_t rows = 0; ///< Rows in all cached tables
+    };
+
+    /// A cached result table.
+    class Entry {
+    public:
+        typedef std::shared_ptr<Entry const> CPtr;
+
+        Entry(mysql::MySqlConfig const& resultConfig, std::string const& table_,
+              std::string const& orderBy_, uint64_t rows_, Versions const& versions_);
+
+        Entry(Entry const&) = delete;
+        Entry& operator=(Entry const&) = delete;
+
+        /// Drops the table.
+        ~Entry();
+
+        std::string const table; ///< Table in the result database
+        std::string const orderBy; ///< ORDER BY for mysql-proxy
+        uint64_t const rows;
+        Versions const versions;
+        std::chrono::steady_clock::time_point const created;
+
+    private:
+        mysql::MySqlConfig const _resultConfig;
+    };
+
+    /// Drops the tables left behind by an earlier instance.
+    /// @param resultConfig: result database
+    /// @param tablePrefix: prefix of the names of the tables of this cache,
+    ///                     which must not be used by any other table
+    /// @param maxRows: max number of rows in all cached tables
+    /// @param ttlSec: seconds an entry stays valid
+    ResultCache(mysql::MySqlConfig const& resultConfig, std::string const& tablePrefix,
+                uint64_t maxRows, unsigned ttlSec);
+
+    ResultCache(ResultCache const&) = delete;
+    ResultCache& operator=(ResultCache const&) = delete;
+
+    /// @return the entry of a query if it is valid for 'versions', nullptr
+    ///         otherwise. The table of the entry stays while it is held.
+    Entry::CPtr get(std::string const& key, Versions const& versions);
+
+    /// Copy the result table of a query into the cache, unless it has more
+    /// rows than the cache holds or the query was not seen before, in which
+    /// case it is only remembered. Failures are only logged.
+    /// @param versions: data versions seen before the query was dispatched
+    void put(std::string const& key, Versions const& versions,
+             std::string const& resultTable, std::string const& orderBy);
+
+    /// Drop the entries computed from database 'dbName'.
+    void invalidate(std::string const& dbName);
+
+    /// @return a new table name for a copy of a cached result.
+    std::string newTableName();
+
+    /// Create table 'to' in the result database with the rows of table 'from'.
+    static bool copyTable(sql::SqlConnection& conn, std::string const& from,
+                          std::string const& to, sql::SqlErrorObject& errObj);
+
+    Stats getStats() const;
+
+private:
+    typedef std::list<std::pair<std::string, Entry::CPtr>> EntryList;
+
+    void _erase(EntryList::iterator iter, std::vector<Entry::CPtr>& dropped);
+
+    mysql::MySqlConfig const _resultConfig;
+    std::string const _tablePrefix;
+    uint64_t const _maxRows;
+    std::chrono::seconds const _ttl;
+
+    mutable std::mutex _mutex; ///< Protects members below
+    EntryList _lru; ///< Most recently used first
+    std::unordered_map<std::string, EntryList::iterator> _index;
+    uint64_t _rows{0};
+    /// Hashes of the keys of queries that ran once without being cached,
+    /// most recent first, at most _maxSeen of them.
+    std::list<size_t> _seen;
+    std::unordered_map<size_t, std::list<size_t>::iterator> _seenIndex;
+    static size_t const _maxSeen = 100000;
+
+    std::atomic<uint64_t> _tableCounter{0};
+    std::atomic<uint64_t> _hits{0};
+    std::atomic<uint64_t> _misses{0};
+    std::atomic<uint64_t> _evictions{0};
+};
+
+}}} // namespace lsst::qserv::ccontrol
+
+#endif // LSST_QSERV_CCONTROL_RESULTCACHE_H
@@ -45,7 +45,7 @@ public:
            << "_";
         _prefix = ss.str();
     }
-    std::string make(int chunkId, int seq=0) {
+    std::string make(int chunkId, int seq=0) const {
         std::stringstream ss;
         ss << _prefix << chunkId << "_" << seq;
         return ss.str();
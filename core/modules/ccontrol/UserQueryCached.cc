@@ -0,0 +1,92 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "ccontrol/UserQueryCached.h"
+
+// System headers
+
+// LSST headers
+#include "lsst/log/Log.h"
+
+// Qserv headers
+#include "qdisp/MessageStore.h"
+#include "sql/SqlConnection.h"
+#include "sql/SqlErrorObject.h"
+
+namespace {
+LOG_LOGGER _log = LOG_GET("lsst.qserv.ccontrol.UserQueryCached");
+}
+
+namespace lsst {
+namespace qserv {
+namespace ccontrol {
+
+// Constructor
+UserQueryCached::UserQueryCached(ResultCache::Entry::CPtr const& entry,
+                                 mysql::MySqlConfig const& resultConfig,
+                                 std::string const& resultTable)
+    : _entry(entry), _resultConfig(resultConfig), _resultTable(resultTable),
+      _orderBy(entry->orderBy), _qState(UNKNOWN),
+      _messageStore(std::make_shared<qdisp::MessageStore>()) {
+}
+
+std::string UserQueryCached::getError() const {
+    return std::string();
+}
+
+// Attempt to kill in progress.
+void UserQueryCached::kill() {
+}
+
+// Submit or execute the query.
+void UserQueryCached::submit() {
+
+    LOGS(_log, LOG_LVL_INFO, "Copying cached result " << _entry->table << " to " << _resultTable);
+
+    sql::SqlConnection conn(_resultConfig);
+    sql::SqlErrorObject errObj;
+    if (ResultCache::copyTable(conn, _entry->table, _resultTable, errObj)) {
+        _qState = SUCCESS;
+    } else {
+        LOGS(_log, LOG_LVL_ERROR, "Failed to copy cached result: " << errObj.errMsg());
+        std::string message = "Failed to copy cached result: " + errObj.errMsg();
+        _messageStore->addMessage(-1, errObj.errNo(), message, MessageSeverity::MSG_ERROR);
+        _qState = ERROR;
+    }
+
+    // cached table may be dropped now
+    _entry.reset();
+}
+
+// Block until a submit()'ed query completes.
+QueryState UserQueryCached::join() {
+    // everything should be done in submit()
+    return _qState;
+}
+
+// Release resources.
+void UserQueryCached::discard() {
+    _entry.reset();
+}
+
+}}} // lsst::qserv::ccontrol
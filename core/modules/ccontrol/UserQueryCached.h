@@ -0,0 +1,111 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef LSST_QSERV_CCONTROL_USERQUERYCACHED_H
+#define LSST_QSERV_CCONTROL_USERQUERYCACHED_H
+
+// System headers
+#include <memory>
+#include <string>
+
+// Third-party headers
+
+// Qserv headers
+#include "ccontrol/ResultCache.h"
+#include "ccontrol/UserQuery.h"
+#include "mysql/MySqlConfig.h"
+
+namespace lsst {
+namespace qserv {
+namespace ccontrol {
+
+/// @addtogroup ccontrol
+
+/**
+ *  @ingroup ccontrol
+ *
+ *  @brief Implementation of UserQuery for SELECT statements whose result
+ *  is found in ResultCache.
+ *
+ *  Nothing is dispatched, submit() copies the cached table into a new
+ *  result table for mysql-proxy.
+ */
+
+class UserQueryCached : public UserQuery {
+public:
+
+    /**
+     *  @param entry:         Cached result
+     *  @param resultConfig:  Result database
+     *  @param resultTable:   Name of the table to create
+     */
+    UserQueryCached(ResultCache::Entry::CPtr const& entry,
+                    mysql::MySqlConfig const& resultConfig,
+                    std::string const& resultTable);
+
+    UserQueryCached(UserQueryCached const&) = delete;
+    UserQueryCached& operator=(UserQueryCached const&) = delete;
+
+    // Accessors
+
+    /// @return a non-empty string describing the current error state
+    /// Returns an empty string if no errors have been detected.
+    virtual std::string getError() const override;
+
+    /// Copy the cached result table.
+    virtual void submit() override;
+
+    /// Wait until the query has completed execution.
+    /// @return the final execution state.
+    virtual QueryState join() override;
+
+    /// Stop a query in progress (for immediate shutdowns)
+    virtual void kill() override;
+
+    /// Release resources related to user query
+    virtual void discard() override;
+
+    // Delegate objects
+    virtual std::shared_ptr<qdisp::MessageStore> getMessageStore() override {
+        return _messageStore; }
+
+    /// @return Name of the result table for this query, can be empty
+    virtual std::string getResultTableName() override { return _resultTable; }
+
+    /// @return ORDER BY part of SELECT statement to be executed by proxy
+    virtual std::string getProxyOrderBy() override { return _orderBy; }
+
+protected:
+
+private:
+
+    ResultCache::Entry::CPtr _entry; ///< Released once copied
+    mysql::MySqlConfig const _resultConfig;
+    std::string const _resultTable;
+    std::string const _orderBy;
+    QueryState _qState;
+    std::shared_ptr<qdisp::MessageStore> _messageStore;
+
+};
+
+}}} // namespace lsst::qserv::ccontrol
+
+#endif // LSST_QSERV_CCONTROL_USERQUERYCACHED_H
@@ -31,11 +31,13 @@
 #include "lsst/log/Log.h"
 
 // Qserv headers
+#include "ccontrol/ResultCache.h"
 #include "css/CssAccess.h"
 #include "css/CssError.h"
 #include "qdisp/MessageStore.h"
 #include "qmeta/Exceptions.h"
 #include "qmeta/QMeta.h"
+#include "qproc/SecondaryIndex.h"
 #include "sql/SqlConnection.h"
 #include "sql/SqlErrorObject.h"
 #include "util/IterableFormatter.h"
@@ -54,10 +56,13 @@ UserQueryDrop::UserQueryDrop(std::shared_ptr<css::CssAccess> const& css,
                              std::string const& tableName,
                              sql::SqlConnection* resultDbConn,
                              std::shared_ptr<qmeta::QMeta> const& queryMetadata,
-                             qmeta::CzarId qMetaCzarId)
+                             qmeta::CzarId qMetaCzarId,
+                             std::shared_ptr<ResultCache> const& resultCache,
+                             std::shared_ptr<qproc::SecondaryIndex> const& secondaryIndex)
     : _css(css), _dbName(dbName), _tableName(tableName),
       _resultDbConn(resultDbConn), _queryMetadata(queryMetadata),
-      _qMetaCzarId(qMetaCzarId), _qState(UNKNOWN),
+      _qMetaCzarId(qMetaCzarId), _resultCache(resultCache),
+      _secondaryIndex(secondaryIndex), _qState(UNKNOWN),
       _messageStore(std::make_shared<qdisp::MessageStore>()),
       _sessionId(0) {
 }
@@ -116,6 +121,13 @@ void UserQueryDrop::submit() {
             _css->setTableStatus(_dbName, _tableName, newStatus);
         }
         _qState = SUCCESS;
+        if (_resultCache) {
+            _resultCache->invalidate(_dbName);
+        }
+        // the index of a table loaded again under the same name is a new one
+        if (_secondaryIndex) {
+            _secondaryIndex->invalidate(_dbName, _tableName);
+        }
     } catch (css::NoSuchDb const& exc) {
         // Has it disappeared already?
         LOGS(_log, LOG_LVL_ERROR, "database disappeared from CSS");
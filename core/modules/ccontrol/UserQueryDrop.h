@@ -40,9 +40,15 @@ namespace qserv {
 namespace css {
 class CssAccess;
 }
+namespace ccontrol {
+class ResultCache;
+}
 namespace qmeta {
 class QMeta;
 }
+namespace qproc {
+class SecondaryIndex;
+}
 namespace sql {
 class SqlConnection;
 }}}
@@ -64,13 +70,17 @@ public:
      *  @param resultDbConn:  Connection to results database
      *  @param queryMetadata: QMeta interface
      *  @param qMetaCzarId:   Czar ID in QMeta database
+     *  @param resultCache:   Cached query results, may be null
+     *  @param secondaryIndex: Secondary index, may be null
      */
     UserQueryDrop(std::shared_ptr<css::CssAccess> const& css,
                   std::string const& dbName,
                   std::string const& tableName,
                   sql::SqlConnection* resultDbConn,
                   std::shared_ptr<qmeta::QMeta> const& queryMetadata,
-                  qmeta::CzarId qMetaCzarId);
+                  qmeta::CzarId qMetaCzarId,
+                  std::shared_ptr<ResultCache> const& resultCache,
+                  std::shared_ptr<qproc::SecondaryIndex> const& secondaryIndex);
 
     UserQueryDrop(UserQueryDrop const&) = delete;
     UserQueryDrop& operator=(UserQueryDrop const&) = delete;
@@ -115,6 +125,8 @@ private:
     sql::SqlConnection* _resultDbConn;
     std::shared_ptr<qmeta::QMeta> _queryMetadata;
     qmeta::CzarId const _qMetaCzarId;   ///< Czar ID in QMeta database
+    std::shared_ptr<ResultCache> const _resultCache;
+    std::shared_ptr<qproc::SecondaryIndex> const _secondaryIndex;
     QueryState _qState;
     std::shared_ptr<qdisp::MessageStore> _messageStore;
     int _sessionId; ///< External reference number
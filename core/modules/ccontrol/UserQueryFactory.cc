@@ -25,8 +25,11 @@
 #include "ccontrol/UserQueryFactory.h"
 
 // System headers
+#include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <cstdlib>
+#include <set>
 #include <string>
 
 // Third-party headers
@@ -37,25 +40,131 @@
 // Qserv headers
 #include "ccontrol/ConfigError.h"
 #include "ccontrol/ConfigMap.h"
+#include "ccontrol/ResultCache.h"
+#include "ccontrol/UserQueryCached.h"
 #include "ccontrol/UserQueryDrop.h"
 #include "ccontrol/UserQueryFlushChunksCache.h"
 #include "ccontrol/UserQueryInvalid.h"
 #include "ccontrol/UserQuerySelect.h"
 #include "ccontrol/UserQueryType.h"
 #include "css/CssAccess.h"
+#include "css/CssError.h"
 #include "css/KvInterfaceImplMem.h"
 #include "czar/CzarConfig.h"
 #include "mysql/MySqlConfig.h"
+#include "proto/ProtoHeaderWrap.h"
 #include "qdisp/Executive.h"
 #include "qdisp/MessageStore.h"
 #include "qmeta/QMetaMysql.h"
 #include "qproc/QuerySession.h"
 #include "qproc/SecondaryIndex.h"
+#include "query/BoolTerm.h"
+#include "query/FromList.h"
+#include "query/FuncExpr.h"
+#include "query/GroupByClause.h"
+#include "query/HavingClause.h"
+#include "query/JoinRef.h"
+#include "query/JoinSpec.h"
+#include "query/OrderByClause.h"
+#include "query/SelectList.h"
+#include "query/SelectStmt.h"
+#include "query/TableRef.h"
+#include "query/ValueExpr.h"
+#include "query/ValueFactor.h"
+#include "query/WhereClause.h"
 #include "rproc/InfileMerger.h"
 #include "sql/SqlConnection.h"
 
 namespace {
 LOG_LOGGER _log = LOG_GET("lsst.qserv.ccontrol.UserQueryFactory");
+
+using lsst::qserv::ccontrol::ResultCache;
+
+/// Functions whose value changes between runs of the same query
+std::set<std::string> const volatileFunctions = {
+    "CONNECTION_ID", "CURDATE", "CURRENT_DATE", "CURRENT_TIME", "CURRENT_TIMESTAMP",
+    "CURRENT_USER", "CURTIME", "LAST_INSERT_ID", "LOCALTIME", "LOCALTIMESTAMP", "NOW",
+    "RAND", "SYSDATE", "UNIX_TIMESTAMP", "UTC_DATE", "UTC_TIME", "UTC_TIMESTAMP",
+    "UUID", "UUID_SHORT"};
+
+/// @return true if 'expr' calls a volatile function, at any depth.
+bool callsVolatile(lsst::qserv::query::ValueExpr const& expr) {
+    using lsst::qserv::query::ValueFactor;
+    for (auto const& factorOp : expr.getFactorOps()) {
+        auto const& factor = factorOp.factor;
+        if (!factor) continue;
+        if (factor->getType() == ValueFactor::FUNCTION || factor->getType() == ValueFactor::AGGFUNC) {
+            auto const funcExpr = factor->getFuncExpr();
+            if (!funcExpr) continue;
+            std::string name = funcExpr->name;
+            std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+            if (volatileFunctions.count(name) != 0) {
+                return true;
+            }
+            for (auto const& param : funcExpr->params) {
+                if (param && callsVolatile(*param)) {
+                    return true;
+                }
+            }
+        } else if (factor->getType() == ValueFactor::EXPR) {
+            if (factor->getExpr() && callsVolatile(*factor->getExpr())) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/// @return true if any function call of 'stmt' is to a volatile function.
+bool callsVolatile(lsst::qserv::query::SelectStmt const& constStmt) {
+    // findValueExprs() only collects, it is not declared const
+    auto& stmt = const_cast<lsst::qserv::query::SelectStmt&>(constStmt);
+    lsst::qserv::query::ValueExprPtrVector exprs(*stmt.getSelectList().getValueExprList());
+    if (stmt.hasWhereClause()) stmt.getWhereClause().findValueExprs(exprs);
+    if (stmt.hasGroupBy()) stmt.getGroupBy().findValueExprs(exprs);
+    if (stmt.hasHaving()) stmt.getHaving().findValueExprs(exprs);
+    if (stmt.hasOrderBy()) stmt.getOrderBy().findValueExprs(exprs);
+    for (auto const& tableRef : stmt.getFromList().getTableRefList()) {
+        for (auto const& join : tableRef->getJoins()) {
+            auto const spec = join->getSpec();
+            if (spec && spec->getOn()) spec->getOn()->findValueExprs(exprs);
+        }
+    }
+    for (auto const& expr : exprs) {
+        if (expr && callsVolatile(*expr)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Find the result cache key of an analysed query and the data versions of
+/// its databases.
+/// @return false if the result of the query must not be cached.
+bool resultCacheKey(lsst::qserv::qproc::QuerySession const& qs,
+                    lsst::qserv::css::CssAccess const& css,
+                    std::string& key, ResultCache::Versions& versions) {
+    // analysis qualified all table and column names, the text does not
+    // depend on the default database or on the way the query was typed
+    key = qs.getStmt().getQueryTemplate().sqlFragment();
+
+    if (callsVolatile(qs.getStmt())) {
+        return false;
+    }
+
+    versions.clear();
+    for (auto const& tableRef : qs.getStmt().getFromList().getTableRefList()) {
+        versions[tableRef->getDb()] = css.getDbDataVersion(tableRef->getDb());
+        for (auto const& join : tableRef->getJoins()) {
+            auto const& right = join->getRight();
+            if (right) {
+                versions[right->getDb()] = css.getDbDataVersion(right->getDb());
+            }
+        }
+    }
+    return !versions.empty();
+}
+
 }
 
 namespace lsst {
@@ -73,10 +182,19 @@ public:
     qdisp::Executive::Config::Ptr executiveConfig;
     std::shared_ptr<css::CssAccess> css;
     mysql::MySqlConfig const mysqlResultConfig;
+    int const mergeConnections;
+    bool const aggregateMerge;
+    bool const topNMerge;
+    bool const directMerge;
+    int const limitFirstWave;
+    bool const orderedResults;
+    proto::ProtoHeader::ChecksumType resultChecksum;
+    int const resultProtocol;
     std::shared_ptr<qproc::SecondaryIndex> secondaryIndex;
     std::shared_ptr<qmeta::QMeta> queryMetadata;
     std::unique_ptr<sql::SqlConnection> resultDbConn;
     qmeta::CzarId qMetaCzarId = {0};   ///< Czar ID in QMeta database
+    ResultCache::Ptr resultCache;      ///< null if disabled
 };
 
 ////////////////////////////////////////////////////////////////////////
@@ -89,6 +207,21 @@ UserQueryFactory::UserQueryFactory(czar::CzarConfig const& czarConfig,
     // register czar in QMeta
     // TODO: check that czar with the same name is not active already?
     _impl->qMetaCzarId = _impl->queryMetadata->registerCzar(czarName);
+
+    // cached tables are named after czar ID, so that czars sharing result
+    // database leave each other's tables alone
+    if (czarConfig.getResultCacheRows() > 0) {
+        std::string const prefix = "qcache" + std::to_string(_impl->qMetaCzarId) + "_";
+        _impl->resultCache = std::make_shared<ResultCache>(_impl->mysqlResultConfig, prefix,
+                                                           czarConfig.getResultCacheRows(),
+                                                           std::max(czarConfig.getResultCacheTtlSec(), 0));
+    }
+}
+
+ResultCache::Stats
+UserQueryFactory::getResultCacheStats() const {
+    if (_impl->resultCache) return _impl->resultCache->getStats();
+    return ResultCache::Stats();
 }
 
 UserQuery::Ptr
@@ -114,18 +247,48 @@ UserQueryFactory::newUserQuery(std::string const& query,
             sessionValid = false;
         }
 
+        // repeated query on unchanged data needs no dispatch
+        std::string cacheKey;
+        ResultCache::Versions cacheVersions;
+        bool cacheable = false;
+        if (sessionValid && _impl->resultCache) {
+            try {
+                cacheable = resultCacheKey(*qs, *_impl->css, cacheKey, cacheVersions);
+            } catch (css::CssError const& exc) {
+                LOGS(_log, LOG_LVL_WARN, "Result cache disabled for query, CSS failure: " << exc.what());
+            }
+        }
+        if (cacheable) {
+            auto entry = _impl->resultCache->get(cacheKey, cacheVersions);
+            if (entry) {
+                LOGS(_log, LOG_LVL_DEBUG, "make UserQueryCached: " << entry->table);
+                return std::make_shared<UserQueryCached>(entry, _impl->mysqlResultConfig,
+                                                         _impl->resultCache->newTableName());
+            }
+        }
+
         auto messageStore = std::make_shared<qdisp::MessageStore>();
         std::shared_ptr<qdisp::Executive> executive;
         std::shared_ptr<rproc::InfileMergerConfig> infileMergerConfig;
         if (sessionValid) {
             executive = qdisp::Executive::newExecutive(_impl->executiveConfig, messageStore);
             infileMergerConfig = std::make_shared<rproc::InfileMergerConfig>(_impl->mysqlResultConfig);
+            infileMergerConfig->mergeConnections = _impl->mergeConnections;
+            infileMergerConfig->aggregateMerge = _impl->aggregateMerge;
+            infileMergerConfig->topNMerge = _impl->topNMerge;
+            infileMergerConfig->directMerge = _impl->directMerge;
+            infileMergerConfig->resultChecksum = _impl->resultChecksum;
+            infileMergerConfig->resultProtocol = _impl->resultProtocol;
         }
         auto uq = std::make_shared<UserQuerySelect>(qs, messageStore, executive, infileMergerConfig,
                                                     _impl->secondaryIndex, _impl->queryMetadata,
-                                                    _impl->qMetaCzarId, errorExtra);
+                                                    _impl->qMetaCzarId, _impl->limitFirstWave,
+                                                    _impl->orderedResults, errorExtra);
         if (sessionValid) {
             uq->setupChunking();
+            if (cacheable) {
+                uq->setResultCache(_impl->resultCache, cacheKey, cacheVersions);
+            }
         }
         return uq;
     } else if (UserQueryType::isDropTable(query, dbName, tableName)) {
@@ -135,19 +298,23 @@ UserQueryFactory::newUserQuery(std::string const& query,
         }
         auto uq = std::make_shared<UserQueryDrop>(_impl->css, dbName, tableName,
                                                   _impl->resultDbConn.get(),
-                                                  _impl->queryMetadata, _impl->qMetaCzarId);
+                                                  _impl->queryMetadata, _impl->qMetaCzarId,
+                                                  _impl->resultCache, _impl->secondaryIndex);
         LOGS(_log, LOG_LVL_DEBUG, "make UserQueryDrop: " << dbName << "." << tableName);
         return uq;
     } else if (UserQueryType::isDropDb(query, dbName)) {
         // processing DROP DATABASE
         auto uq = std::make_shared<UserQueryDrop>(_impl->css, dbName, std::string(),
                                                   _impl->resultDbConn.get(),
-                                                  _impl->queryMetadata, _impl->qMetaCzarId);
+                                                  _impl->queryMetadata, _impl->qMetaCzarId,
+                                                  _impl->resultCache, _impl->secondaryIndex);
         LOGS(_log, LOG_LVL_DEBUG, "make UserQueryDrop: db=" << dbName);
         return uq;
     } else if (UserQueryType::isFlushChunksCache(query, dbName)) {
         auto uq = std::make_shared<UserQueryFlushChunksCache>(_impl->css, dbName,
-                                                              _impl->resultDbConn.get());
+                                                              _impl->resultDbConn.get(),
+                                                              _impl->resultCache,
+                                                              _impl->secondaryIndex);
         LOGS(_log, LOG_LVL_DEBUG, "make UserQueryFlushChunksCache: " << dbName);
         return uq;
     } else {
@@ -158,10 +325,29 @@ UserQueryFactory::newUserQuery(std::string const& query,
 }
 
 UserQueryFactory::Impl::Impl(czar::CzarConfig const& czarConfig)
-    : mysqlResultConfig(czarConfig.getMySqlResultConfig()) {
+    : mysqlResultConfig(czarConfig.getMySqlResultConfig()),
+      mergeConnections(czarConfig.getMergeConnections()),
+      aggregateMerge(czarConfig.getAggregateMerge() != 0),
+      topNMerge(czarConfig.getTopNMerge() != 0),
+      directMerge(czarConfig.getDirectMerge() != 0),
+      limitFirstWave(czarConfig.getLimitFirstWave()),
+      orderedResults(czarConfig.getOrderedResults() != 0),
+      resultProtocol(czarConfig.getResultProtocol()) {
+
+    if (!proto::ProtoHeaderWrap::parseChecksumType(czarConfig.getResultChecksum(), resultChecksum)) {
+        throw ConfigError("Unknown tuning.resultChecksum: " + czarConfig.getResultChecksum());
+    }
+    if (resultProtocol != 2 && resultProtocol != 3) {
+        throw ConfigError("Unsupported tuning.resultProtocol: " + std::to_string(resultProtocol));
+    }
 
     executiveConfig = std::make_shared<qdisp::Executive::Config>(czarConfig.getXrootdFrontendUrl());
-    secondaryIndex = std::make_shared<qproc::SecondaryIndex>(mysqlResultConfig);
+    secondaryIndex = std::make_shared<qproc::SecondaryIndex>(
+        mysqlResultConfig,
+        std::max(czarConfig.getSecondaryIndexBatchSize(), 1),
+        std::max(czarConfig.getSecondaryIndexConnections(), 1),
+        std::max(czarConfig.getSecondaryIndexCacheSize(), 0),
+        czarConfig.getSecondaryIndexDir());
 
     // make one dedicated connection for results database
     resultDbConn.reset(new sql::SqlConnection(mysqlResultConfig));
@@ -39,6 +39,7 @@
 #include "boost/utility.hpp"
 
 // Local headers
+#include "ccontrol/ResultCache.h"
 #include "ccontrol/UserQuery.h"
 #include "czar/CzarConfig.h"
 #include "global/stringTypes.h"
@@ -63,6 +64,9 @@ public:
     UserQuery::Ptr newUserQuery(std::string const& query,
                                 std::string const& defaultDb);
 
+    /// @return counters of the query result cache, all zeros if disabled
+    ResultCache::Stats getResultCacheStats() const;
+
 private:
     class Impl;
     std::shared_ptr<Impl> _impl;
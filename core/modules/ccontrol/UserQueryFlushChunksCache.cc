@@ -29,9 +29,11 @@
 #include "lsst/log/Log.h"
 
 // Qserv headers
+#include "ccontrol/ResultCache.h"
 #include "css/CssAccess.h"
 #include "css/EmptyChunks.h"
 #include "qdisp/MessageStore.h"
+#include "qproc/SecondaryIndex.h"
 #include "sql/SqlConnection.h"
 #include "sql/SqlErrorObject.h"
 
@@ -46,8 +48,11 @@ namespace ccontrol {
 // Constructor
 UserQueryFlushChunksCache::UserQueryFlushChunksCache(std::shared_ptr<css::CssAccess> const& css,
                                                      std::string const& dbName,
-                                                     sql::SqlConnection* resultDbConn)
-    : _css(css), _dbName(dbName), _resultDbConn(resultDbConn),
+                                                     sql::SqlConnection* resultDbConn,
+                                                     std::shared_ptr<ResultCache> const& resultCache,
+                                                     std::shared_ptr<qproc::SecondaryIndex> const& secondaryIndex)
+    : _css(css), _dbName(dbName), _resultDbConn(resultDbConn), _resultCache(resultCache),
+      _secondaryIndex(secondaryIndex),
       _qState(UNKNOWN), _messageStore(std::make_shared<qdisp::MessageStore>()) {
 }
 
@@ -67,6 +72,15 @@ void UserQueryFlushChunksCache::submit() {
     // reset empty chunk cache , this does not throw
     _css->getEmptyChunks().clearCache(_dbName);
 
+    // cached query results may depend on the old chunk list
+    if (_resultCache) {
+        _resultCache->invalidate(_dbName);
+    }
+    // and so may the key locations of its secondary index
+    if (_secondaryIndex) {
+        _secondaryIndex->invalidate(_dbName);
+    }
+
     _qState = SUCCESS;
 }
 
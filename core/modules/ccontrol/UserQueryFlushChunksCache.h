@@ -33,9 +33,15 @@
 // Forward decl
 namespace lsst {
 namespace qserv {
+namespace ccontrol {
+class ResultCache;
+}
 namespace css {
 class CssAccess;
 }
+namespace qproc {
+class SecondaryIndex;
+}
 namespace sql {
 class SqlConnection;
 }}}
@@ -59,10 +65,14 @@ public:
      *  @param css:           CSS interface
      *  @param dbName:        Name of the database where table is
      *  @param resultDbConn:  Connection to results database
+     *  @param resultCache:   Cached query results, may be null
+     *  @param secondaryIndex: Secondary index, may be null
      */
     UserQueryFlushChunksCache(std::shared_ptr<css::CssAccess> const& css,
                               std::string const& dbName,
-                              sql::SqlConnection* resultDbConn);
+                              sql::SqlConnection* resultDbConn,
+                              std::shared_ptr<ResultCache> const& resultCache,
+                              std::shared_ptr<qproc::SecondaryIndex> const& secondaryIndex);
 
     UserQueryFlushChunksCache(UserQueryFlushChunksCache const&) = delete;
     UserQueryFlushChunksCache& operator=(UserQueryFlushChunksCache const&) = delete;
@@ -103,6 +113,8 @@ private:
     std::shared_ptr<css::CssAccess> const _css;
     std::string const _dbName;
     sql::SqlConnection* _resultDbConn;
+    std::shared_ptr<ResultCache> const _resultCache;
+    std::shared_ptr<qproc::SecondaryIndex> const _secondaryIndex;
     QueryState _qState;
     std::shared_ptr<qdisp::MessageStore> _messageStore;
 
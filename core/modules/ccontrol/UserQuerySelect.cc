@@ -64,7 +64,10 @@
 #include "ccontrol/UserQuerySelect.h"
 
 // System headers
+#include <algorithm>
 #include <cassert>
+#include <deque>
+#include <future>
 #include <memory>
 
 // LSST headers
@@ -89,7 +92,8 @@
 #include "query/JoinRef.h"
 #include "query/SelectStmt.h"
 #include "rproc/InfileMerger.h"
-#include "util/Callable.h"
+#include "util/Command.h"
+#include "util/EventThread.h"
 #include "util/IterableFormatter.h"
 
 namespace {
@@ -99,17 +103,6 @@ LOG_LOGGER _log = LOG_GET("lsst.qserv.ccontrol.UserQuerySelect");
 namespace lsst {
 namespace qserv {
 
-/// A class that can be used to parameterize a ProtoImporter<TaskMsg> for
-/// debugging purposes
-class ProtoPrinter: public util::UnaryCallable<void, std::shared_ptr<proto::TaskMsg> > {
-public:
-    ProtoPrinter() {}
-    virtual void operator()(std::shared_ptr<proto::TaskMsg> m) {
-        std::cout << "Got taskmsg ok";
-    }
-    virtual ~ProtoPrinter() {}
-};
-
 /// Factory to create chunkid-specific MsgReceiver objs linked to the right
 /// messagestore
 class ChunkMsgReceiver : public MsgReceiver {
@@ -134,6 +127,73 @@ public:
 // UserQuerySelect implementation
 namespace ccontrol {
 
+namespace {
+
+/// Chunks whose queries one _taskMsgPool command generates
+size_t const chunksPerBatch = 32;
+
+/// Batches a query generates ahead of dispatch
+size_t const maxPendingBatches = 8;
+
+/// A chunk query ready to be dispatched
+struct ChunkJob {
+    int jobId;
+    int chunkId;
+    std::string db;
+    std::string chunkResultName;
+    std::string msg; ///< serialized TaskMsg
+};
+typedef std::vector<ChunkJob> ChunkJobVector;
+
+/// Generate and serialize the TaskMsgs of a batch of chunks, the first of
+/// which has job id firstJobId.
+ChunkJobVector makeChunkJobs(qproc::QuerySession const& qSession,
+                             qproc::ChunkSpecVector const& batch,
+                             int firstJobId,
+                             qproc::TaskMsgFactory const& taskMsgFactory,
+                             TmpTableName const& ttn,
+                             uint64_t executiveId) {
+    ChunkJobVector jobs;
+    jobs.reserve(batch.size());
+    int jobId = firstJobId;
+    for (auto const& chunkSpec: batch) {
+        std::shared_ptr<qproc::ChunkQuerySpec> cs = qSession.buildChunkQuerySpec(chunkSpec);
+        ChunkJob job;
+        job.jobId = jobId;
+        job.chunkId = cs->chunkId;
+        job.db = cs->db;
+        job.chunkResultName = ttn.make(cs->chunkId);
+        job.msg = taskMsgFactory.serializeMsg(*cs, job.chunkResultName, executiveId, jobId);
+#ifndef NDEBUG
+        proto::TaskMsg check;
+        if (!proto::ProtoImporter<proto::TaskMsg>::setMsgFrom(check, job.msg.data(), job.msg.size())) {
+            throw UserQueryBug("Error serializing TaskMsg for chunk " + std::to_string(job.chunkId));
+        }
+#endif
+        jobs.push_back(std::move(job));
+        ++jobId;
+    }
+    return jobs;
+}
+
+std::mutex taskMsgPoolMutex;
+
+} // anonymous namespace
+
+std::shared_ptr<util::ThreadPool> UserQuerySelect::_taskMsgPool;
+
+int UserQuerySelect::setTaskMsgPoolSize(int size) {
+    std::lock_guard<std::mutex> lock(taskMsgPoolMutex);
+    size = std::max(1, size); // size must be at least 1
+    if (_taskMsgPool == nullptr) {
+        _taskMsgPool = util::ThreadPool::newThreadPool(size, nullptr);
+    } else {
+        _taskMsgPool->resize(size);
+    }
+    LOGS(_log, LOG_LVL_DEBUG, "UserQuerySelect::setTaskMsgPoolSize sz=" << size);
+    return size;
+}
+
 /// Constructor
 UserQuerySelect::UserQuerySelect(std::shared_ptr<qproc::QuerySession> const& qs,
                                  std::shared_ptr<qdisp::MessageStore> const& messageStore,
@@ -142,16 +202,25 @@ UserQuerySelect::UserQuerySelect(std::shared_ptr<qproc::QuerySession> const& qs,
                                  std::shared_ptr<qproc::SecondaryIndex> const& secondaryIndex,
                                  std::shared_ptr<qmeta::QMeta> const& queryMetadata,
                                  qmeta::CzarId czarId,
+                                 int limitFirstWave,
+                                 bool orderedResults,
                                  std::string const& errorExtra)
     :  _qSession(qs), _messageStore(messageStore), _executive(executive),
        _infileMergerConfig(infileMergerConfig), _secondaryIndex(secondaryIndex),
        _queryMetadata(queryMetadata), _qMetaCzarId(czarId), _qMetaQueryId(0),
-       _killed(false), _errorExtra(errorExtra) {
+       _killed(false), _errorExtra(errorExtra), _limitFirstWave(limitFirstWave) {
     // register query in qmeta, this may throw
     _qMetaRegister();
 
     _resultTable = "result_";
     _resultTable += std::to_string(_qMetaQueryId);
+
+    // The merge of "ORDER BY ... LIMIT" queries writes sorted rows into a new
+    // MyISAM table, which a table scan returns in insertion order.
+    if (orderedResults && _infileMergerConfig) {
+        auto mergeStmt = _qSession->getMergeStmt();
+        _orderedResult = mergeStmt && mergeStmt->hasOrderBy() && mergeStmt->hasLimit();
+    }
 }
 
 std::string UserQuerySelect::getError() const {
@@ -187,6 +256,9 @@ void UserQuerySelect::addChunk(qproc::ChunkSpec const& cs) {
 
 std::string
 UserQuerySelect::getProxyOrderBy() {
+    if (_orderedResult) {
+        return std::string();
+    }
     return _qSession->getProxyOrderBy();
 }
 
@@ -201,39 +273,92 @@ void UserQuerySelect::submit() {
     // create query messages and send them to the async query manager.
     LOGS(_log, LOG_LVL_DEBUG, getQueryIdString() << " UserQuerySelect beginning submission");
     assert(_infileMerger);
+    if (_taskMsgPool == nullptr) {
+        throw UserQueryBug(getQueryIdString() + " taskMsgPool uninitialized");
+    }
 
-    qproc::TaskMsgFactory taskMsgFactory(_qMetaQueryId);
-    TmpTableName ttn(_qMetaQueryId, _qSession->getOriginal());
-    proto::ProtoImporter<proto::TaskMsg> pi;
+    auto taskMsgFactory = std::make_shared<qproc::TaskMsgFactory>(
+        _qMetaQueryId, _infileMergerConfig->resultChecksum, _infileMergerConfig->resultProtocol);
+    auto ttn = std::make_shared<TmpTableName>(_qMetaQueryId, _qSession->getOriginal());
+    qproc::ChunkSpecVector const& chunkSpecs = _qSession->getChunks();
     std::vector<int> chunks;
-    int msgCount = 0;
     int sequence = 0;
-    // Writing query for each chunk, stop if query is cancelled.
-    for(auto i = _qSession->cQueryBegin(), e = _qSession->cQueryEnd();
-            i != e && !_executive->getCancelled(); ++i) {
-        qproc::ChunkQuerySpec& cs = *i;
-        chunks.push_back(cs.chunkId);
-        std::string chunkResultName = ttn.make(cs.chunkId);
-        ++msgCount;
-        std::ostringstream ss;
-        taskMsgFactory.serializeMsg(cs, chunkResultName, _executive->getId(), sequence, ss);
-        std::string msg = ss.str();
-
-        pi(msg.data(), msg.size());
-        if (pi.getNumAccepted() != msgCount) {
-            throw UserQueryBug(getQueryIdString() + " Error serializing TaskMsg.");
-        }
+    // When the rows of any chunks satisfy the LIMIT, chunks are dispatched in
+    // waves, each twice the size of the previous one, and dispatch stops once
+    // enough rows have been merged (the Executive is then cancelled). A wave
+    // leaves once half of the previous one completed, so workers are not idle
+    // while its slowest chunks finish. LIMIT 0 needs no rows, there is nothing
+    // to stop dispatch early.
+    int waveSize = 0;
+    int waveEnd = -1;
+    if (_qSession->getRowLimit() > 0 && _limitFirstWave > 0) {
+        waveSize = _limitFirstWave;
+        waveEnd = waveSize;
+    }
 
-        std::shared_ptr<ChunkMsgReceiver> cmr = ChunkMsgReceiver::newInstance(cs.chunkId, _messageStore);
-        ResourceUnit ru;
-        ru.setAsDbChunk(cs.db, cs.chunkId);
-        qdisp::JobDescription jobDesc(sequence, ru, ss.str(),
-                std::make_shared<MergingHandler>(cmr, _infileMerger, chunkResultName));
-        _executive->add(jobDesc);
-        ++sequence;
+    // Chunk queries are generated in batches on _taskMsgPool, a few batches
+    // ahead of dispatch, so the first jobs leave before the last ones are
+    // generated. Batches are dispatched in order, the job id of a chunk is
+    // its position in chunkSpecs.
+    std::deque<std::future<ChunkJobVector>> pending;
+    size_t nextChunk = 0;
+    auto queueBatch = [&]() {
+        size_t const begin = nextChunk;
+        nextChunk = std::min(begin + chunksPerBatch, chunkSpecs.size());
+        auto promise = std::make_shared<std::promise<ChunkJobVector>>();
+        pending.push_back(promise->get_future());
+        auto qSession = _qSession;
+        qproc::ChunkSpecVector batch(chunkSpecs.begin() + begin, chunkSpecs.begin() + nextChunk);
+        uint64_t const executiveId = _executive->getId();
+        auto generate = [=](util::CmdData*) {
+            try {
+                promise->set_value(makeChunkJobs(*qSession, batch, begin, *taskMsgFactory,
+                                                 *ttn, executiveId));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        };
+        _taskMsgPool->getQueue()->queCmd(std::make_shared<util::Command>(generate));
+    };
+    while (pending.size() < maxPendingBatches && nextChunk < chunkSpecs.size()) {
+        queueBatch();
     }
 
-    LOGS(_log, LOG_LVL_DEBUG, getQueryIdString() <<" total jobs in query=" << sequence);
+    // Sending jobs for each chunk, stop if query is cancelled.
+    while (!pending.empty() && !_executive->getCancelled()) {
+        ChunkJobVector jobs = pending.front().get();
+        pending.pop_front();
+        if (nextChunk < chunkSpecs.size()) {
+            queueBatch();
+        }
+        for (auto& job: jobs) {
+            if (sequence == waveEnd) {
+                _executive->waitInflight(waveSize / 2);
+                if (_executive->getCancelled()) {
+                    break;
+                }
+                waveSize *= 2;
+                waveEnd += waveSize;
+                LOGS(_log, LOG_LVL_DEBUG, getQueryIdString() << " limit not reached after "
+                     << sequence << " jobs, dispatching " << waveSize << " more");
+            }
+            if (_executive->getCancelled()) {
+                break;
+            }
+            assert(job.jobId == sequence);
+            chunks.push_back(job.chunkId);
+            std::shared_ptr<ChunkMsgReceiver> cmr = ChunkMsgReceiver::newInstance(job.chunkId, _messageStore);
+            ResourceUnit ru;
+            ru.setAsDbChunk(job.db, job.chunkId);
+            qdisp::JobDescription jobDesc(sequence, ru, job.msg,
+                    std::make_shared<MergingHandler>(cmr, _infileMerger, job.chunkResultName));
+            _executive->add(jobDesc);
+            ++sequence;
+        }
+    }
+
+    LOGS(_log, LOG_LVL_DEBUG, getQueryIdString() <<" total jobs in query=" << sequence
+         << (_executive->getLimitReached() ? " (limit reached)" : ""));
 
     // we only care about per-chunk info for ASYNC queries, and
     // currently all queries are SYNC, so we skip this.
@@ -247,11 +372,20 @@ void UserQuerySelect::submit() {
 /// @return the QueryState indicating success or failure
 QueryState UserQuerySelect::join() {
     bool successful = _executive->join(); // Wait for all data
-    _infileMerger->finalize(); // Since all data are in, run final SQL commands like GROUP BY.
+    // Since all data are in, run final SQL commands like GROUP BY.
+    // This also waits for, and reports errors from, results still being loaded.
+    if (!_infileMerger->finalize()) {
+        LOGS(_log, LOG_LVL_ERROR, getQueryIdString() << " InfileMerger::finalize failed: "
+             << _infileMerger->getError());
+        successful = false;
+    }
     _discardMerger();
     if (successful) {
         _qMetaUpdateStatus(qmeta::QInfo::COMPLETED);
         LOGS(_log, LOG_LVL_DEBUG, getQueryIdString() << " Joined everything (success)");
+        if (_resultCache) {
+            _resultCache->put(_resultCacheKey, _resultCacheVersions, _resultTable, getProxyOrderBy());
+        }
         return SUCCESS;
     } else {
         _qMetaUpdateStatus(qmeta::QInfo::FAILED);
@@ -299,6 +433,17 @@ void UserQuerySelect::_setupMerger() {
     _infileMergerConfig->targetTable = _resultTable;
     _infileMergerConfig->mergeStmt = _qSession->getMergeStmt();
     _infileMerger = std::make_shared<rproc::InfileMerger>(*_infileMergerConfig);
+    int const rowLimit = _qSession->getRowLimit();
+    if (rowLimit > 0) {
+        // Remaining jobs are not needed once rowLimit rows have arrived.
+        std::weak_ptr<qdisp::Executive> weakExecutive = _executive;
+        _infileMerger->setRowLimitHandler(rowLimit, [weakExecutive]() {
+            auto executive = weakExecutive.lock();
+            if (executive != nullptr) {
+                executive->squashLimitReached();
+            }
+        });
+    }
 }
 
 void UserQuerySelect::setupChunking() {
@@ -326,20 +471,23 @@ void UserQuerySelect::setupChunking() {
         css::StripingParams partStriping = _qSession->getDbStriping();
 
         im = std::make_shared<qproc::IndexMap>(partStriping, _secondaryIndex);
-        qproc::ChunkSpecVector csv;
         if (constraints) {
-            csv = im->getChunks(*constraints);
-        } else { // Unconstrained: full-sky
-            csv = im->getAllChunks();
-        }
-
-        LOGS(_log, LOG_LVL_TRACE, getQueryIdString() << " Chunk specs: " << util::printable(csv));
-        // Filter out empty chunks
-        for(qproc::ChunkSpecVector::const_iterator i=csv.begin(), e=csv.end();
-            i != e;
-            ++i) {
-            if (eSet->count(i->chunkId) == 0) { // chunk not in empty?
-                _qSession->addChunk(*i);
+            qproc::ChunkSpecVector csv = im->getChunks(*constraints);
+
+            LOGS(_log, LOG_LVL_TRACE, getQueryIdString() << " Chunk specs: " << util::printable(csv));
+            // Filter out empty chunks
+            for(qproc::ChunkSpecVector::const_iterator i=csv.begin(), e=csv.end();
+                i != e;
+                ++i) {
+                if (eSet->count(i->chunkId) == 0) { // chunk not in empty?
+                    _qSession->addChunk(*i);
+                }
+            }
+        } else { // Unconstrained: full-sky, empty chunks are already filtered out
+            auto csv = im->getNonEmptyChunks(eSet);
+            LOGS(_log, LOG_LVL_TRACE, getQueryIdString() << " Full-sky chunk count: " << csv->size());
+            for (auto const& cs: *csv) {
+                _qSession->addChunk(cs);
             }
         }
     } else {
@@ -347,6 +495,13 @@ void UserQuerySelect::setupChunking() {
     }
 }
 
+void UserQuerySelect::setResultCache(ResultCache::Ptr const& cache, std::string const& key,
+                                     ResultCache::Versions const& versions) {
+    _resultCache = cache;
+    _resultCacheKey = key;
+    _resultCacheVersions = versions;
+}
+
 // register query in qmeta database
 void UserQuerySelect::_qMetaRegister()
 {
@@ -39,6 +39,7 @@
 // Third-party headers
 
 // Qserv headers
+#include "ccontrol/ResultCache.h"
 #include "ccontrol/UserQuery.h"
 #include "css/StripingParams.h"
 #include "qmeta/QInfo.h"
@@ -63,6 +64,9 @@ class SecondaryIndex;
 namespace rproc {
 class InfileMerger;
 class InfileMergerConfig;
+}
+namespace util {
+class ThreadPool;
 }}}
 
 namespace lsst {
@@ -80,6 +84,8 @@ public:
                     std::shared_ptr<qproc::SecondaryIndex> const& secondaryIndex,
                     std::shared_ptr<qmeta::QMeta> const& queryMetadata,
                     qmeta::CzarId czarId,
+                    int limitFirstWave,
+                    bool orderedResults,
                     std::string const& errorExtra);
 
     UserQuerySelect(UserQuerySelect const&) = delete;
@@ -119,8 +125,18 @@ public:
     /// Add a chunk for later execution
     void addChunk(qproc::ChunkSpec const& cs);
 
+    /// Create the shared thread pool generating chunk query messages
+    /// and/or change its size.
+    // @return the size of the pool.
+    static int setTaskMsgPoolSize(int size);
+
     void setupChunking();
 
+    /// Put the result into 'cache' under 'key' if the query succeeds.
+    /// @param versions: data versions of the databases used by the query
+    void setResultCache(ResultCache::Ptr const& cache, std::string const& key,
+                        ResultCache::Versions const& versions);
+
 private:
     void _setupMerger();
     void _discardMerger();
@@ -145,6 +161,18 @@ private:
     std::mutex _killMutex;
     std::string _errorExtra;        ///< Additional error information
     std::string _resultTable;       ///< Result table name
+    /// Chunks dispatched at first for a query any rows of which satisfy its
+    /// LIMIT, each later wave is twice as large. 0 dispatches all chunks at once.
+    int _limitFirstWave;
+    /// true if the merge writes rows into the result table in ORDER BY
+    /// order, so that mysql-proxy need not sort them again.
+    bool _orderedResult{false};
+    ResultCache::Ptr _resultCache; ///< null if the result is not cached
+    std::string _resultCacheKey;
+    ResultCache::Versions _resultCacheVersions;
+
+    /// Generates chunk query messages for submit() of all queries
+    static std::shared_ptr<util::ThreadPool> _taskMsgPool;
 };
 
 }}} // namespace lsst::qserv:ccontrol
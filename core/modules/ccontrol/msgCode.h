@@ -37,6 +37,7 @@ const int MSG_XRD_OPEN_FAIL = 1290;
 const int MSG_XRD_WRITE     = 1300;
 const int MSG_XRD_READ      = 1400;
 const int MSG_RESULT_MD5    = 1420;
+const int MSG_RESULT_CHECKSUM = 1425; // non-MD5 checksum mismatch
 const int MSG_RESULT_DECODE = 1430;
 const int MSG_RESULT_ERROR  = 1470;
 const int MSG_MERGE_ERROR   = 1480;
@@ -25,9 +25,15 @@
 
 // System headers
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
 #include <fstream>
 #include <map>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 // Third-party headers
 #include "boost/lexical_cast.hpp"
@@ -55,12 +61,244 @@ LOG_LOGGER _log = LOG_GET("lsst.qserv.css.CssAccess");
 // Name of sub-key used for packed data
 std::string const _packedKeyName(".packed.json");
 
+using lsst::qserv::css::KvInterface;
+using lsst::qserv::css::NoSuchKey;
+using lsst::qserv::css::ReadonlyCss;
+
+/// Read-only immutable copy of KV store contents. Unlike KvInterfaceImplMem
+/// it does not need any locking as data never changes after construction.
+class KvSnapshot : public KvInterface {
+public:
+
+    // Construct from data in the format produced by KvInterface::dumpKV()
+    explicit KvSnapshot(std::string const& data) {
+        std::istringstream str(data);
+        std::string line;
+        while (std::getline(str, line)) {
+            auto const pos = line.find('\t');
+            if (pos == std::string::npos) continue;
+            std::string value(line, pos + 1);
+            if (value == "\\N") value.clear();
+            _kvMap[line.substr(0, pos)] = value;
+        }
+    }
+
+    std::string create(std::string const&, std::string const&, bool) override {
+        throw ReadonlyCss();
+    }
+
+    void set(std::string const&, std::string const&) override {
+        throw ReadonlyCss();
+    }
+
+    bool exists(std::string const& key) override {
+        return _kvMap.count(key) != 0;
+    }
+
+    std::map<std::string, std::string> getMany(std::vector<std::string> const& keys) override {
+        std::map<std::string, std::string> result;
+        for (auto& key: keys) {
+            auto iter = _kvMap.find(key);
+            if (iter != _kvMap.end()) {
+                result.insert(*iter);
+            }
+        }
+        return result;
+    }
+
+    std::vector<std::string> getChildren(std::string const& key) override {
+        std::vector<std::string> result;
+        for (auto& pair: getChildrenValues(key)) {
+            result.push_back(pair.first);
+        }
+        return result;
+    }
+
+    std::map<std::string, std::string> getChildrenValues(std::string const& key) override {
+        if (not exists(key)) {
+            throw NoSuchKey(key);
+        }
+        std::string const pfx(key == "/" ? key : key + "/");
+        std::map<std::string, std::string> result;
+        for (auto iter = _kvMap.lower_bound(pfx); iter != _kvMap.end(); ++iter) {
+            auto& fullKey = iter->first;
+            if (fullKey.compare(0, pfx.size(), pfx) != 0) break;
+            if (fullKey.find('/', pfx.size()) == std::string::npos) {
+                result.insert(std::make_pair(fullKey.substr(pfx.size()), iter->second));
+            }
+        }
+        return result;
+    }
+
+    void deleteKey(std::string const&) override {
+        throw ReadonlyCss();
+    }
+
+    std::string dumpKV() override {
+        std::string result;
+        for (auto& pair: _kvMap) {
+            if (not result.empty()) result += '\n';
+            result += pair.first;
+            result += '\t';
+            result += pair.second.empty() ? "\\N" : pair.second;
+        }
+        return result;
+    }
+
+protected:
+
+    std::string _get(std::string const& key,
+                     std::string const& defaultValue,
+                     bool throwIfKeyNotFound) override {
+        auto iter = _kvMap.find(key);
+        if (iter == _kvMap.end()) {
+            if (throwIfKeyNotFound) {
+                throw NoSuchKey(key);
+            }
+            return defaultValue;
+        }
+        return iter->second;
+    }
+
+private:
+
+    std::map<std::string, std::string> _kvMap;
+};
+
 }
 
 namespace lsst {
 namespace qserv {
 namespace css {
 
+/// Snapshot cache, shared by all copies of one CssAccess instance.
+///
+/// Readers get the current snapshot with a single atomic load and never
+/// block. Background thread periodically compares update stamp in KV store
+/// with the stamp of the current snapshot and rebuilds snapshot from a full
+/// KV dump when they differ. A store that was never modified through
+/// CssAccess has no stamp, which is as valid as any other stamp.
+class CssAccess::Cache {
+public:
+
+    Cache(std::shared_ptr<KvInterface> const& kvI, unsigned refreshMs)
+        : _kvI(kvI), _refreshPeriod(refreshMs) {
+        try {
+            refresh();
+        } catch (std::exception const& exc) {
+            // not fatal, reads go to KV store until next refresh succeeds
+            LOGS(_log, LOG_LVL_WARN, "Failed to build CSS snapshot: " << exc.what());
+        }
+        _thread = std::thread(&Cache::_run, this);
+    }
+
+    Cache(Cache const&) = delete;
+    Cache& operator=(Cache const&) = delete;
+
+    ~Cache() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _cv.notify_all();
+        _thread.join();
+    }
+
+    /// Returns current snapshot, or null pointer if there is no valid snapshot.
+    std::shared_ptr<KvInterface> get() {
+        auto snapshot = std::atomic_load(&_snapshot);
+        if (snapshot) {
+            ++_hits;
+            return snapshot->kvI;
+        }
+        ++_misses;
+        return nullptr;
+    }
+
+    /// Drop current snapshot and ask background thread to build new one.
+    void invalidate() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_generation;
+        std::atomic_store(&_snapshot, std::shared_ptr<Snapshot const>());
+        _wanted = true;
+        _cv.notify_all();
+    }
+
+    /// Build new snapshot from KV store contents.
+    void refresh() {
+        std::lock_guard<std::mutex> refreshLock(_refreshMutex);
+        unsigned generation;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            generation = _generation;
+        }
+
+        // stamp is read before data so that any concurrent update results
+        // in a stamp mismatch on next check
+        auto snapshot = std::make_shared<Snapshot>();
+        snapshot->stamp = _kvI->get(UPDATE_KEY, "");
+        snapshot->kvI = std::make_shared<KvSnapshot>(_kvI->dumpKV());
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (generation != _generation) {
+            // invalidated while we were reading, data may be stale
+            LOGS(_log, LOG_LVL_DEBUG, "CSS snapshot invalidated during refresh, discarding");
+            return;
+        }
+        std::atomic_store(&_snapshot, std::shared_ptr<Snapshot const>(snapshot));
+        ++_refreshes;
+        LOGS(_log, LOG_LVL_DEBUG, "CSS snapshot refreshed, stamp: " << snapshot->stamp);
+    }
+
+    CacheStats getStats() const {
+        CacheStats stats;
+        stats.hits = _hits;
+        stats.misses = _misses;
+        stats.refreshes = _refreshes;
+        return stats;
+    }
+
+private:
+
+    struct Snapshot {
+        std::shared_ptr<KvInterface> kvI;
+        std::string stamp;
+    };
+
+    void _run() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (not _stop) {
+            _cv.wait_for(lock, _refreshPeriod, [this]() { return _stop or _wanted; });
+            if (_stop) break;
+            _wanted = false;
+            lock.unlock();
+            try {
+                auto snapshot = std::atomic_load(&_snapshot);
+                if (not snapshot or _kvI->get(UPDATE_KEY, "") != snapshot->stamp) {
+                    refresh();
+                }
+            } catch (std::exception const& exc) {
+                LOGS(_log, LOG_LVL_WARN, "Failed to refresh CSS snapshot: " << exc.what());
+            }
+            lock.lock();
+        }
+    }
+
+    std::shared_ptr<KvInterface> const _kvI;
+    std::chrono::milliseconds const _refreshPeriod;
+    std::shared_ptr<Snapshot const> _snapshot;  // only accessed with atomic_load/atomic_store
+    std::mutex _refreshMutex;                   // serializes refresh()
+    std::mutex _mutex;                          // protects members below
+    std::condition_variable _cv;
+    unsigned _generation = 0;                   // incremented on every invalidation
+    bool _wanted = false;                       // true if refresh is requested
+    bool _stop = false;
+    std::atomic<uint64_t> _hits{0};
+    std::atomic<uint64_t> _misses{0};
+    std::atomic<uint64_t> _refreshes{0};
+    std::thread _thread;
+};
+
 std::shared_ptr<CssAccess>
 CssAccess::createFromStream(std::istream& stream,
                             std::string const& emptyChunkPath,
@@ -88,13 +326,14 @@ CssAccess::createFromConfig(std::map<std::string, std::string> const& config,
                             bool readOnly) {
     css::CssConfig cssConfig(config);
     LOGS(_log, LOG_LVL_DEBUG, "Create CSS instance from config map");
+    std::shared_ptr<KvInterface> kvi;
     if (cssConfig.getTechnology() == "mem") {
         // optional data or file keys
-        std::string iterData = cssConfig.getData();
-        std::string iterFile = cssConfig.getFile();
         if (not cssConfig.getData().empty()) {
             // data is in a string
-            return createFromData(cssConfig.getData(), emptyChunkPath, readOnly);
+            LOGS(_log, LOG_LVL_DEBUG, "Create CSS instance with memory store from data in string");
+            std::istringstream str(cssConfig.getData());
+            kvi = std::make_shared<KvInterfaceImplMem>(str, readOnly);
         } else if (not cssConfig.getFile().empty()) {
             // read data from file
             std::ifstream f(cssConfig.getFile());
@@ -104,30 +343,28 @@ CssAccess::createFromConfig(std::map<std::string, std::string> const& config,
             }
             LOGS(_log, LOG_LVL_DEBUG,
                  "Create CSS instance with memory store from data file " << cssConfig.getFile());
-            auto kvi = std::make_shared<KvInterfaceImplMem>(f, readOnly);
-            return std::shared_ptr<CssAccess>(new CssAccess(kvi,
-                                                            std::make_shared<EmptyChunks>(emptyChunkPath)));
+            kvi = std::make_shared<KvInterfaceImplMem>(f, readOnly);
         } else {
             // no initial data
             LOGS(_log, LOG_LVL_DEBUG, "Create CSS instance with empty memory store");
-            auto kvi = std::make_shared<KvInterfaceImplMem>(readOnly);
-            return std::shared_ptr<CssAccess>(new CssAccess(kvi,
-                                                            std::make_shared<EmptyChunks>(emptyChunkPath)));
+            kvi = std::make_shared<KvInterfaceImplMem>(readOnly);
         }
     } else if (cssConfig.getTechnology() == "mysql") {
         LOGS(_log, LOG_LVL_DEBUG, "Create CSS instance with mysql store " << cssConfig.getMySqlConfig());
-        auto kvi = std::make_shared<KvInterfaceImplMySql>(cssConfig.getMySqlConfig(), readOnly);
-        return std::shared_ptr<CssAccess>(new CssAccess(kvi, std::make_shared<EmptyChunks>(emptyChunkPath)));
+        kvi = std::make_shared<KvInterfaceImplMySql>(cssConfig.getMySqlConfig(), readOnly);
     } else {
         LOGS(_log, LOG_LVL_DEBUG, "Unexpected value of \"technology\" key: " << cssConfig.getTechnology());
         throw ConfigError("Unexpected value of \"technology\" key: " + cssConfig.getTechnology());
     }
+    return std::shared_ptr<CssAccess>(new CssAccess(kvi, std::make_shared<EmptyChunks>(emptyChunkPath),
+                                                    std::string(), cssConfig.getCacheRefreshMs()));
 }
 
 // Construct from KvInterface instance and empty chunk list instance
 CssAccess::CssAccess(std::shared_ptr<KvInterface> const& kvInterface,
                      std::shared_ptr<EmptyChunks> const& emptyChunks,
-                     std::string const& prefix)
+                     std::string const& prefix,
+                     unsigned cacheRefreshMs)
     : _kvI(kvInterface), _emptyChunks(emptyChunks),
       _prefix(prefix), _versionOk(false) {
 
@@ -138,6 +375,11 @@ CssAccess::CssAccess(std::shared_ptr<KvInterface> const& kvInterface,
         _kvI->create(VERSION_KEY, VERSION_STR);
         _versionOk = true;
     }
+
+    if (cacheRefreshMs > 0) {
+        LOGS(_log, LOG_LVL_DEBUG, "Enable CSS snapshot cache, refresh period: " << cacheRefreshMs << " ms");
+        _cache = std::make_shared<Cache>(_kvI, cacheRefreshMs);
+    }
 }
 
 int
@@ -145,6 +387,41 @@ CssAccess::cssVersion() {
     return VERSION;
 }
 
+void
+CssAccess::refreshCache() {
+    if (_cache) _cache->refresh();
+}
+
+CssAccess::CacheStats
+CssAccess::getCacheStats() const {
+    if (_cache) return _cache->getStats();
+    return CacheStats();
+}
+
+std::shared_ptr<KvInterface>
+CssAccess::_readKvI() const {
+    if (_cache) {
+        auto kvI = _cache->get();
+        if (kvI) return kvI;
+    }
+    return _kvI;
+}
+
+void
+CssAccess::_markUpdated(std::string const& dbName) {
+    // stamp value only needs to differ from previous ones
+    auto const now = std::chrono::system_clock::now().time_since_epoch();
+    auto const usec = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+    if (not dbName.empty()) {
+        // data version must change even if clock did not move
+        std::string const key = std::string(DATA_VERSION_KEY) + "/" + dbName;
+        long long const prev = std::strtoll(_kvI->get(key, "0").c_str(), nullptr, 10);
+        _kvI->set(key, std::to_string(std::max<long long>(usec, prev + 1)));
+    }
+    _kvI->set(UPDATE_KEY, std::to_string(usec));
+    if (_cache) _cache->invalidate();
+}
+
 void
 CssAccess::_checkVersion(bool mustExist) const {
     if (_versionOk) return;
@@ -167,7 +444,7 @@ CssAccess::getDbNames() const {
     _checkVersion();
 
     std::string p = _prefix + "/DBS";
-    auto names = _kvI->getChildren(p);
+    auto names = _readKvI()->getChildren(p);
 
     // databases cannot be packed, but just in case remove packed key if any
     auto it = std::remove(names.begin(), names.end(), ::_packedKeyName);
@@ -181,7 +458,7 @@ CssAccess::getDbStatus() const {
     _checkVersion();
 
     std::string p = _prefix + "/DBS";
-    auto kvs = _kvI->getChildrenValues(p);
+    auto kvs = _readKvI()->getChildrenValues(p);
 
     // databases cannot be packed, but just in case remove packed key if any
     kvs.erase(::_packedKeyName);
@@ -197,6 +474,20 @@ CssAccess::setDbStatus(std::string const& dbName, std::string const& status) {
     _assertDbExists(dbName);
     std::string const dbKey = _prefix + "/DBS/" + dbName;
     _kvI->set(dbKey, status);
+    _markUpdated(dbName);
+}
+
+std::string
+CssAccess::getDbDataVersion(std::string const& dbName) const {
+    _checkVersion();
+    return _readKvI()->get(std::string(DATA_VERSION_KEY) + "/" + dbName, "");
+}
+
+void
+CssAccess::updateDbDataVersion(std::string const& dbName) {
+    LOGS(_log, LOG_LVL_DEBUG, "updateDbDataVersion(" << dbName << ")");
+    _checkVersion();
+    _markUpdated(dbName);
 }
 
 bool
@@ -207,7 +498,7 @@ CssAccess::containsDb(std::string const& dbName) const {
         return false;
     }
     std::string p = _prefix + "/DBS/" + dbName;
-    bool ret = _kvI->exists(p);
+    bool ret = _readKvI()->exists(p);
     LOGS(_log, LOG_LVL_DEBUG, "containsDb(" << dbName << "): " << ret);
     return ret;
 }
@@ -291,6 +582,7 @@ CssAccess::createDb(std::string const& dbName,
     std::string const dbKey = _prefix + "/DBS/" + dbName;
     _storePacked(dbKey, dbMap);
     _kvI->set(dbKey, KEY_STATUS_READY);
+    _markUpdated(dbName);
 }
 
 void
@@ -310,6 +602,7 @@ CssAccess::createDbLike(std::string const& dbName,
     std::string const dbKey = _prefix + "/DBS/" + dbName;
     _storePacked(dbKey, dbMap);
     _kvI->set(dbKey, KEY_STATUS_READY);
+    _markUpdated(dbName);
 }
 
 void
@@ -327,6 +620,8 @@ CssAccess::dropDb(std::string const& dbName) {
         LOGS(_log, LOG_LVL_DEBUG, "dropDb: key is not found: " << key);
         throw NoSuchDb(dbName);
     }
+
+    _markUpdated(dbName);
 }
 
 std::vector<std::string>
@@ -337,7 +632,7 @@ CssAccess::getTableNames(std::string const& dbName, bool readyOnly) const {
     std::string key = _prefix + "/DBS/" + dbName + "/TABLES";
     std::vector<std::string> names;
     try {
-        names = _kvI->getChildren(key);
+        names = _readKvI()->getChildren(key);
     } catch (NoSuchKey const& exc) {
         LOGS(_log, LOG_LVL_DEBUG, "getTableNames: key is not found: " << key);
         _assertDbExists(dbName);
@@ -368,7 +663,7 @@ CssAccess::getTableStatus(std::string const& dbName) const {
     std::string key = _prefix + "/DBS/" + dbName + "/TABLES";
     std::map<std::string, std::string> kvs;
     try {
-        kvs = _kvI->getChildrenValues(key);
+        kvs = _readKvI()->getChildrenValues(key);
     } catch (NoSuchKey const& exc) {
         LOGS(_log, LOG_LVL_DEBUG, "getTableNames: key is not found: " << key);
         _assertDbExists(dbName);
@@ -392,6 +687,7 @@ CssAccess::setTableStatus(std::string const& dbName,
     std::string const tableKey = _prefix + "/DBS/" + dbName + "/TABLES/" + tableName;
     if (not _kvI->exists(tableKey)) throw NoSuchTable(dbName, tableName);
     _kvI->set(tableKey, status);
+    _markUpdated(dbName);
 }
 
 bool
@@ -401,7 +697,7 @@ CssAccess::containsTable(std::string const& dbName, std::string const& tableName
 
     std::string const key = _prefix + "/DBS/" + dbName + "/TABLES/" + tableName;
     // If key is not there pretend that its value is not "READY"
-    std::string const val = _kvI->get(key, "DOES_NOT_EXIST");
+    std::string const val = _readKvI()->get(key, "DOES_NOT_EXIST");
     if (val == "DOES_NOT_EXIST") {
         // table key is not there at all, throw if database name is not good
         _assertDbExists(dbName);
@@ -425,7 +721,7 @@ CssAccess::getTableSchema(std::string const& dbName, std::string const& tableNam
     auto const schema = kvMap["schema"];
     if (schema.empty()) {
         // check table key
-        if (not _kvI->exists(tableKey)) throw NoSuchTable(dbName, tableName);
+        if (not _readKvI()->exists(tableKey)) throw NoSuchTable(dbName, tableName);
     }
     return schema;
 }
@@ -445,7 +741,7 @@ CssAccess::getMatchTableParams(std::string const& dbName,
     auto paramMap = _getSubkeys(tableKey, subKeys);
     if (paramMap.empty()) {
         // check table key
-        if (not _kvI->exists(tableKey)) throw NoSuchTable(dbName, tableName);
+        if (not _readKvI()->exists(tableKey)) throw NoSuchTable(dbName, tableName);
         return params;
     }
 
@@ -469,7 +765,7 @@ CssAccess::getPartTableParams(std::string const& dbName,
     auto paramMap = _getSubkeys(tableKey, subKeys);
     if (paramMap.empty()) {
         // check table key
-        if (not _kvI->exists(tableKey)) throw NoSuchTable(dbName, tableName);
+        if (not _readKvI()->exists(tableKey)) throw NoSuchTable(dbName, tableName);
         return params;
     }
 
@@ -491,7 +787,7 @@ CssAccess::getScanTableParams(std::string const& dbName,
     auto paramMap = _getSubkeys(tableKey, subKeys);
     if (paramMap.empty()) {
         // check table key
-        if (not _kvI->exists(tableKey)) throw NoSuchTable(dbName, tableName);
+        if (not _readKvI()->exists(tableKey)) throw NoSuchTable(dbName, tableName);
         return params;
     }
 
@@ -517,7 +813,7 @@ CssAccess::getTableParams(std::string const& dbName, std::string const& tableNam
     auto paramMap = _getSubkeys(tableKey, subKeys);
     if (paramMap.empty()) {
         // check table key
-        if (not _kvI->exists(tableKey)) throw NoSuchTable(dbName, tableName);
+        if (not _readKvI()->exists(tableKey)) throw NoSuchTable(dbName, tableName);
         return params;
     }
 
@@ -582,6 +878,7 @@ CssAccess::createTable(std::string const& dbName,
 
     // done
     _kvI->set(tableKey, KEY_STATUS_READY);
+    _markUpdated(dbName);
 }
 
 void
@@ -622,6 +919,7 @@ CssAccess::createMatchTable(std::string const& dbName,
 
     // done, can mark table as ready
     _kvI->set(tableKey, KEY_STATUS_READY);
+    _markUpdated(dbName);
 }
 
 void
@@ -639,12 +937,14 @@ CssAccess::dropTable(std::string const& dbName, std::string const& tableName) {
         LOGS(_log, LOG_LVL_DEBUG, "dropTable: key is not found: " << key);
         throw NoSuchTable(dbName, tableName);
     }
+
+    _markUpdated(dbName);
 }
 
 std::vector<std::string>
 CssAccess::getNodeNames() const {
     std::string const key = _prefix + "/NODES";
-    auto nodes = _kvI->getChildren(key);
+    auto nodes = _readKvI()->getChildren(key);
     _checkVersion();
 
     // /NODES cannot have packed keys, but just in case remove packed key if any
@@ -667,7 +967,7 @@ CssAccess::getNodeParams(std::string const& nodeName) const {
     auto paramMap = _getSubkeys(key, subKeys);
     if (paramMap.empty()) {
         // check node key
-        if (not _kvI->exists(key + "/" + nodeName)) throw NoSuchNode(nodeName);
+        if (not _readKvI()->exists(key + "/" + nodeName)) throw NoSuchNode(nodeName);
         return params;
     }
 
@@ -734,6 +1034,7 @@ CssAccess::addNode(std::string const& nodeName, NodeParams const& nodeParams) {
 
     // done
     _kvI->set(key, nodeParams.state);
+    _markUpdated();
 }
 
 void CssAccess::setNodeState(std::string const& nodeName, std::string const& newState) {
@@ -748,6 +1049,7 @@ void CssAccess::setNodeState(std::string const& nodeName, std::string const& new
     }
 
     _kvI->set(key, newState);
+    _markUpdated();
 }
 
 void
@@ -778,6 +1080,8 @@ CssAccess::deleteNode(std::string const& nodeName) {
         LOGS(_log, LOG_LVL_DEBUG, "deleteNode: key is not found: " << key);
         throw NoSuchNode(nodeName);
     }
+
+    _markUpdated();
 }
 
 void
@@ -798,6 +1102,8 @@ CssAccess::addChunk(std::string const& dbName,
         std::map<std::string, std::string> chunkMap{std::make_pair("nodeName", node)};
         _storePacked(path, chunkMap);
     }
+
+    _markUpdated(dbName);
 }
 
 std::map<int, std::vector<std::string>>
@@ -812,9 +1118,9 @@ CssAccess::getChunks(std::string const& dbName, std::string const& tableName) {
 
     std::vector<std::string> chunks;
     try {
-        chunks = _kvI->getChildren(chunksKey);
+        chunks = _readKvI()->getChildren(chunksKey);
     } catch (NoSuchKey const& exc) {
-        if (not _kvI->exists(tableKey)) throw NoSuchTable(dbName, tableName);
+        if (not _readKvI()->exists(tableKey)) throw NoSuchTable(dbName, tableName);
         LOGS(_log, LOG_LVL_DEBUG, "getChunks: No CHUNKS sub-key for: " << tableKey);
         return result;
     }
@@ -831,7 +1137,7 @@ CssAccess::getChunks(std::string const& dbName, std::string const& tableName) {
         std::string const replicasKey = chunksKey + "/" + chunk + "/REPLICAS";
         std::vector<std::string> replicas;
         try {
-            replicas = _kvI->getChildren(replicasKey);
+            replicas = _readKvI()->getChildren(replicasKey);
 
             // replicas cannot be packed, but just in case remove packed key if any
             auto it = std::remove(replicas.begin(), replicas.end(), ::_packedKeyName);
@@ -893,7 +1199,7 @@ CssAccess::_getSubkeys(std::string const& key, std::vector<std::string> const& s
 
     // get everything in one call from KV store, this is
     // supposed to be consistent set of values
-    auto keyMap = _kvI->getMany(allKeys);
+    auto keyMap = _readKvI()->getMany(allKeys);
     LOGS(_log, LOG_LVL_DEBUG, "_getSubkeys: kvI returned: " << util::printable(keyMap));
 
     // unpack packed guys, and add unpacked keys to a key map, this does not overwrite
@@ -23,6 +23,7 @@
 #define LSST_QSERV_CSS_CSSACCESS_H
 
 // System headers
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -66,11 +67,27 @@ class KvInterface;
  *
  *  This is a concrete class, instances can be copied around and all copies
  *  share the same KvInterface instance (and empty chunk list).
+ *
+ *  Optionally all read methods can be served from an in-memory snapshot of
+ *  the whole KV store (see "cacheRefreshMs" configuration key). Snapshot is
+ *  immutable and is replaced as a whole by a background thread when the
+ *  update stamp stored in KV (UPDATE_KEY) changes, so readers never block
+ *  each other. Every modification done through this class updates that
+ *  stamp and drops the local snapshot, so the changes are visible
+ *  immediately to this instance and after one refresh period to all other
+ *  instances. Copies of an instance share the same snapshot.
  */
 
 class CssAccess {
 public:
 
+    /// Counters for the metadata snapshot cache.
+    struct CacheStats {
+        uint64_t hits = 0;       ///< KV reads served from the snapshot
+        uint64_t misses = 0;     ///< KV reads that went to the KV store
+        uint64_t refreshes = 0;  ///< number of snapshots built
+    };
+
     /**
      *  Create CssAccess instance from existing key-value data in a stream.
      *
@@ -121,6 +138,9 @@ public:
      *       'username': mysql user name
      *       'password': user password
      *       'database': database name
+     *  Optional key 'cacheRefreshMs' (for any technology) enables the snapshot
+     *  cache, its value is the period in milliseconds for checking the update
+     *  stamp in KV store, 0 (default) disables the cache.
      *
      *  @param config:  configuration map
      *  @param emptyChunkPath:  path to empty chunk list file
@@ -165,6 +185,31 @@ public:
      */
     void setDbStatus(std::string const& dbName, std::string const& status);
 
+    /**
+     * @brief Returns data version of a database.
+     *
+     * Version is an opaque string which changes on every modification of
+     * the database done through this class (tables, chunks, status) and on
+     * every call to updateDbDataVersion(). It is empty if the database was
+     * never modified that way.
+     *
+     * @param dbName:  Database name
+     * @throws CssError: for all CSS errors
+     */
+    std::string getDbDataVersion(std::string const& dbName) const;
+
+    /**
+     * @brief Change data version of a database.
+     *
+     * For clients which modify data of a database without changing its
+     * CSS metadata, so that results computed from older data are not
+     * reused.
+     *
+     * @param dbName:  Database name
+     * @throws CssError: for all CSS errors
+     */
+    void updateDbDataVersion(std::string const& dbName);
+
     /**
      * @brief Returns true if database name is defined in CSS.
      *
@@ -479,12 +524,31 @@ public:
      */
     std::shared_ptr<KvInterface> getKvI() { return _kvI; }
 
+    /**
+     *  Rebuild snapshot cache from current KV store contents.
+     *
+     *  Modifications made through this class refresh the cache automatically,
+     *  this method is for clients which know that CSS was updated by other
+     *  means (e.g. after DDL executed by a different process) and cannot
+     *  wait for the background refresh. Does nothing if cache is disabled.
+     *
+     *  @throws CssError: for all CSS errors
+     */
+    void refreshCache();
+
+    /**
+     *  Return snapshot cache counters, all zeros if cache is disabled.
+     */
+    CacheStats getCacheStats() const;
+
 protected:
 
-    // Construct from KvInterface instance and empty chunk list instance
+    // Construct from KvInterface instance and empty chunk list instance,
+    // non-zero cacheRefreshMs enables snapshot cache.
     CssAccess(std::shared_ptr<KvInterface> const& kvInterface,
               std::shared_ptr<EmptyChunks> const& emptyChunks,
-              std::string const& prefix = std::string());
+              std::string const& prefix = std::string(),
+              unsigned cacheRefreshMs = 0);
 
     // Methods below are protected only for testing purposes so that one can
     // subclass CssAccess and expose these methods for testing
@@ -524,6 +588,16 @@ protected:
 
 private:
 
+    class Cache;
+
+    /// Returns KV instance to use for reading, snapshot if cache is enabled
+    /// and populated, underlying KV store otherwise.
+    std::shared_ptr<KvInterface> _readKvI() const;
+
+    /// Update stamp in KV store after modification and drop local snapshot,
+    /// non-empty dbName also updates data version of that database.
+    void _markUpdated(std::string const& dbName=std::string());
+
     void _fillPartTableParams(std::map<std::string, std::string>& paramMap,
                               PartTableParams& params,
                               std::string const& tableKey) const;
@@ -539,6 +613,7 @@ private:
     std::shared_ptr<EmptyChunks> _emptyChunks;
     std::string _prefix;    // optional prefix, for isolating tests from production
     mutable bool _versionOk;   // True if version is checked (and is OK)
+    std::shared_ptr<Cache> _cache;  // Snapshot cache, null if disabled
 };
 
 }}} // namespace lsst::qserv::css
@@ -47,6 +47,7 @@ namespace css {
 
 CssConfig::CssConfig(util::ConfigStore const& configStore)
     try : _technology(configStore.get("technology")),
+      _cacheRefreshMs(configStore.getInt("cacheRefreshMs", 0)),
       _data(configStore.get("data")),
       _file(configStore.get("file")),
       _mySqlConfig(configStore.get("username"),
@@ -62,6 +63,12 @@ CssConfig::CssConfig(util::ConfigStore const& configStore)
         throw ConfigError(msg);
     }
 
+    if (configStore.getInt("cacheRefreshMs", 0) < 0) {
+        std::string msg = "\"cacheRefreshMs\" cannot be negative";
+        LOGS(_log, LOG_LVL_ERROR, msg);
+        throw ConfigError(msg);
+    }
+
     if (not _data.empty() and  not _file.empty()) {
         std::string msg = "\"data\"  and \"file\" keys are mutually exclusive";
         LOGS(_log, LOG_LVL_ERROR, msg);
@@ -72,7 +79,8 @@ CssConfig::CssConfig(util::ConfigStore const& configStore)
 }
 
 std::ostream& operator<<(std::ostream &out, CssConfig const& cssConfig) {
-    out << "[ technology=" << cssConfig._technology << ", data=" << cssConfig._data
+    out << "[ technology=" << cssConfig._technology
+        << ", cacheRefreshMs=" << cssConfig._cacheRefreshMs << ", data=" << cssConfig._data
         << ", file=" << cssConfig._file << ", mysql_configuration=" << cssConfig._mySqlConfig <<"]";
     return out;
 }
@@ -100,12 +100,22 @@ public:
         return _technology;
     }
 
+    /* Get refresh period for CSS snapshot cache
+     *
+     * @return period in milliseconds, 0 means that cache is disabled
+     */
+    unsigned getCacheRefreshMs() const {
+        return _cacheRefreshMs;
+    }
+
 private:
 
     CssConfig(util::ConfigStore const& configStore);
 
     std::string const _technology;
 
+    unsigned const _cacheRefreshMs;
+
     // used by "mem" technology
     std::string const _data;
     std::string const _file;
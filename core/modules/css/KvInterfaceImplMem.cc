@@ -100,6 +100,7 @@ KvInterfaceImplMem::create(string const& key, string const& value, bool unique)
         throw ReadonlyCss();
     }
 
+    std::lock_guard<std::mutex> lock(_kvMapMutex);
     string path = key;
     if (unique) {
         // append unique suffix, in-memory KVI is not meant for large-scale
@@ -111,7 +112,7 @@ KvInterfaceImplMem::create(string const& key, string const& value, bool unique)
             path = key + str.str();
         } while (_kvMap.count(path));
     }
-    if (exists(path)) {
+    if (_exists(path)) {
         throw KeyExistsError(path);
     }
     // create all parents
@@ -136,6 +137,7 @@ KvInterfaceImplMem::set(string const& key, string const& value) {
         throw ReadonlyCss();
     }
 
+    std::lock_guard<std::mutex> lock(_kvMapMutex);
     // create all parents
     string parent = key;
     for (string::size_type p = parent.rfind('/'); p != string::npos; p = parent.rfind('/')) {
@@ -150,7 +152,8 @@ KvInterfaceImplMem::set(string const& key, string const& value) {
 
 bool
 KvInterfaceImplMem::exists(string const& key) {
-    bool ret = _kvMap.find(key) != _kvMap.end();
+    std::lock_guard<std::mutex> lock(_kvMapMutex);
+    bool ret = _exists(key);
     LOGS(_log, LOG_LVL_DEBUG, "exists(" << key << "): " << (ret?"YES":"NO"));
     return ret;
 }
@@ -158,6 +161,7 @@ KvInterfaceImplMem::exists(string const& key) {
 std::map<std::string, std::string>
 KvInterfaceImplMem::getMany(std::vector<std::string> const& keys) {
     std::map<std::string, std::string> result;
+    std::lock_guard<std::mutex> lock(_kvMapMutex);
     for (auto& key: keys) {
         auto iter = _kvMap.find(key);
         if (iter != _kvMap.end()) {
@@ -172,13 +176,15 @@ KvInterfaceImplMem::_get(string const& key,
                          string const& defaultValue,
                          bool throwIfKeyNotFound) {
     LOGS(_log, LOG_LVL_DEBUG, "get(" << key << ")");
-    if ( !exists(key) ) {
+    std::lock_guard<std::mutex> lock(_kvMapMutex);
+    auto iter = _kvMap.find(key);
+    if (iter == _kvMap.end()) {
         if (throwIfKeyNotFound) {
             throw NoSuchKey(key);
         }
         return defaultValue;
     }
-    string s = _kvMap[key];
+    string s = iter->second;
     LOGS(_log, LOG_LVL_DEBUG, "got: '" << s << "'");
     return s;
 }
@@ -186,7 +192,8 @@ KvInterfaceImplMem::_get(string const& key,
 vector<string>
 KvInterfaceImplMem::getChildren(string const& key) {
     LOGS(_log, LOG_LVL_DEBUG, "getChildren(), key: " << key);
-    if ( ! exists(key) ) {
+    std::lock_guard<std::mutex> lock(_kvMapMutex);
+    if ( ! _exists(key) ) {
         throw NoSuchKey(key);
     }
     const string pfx(key == "/" ? key : key + "/");
@@ -210,7 +217,8 @@ KvInterfaceImplMem::getChildren(string const& key) {
 std::map<std::string, std::string>
 KvInterfaceImplMem::getChildrenValues(std::string const& key) {
     LOGS(_log, LOG_LVL_DEBUG, "getChildrenValues(), key: " << key);
-    if ( ! exists(key) ) {
+    std::lock_guard<std::mutex> lock(_kvMapMutex);
+    if ( ! _exists(key) ) {
         throw NoSuchKey(key);
     }
     const string pfx(key == "/" ? key : key + "/");
@@ -238,6 +246,7 @@ KvInterfaceImplMem::deleteKey(string const& key) {
         throw ReadonlyCss();
     }
 
+    std::lock_guard<std::mutex> lock(_kvMapMutex);
     auto iter = _kvMap.find(key);
     if (iter == _kvMap.end()) {
         throw NoSuchKey(key);
@@ -259,6 +268,7 @@ KvInterfaceImplMem::deleteKey(string const& key) {
 
 std::string KvInterfaceImplMem::dumpKV() {
     std::string result;
+    std::lock_guard<std::mutex> lock(_kvMapMutex);
     for (auto& pair: _kvMap) {
         if (not result.empty()) result += '\n';
         result += pair.first;
@@ -275,6 +285,10 @@ std::string KvInterfaceImplMem::dumpKV() {
     return result;
 }
 
+bool KvInterfaceImplMem::_exists(string const& key) const {
+    return _kvMap.find(key) != _kvMap.end();
+}
+
 void KvInterfaceImplMem::_init(std::istream& mapStream) {
     if (mapStream.fail()) {
         throw ConnError();
@@ -295,6 +309,7 @@ void KvInterfaceImplMem::_init(std::istream& mapStream) {
 std::shared_ptr<KvInterfaceImplMem>
 KvInterfaceImplMem::clone() const {
     std::shared_ptr<KvInterfaceImplMem> newOne = std::make_shared<KvInterfaceImplMem>();
+    std::lock_guard<std::mutex> lock(_kvMapMutex);
     newOne->_kvMap = _kvMap;
     return newOne;
 }
@@ -36,6 +36,7 @@
 // System headers
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -74,7 +75,9 @@ protected:
 
 private:
     void _init(std::istream& mapStream);
+    bool _exists(std::string const& key) const; ///< _kvMapMutex must be held
     std::map<std::string, std::string> _kvMap;
+    mutable std::mutex _kvMapMutex; ///< Protects _kvMap
     bool _readOnly;
 };
 
@@ -111,8 +111,8 @@ class KvTransaction
 {
 public:
     // Constructors
-    KvTransaction(sql::SqlConnection& conn)
-        : _errObj(), _trans(conn, _errObj) {
+    KvTransaction(sql::SqlConnectionPool& connPool)
+        : _errObj(), _conn(connPool.acquire()), _trans(*_conn, _errObj) {
         if (_errObj.isSet()) {
             throw CssError(_errObj);
         }
@@ -156,14 +156,20 @@ public:
         return _trans.isActive();
     }
 
+    /// @return the connection the transaction runs on
+    sql::SqlConnection& conn() const {
+        return *_conn;
+    }
+
 private:
     sql::SqlErrorObject _errObj; // this must be declared before _trans
+    sql::SqlConnectionPool::Lease _conn; // this must be declared before _trans
     sql::SqlTransaction _trans;
 };
 
 
 KvInterfaceImplMySql::KvInterfaceImplMySql(mysql::MySqlConfig const& mysqlConf, bool readOnly)
-: _conn(mysqlConf), _readOnly(readOnly) {
+: _connPool(mysqlConf), _readOnly(readOnly) {
 }
 
 
@@ -193,10 +199,10 @@ KvInterfaceImplMySql::_findParentId(std::string const& childKvKey, bool* hasPare
 
     size_t loc = childKvKey.find_last_of(KEY_PATH_DELIMITER);
     std::string const parentKey(childKvKey, 0, loc);
-    std::string query = str(boost::format("SELECT kvId FROM kvData WHERE kvKey='%1%'") % _escapeSqlString(parentKey));
+    std::string query = str(boost::format("SELECT kvId FROM kvData WHERE kvKey='%1%'") % _escapeSqlString(parentKey, transaction));
     sql::SqlResults results;
     sql::SqlErrorObject errObj;
-    if (not _conn.runQuery(query, results, errObj)) {
+    if (not transaction.conn().runQuery(query, results, errObj)) {
         LOGS(_log, LOG_LVL_ERROR, "_findParentId - query failed: " << query);
         throw CssError(errObj);
     } else {
@@ -217,7 +223,7 @@ KvInterfaceImplMySql::create(std::string const& key, std::string const& value, b
     }
 
     // key is validated by _create
-    KvTransaction transaction(_conn);
+    KvTransaction transaction(_connPool);
 
     std::string path = key;
     if (unique) {
@@ -230,13 +236,13 @@ KvInterfaceImplMySql::create(std::string const& key, std::string const& value, b
         // substring operations. This may kill indexing so it's not very efficient.
         const char* qTemplate = "SELECT RIGHT(kvKey, 10) FROM kvData WHERE "
                         "LENGTH(kvKey) = %1%+10 AND LEFT(kvKey, %1%) = '%2%'";
-        std::string query = (boost::format(qTemplate)  % key.size() % _escapeSqlString(key)).str();
+        std::string query = (boost::format(qTemplate)  % key.size() % _escapeSqlString(key, transaction)).str();
 
         // run query
         sql::SqlErrorObject errObj;
         sql::SqlResults results;
         LOGS(_log, LOG_LVL_DEBUG, "create - executing query: " << query);
-        if (not _conn.runQuery(query, results, errObj)) {
+        if (not transaction.conn().runQuery(query, results, errObj)) {
             std::stringstream ss;
             ss << "create - " << query << " failed with err: " << errObj.errMsg() << std::ends;
             LOGS(_log, LOG_LVL_ERROR, ss.str());
@@ -294,17 +300,17 @@ KvInterfaceImplMySql::_create(std::string const& key, std::string const& value,
     boost::format fmQuery;
     if (hasParent) {
         fmQuery = boost::format("INSERT INTO kvData (kvKey, kvVal, parentKvId) VALUES ('%1%', '%2%', '%3%')");
-        fmQuery % _escapeSqlString(key) % _escapeSqlString(value) % parentKvId;
+        fmQuery % _escapeSqlString(key, transaction) % _escapeSqlString(value, transaction) % parentKvId;
     } else {
         fmQuery = boost::format("INSERT INTO kvData (kvKey, kvVal) VALUES ('%1%', '%2%')"); // leave parentKvId NULL
-        fmQuery % _escapeSqlString(key) % _escapeSqlString(value);
+        fmQuery % _escapeSqlString(key, transaction) % _escapeSqlString(value, transaction);
     }
     if (updateIfExists) {
-        fmQuery = boost::format("%1% ON DUPLICATE KEY UPDATE kvVal='%2%'") % fmQuery % _escapeSqlString(value);
+        fmQuery = boost::format("%1% ON DUPLICATE KEY UPDATE kvVal='%2%'") % fmQuery % _escapeSqlString(value, transaction);
     }
     std::string query = fmQuery.str();
     sql::SqlErrorObject errObj;
-    if (not _conn.runQuery(query, errObj)) {
+    if (not transaction.conn().runQuery(query, errObj)) {
         switch (errObj.errNo()) {
         default:
             throw CssError(errObj);
@@ -317,7 +323,7 @@ KvInterfaceImplMySql::_create(std::string const& key, std::string const& value,
         }
     }
 
-    unsigned int kvId = _conn.getInsertId();
+    unsigned int kvId = transaction.conn().getInsertId();
     LOGS(_log, LOG_LVL_DEBUG, "_create - executed query: " << query << ", kvId is:" << kvId);
     return kvId;
 }
@@ -330,7 +336,7 @@ KvInterfaceImplMySql::set(std::string const& key, std::string const& value) {
     }
 
     // key is validated by _create
-    KvTransaction transaction(_conn);
+    KvTransaction transaction(_connPool);
     _create(key, value, true, transaction);
     transaction.commit();
 }
@@ -338,12 +344,12 @@ KvInterfaceImplMySql::set(std::string const& key, std::string const& value) {
 
 bool
 KvInterfaceImplMySql::exists(std::string const& key) {
-    KvTransaction transaction(_conn);
-    std::string query = str(boost::format("SELECT COUNT(*) FROM kvData WHERE kvKey='%1%'") % _escapeSqlString(key));
+    KvTransaction transaction(_connPool);
+    std::string query = str(boost::format("SELECT COUNT(*) FROM kvData WHERE kvKey='%1%'") % _escapeSqlString(key, transaction));
     sql::SqlErrorObject errObj;
     sql::SqlResults results;
     LOGS(_log, LOG_LVL_DEBUG, "exists - executing query: " << query);
-    if (not _conn.runQuery(query, results, errObj)) {
+    if (not transaction.conn().runQuery(query, results, errObj)) {
         std::stringstream ss;
         ss << "exists - " << query << " failed with err: " << errObj.errMsg() << std::ends;
         LOGS(_log, LOG_LVL_ERROR, ss.str());
@@ -369,23 +375,23 @@ KvInterfaceImplMySql::getMany(std::vector<std::string> const& keys) {
     }
 
     // build query
+    KvTransaction transaction(_connPool);
     std::string query = "SELECT kvKey, kvVal FROM kvData WHERE kvKey IN (";
     bool first = true;
     for (auto& key: keys) {
         if (not first) query += ", ";
         first = false;
         query += '"';
-        if (key != "/") query += _escapeSqlString(key);  // slash == ""
+        if (key != "/") query += _escapeSqlString(key, transaction);  // slash == ""
         query += '"';
     }
     query += ')';
 
     // run query
-    KvTransaction transaction(_conn);
     sql::SqlErrorObject errObj;
     sql::SqlResults results;
     LOGS(_log, LOG_LVL_DEBUG, "getMany - executing query: " << query);
-    if (not _conn.runQuery(query, results, errObj)) {
+    if (not transaction.conn().runQuery(query, results, errObj)) {
         std::stringstream ss;
         ss << "getMany - " << query << " failed with err: " << errObj.errMsg() << std::ends;
         LOGS(_log, LOG_LVL_ERROR, ss.str());
@@ -413,7 +419,7 @@ KvInterfaceImplMySql::getChildren(std::string const& parentKey) {
 
     _validateKey(key);
     // get the children with a /fully/qualified/path
-    KvTransaction transaction(_conn);
+    KvTransaction transaction(_connPool);
     std::vector<std::string> strVec = _getChildrenFullPath(key, transaction);
     transaction.commit();
 
@@ -439,7 +445,7 @@ KvInterfaceImplMySql::getChildrenValues(std::string const& parentKey) {
     _validateKey(key);
 
     // get the children with a /fully/qualified/path
-    KvTransaction transaction(_conn);
+    KvTransaction transaction(_connPool);
     unsigned int parentId;
     if (not _getIdFromServer(key, &parentId, transaction)) {
         if (not exists(key)) {
@@ -451,7 +457,7 @@ KvInterfaceImplMySql::getChildrenValues(std::string const& parentKey) {
     sql::SqlErrorObject errObj;
     sql::SqlResults results;
     LOGS(_log, LOG_LVL_DEBUG, "getChildrenValues - executing query: " << query);
-    if (not _conn.runQuery(query, results, errObj)) {
+    if (not transaction.conn().runQuery(query, results, errObj)) {
         std::stringstream ss;
         ss << "getChildrenValues - " << query << " failed with err: "  << errObj.errMsg() << std::ends;
         LOGS(_log, LOG_LVL_ERROR, ss.str());
@@ -501,7 +507,7 @@ KvInterfaceImplMySql::_getChildrenFullPath(std::string const& parentKey, KvTrans
     sql::SqlErrorObject errObj;
     sql::SqlResults results;
     LOGS(_log, LOG_LVL_DEBUG, "_getChildrenFullPath - executing query: " << query);
-    if (not _conn.runQuery(query, results, errObj)) {
+    if (not transaction.conn().runQuery(query, results, errObj)) {
         std::stringstream ss;
         ss << "_getChildrenFullPath - " << query << " failed with err: " << errObj.errMsg() << std::ends;
         LOGS(_log, LOG_LVL_ERROR, ss.str());
@@ -530,7 +536,7 @@ KvInterfaceImplMySql::deleteKey(std::string const& keyArg) {
 
     std::string key = keyArg;
     if (key == "/") key.erase();
-    KvTransaction transaction(_conn);
+    KvTransaction transaction(_connPool);
     _delete(key, transaction);
     transaction.commit();
 }
@@ -542,11 +548,11 @@ std::string KvInterfaceImplMySql::dumpKV() {
     std::string query = "SELECT kvKey, kvVal FROM kvData ORDER BY kvKey";
 
     // run query
-    KvTransaction transaction(_conn);
+    KvTransaction transaction(_connPool);
     sql::SqlErrorObject errObj;
     sql::SqlResults results;
     LOGS(_log, LOG_LVL_DEBUG, "dumpKV - executing query: " << query);
-    if (not _conn.runQuery(query, results, errObj)) {
+    if (not transaction.conn().runQuery(query, results, errObj)) {
         std::stringstream ss;
         ss << "dumpKV - " << query << " failed with err: " << errObj.errMsg() << std::ends;
         LOGS(_log, LOG_LVL_ERROR, ss.str());
@@ -593,11 +599,11 @@ KvInterfaceImplMySql::_delete(std::string const& key, KvTransaction const& trans
         _delete(*strItr, transaction);
     }
 
-    std::string query = str(boost::format("DELETE FROM kvData WHERE kvKey='%1%'") % _escapeSqlString(key));
+    std::string query = str(boost::format("DELETE FROM kvData WHERE kvKey='%1%'") % _escapeSqlString(key, transaction));
     sql::SqlErrorObject errObj;
     sql::SqlResults resultsObj;
     LOGS(_log, LOG_LVL_DEBUG, "deleteKey - executing query: " << query);
-    if (not _conn.runQuery(query, resultsObj, errObj)) {
+    if (not transaction.conn().runQuery(query, resultsObj, errObj)) {
         LOGS(_log, LOG_LVL_ERROR, "deleteKey - " << query << " failed with err: " << errObj.errMsg());
         throw CssError(errObj);
     }
@@ -622,13 +628,13 @@ KvInterfaceImplMySql::_get(std::string const& keyArg, std::string const& default
     std::string key = keyArg;
     if (key == "/") key.erase();
 
-    KvTransaction transaction(_conn);
+    KvTransaction transaction(_connPool);
 
     std::string val;
     sql::SqlErrorObject errObj;
-    std::string query = str(boost::format("SELECT kvVal FROM kvData WHERE kvKey='%1%'") % _escapeSqlString(key));
+    std::string query = str(boost::format("SELECT kvVal FROM kvData WHERE kvKey='%1%'") % _escapeSqlString(key, transaction));
     sql::SqlResults results;
-    if (not _conn.runQuery(query, results, errObj)) {
+    if (not transaction.conn().runQuery(query, results, errObj)) {
         LOGS(_log, LOG_LVL_ERROR, "_get - query failed: " << query);
         throw CssError(errObj);
     } else {
@@ -653,10 +659,10 @@ bool KvInterfaceImplMySql::_getIdFromServer(std::string const& key, unsigned int
         throw CssError("A transaction must active here.");
     }
 
-    std::string query = str(boost::format("SELECT kvId FROM kvData WHERE kvKey='%1%'") % _escapeSqlString(key));
+    std::string query = str(boost::format("SELECT kvId FROM kvData WHERE kvKey='%1%'") % _escapeSqlString(key, transaction));
     sql::SqlResults results;
     sql::SqlErrorObject errObj;
-    if (not _conn.runQuery(query, results, errObj)) {
+    if (not transaction.conn().runQuery(query, results, errObj)) {
         LOGS(_log, LOG_LVL_ERROR, "_getIdFromServer - query failed: " << query);
         throw CssError(errObj);
         return false;
@@ -689,12 +695,12 @@ void KvInterfaceImplMySql::_validateKey(std::string const& key) {
 }
 
 
-std::string KvInterfaceImplMySql::_escapeSqlString(std::string const& str) {
+std::string KvInterfaceImplMySql::_escapeSqlString(std::string const& str, KvTransaction const& transaction) {
     // There is no need for a transaction here.
 
     sql::SqlErrorObject errObj;
     std::string escapedStr;
-    if (not _conn.escapeString(str, escapedStr, errObj)) {
+    if (not transaction.conn().escapeString(str, escapedStr, errObj)) {
         throw CssError(errObj);
     }
     return escapedStr;
@@ -41,7 +41,7 @@
 // Local headers
 #include "css/KvInterface.h"
 #include "mysql/MySqlConfig.h"
-#include "sql/SqlConnection.h"
+#include "sql/SqlConnectionPool.h"
 
 namespace lsst {
 namespace qserv {
@@ -129,13 +129,15 @@ private:
     /**
      * @brief Escape a string for sql.
      * @param value will be escaped as needed
-     * Will connect to the local connection if needed.
+     * Will connect the transaction's connection if needed.
      * @throws CssErrror if connection fails
      * @return the escaped string
      */
-    std::string _escapeSqlString(std::string const& str);
+    std::string _escapeSqlString(std::string const& str, KvTransaction const& transaction);
 
-    sql::SqlConnection _conn;
+    /// Each transaction borrows its own connection, so concurrent callers do
+    /// not interleave statements on a shared one.
+    sql::SqlConnectionPool _connPool;
     bool _readOnly;
 };
 
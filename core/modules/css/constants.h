@@ -40,6 +40,14 @@ int const VERSION = 1; ///< Current supported version (integer)
 // conversions I define this string once and use it with kvInterface
 char const VERSION_STR[] = "1"; ///< Current supported version
 
+// Key which is updated with a new unique value (timestamp) by CssAccess on
+// every modification of CSS, used to detect stale metadata caches.
+char const UPDATE_KEY[] = "/css_meta/updated"; ///< Path to update stamp
+
+// Keys below this one hold per-database stamps, updated by CssAccess on every
+// modification of a database, used to detect stale query results.
+char const DATA_VERSION_KEY[] = "/css_meta/dataVersion"; ///< Path to data versions
+
 // Set of values used for database and table status.
 
 /// This status means CSS data is in inconsistent state, do not use.
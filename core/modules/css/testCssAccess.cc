@@ -11,8 +11,10 @@
 
 // System headers
 #include <algorithm>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -223,6 +225,22 @@ BOOST_AUTO_TEST_CASE(testSetDbStatus) {
     BOOST_CHECK_EQUAL(statMap["dbC"], "");
 }
 
+BOOST_AUTO_TEST_CASE(testDbDataVersion) {
+    BOOST_CHECK_EQUAL(getDbDataVersion("dbA"), "");
+    setDbStatus("dbA", "DEAD");
+    string const v1 = getDbDataVersion("dbA");
+    BOOST_CHECK(not v1.empty());
+    BOOST_CHECK_EQUAL(getDbDataVersion("dbB"), "");
+
+    // changes on every update, other databases are not affected
+    updateDbDataVersion("dbA");
+    string const v2 = getDbDataVersion("dbA");
+    BOOST_CHECK(v2 != v1);
+    addChunk("dbB", "MyObject", 1000, {"worker1"});
+    BOOST_CHECK_EQUAL(getDbDataVersion("dbA"), v2);
+    BOOST_CHECK(not getDbDataVersion("dbB").empty());
+}
+
 BOOST_AUTO_TEST_CASE(testContainsDb) {
     BOOST_CHECK(containsDb("dbA"));
     BOOST_CHECK(containsDb("dbB"));
@@ -829,4 +847,89 @@ BOOST_AUTO_TEST_CASE(testCssVersion) {
 
 BOOST_AUTO_TEST_SUITE_END()
 
+// CssAccess instance with snapshot cache on top of existing KV store
+class CachedCssAccess: public CssAccess {
+public:
+    CachedCssAccess(shared_ptr<KvInterface> const& kvI, unsigned cacheRefreshMs)
+        : CssAccess(kvI, make_shared<EmptyChunks>(), "", cacheRefreshMs) {}
+};
+
+// Test suite for CssAccess snapshot cache
+BOOST_AUTO_TEST_SUITE(CssAccessCacheTestSuite)
+
+BOOST_AUTO_TEST_CASE(testCacheDisabled) {
+    CachedCssAccess css(initKVI(), 0);
+    BOOST_CHECK(css.containsDb("dbA"));
+    auto stats = css.getCacheStats();
+    BOOST_CHECK_EQUAL(stats.hits, 0U);
+    BOOST_CHECK_EQUAL(stats.misses, 0U);
+    BOOST_CHECK_EQUAL(stats.refreshes, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheReads) {
+    // long refresh period, only explicit or update-triggered refreshes
+    CachedCssAccess css(initKVI(), 3600*1000);
+    BOOST_CHECK_EQUAL(css.getCacheStats().refreshes, 1U);
+
+    BOOST_CHECK(css.containsDb("dbA"));
+    BOOST_CHECK(not css.containsDb("dbX"));
+    BOOST_CHECK(css.containsTable("dbA", "Object"));
+    BOOST_CHECK(not css.containsTable("dbB", "DeletedTable"));
+    BOOST_CHECK_EQUAL(css.getDbNames().size(), 3U);
+    BOOST_CHECK_EQUAL(css.getTableNames("dbA").size(), 4U);
+    BOOST_CHECK_EQUAL(css.getDbStriping("dbA").stripes, 60);
+    BOOST_CHECK_EQUAL(css.getTableParams("dbA", "Object").partitioning.lonColName, "ra_PS");
+    BOOST_CHECK_EQUAL(css.getTableParams("dbC", "RefMatch2").match.dirTable2, "Source");
+    BOOST_CHECK_EQUAL(css.getChunks("dbA", "Exposure").size(), 2U);
+    BOOST_CHECK_EQUAL(css.getNodeParams("node2").host, "worker2");
+    BOOST_CHECK_THROW(css.getTableParams("dbA", "NotATable"), NoSuchTable);
+    BOOST_CHECK_THROW(css.getNodeParams("node4"), NoSuchNode);
+
+    auto stats = css.getCacheStats();
+    BOOST_CHECK(stats.hits > 0U);
+    BOOST_CHECK_EQUAL(stats.misses, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheNoStamp) {
+    // store without update stamp is not dumped again on every refresh
+    auto kvI = initKVI();
+    BOOST_CHECK_EQUAL(kvI->get(UPDATE_KEY, ""), "");
+    CachedCssAccess css(kvI, 10);
+    this_thread::sleep_for(chrono::milliseconds(200));
+    BOOST_CHECK(css.containsDb("dbA"));
+    BOOST_CHECK_EQUAL(css.getCacheStats().refreshes, 1U);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheUpdates) {
+    auto kvI = initKVI();
+    CachedCssAccess css(kvI, 3600*1000);
+    CachedCssAccess writer(kvI, 0);
+
+    // modifications done by other instance need refresh
+    StripingParams striping;
+    writer.createDb("dbNew1", striping, "L2", "UNRELEASED");
+    BOOST_CHECK(not css.containsDb("dbNew1"));
+    css.refreshCache();
+    BOOST_CHECK(css.containsDb("dbNew1"));
+
+    // local modifications are visible immediately
+    css.createDb("dbNew2", striping, "L2", "UNRELEASED");
+    BOOST_CHECK(css.containsDb("dbNew2"));
+    BOOST_CHECK_EQUAL(css.getDbNames().size(), 5U);
+
+    // background refresh notices updated stamp
+    CachedCssAccess css2(kvI, 10);
+    BOOST_CHECK(css2.containsTable("dbA", "Object"));
+    writer.dropTable("dbA", "Object");
+    bool dropped = false;
+    for (int i = 0; i != 500 and not dropped; ++i) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+        dropped = not css2.containsTable("dbA", "Object");
+    }
+    BOOST_CHECK(dropped);
+    BOOST_CHECK(css2.getCacheStats().refreshes >= 2U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 }}} // namespace lsst::qserv::css
@@ -31,13 +31,17 @@
 
 // System headers
 #include <algorithm> // sort
+#include <atomic>
 #include <cstddef>   // nullptr
 #include <cstdlib>   // rand, srand
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <string>
 #include <string.h>  // memset
+#include <thread>
 #include <time.h>    // time
+#include <vector>
 
 // Third-party headers
 #include "boost/lexical_cast.hpp"
@@ -110,4 +114,33 @@ BOOST_AUTO_TEST_CASE(testMem) {
     doIt(new lsst::qserv::css::KvInterfaceImplMem());
 }
 
+BOOST_AUTO_TEST_CASE(testMemConcurrent) {
+    // Readers analyzing queries while another thread changes the store.
+    lsst::qserv::css::KvInterfaceImplMem kvI;
+    kvI.create(k1, v1);
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches(0);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&kvI, &mismatches, this, t]() {
+            for (int i = 0; i < 1000; ++i) {
+                if (t == 0) {
+                    std::string key = k2 + "/" + std::to_string(i);
+                    kvI.create(key, v2);
+                    kvI.deleteKey(key);
+                } else {
+                    if (kvI.get(k1) != v1) ++mismatches;
+                    kvI.get(k3, "");
+                    kvI.getChildren(prefix);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    BOOST_CHECK_EQUAL(mismatches.load(), 0);
+    BOOST_CHECK(not kvI.exists(k3));
+    BOOST_CHECK_EQUAL(kvI.getChildren(k2).size(), 0U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
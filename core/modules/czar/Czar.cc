@@ -24,8 +24,9 @@
 #include "czar/Czar.h"
 
 // System headers
+#include <algorithm>
+#include <exception>
 #include <sys/time.h>
-#include <thread>
 
 // Third-party headers
 #include "boost/lexical_cast.hpp"
@@ -35,8 +36,11 @@
 
 // Qserv headers
 #include "ccontrol/ConfigMap.h"
+#include "ccontrol/UserQueryCached.h"
+#include "ccontrol/UserQuerySelect.h"
 #include "czar/MessageTable.h"
 #include "rproc/InfileMerger.h"
+#include "util/Command.h"
 #include "util/IterableFormatter.h"
 
 namespace {
@@ -70,11 +74,23 @@ Czar::Czar(std::string const& configPath, std::string const& czarName)
 
     int largeResultPoolSize = _czarConfig.getLargeResultPoolSize();
     rproc::InfileMerger::setLargeResultPoolSize(largeResultPoolSize);
+    rproc::InfileMerger::setMergePoolSize(_czarConfig.getMergePoolSize());
+    ccontrol::UserQuerySelect::setTaskMsgPoolSize(_czarConfig.getTaskMsgPoolSize());
 
     LOGS(_log, LOG_LVL_INFO, "Creating czar instance with name " << czarName);
     LOGS(_log, LOG_LVL_DEBUG, "Czar config: " << _czarConfig);
 
     _uqFactory.reset(new ccontrol::UserQueryFactory(_czarConfig, _czarName));
+
+    // UserQueryFactory is safe to use from several threads, the pool only
+    // bounds how many analyses run at once.
+    _analysisPool = util::ThreadPool::newThreadPool(std::max(1, _czarConfig.getAnalysisPoolSize()), nullptr);
+
+    // Queries beyond the pool size wait in _execQueue instead of all loading
+    // results into the result database at the same time.
+    _execQueue = std::make_shared<QueryExecQueue>();
+    _execPool = util::ThreadPool::newThreadPool(std::max(1, _czarConfig.getQueryExecPoolSize()),
+                                                _execQueue);
 }
 
 SubmitResult
@@ -89,6 +105,11 @@ Czar::submitQuery(std::string const& query,
     // Analyze query hints
     std::string clientId = hintsConfigStore.get("client_dst_name");
 
+    // Queries from the same user take turns with queries from other users
+    // when they have to wait for execution, clients which do not say who
+    // the user is share one turn.
+    std::string user = hintsConfigStore.get("user");
+
     // Not being able to get thread id is not fatal,
     // it just means query cannot be associate with particular
     // client/thread and will not be able to be killed later
@@ -117,12 +138,20 @@ Czar::submitQuery(std::string const& query,
     }
 
 
-    // make new UserQuery
-    // this is atomic
+    // make new UserQuery on the analysis pool, concurrently with other queries
     ccontrol::UserQuery::Ptr uq;
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        uq = _uqFactory->newUserQuery(query, defaultDb);
+    std::exception_ptr analysisError;
+    auto analyze = std::make_shared<util::CommandTracked>([&](util::CmdData*) {
+        try {
+            uq = _uqFactory->newUserQuery(query, defaultDb);
+        } catch (...) {
+            analysisError = std::current_exception();
+        }
+    });
+    _analysisPool->getQueue()->queCmd(analyze);
+    analyze->waitComplete();
+    if (analysisError) {
+        std::rethrow_exception(analysisError);
     }
     auto queryIdStr = uq->getQueryIdString();
 
@@ -133,9 +162,9 @@ Czar::submitQuery(std::string const& query,
         return result;
     }
 
-    // spawn background thread to wait until query finishes to unlock,
-    // note that lambda stores copies of uq and msgTable.
-    auto finalizer = [uq, msgTable]() mutable {
+    // queue query for execution, a thread from the pool waits until query
+    // finishes to unlock, note that lambda stores copies of uq and msgTable.
+    auto finalizer = [uq, msgTable](util::CmdData*) mutable {
         LOGS(_log, LOG_LVL_DEBUG, uq->getQueryIdString() << " submitting new query");
         uq->submit();
         uq->join();
@@ -149,9 +178,19 @@ Czar::submitQuery(std::string const& query,
                  << " Query finalization failed (client likely hangs): " << exc.what());
         }
     };
-    LOGS(_log, LOG_LVL_DEBUG, queryIdStr << " starting finalizer thread for query");
-    std::thread finalThread(finalizer);
-    finalThread.detach();
+    if (std::dynamic_pointer_cast<ccontrol::UserQueryCached>(uq)) {
+        // cached result only needs a table copy, no reason to wait for
+        // the queries ahead in the queue
+        finalizer(nullptr);
+        auto const stats = _uqFactory->getResultCacheStats();
+        LOGS(_log, LOG_LVL_INFO, "Query result found in cache, hits=" << stats.hits
+             << " misses=" << stats.misses << " evictions=" << stats.evictions
+             << " entries=" << stats.entries << " rows=" << stats.rows);
+    } else {
+        _execQueue->queCmd(std::make_shared<QueryExecQueue::Cmd>(user, finalizer));
+        LOGS(_log, LOG_LVL_INFO, queryIdStr << " queued for execution, user=\"" << user
+             << "\" " << _execQueue->getStats());
+    }
 
     {
         std::lock_guard<std::mutex> lock(_mutex);
@@ -187,6 +226,16 @@ Czar::submitQuery(std::string const& query,
     return result;
 }
 
+QueryExecQueue::Stats
+Czar::getQueryExecStats() const {
+    return _execQueue->getStats();
+}
+
+ccontrol::ResultCache::Stats
+Czar::getResultCacheStats() const {
+    return _uqFactory->getResultCacheStats();
+}
+
 std::string
 Czar::killQuery(std::string const& query, std::string const& clientId) {
 
@@ -37,10 +37,12 @@
 #include "ccontrol/UserQuery.h"
 #include "ccontrol/UserQueryFactory.h"
 #include "czar/CzarConfig.h"
+#include "czar/QueryExecQueue.h"
 #include "czar/SubmitResult.h"
 #include "global/stringTypes.h"
 #include "mysql/MySqlConfig.h"
 #include "util/ConfigStore.h"
+#include "util/EventThread.h"
 
 namespace lsst {
 namespace qserv {
@@ -89,6 +91,16 @@ public:
      */
     std::string killQuery(std::string const& query, std::string const& clientId);
 
+    /**
+     * Return length of the execution queue and time spent waiting in it.
+     */
+    QueryExecQueue::Stats getQueryExecStats() const;
+
+    /**
+     * Return hit, miss and eviction counters of the query result cache.
+     */
+    ccontrol::ResultCache::Stats getResultCacheStats() const;
+
 protected:
 
 private:
@@ -102,8 +114,11 @@ private:
 
     std::atomic<uint64_t> _idCounter;   ///< Query/task identifier for next query
     std::unique_ptr<ccontrol::UserQueryFactory> _uqFactory;
+    util::ThreadPool::Ptr _analysisPool; ///< Runs _uqFactory->newUserQuery() for submitQuery
+    QueryExecQueue::Ptr _execQueue;     ///< Queries waiting for a thread in _execPool
+    util::ThreadPool::Ptr _execPool;    ///< Submits queries and waits for them to finish
     ClientToQuery _clientToQuery;       ///< maps client ID to query
-    std::mutex _mutex;                  ///< protects both _uqFactory and _clientToQuery
+    std::mutex _mutex;                  ///< protects _clientToQuery
 };
 
 }}} // namespace lsst::qserv::czar
@@ -79,7 +79,25 @@ CzarConfig::CzarConfig(util::ConfigStore const& configStore)
                         configStore.get("qmeta.db", "qservMeta")),
        _xrootdFrontendUrl(configStore.get("frontend.xrootd", "localhost:1094")),
        _emptyChunkPath(configStore.get("partitioner.emptyChunkPath", ".")),
-       _largeResultPoolSize(configStore.getInt("tuning.largeResultPoolSize", 3)) {
+       _largeResultPoolSize(configStore.getInt("tuning.largeResultPoolSize", 3)),
+       _mergeConnections(configStore.getInt("tuning.mergeConnections", 1)),
+       _mergePoolSize(configStore.getInt("tuning.mergePoolSize", 8)),
+       _aggregateMerge(configStore.getInt("tuning.aggregateMerge", 1)),
+       _topNMerge(configStore.getInt("tuning.topNMerge", 1)),
+       _directMerge(configStore.getInt("tuning.directMerge", 1)),
+       _orderedResults(configStore.getInt("tuning.orderedResults", 1)),
+       _resultCacheRows(configStore.getInt("tuning.resultCacheRows", 0)),
+       _resultCacheTtlSec(configStore.getInt("tuning.resultCacheTtlSec", 600)),
+       _analysisPoolSize(configStore.getInt("tuning.analysisPoolSize", 4)),
+       _taskMsgPoolSize(configStore.getInt("tuning.taskMsgPoolSize", 4)),
+       _queryExecPoolSize(configStore.getInt("tuning.queryExecPoolSize", 32)),
+       _limitFirstWave(configStore.getInt("tuning.limitFirstWave", 8)),
+       _secondaryIndexBatchSize(configStore.getInt("tuning.secondaryIndexBatchSize", 10000)),
+       _secondaryIndexConnections(configStore.getInt("tuning.secondaryIndexConnections", 4)),
+       _secondaryIndexCacheSize(configStore.getInt("tuning.secondaryIndexCacheSize", 100000)),
+       _secondaryIndexDir(configStore.get("tuning.secondaryIndexDir")),
+       _resultChecksum(configStore.get("tuning.resultChecksum", "crc32c")),
+       _resultProtocol(configStore.getInt("tuning.resultProtocol", 2)) {
 }
 
 std::ostream& operator<<(std::ostream &out, CzarConfig const& czarConfig) {
@@ -120,6 +120,169 @@ public:
          return _largeResultPoolSize;
     }
 
+    /* Get number of connections each query uses to load results into the
+     * result database. With 1, results are loaded serially as they arrive.
+     *
+     * @return the number of merge connections per query.
+     */
+    int getMergeConnections() const {
+         return _mergeConnections;
+    }
+
+    /* Get number of threads shared by all queries for loading results
+     * when more than one merge connection is used.
+     *
+     * @return the size of the thread pool for merging.
+     */
+    int getMergePoolSize() const {
+         return _mergePoolSize;
+    }
+
+    /* Get whether partial aggregates (GROUP BY with SUM, COUNT, MIN, MAX
+     * and AVG) are folded by the czar as results arrive, instead of being
+     * loaded into a merge table and aggregated by MySQL.
+     *
+     * @return 0 to always aggregate in MySQL.
+     */
+    int getAggregateMerge() const {
+         return _aggregateMerge;
+    }
+
+    /* Get whether the czar keeps only the first n rows of
+     * "ORDER BY ... LIMIT n" results as they arrive, instead of loading
+     * the first n rows of every chunk into a merge table.
+     *
+     * @return 0 to always sort in MySQL.
+     */
+    int getTopNMerge() const {
+         return _topNMerge;
+    }
+
+    /* Get whether the rows of queries whose merge only selects columns,
+     * with an optional LIMIT, are loaded straight into the result table
+     * instead of going through a merge table.
+     *
+     * @return 0 to always merge through a merge table.
+     */
+    int getDirectMerge() const {
+         return _directMerge;
+    }
+
+    /* Get whether mysql-proxy reads the result table of "ORDER BY ... LIMIT"
+     * queries without sorting it again. The czar writes their rows into a
+     * fresh MyISAM table in order, and a table scan returns them in that order.
+     *
+     * @return 0 to have mysql-proxy always sort.
+     */
+    int getOrderedResults() const {
+         return _orderedResults;
+    }
+
+    /* Get max number of rows in all the result tables kept by the czar for
+     * repeated SELECT queries, larger results are not kept. Kept results are
+     * only dropped when the CSS data version of a database changes, rows
+     * loaded without a CSS update go unnoticed until the results expire.
+     *
+     * @return 0 to disable the result cache, the default.
+     */
+    int getResultCacheRows() const {
+         return _resultCacheRows;
+    }
+
+    /* Get number of seconds a kept result may be reused, even if the data
+     * versions of its databases did not change.
+     */
+    int getResultCacheTtlSec() const {
+         return _resultCacheTtlSec;
+    }
+
+    /* Get number of threads analyzing new user queries. Queries arriving
+     * while all of them are busy wait for one to become free.
+     *
+     * @return the size of the thread pool for query analysis.
+     */
+    int getAnalysisPoolSize() const {
+         return _analysisPoolSize;
+    }
+
+    /* Get number of threads shared by all queries for generating and
+     * serializing chunk query messages.
+     *
+     * @return the size of the thread pool for task message generation.
+     */
+    int getTaskMsgPoolSize() const {
+         return _taskMsgPoolSize;
+    }
+
+    /* Get number of user queries executing at the same time. Further queries
+     * wait their turn, queries from different users take turns.
+     *
+     * @return the size of the thread pool for query execution.
+     */
+    int getQueryExecPoolSize() const {
+         return _queryExecPoolSize;
+    }
+
+    /* Get the number of chunks dispatched at first for a query with a LIMIT
+     * that rows from any chunks satisfy. Each later wave is twice as large,
+     * dispatch stops once enough rows arrived.
+     *
+     * @return the size of the first dispatch wave, 0 dispatches all chunks at once.
+     */
+    int getLimitFirstWave() const {
+         return _limitFirstWave;
+    }
+
+    /* Get the max number of keys looked up in the secondary index with one query.
+     *
+     * @return the secondary index lookup batch size.
+     */
+    int getSecondaryIndexBatchSize() const {
+         return _secondaryIndexBatchSize;
+    }
+
+    /* Get the number of connections one secondary index lookup uses to run
+     * its batches in parallel.
+     *
+     * @return the max number of secondary index connections per lookup.
+     */
+    int getSecondaryIndexConnections() const {
+         return _secondaryIndexConnections;
+    }
+
+    /* Get the number of director keys whose chunk and sub-chunk are
+     * remembered between secondary index lookups.
+     *
+     * @return the size of the secondary index cache, 0 disables it.
+     */
+    int getSecondaryIndexCacheSize() const {
+         return _secondaryIndexCacheSize;
+    }
+
+    /* Get the directory with local secondary index files.
+     *
+     * @return the local secondary index directory, empty if not used.
+     */
+    std::string const& getSecondaryIndexDir() const {
+         return _secondaryIndexDir;
+    }
+
+    /* Get the checksum workers attach to result messages.
+     *
+     * @return "none", "crc32c", "xxhash64" or "md5"
+     */
+    std::string const& getResultChecksum() const {
+         return _resultChecksum;
+    }
+
+    /* Get the result protocol requested from workers.
+     *
+     * @return 2 (row-based) or 3 (column-based, needs upgraded workers)
+     */
+    int getResultProtocol() const {
+         return _resultProtocol;
+    }
+
 private:
 
     CzarConfig(util::ConfigStore const& ConfigStore);
@@ -134,6 +297,24 @@ private:
     std::string const _xrootdFrontendUrl;
     std::string const _emptyChunkPath;
     int _largeResultPoolSize;
+    int _mergeConnections;
+    int _mergePoolSize;
+    int _aggregateMerge;
+    int _topNMerge;
+    int _directMerge;
+    int _orderedResults;
+    int _resultCacheRows;
+    int _resultCacheTtlSec;
+    int _analysisPoolSize;
+    int _taskMsgPoolSize;
+    int _queryExecPoolSize;
+    int _limitFirstWave;
+    int _secondaryIndexBatchSize;
+    int _secondaryIndexConnections;
+    int _secondaryIndexCacheSize;
+    std::string const _secondaryIndexDir;
+    std::string const _resultChecksum;
+    int _resultProtocol;
 };
 
 }}} // namespace lsst::qserv::czar
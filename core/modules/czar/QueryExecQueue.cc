@@ -0,0 +1,138 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "czar/QueryExecQueue.h"
+
+// System headers
+#include <algorithm>
+#include <iostream>
+
+// LSST headers
+#include "lsst/log/Log.h"
+
+namespace {
+
+LOG_LOGGER _log = LOG_GET("lsst.qserv.czar.QueryExecQueue");
+
+} // anonymous namespace
+
+namespace lsst {
+namespace qserv {
+namespace czar {
+
+void QueryExecQueue::queCmd(util::Command::Ptr const& cmd) {
+    auto query = std::dynamic_pointer_cast<Cmd>(cmd);
+    if (query == nullptr) {
+        util::CommandQueue::queCmd(cmd);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_mx);
+    auto& userQueue = _userQueues[query->getUser()];
+    if (userQueue.empty()) {
+        _userTurns.push_back(query->getUser());
+    }
+    userQueue.push_back(query);
+    ++_queued;
+    LOGS(_log, LOG_LVL_DEBUG, "queued query for user=\"" << query->getUser()
+         << "\" queued=" << _queued << " running=" << _running);
+    notify(false);
+}
+
+util::Command::Ptr QueryExecQueue::getCmd(bool wait) {
+    std::unique_lock<std::mutex> lock(_mx);
+    if (wait) {
+        _cv.wait(lock, [this](){ return !_empty(); });
+    }
+    if (!_qu.empty()) {
+        auto cmd = _qu.front();
+        _qu.pop_front();
+        return cmd;
+    }
+    if (_queued == 0) {
+        return nullptr;
+    }
+
+    // The user at the front of _userTurns goes next, then moves to the back
+    // of the line if it still has queries waiting.
+    std::string user = _userTurns.front();
+    _userTurns.pop_front();
+    auto iter = _userQueues.find(user);
+    Cmd::Ptr query = iter->second.front();
+    iter->second.pop_front();
+    if (iter->second.empty()) {
+        _userQueues.erase(iter);
+    } else {
+        _userTurns.push_back(user);
+    }
+    --_queued;
+
+    double waitSec = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - query->getQueuedTime()).count();
+    ++_admitted;
+    _totalWaitSec += waitSec;
+    _maxWaitSec = std::max(_maxWaitSec, waitSec);
+    LOGS(_log, LOG_LVL_DEBUG, "admitted query for user=\"" << user << "\" after "
+         << waitSec << " s, queued=" << _queued);
+    return query;
+}
+
+void QueryExecQueue::commandStart(util::Command::Ptr const& cmd) {
+    if (std::dynamic_pointer_cast<Cmd>(cmd) != nullptr) {
+        std::lock_guard<std::mutex> lock(_mx);
+        ++_running;
+    }
+}
+
+void QueryExecQueue::commandFinish(util::Command::Ptr const& cmd) {
+    if (std::dynamic_pointer_cast<Cmd>(cmd) != nullptr) {
+        std::lock_guard<std::mutex> lock(_mx);
+        --_running;
+    }
+}
+
+std::size_t QueryExecQueue::getQueueLength() const {
+    std::lock_guard<std::mutex> lock(_mx);
+    return _queued;
+}
+
+QueryExecQueue::Stats QueryExecQueue::getStats() const {
+    std::lock_guard<std::mutex> lock(_mx);
+    Stats stats;
+    stats.queued = _queued;
+    stats.running = _running;
+    stats.users = _userQueues.size();
+    stats.admitted = _admitted;
+    stats.totalWaitSec = _totalWaitSec;
+    stats.maxWaitSec = _maxWaitSec;
+    return stats;
+}
+
+std::ostream& operator<<(std::ostream& os, QueryExecQueue::Stats const& stats) {
+    os << "queued=" << stats.queued << " running=" << stats.running
+       << " users=" << stats.users << " admitted=" << stats.admitted
+       << " meanWait=" << stats.meanWaitSec() << "s maxWait=" << stats.maxWaitSec << "s";
+    return os;
+}
+
+}}} // namespace lsst::qserv::czar
@@ -0,0 +1,110 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef LSST_QSERV_CZAR_QUERYEXECQUEUE_H
+#define LSST_QSERV_CZAR_QUERYEXECQUEUE_H
+
+// System headers
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
+
+// Qserv headers
+#include "util/EventThread.h"
+
+namespace lsst {
+namespace qserv {
+namespace czar {
+
+/// Admission queue for user queries waiting on the czar execution thread pool.
+/// Queries are handed out round-robin between users so that a burst from one
+/// user cannot hold back queries from everybody else, queries from the same
+/// user run in the order they arrived. Commands which are not QueryExecQueue::Cmd
+/// (e.g. the pool's own end-of-thread messages) are handed out before any query.
+class QueryExecQueue : public util::CommandQueue {
+public:
+    using Ptr = std::shared_ptr<QueryExecQueue>;
+
+    /// Command running a single user query.
+    class Cmd : public util::Command {
+    public:
+        using Ptr = std::shared_ptr<Cmd>;
+        Cmd(std::string const& user, std::function<void(util::CmdData*)> func)
+            : util::Command{func}, _user(user), _queuedTime(std::chrono::steady_clock::now()) {}
+
+        std::string const& getUser() const { return _user; }
+        std::chrono::steady_clock::time_point getQueuedTime() const { return _queuedTime; }
+
+    private:
+        std::string const _user;
+        std::chrono::steady_clock::time_point const _queuedTime;
+    };
+
+    /// Queue length and admission wait times.
+    struct Stats {
+        std::size_t queued{0};   ///< Queries waiting to run.
+        std::size_t running{0};  ///< Queries currently running.
+        std::size_t users{0};    ///< Users with at least one query waiting.
+        std::uint64_t admitted{0}; ///< Queries taken off the queue so far.
+        double totalWaitSec{0};  ///< Sum of the time admitted queries spent waiting.
+        double maxWaitSec{0};    ///< Longest time a query spent waiting.
+        double meanWaitSec() const { return admitted > 0 ? totalWaitSec/admitted : 0; }
+    };
+
+    QueryExecQueue() = default;
+    QueryExecQueue(QueryExecQueue const&) = delete;
+    QueryExecQueue& operator=(QueryExecQueue const&) = delete;
+
+    // util::CommandQueue overrides
+    void queCmd(util::Command::Ptr const& cmd) override;
+    util::Command::Ptr getCmd(bool wait=true) override;
+    void commandStart(util::Command::Ptr const& cmd) override;
+    void commandFinish(util::Command::Ptr const& cmd) override;
+
+    /// @return the number of queries waiting to run.
+    std::size_t getQueueLength() const;
+
+    Stats getStats() const;
+
+private:
+    bool _empty() const { return _qu.empty() && _queued == 0; }
+
+    /// Queued queries for each user, only users with queued queries are present.
+    std::map<std::string, std::deque<Cmd::Ptr>> _userQueues;
+    std::deque<std::string> _userTurns; ///< Users with queued queries, next one to run first.
+    std::size_t _queued{0};  ///< Total number of queries in _userQueues.
+    std::size_t _running{0};
+    std::uint64_t _admitted{0};
+    double _totalWaitSec{0};
+    double _maxWaitSec{0};
+};
+
+std::ostream& operator<<(std::ostream& os, QueryExecQueue::Stats const& stats);
+
+}}} // namespace lsst::qserv::czar
+
+#endif // LSST_QSERV_CZAR_QUERYEXECQUEUE_H
@@ -0,0 +1,108 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+/**
+ *
+ * @brief test QueryExecQueue
+ *
+ */
+
+// System headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Qserv headers
+#include "czar/QueryExecQueue.h"
+
+// Boost unit test header
+#define BOOST_TEST_MODULE QueryExecQueue
+#include "boost/test/included/unit_test.hpp"
+
+namespace test = boost::test_tools;
+
+using lsst::qserv::czar::QueryExecQueue;
+using namespace lsst::qserv::util;
+
+BOOST_AUTO_TEST_SUITE(Suite)
+
+BOOST_AUTO_TEST_CASE(FairOrder) {
+    QueryExecQueue queue;
+    auto noop = [](CmdData*) {};
+    for (auto user : {"a", "a", "a", "b", "c", "b"}) {
+        queue.queCmd(std::make_shared<QueryExecQueue::Cmd>(user, noop));
+    }
+    auto other = std::make_shared<Command>(noop);
+    queue.queCmd(other);
+    BOOST_CHECK_EQUAL(queue.getQueueLength(), 6U);
+    BOOST_CHECK_EQUAL(queue.getStats().users, 3U);
+
+    // Commands which are not queries go first, then users take turns.
+    BOOST_CHECK(queue.getCmd(false) == other);
+    std::string order;
+    while (auto cmd = queue.getCmd(false)) {
+        order += std::dynamic_pointer_cast<QueryExecQueue::Cmd>(cmd)->getUser();
+    }
+    BOOST_CHECK_EQUAL(order, "abcaba");
+
+    auto stats = queue.getStats();
+    BOOST_CHECK_EQUAL(stats.queued, 0U);
+    BOOST_CHECK_EQUAL(stats.users, 0U);
+    BOOST_CHECK_EQUAL(stats.admitted, 6U);
+    BOOST_CHECK(stats.maxWaitSec >= stats.meanWaitSec());
+}
+
+BOOST_AUTO_TEST_CASE(BoundedPool) {
+    auto queue = std::make_shared<QueryExecQueue>();
+    auto pool = ThreadPool::newThreadPool(2, queue);
+
+    std::atomic<int> running(0);
+    std::atomic<int> maxRunning(0);
+    std::atomic<int> done(0);
+    int const queries = 8;
+    for (int i = 0; i < queries; ++i) {
+        std::string user = (i % 2 == 0) ? "a" : "b";
+        queue->queCmd(std::make_shared<QueryExecQueue::Cmd>(user, [&](CmdData*) {
+            int now = ++running;
+            int prev = maxRunning.load();
+            while (now > prev && !maxRunning.compare_exchange_weak(prev, now)) {}
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            --running;
+            ++done;
+        }));
+    }
+    while (done < queries) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    BOOST_CHECK(maxRunning.load() <= 2);
+    auto stats = queue->getStats();
+    BOOST_CHECK_EQUAL(stats.admitted, static_cast<uint64_t>(queries));
+    BOOST_CHECK(stats.maxWaitSec > 0);
+
+    pool->endAll();
+    pool->waitForResize(0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
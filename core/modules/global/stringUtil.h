@@ -30,6 +30,9 @@
 // System headers
 #include <algorithm>
 #include <cctype>
+#include <functional>
+#include <iterator>
+#include <string>
 
 namespace lsst {
 namespace qserv {
@@ -69,5 +72,23 @@ sanitizeName(std::string const& name) {
     return out;
 }
 
+/// @return s with every occurrence of pat replaced by value.
+inline std::string
+replaceAll(std::string const& s, std::string const& pat, std::string const& value) {
+    if (pat.empty()) return s;
+    std::string result;
+    result.reserve(s.size() + value.size());
+    std::string::size_type i = 0;
+    while(true) {
+        std::string::size_type j = s.find(pat, i);
+        result.append(s, i, j - i);
+        if (j == std::string::npos) {
+            return result;
+        }
+        result.append(value);
+        i = j + pat.size();
+    }
+}
+
 }} // namespace lsst::qserv
 #endif // LSST_QSERV_STRINGUTIL_H
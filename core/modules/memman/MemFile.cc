@@ -54,10 +54,10 @@ MemFile::MLResult MemFile::memLock() {
     std::lock_guard<std::mutex> guard(_fileMutex);
     int rc;
 
-    // If the file is already locked, indicate success
+    // If the file is already locked, indicate success. All of it is in memory.
     //
     if (_isLocked) {
-        MLResult aokResult(_memInfo.size(), 0);
+        MLResult aokResult(_memInfo.size(), 0, _memInfo.size());
         return aokResult;
     }
 
@@ -65,9 +65,10 @@ MemFile::MLResult MemFile::memLock() {
     //
     if (!_isMapped) rc = ENOMEM;
     else {
-        rc = _memory.memLock(_memInfo, _isFlex);
+        uint64_t bCached;
+        rc = _memory.memLock(_memInfo, _isFlex, bCached);
         if (rc == 0) {
-            MLResult aokResult(_memInfo.size(),0);
+            MLResult aokResult(_memInfo.size(), 0, bCached);
             _isLocked = true;
             return aokResult;
         }
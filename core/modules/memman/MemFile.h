@@ -50,7 +50,8 @@ public:
     //-----------------------------------------------------------------------------
     //! @brief Lock database file in memory.
     //!
-    //! @return MLResult  When bLocked > 0 this number of bytes locked.
+    //! @return MLResult  When bLocked > 0 this number of bytes locked, of
+    //!                   which bCached bytes were already in memory.
     //!                   When bLocked = 0 no bytes were locked and retc holds
     //!                   the reason. When retc = 0 there was not enough memory
     //!                   and the table was marked flexible.
@@ -58,9 +59,11 @@ public:
 
     struct MLResult {
         uint64_t bLocked;
+        uint64_t bCached;
         int      retc;
-        MLResult() : bLocked(0), retc(0) {}
-        MLResult(uint64_t lksz, int rc) : bLocked(lksz), retc(rc) {}
+        MLResult() : bLocked(0), bCached(0), retc(0) {}
+        MLResult(uint64_t lksz, int rc, uint64_t cachesz=0)
+                : bLocked(lksz), bCached(cachesz), retc(rc) {}
     };
 
     MLResult    memLock();
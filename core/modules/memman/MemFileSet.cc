@@ -86,6 +86,7 @@ int MemFileSet::lockAll(bool strict) {
 
     MemFile::MLResult mlResult;
     uint64_t totLocked = 0;
+    uint64_t totCached = 0;
 
     // Try to lock all of the required tables. Any failure is considered fatal.
     // The caller should delete the fileset upon return in this case.
@@ -93,8 +94,10 @@ int MemFileSet::lockAll(bool strict) {
     for (auto mfP : _lockFiles) {
         mlResult = mfP->memLock();
         totLocked += mlResult.bLocked;
+        totCached += mlResult.bCached;
         if (mlResult.retc != 0 && strict) {
-            _lockBytes += totLocked;
+            _lockBytes  += totLocked;
+            _cacheBytes += totCached;
             return mlResult.retc;
         }
     }
@@ -106,6 +109,7 @@ int MemFileSet::lockAll(bool strict) {
     for (auto mfP : _flexFiles) {
         mlResult = mfP->memLock();
         totLocked += mlResult.bLocked;
+        totCached += mlResult.bCached;
     }
 
     // We ignore optional files at this point. FUTURE!!!
@@ -113,7 +117,8 @@ int MemFileSet::lockAll(bool strict) {
 
     // All done, update the statistics.
     //
-    _lockBytes += totLocked;
+    _lockBytes  += totLocked;
+    _cacheBytes += totCached;
     return 0;
 }
 
@@ -161,6 +166,7 @@ MemMan::Status MemFileSet::status() {
     // Fill out status information and return it.
     //
     myStatus.bytesLock = _lockBytes;
+    myStatus.bytesCached = _cacheBytes;
     myStatus.numFiles  = _numFiles;
     myStatus.chunk     = _chunk;
     return myStatus;
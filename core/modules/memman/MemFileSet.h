@@ -140,7 +140,7 @@ public:
     //-----------------------------------------------------------------------------
 
     MemFileSet(Memory& memory, int numLock, int numFlex, int chunk)
-              : _memory(memory), _lockBytes(0), _numFiles(0), _chunk(chunk),
+              : _memory(memory), _lockBytes(0), _cacheBytes(0), _numFiles(0), _chunk(chunk),
                 _mtxLocked(false) {
                 _lockFiles.reserve(numLock);
                 _flexFiles.reserve(numFlex);
@@ -154,6 +154,7 @@ private:
     std::vector<MemFile*> _lockFiles;
     std::vector<MemFile*> _flexFiles;
     uint64_t              _lockBytes;     // Total bytes locked
+    uint64_t              _cacheBytes;    // Bytes locked that were in memory
     uint32_t              _numFiles;
     int                   _chunk;
     std::atomic_bool      _mtxLocked;     // true -> _setMutex is locked
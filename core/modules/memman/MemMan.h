@@ -89,12 +89,15 @@ public:
     //!
     //! @param  maxBytes   - Maximum amount of memory that can be used
     //! @param  dbPath     - Path to directory where the database resides
+    //! @param  prefetchThreads - Number of threads reading ahead tables passed
+    //!                      to prefetch(), zero disables prefetching.
     //!
     //! @return !0: The pointer to the memory manager.
     //! @return  0: A manager could not be created.
     //-----------------------------------------------------------------------------
 
-    static MemMan* create(uint64_t maxBytes, std::string const& dbPath);
+    static MemMan* create(uint64_t maxBytes, std::string const& dbPath,
+                          int prefetchThreads=0);
 
     //-----------------------------------------------------------------------------
     //! @brief Lock a set of tables in memory passed to the prepare() method.
@@ -144,6 +147,22 @@ public:
 
     virtual Handle prepare(std::vector<TableInfo> const& tables, int chunk) = 0;
 
+    //-----------------------------------------------------------------------------
+    //! @brief Start reading a set of tables into the page cache, ahead of
+    //!        prepare() and lock() being called for them.
+    //!
+    //! The tables are read in the background and are not locked. Nothing is
+    //! read when the tables would not fit in the memory that is not already
+    //! locked or reserved, or when the chunk is still being read from an
+    //! earlier call. This method does not wait.
+    //!
+    //! @param  tables - Reference to the tables to process. Data and index
+    //!                  files are read unless their lock type is NOLOCK.
+    //! @param  chunk  - The chunk number associated with the tables.
+    //-----------------------------------------------------------------------------
+
+    virtual void   prefetch(std::vector<TableInfo> const& tables, int chunk) = 0;
+
     //-----------------------------------------------------------------------------
     //! @brief Unlock a set of tables previously locked by the lock() or were
     //!        prepared for locking by prepare().
@@ -185,6 +204,10 @@ public:
         uint32_t numFlexLock;  //!< Number  flexible files that were locked
         uint32_t numLocks;     //!< Number of calls to lock()
         uint32_t numErrors;    //!< Number of calls that failed
+        uint64_t bytesFromCache; //!< Bytes locked that were already in memory
+        uint64_t bytesFromDisk;  //!< Bytes locked that were read from disk
+        uint64_t bytesPrefetched;//!< Bytes read ahead by prefetch()
+        uint32_t numPrefetches;  //!< Number of chunks read ahead by prefetch()
     };
 
     virtual Statistics getStatistics() = 0;
@@ -200,6 +223,7 @@ public:
 
     struct Status {
         uint64_t bytesLock; //!< Number of resource bytes locked
+        uint64_t bytesCached; //!< Bytes of bytesLock that were already in memory
         uint32_t numFiles;  //!< Number of files resource has
         int      chunk;     //!< Chunk number associated with resource
     };
@@ -56,6 +56,9 @@ public:
                return HandleType::ISEMPTY;
            }
 
+    void  prefetch(std::vector<TableInfo> const& tables, int chunk) override
+                  {(void)tables; (void)chunk;}
+
     bool  unlock(Handle handle) override {(void)handle; return true;}
 
     void  unlockAll() override {}
@@ -74,6 +74,10 @@ MemMan::Statistics MemManReal::getStatistics() {
     stats.numLocks     = _numLocks;
     stats.numErrors    = _numErrors;
     stats.numFiles     = MemFile::numFiles();
+    stats.bytesFromCache = mStats.bytesFromCache;
+    stats.bytesFromDisk  = mStats.bytesFromDisk;
+    stats.bytesPrefetched= mStats.bytesReadAhead;
+    stats.numPrefetches  = _numPrefetches;
 
     // The following requires a lock
     //
@@ -161,6 +165,59 @@ int MemManReal::lock(MemMan::Handle handle, bool strict) {
     return rc;
 }
   
+/******************************************************************************/
+/*                              p r e f e t c h                               */
+/******************************************************************************/
+
+void MemManReal::prefetch(std::vector<TableInfo> const& tables, int chunk) {
+
+    std::vector<std::string> paths;
+    uint64_t totBytes = 0;
+
+    // If prefetching is disabled, there is nothing to do.
+    //
+    if (_prefetchPool == nullptr) return;
+
+    // Find the files we would lock for these tables and how big they are.
+    // Missing files are skipped, prepare() will report them.
+    //
+    auto addFile = [&](std::string const& tabName, bool isIndex) {
+        std::string fPath(_memory.filePath(tabName, chunk, isIndex));
+        MemInfo fInfo = _memory.fileInfo(fPath);
+        if (fInfo.isValid()) {
+            paths.push_back(fPath);
+            totBytes += fInfo.size();
+        }
+    };
+    for (auto&& tab : tables) {
+        if (tab.theData  != TableInfo::LockType::NOLOCK) addFile(tab.tableName, false);
+        if (tab.theIndex != TableInfo::LockType::NOLOCK) addFile(tab.tableName, true);
+    }
+    if (paths.empty()) return;
+
+    // Only read the chunk once at a time and only if it would fit in the
+    // memory we are allowed to lock along with everything else being read.
+    //
+    {    std::lock_guard<std::mutex> guard(_prefetchMutex);
+         if (_prefetchChunks.count(chunk) != 0) return;
+         if (_prefetchBytes + totBytes > _memory.bytesFree()) return;
+         _prefetchChunks.insert(chunk);
+         _prefetchBytes += totBytes;
+    }
+
+    // Read the files in the background, errors are ignored as the files are
+    // going to be locked later and that will report any problem.
+    //
+    auto readFiles = [this, paths, totBytes, chunk](util::CmdData*) {
+        for (auto&& fPath : paths) {_memory.readAhead(fPath);}
+        std::lock_guard<std::mutex> guard(_prefetchMutex);
+        _prefetchChunks.erase(chunk);
+        _prefetchBytes -= totBytes;
+        _numPrefetches++;
+    };
+    _prefetchPool->getQueue()->queCmd(std::make_shared<util::Command>(readFiles));
+}
+
 /******************************************************************************/
 /*                               p r e p a r e                                */
 /******************************************************************************/
@@ -27,11 +27,13 @@
 // System headers
 #include <atomic>
 #include <mutex>
+#include <set>
 #include <unordered_map>
 
 // Qserv Headers
 #include "memman/MemMan.h"
 #include "memman/Memory.h"
+#include "util/EventThread.h"
 
 namespace lsst {
 namespace qserv {
@@ -48,6 +50,8 @@ public:
 
     Handle prepare(std::vector<TableInfo> const& tables, int chunk) override;
 
+    void   prefetch(std::vector<TableInfo> const& tables, int chunk) override;
+
     bool   unlock(Handle handle) override;
 
     void   unlockAll() override;
@@ -59,15 +63,30 @@ public:
     MemManReal & operator=(const MemManReal&) = delete;
     MemManReal(const MemManReal&) = delete;
 
-    MemManReal(std::string const& dbPath, uint64_t maxBytes)
+    MemManReal(std::string const& dbPath, uint64_t maxBytes,
+               int prefetchThreads=0)
               : _memory(dbPath, maxBytes), _numErrors(0), _numLkerrs(0),
-                _numLocks(0), _numReqdFiles(0), _numFlexFiles(0) {}
-
-    ~MemManReal() override {unlockAll();}
+                _numLocks(0), _numReqdFiles(0), _numFlexFiles(0),
+                _numPrefetches(0) {
+                if (prefetchThreads > 0) {
+                   _prefetchPool = util::ThreadPool::newThreadPool(
+                                   prefetchThreads, nullptr);
+                }
+               }
+
+    ~MemManReal() override {
+                if (_prefetchPool != nullptr) _prefetchPool->endAll();
+                unlockAll();
+               }
 
 private:
 
     Memory           _memory;
+    util::ThreadPool::Ptr _prefetchPool; // Reads ahead for prefetch()
+    std::mutex       _prefetchMutex;
+    std::set<int>    _prefetchChunks;    // Being read, under _prefetchMutex
+    uint64_t         _prefetchBytes = 0; // Being read, under _prefetchMutex
+    std::atomic_uint _numPrefetches;
     std::atomic_uint _numErrors;
     std::atomic_uint _numLkerrs;
     uint32_t         _numLocks;      // Under control of hanMutex
@@ -30,6 +30,7 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <vector>
 
 namespace lsst {
 namespace qserv {
@@ -87,17 +88,26 @@ std::string Memory::filePath(std::string const& dbTable,
 /*                               m e m L o c k                                */
 /******************************************************************************/
   
-int Memory::memLock(MemInfo mInfo, bool isFlex) {
+int Memory::memLock(MemInfo mInfo, bool isFlex, uint64_t& bCached) {
 
     // Verify that this is a valid mapping
     //
+    bCached = 0;
     if (!mInfo.isValid()) return EFAULT;
 
+    // Find out how much of the file is already in the page cache as mlock()
+    // will have to read the rest from disk.
+    //
+    uint64_t resident = memResident(mInfo);
+
     // Lock this map into memory. Return success if this worked.
     //
     if (!mlock(mInfo._memAddr, mInfo._memSize)) {
         _lokBytes += mInfo._memSize;
         if (isFlex) _flexNum++;
+        bCached = resident;
+        _cacheBytes += resident;
+        _diskBytes  += mInfo._memSize - resident;
         return 0;
     }
 
@@ -107,6 +117,30 @@ int Memory::memLock(MemInfo mInfo, bool isFlex) {
     return (errno == EAGAIN ? ENOMEM : errno);
 }
 
+/******************************************************************************/
+/*                            m e m R e s i d e n t                           */
+/******************************************************************************/
+
+uint64_t Memory::memResident(MemInfo mInfo) {
+
+    static const uint64_t pageSize = sysconf(_SC_PAGESIZE);
+
+    // Verify that this is a valid mapping
+    //
+    if (!mInfo.isValid()) return 0;
+
+    // Ask which pages of the mapping are resident. If we can't tell, say none.
+    //
+    std::vector<unsigned char> pages((mInfo._memSize + pageSize - 1) / pageSize);
+    if (mincore(mInfo._memAddr, mInfo._memSize, pages.data())) return 0;
+
+    uint64_t resident = 0;
+    for (auto page : pages) {
+        if (page & 1) resident += pageSize;
+    }
+    return (resident > mInfo._memSize ? mInfo._memSize : resident);
+}
+
 /******************************************************************************/
 /*                               m a p F i l e                                */
 /******************************************************************************/
@@ -154,6 +188,39 @@ MemInfo Memory::mapFile(std::string const& fPath) {
     return mInfo;
 }
 
+/******************************************************************************/
+/*                              r e a d A h e a d                             */
+/******************************************************************************/
+
+int Memory::readAhead(std::string const& fPath) {
+
+    struct stat sBuff;
+    int         fdNum, rc = 0;
+
+    // Open the file and get its size
+    //
+    fdNum = open(fPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fdNum < 0 || fstat(fdNum, &sBuff)) {
+        rc = errno;
+        if (fdNum >= 0) close(fdNum);
+        return rc;
+    }
+
+    // Have the kernel read the whole file into the page cache. Should the
+    // filesystem not support readahead() just advise it that we need the
+    // file, which starts reading it asynchronously.
+    //
+    if (readahead(fdNum, 0, sBuff.st_size)) {
+        rc = posix_fadvise(fdNum, 0, 0, POSIX_FADV_WILLNEED);
+    }
+    if (rc == 0) _readBytes += static_cast<uint64_t>(sBuff.st_size);
+
+    // Close the file and return result
+    //
+    close(fdNum);
+    return rc;
+}
+
 /******************************************************************************/
 /*                                m e m R e l                                 */
 /******************************************************************************/
@@ -141,12 +141,36 @@ public:
     //!
     //! @param  mInfo  - The memory mapping returned by mapFile().
     //! @param  isFlex - When true account for flexible files in the statistics.
+    //! @param  bCached- Set to the number of bytes that were already in the
+    //!                  page cache, the rest had to be read from disk.
     //!
     //! @return =0     - Memory was locked.
     //! @return !0     - Memory not locked, retuned value is the errno.
     //-----------------------------------------------------------------------------
 
-    int     memLock(MemInfo mInfo, bool isFlex);
+    int     memLock(MemInfo mInfo, bool isFlex, uint64_t& bCached);
+
+    //-----------------------------------------------------------------------------
+    //! @brief Get the number of bytes of a mapped file in the page cache.
+    //!
+    //! @param  mInfo  - The memory mapping returned by mapFile().
+    //!
+    //! @return The number of bytes that are resident.
+    //-----------------------------------------------------------------------------
+
+    uint64_t memResident(MemInfo mInfo);
+
+    //-----------------------------------------------------------------------------
+    //! @brief Read a database file into the page cache without locking it.
+    //! This call blocks until the file has been read.
+    //!
+    //! @param  fPath  - Path of the database file to be read.
+    //!
+    //! @return =0     - File was read.
+    //! @return !0     - File could not be read, returned value is the errno.
+    //-----------------------------------------------------------------------------
+
+    int     readAhead(std::string const& fPath);
 
     //-----------------------------------------------------------------------------
     //! @brief Map a database file in memory.
@@ -207,6 +231,9 @@ public:
         uint32_t numMapErrors;   //!< Number of mmap()  calls that failed
         uint32_t numLokErrors;   //!< Number of mlock() calls that failed
         uint32_t numFlexFiles;   //!< Number of Flexible files encountered
+        uint64_t bytesFromCache; //!< Bytes locked that were in the page cache
+        uint64_t bytesFromDisk;  //!< Bytes locked that were read from disk
+        uint64_t bytesReadAhead; //!< Bytes read ahead by readAhead()
     };
 
     MemStats statistics() {
@@ -219,6 +246,9 @@ public:
         mStats.numMapErrors  = _numMapErrs;
         mStats.numLokErrors  = _numLokErrs;
         mStats.numFlexFiles  = _flexNum;
+        mStats.bytesFromCache= _cacheBytes;
+        mStats.bytesFromDisk = _diskBytes;
+        mStats.bytesReadAhead= _readBytes;
         return mStats;
     }
 
@@ -231,7 +261,8 @@ public:
 
     Memory(std::string const& dbDir, uint64_t memSZ)
           : _dbDir(dbDir), _maxBytes(memSZ), _lokBytes(0), _rsvBytes(0),
-            _numMapErrs(0), _numLokErrs(0), _flexNum(0) {}
+            _numMapErrs(0), _numLokErrs(0), _flexNum(0),
+            _cacheBytes(0), _diskBytes(0), _readBytes(0) {}
 
     ~Memory() {}
 
@@ -245,6 +276,9 @@ private:
     std::atomic_uint   _numMapErrs;
     std::atomic_uint   _numLokErrs;
     std::atomic_uint   _flexNum;
+    std::atomic<uint64_t> _cacheBytes;
+    std::atomic<uint64_t> _diskBytes;
+    std::atomic<uint64_t> _readBytes;
 };
 }}} // namespace lsst:qserv:memman
 #endif  // LSST_QSERV_MEMMAN_MEMORY_H
@@ -194,6 +194,42 @@ MySqlConnection::selectDb(std::string const& dbName) {
     return true;
 }
 
+bool
+MySqlConnection::ping() {
+    return _mysql != nullptr && mysql_ping(_mysql) == 0;
+}
+
+bool
+MySqlConnection::resetSession() {
+    if (!_mysql) {
+        return false;
+    }
+    if (_mysql_res) {
+        MYSQL_ROW row;
+        while((row = mysql_fetch_row(_mysql_res))); // Drain results.
+        freeResult();
+    }
+    // Skip the results of statements a multi-statement query did not get to.
+    while (mysql_next_result(_mysql) == 0) {
+        MYSQL_RES* res = mysql_use_result(_mysql);
+        if (res) {
+            MYSQL_ROW row;
+            while((row = mysql_fetch_row(res)));
+            mysql_free_result(res);
+        }
+    }
+#if (MYSQL_VERSION_ID >= 50703 && MYSQL_VERSION_ID < 100000) || MYSQL_VERSION_ID >= 100204
+    return mysql_reset_connection(_mysql) == 0;
+#else
+    // Older client libraries can only reset the session by logging in again,
+    // which still saves the cost of a new connection.
+    return mysql_change_user(_mysql,
+                             _sqlConfig->username.empty() ? 0 : _sqlConfig->username.c_str(),
+                             _sqlConfig->password.empty() ? 0 : _sqlConfig->password.c_str(),
+                             _sqlConfig->dbName.empty() ? 0 : _sqlConfig->dbName.c_str()) == 0;
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////
 // MySqlConnection
 // private:
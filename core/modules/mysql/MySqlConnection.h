@@ -85,6 +85,15 @@ public:
     MySqlConfig const& getConfig() const { return *_sqlConfig; }
     bool selectDb(std::string const& dbName);
 
+    /// @return true if the server still answers on this connection.
+    bool ping();
+
+    /// Discard unread results and return the session to the state of a new
+    /// connection: user variables, temporary tables and session settings
+    /// are cleared.
+    /// @return false if the session could not be reset.
+    bool resetSession();
+
 private:
     MYSQL* _connectHelper();
     static std::mutex _mysqlShared;
@@ -0,0 +1,225 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "proto/ColumnBatchBuilder.h"
+
+// System headers
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Qserv headers
+#include "global/Bug.h"
+
+namespace {
+
+/// Write the decimal digits of val backwards, ending just before 'end'.
+/// @return a pointer to the first digit.
+char* writeDigits(char* end, unsigned long long val) {
+    do {
+        *--end = static_cast<char>('0' + val % 10);
+        val /= 10;
+    } while (val != 0);
+    return end;
+}
+
+} // anonymous namespace
+
+namespace lsst {
+namespace qserv {
+namespace proto {
+
+const std::size_t ColumnBatchBuilder::FORMAT_BUFFER_SIZE;
+
+ColumnBatchBuilder::ColumnBatchBuilder(std::vector<ColumnBatch::Encoding> const& encodings) {
+    for (auto encoding : encodings) {
+        Column col;
+        col.encoding = encoding;
+        _columns.push_back(col);
+    }
+}
+
+int ColumnBatchBuilder::formatFixed(char* buf, ColumnBatch::Encoding encoding, std::uint64_t bits) {
+    switch (encoding) {
+    case ColumnBatch::INT64:
+    case ColumnBatch::UINT64: {
+        char digits[24];
+        char* const end = digits + sizeof(digits);
+        bool const negative = encoding == ColumnBatch::INT64 && static_cast<std::int64_t>(bits) < 0;
+        // Two's complement negation is well defined on the unsigned value.
+        char* first = writeDigits(end, negative ? 0 - bits : bits);
+        if (negative) {
+            *--first = '-';
+        }
+        std::memcpy(buf, first, end - first);
+        return end - first;
+    }
+    case ColumnBatch::DOUBLE: {
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        return snprintf(buf, FORMAT_BUFFER_SIZE, "%.17g", d);
+    }
+    case ColumnBatch::FLOAT: {
+        std::uint32_t bits32 = static_cast<std::uint32_t>(bits);
+        float f;
+        std::memcpy(&f, &bits32, sizeof(f));
+        return snprintf(buf, FORMAT_BUFFER_SIZE, "%.9g", f);
+    }
+    default:
+        throw Bug("ColumnBatchBuilder::formatFixed: not a fixed-width encoding");
+    }
+}
+
+std::size_t ColumnBatchBuilder::fixedWidth(ColumnBatch::Encoding encoding) {
+    switch (encoding) {
+    case ColumnBatch::INT64:
+    case ColumnBatch::UINT64:
+    case ColumnBatch::DOUBLE:
+        return 8;
+    case ColumnBatch::FLOAT:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+void ColumnBatchBuilder::addRow(char const* const* row, unsigned long const* lengths) {
+    for (std::size_t i = 0, e = _columns.size(); i != e; ++i) {
+        Column& col = _columns[i];
+        if (row[i] == nullptr) {
+            _setNull(col);
+            if (col.encoding == ColumnBatch::STRING) {
+                putUint(col.offsets, col.data.size(), 4);
+            } else {
+                putUint(col.fixed, 0, fixedWidth(col.encoding));
+            }
+            continue;
+        }
+        if (col.encoding != ColumnBatch::STRING) {
+            if (_addFixed(col, row[i], lengths[i])) {
+                continue;
+            }
+            _toString(col);
+        }
+        col.data.append(row[i], lengths[i]);
+        putUint(col.offsets, col.data.size(), 4);
+        _byteSize += lengths[i];
+    }
+    _byteSize += 4 * _columns.size();
+    ++_rowCount;
+}
+
+void ColumnBatchBuilder::moveTo(Result& result) {
+    for (auto& col : _columns) {
+        ColumnBatch* batch = result.add_columnbatch();
+        batch->set_encoding(col.encoding);
+        if (col.encoding == ColumnBatch::STRING) {
+            batch->mutable_offsets()->swap(col.offsets);
+            batch->mutable_data()->swap(col.data);
+        } else {
+            batch->mutable_fixed()->swap(col.fixed);
+        }
+        if (!col.nulls.empty()) {
+            batch->mutable_nulls()->swap(col.nulls);
+        }
+        // Fixed-width columns that fell back to STRING stay STRING for the
+        // rest of the result.
+        col.fixed.clear();
+        col.offsets.clear();
+        col.data.clear();
+        col.nulls.clear();
+    }
+    _rowCount = 0;
+    _byteSize = 0;
+}
+
+/// Parse a non-NULL value into a fixed-width column.
+/// @return false if val is not a complete number of the column's type.
+bool ColumnBatchBuilder::_addFixed(Column& col, char const* val, unsigned long length) {
+    // MySQL values are not NUL-terminated when fetched unbuffered, copy them.
+    char buf[64];
+    if (length == 0 || length >= sizeof(buf)) {
+        return false;
+    }
+    std::memcpy(buf, val, length);
+    buf[length] = '\0';
+    char* end = nullptr;
+    errno = 0;
+    std::uint64_t bits;
+    switch (col.encoding) {
+    case ColumnBatch::INT64:
+        bits = static_cast<std::uint64_t>(std::strtoll(buf, &end, 10));
+        break;
+    case ColumnBatch::UINT64:
+        if (buf[0] == '-') { return false; }
+        bits = std::strtoull(buf, &end, 10);
+        break;
+    case ColumnBatch::DOUBLE: {
+        double d = std::strtod(buf, &end);
+        std::memcpy(&bits, &d, sizeof(d));
+        break;
+    }
+    case ColumnBatch::FLOAT: {
+        float f = std::strtof(buf, &end);
+        std::uint32_t bits32;
+        std::memcpy(&bits32, &f, sizeof(f));
+        bits = bits32;
+        break;
+    }
+    default:
+        return false;
+    }
+    if (errno != 0 || end != buf + length) {
+        return false;
+    }
+    putUint(col.fixed, bits, fixedWidth(col.encoding));
+    _byteSize += fixedWidth(col.encoding);
+    return true;
+}
+
+/// Convert a fixed-width column, and the rows already in it, to STRING.
+void ColumnBatchBuilder::_toString(Column& col) {
+    std::size_t const width = fixedWidth(col.encoding);
+    for (unsigned int r = 0; r < _rowCount; ++r) {
+        if (!isNull(col.nulls, r)) {
+            char buf[FORMAT_BUFFER_SIZE];
+            int len = formatFixed(buf, col.encoding, getUint(&col.fixed[r * width], width));
+            col.data.append(buf, len);
+        }
+        putUint(col.offsets, col.data.size(), 4);
+    }
+    col.fixed.clear();
+    col.encoding = ColumnBatch::STRING;
+}
+
+void ColumnBatchBuilder::_setNull(Column& col) {
+    std::size_t byte = _rowCount / 8;
+    if (col.nulls.size() <= byte) {
+        col.nulls.resize(byte + 1, '\0');
+    }
+    col.nulls[byte] = static_cast<char>(col.nulls[byte] | (1u << (_rowCount % 8)));
+}
+
+}}} // namespace lsst::qserv::proto
@@ -0,0 +1,115 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_QSERV_PROTO_COLUMNBATCHBUILDER_H
+#define LSST_QSERV_PROTO_COLUMNBATCHBUILDER_H
+
+// System headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Qserv headers
+#include "proto/worker.pb.h"
+
+namespace lsst {
+namespace qserv {
+namespace proto {
+
+/// ColumnBatchBuilder accumulates text rows, as returned by the MySQL C API,
+/// into column-major ColumnBatch messages (result protocol 3, see
+/// worker.proto).
+///
+/// Columns with a fixed-width encoding hold the parsed binary value. A value
+/// that does not parse as expected turns its column into a STRING column.
+class ColumnBatchBuilder {
+public:
+    explicit ColumnBatchBuilder(std::vector<ColumnBatch::Encoding> const& encodings);
+
+    /// Add a row. A nullptr value is a NULL.
+    void addRow(char const* const* row, unsigned long const* lengths);
+
+    /// @return the number of rows added since construction or the last moveTo().
+    unsigned int getRowCount() const { return _rowCount; }
+
+    /// @return the approximate serialized size of the rows added so far.
+    std::size_t getByteSize() const { return _byteSize; }
+
+    /// Append one ColumnBatch per column to 'result' and reset the builder.
+    void moveTo(Result& result);
+
+    /// @return the width in bytes of a fixed-width encoding, 0 for STRING.
+    static std::size_t fixedWidth(ColumnBatch::Encoding encoding);
+
+    /// Size of a buffer large enough for formatFixed().
+    static const std::size_t FORMAT_BUFFER_SIZE = 32;
+
+    /// Format a fixed-width value as text that MySQL parses back into the
+    /// same value.
+    /// @return the number of characters written to buf, which must hold
+    /// FORMAT_BUFFER_SIZE bytes.
+    static int formatFixed(char* buf, ColumnBatch::Encoding encoding, std::uint64_t bits);
+
+    /// @return true if row 'row' is marked NULL in 'nulls'.
+    static bool isNull(std::string const& nulls, unsigned int row) {
+        std::size_t byte = row / 8;
+        return byte < nulls.size()
+            && (static_cast<unsigned char>(nulls[byte]) & (1u << (row % 8))) != 0;
+    }
+
+    /// Little-endian encoding and decoding of fixed-width values.
+    static void putUint(std::string& dest, std::uint64_t val, std::size_t width) {
+        for (std::size_t j = 0; j < width; ++j) {
+            dest.push_back(static_cast<char>((val >> (8 * j)) & 0xff));
+        }
+    }
+    static std::uint64_t getUint(char const* src, std::size_t width) {
+        std::uint64_t val = 0;
+        for (std::size_t j = 0; j < width; ++j) {
+            val |= static_cast<std::uint64_t>(static_cast<unsigned char>(src[j])) << (8 * j);
+        }
+        return val;
+    }
+
+private:
+    struct Column {
+        ColumnBatch::Encoding encoding;
+        std::string fixed;
+        std::string offsets;
+        std::string data;
+        std::string nulls;
+    };
+
+    bool _addFixed(Column& col, char const* val, unsigned long length);
+    void _toString(Column& col);
+    void _setNull(Column& col);
+
+    std::vector<Column> _columns;
+    unsigned int _rowCount{0};
+    std::size_t _byteSize{0};
+};
+
+}}} // namespace lsst::qserv::proto
+
+#endif // LSST_QSERV_PROTO_COLUMNBATCHBUILDER_H
@@ -28,7 +28,9 @@
 
 // Qserv headers
 #include "proto/ProtoHeaderWrap.h"
+#include "util/Checksum.h"
 #include "util/common.h"
+#include "util/StringHash.h"
 
 namespace {
 LOG_LOGGER _log = LOG_GET("lsst.qserv.parser.ProtoHeaderWrap");
@@ -66,4 +68,54 @@ bool ProtoHeaderWrap::unwrap(std::shared_ptr<WorkerResponse>& response, std::vec
     return true;
 }
 
+void ProtoHeaderWrap::setChecksum(ProtoHeader& header, ProtoHeader::ChecksumType checksumType,
+                                  char const* buffer, size_t bufferSize) {
+    header.clear_md5();
+    header.clear_checksum();
+    header.set_checksumtype(checksumType);
+    switch (checksumType) {
+    case ProtoHeader::MD5:
+        header.set_md5(util::StringHash::getMd5(buffer, bufferSize));
+        break;
+    case ProtoHeader::NONE:
+        break;
+    case ProtoHeader::CRC32C:
+        header.set_checksum(util::Checksum::crc32c(buffer, bufferSize));
+        break;
+    case ProtoHeader::XXHASH64:
+        header.set_checksum(util::Checksum::xxHash64(buffer, bufferSize));
+        break;
+    }
+}
+
+bool ProtoHeaderWrap::verifyChecksum(ProtoHeader const& header, char const* buffer, size_t bufferSize) {
+    // Headers without checksumtype come from workers that only knew MD5.
+    switch (header.checksumtype()) {
+    case ProtoHeader::MD5:
+        return header.md5() == util::StringHash::getMd5(buffer, bufferSize);
+    case ProtoHeader::NONE:
+        return true;
+    case ProtoHeader::CRC32C:
+        return header.has_checksum() && header.checksum() == util::Checksum::crc32c(buffer, bufferSize);
+    case ProtoHeader::XXHASH64:
+        return header.has_checksum() && header.checksum() == util::Checksum::xxHash64(buffer, bufferSize);
+    }
+    return false;
+}
+
+bool ProtoHeaderWrap::parseChecksumType(std::string const& name, ProtoHeader::ChecksumType& checksumType) {
+    if (name == "none") {
+        checksumType = ProtoHeader::NONE;
+    } else if (name == "crc32c") {
+        checksumType = ProtoHeader::CRC32C;
+    } else if (name == "xxhash64") {
+        checksumType = ProtoHeader::XXHASH64;
+    } else if (name == "md5") {
+        checksumType = ProtoHeader::MD5;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 }}} // namespace lsst::qserv::proto
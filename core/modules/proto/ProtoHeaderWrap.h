@@ -33,6 +33,7 @@
 
 // System headers
 #include <memory>
+#include <string>
 
 // Qserv headers
 #include "proto/ProtoImporter.h"
@@ -52,6 +53,17 @@ public:
 
     static std::string wrap(std::string& protoHeaderString);
     static bool unwrap(std::shared_ptr<WorkerResponse>& response, std::vector<char>& buffer);
+
+    /// Set the checksum fields of header for the message in buffer.
+    static void setChecksum(ProtoHeader& header, ProtoHeader::ChecksumType checksumType,
+                            char const* buffer, size_t bufferSize);
+
+    /// @return true if the checksum in header matches the message in buffer.
+    static bool verifyChecksum(ProtoHeader const& header, char const* buffer, size_t bufferSize);
+
+    /// Parse a checksum type name ("none", "crc32c", "xxhash64", "md5").
+    /// @return false if the name is not recognized.
+    static bool parseChecksumType(std::string const& name, ProtoHeader::ChecksumType& checksumType);
 };
 
 }}} // end namespace
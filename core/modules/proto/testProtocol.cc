@@ -192,6 +192,29 @@ BOOST_AUTO_TEST_CASE(ProtoHeaderWrap) {
     BOOST_CHECK(compareProtoHeaders(response->protoHeader, *ph));
 }
 
+BOOST_AUTO_TEST_CASE(ProtoHeaderChecksum) {
+    std::string msg = "Not really a serialized Result message.";
+    proto::ProtoHeader ph;
+    ph.set_size(msg.size());
+    // Headers from older workers carry only md5.
+    ph.set_md5(std::string("1234567890abcdef"));
+    BOOST_CHECK(!proto::ProtoHeaderWrap::verifyChecksum(ph, msg.data(), msg.size()));
+    for (auto type : {proto::ProtoHeader::MD5, proto::ProtoHeader::NONE,
+                      proto::ProtoHeader::CRC32C, proto::ProtoHeader::XXHASH64}) {
+        proto::ProtoHeaderWrap::setChecksum(ph, type, msg.data(), msg.size());
+        BOOST_CHECK(proto::ProtoHeaderWrap::verifyChecksum(ph, msg.data(), msg.size()));
+        BOOST_CHECK_EQUAL(ph.has_md5(), type == proto::ProtoHeader::MD5);
+        std::string corrupt = msg;
+        corrupt[5] ^= 0x10;
+        bool detected = !proto::ProtoHeaderWrap::verifyChecksum(ph, corrupt.data(), corrupt.size());
+        BOOST_CHECK_EQUAL(detected, type != proto::ProtoHeader::NONE);
+    }
+    proto::ProtoHeader::ChecksumType type;
+    BOOST_CHECK(proto::ProtoHeaderWrap::parseChecksumType("xxhash64", type));
+    BOOST_CHECK_EQUAL(type, proto::ProtoHeader::XXHASH64);
+    BOOST_CHECK(!proto::ProtoHeaderWrap::parseChecksumType("sha1", type));
+}
+
 BOOST_AUTO_TEST_CASE(ScanTableInfo) {
     lsst::qserv::proto::ScanTableInfo stiA{"dba", "fruit", false, 1};
     lsst::qserv::proto::ScanTableInfo stiB{"dba", "fruit", true, 1};
@@ -317,6 +317,8 @@ function queryProcessing()
         -- Need to save thread_id and reuse for killing query
         hintsToPassArr["client_dst_name"] = proxy.connection.client.dst.name
         hintsToPassArr["server_thread_id"] = proxy.connection.server.thread_id
+        -- Queries waiting for execution in czar take turns by user
+        hintsToPassArr["user"] = proxy.connection.client.username
         czarProxy.log("mysql-proxy", "INFO", "proxy.connection.server.thread_id: " .. proxy.connection.server.thread_id)
         czarProxy.log("mysql-proxy", "INFO", "Passing query: " .. queryToPassStr)
 
@@ -50,6 +50,7 @@
 #include "query/QueryContext.h"
 #include "query/SelectList.h"
 #include "query/SelectStmt.h"
+#include "query/ValueExpr.h"
 
 namespace {
 LOG_LOGGER _log = LOG_GET("lsst.qserv.qana.PostPlugin");
@@ -80,6 +81,7 @@ public:
     virtual void applyPhysical(QueryPlugin::Plan& plan, query::QueryContext&);
 
     int _limit;
+    bool _anyRowsMatch{false}; ///< Any _limit rows of the result satisfy the query.
     std::shared_ptr<query::OrderByClause> _orderBy;
 };
 
@@ -125,6 +127,18 @@ PostPlugin::applyLogical(query::SelectStmt& stmt,
     if (stmt.hasOrderBy()) {
         _orderBy = stmt.getOrderBy().clone();
     }
+    // Without ordering or any combination of rows, the first rows to arrive
+    // are as good as any others.
+    _anyRowsMatch = _limit != NOTSET && !_orderBy && !stmt.hasGroupBy()
+        && !stmt.hasHaving() && !stmt.getDistinct();
+    auto vlist = stmt.getSelectList().getValueExprList();
+    if (vlist) {
+        for (auto const& valueExpr : *vlist) {
+            if (valueExpr && valueExpr->hasAggregation()) {
+                _anyRowsMatch = false;
+            }
+        }
+    }
 }
 
 void
@@ -139,6 +153,9 @@ PostPlugin::applyPhysical(QueryPlugin::Plan& plan,
         if (context.hasChunks()) {
              LOGS(_log, LOG_LVL_DEBUG, "Add merge operation");
              context.needsMerge = true;
+             if (_anyRowsMatch) {
+                 context.rowLimit = _limit;
+             }
          }
     } else if (_orderBy) {
         // If there is no LIMIT clause, remove ORDER BY clause from all Czar queries because it is performed by
@@ -43,6 +43,7 @@
 #include "boost/lexical_cast.hpp"
 
 // Qserv headers
+#include "global/stringUtil.h"
 #include "qproc/ChunkSpec.h"
 #include "query/QueryTemplate.h"
 
@@ -61,25 +62,6 @@ public:
     QueryMapping::Parameter param;
 };
 
-std::string const replace(std::string const & s,
-                          std::string const & pat,
-                          std::string const & value)
-{
-    std::string result;
-    size_t i = 0;
-    result.reserve(s.size() + value.size());
-    while(true) {
-        size_t j = s.find(pat, i);
-        result.append(s, i, j - i);
-        if (j == std::string::npos) {
-            break;
-        }
-        result.append(value);
-        i = j + pat.size();
-    }
-    return result;
-}
-
 class Mapping : public query::QueryTemplate::EntryMapping {
 public:
     typedef std::deque<int> IntDeque;
@@ -111,7 +93,7 @@ public:
         //if (!e.isDynamic()) {return newE; }
 
         for(i=_map.begin(); i != _map.end(); ++i) {
-            newE->s = replace(newE->s, i->pat, i->tgt);
+            newE->s = replaceAll(newE->s, i->pat, i->tgt);
             if (i->param == QueryMapping::SUBCHUNK) {
                 // Remember that we mapped a subchunk,
                     // so we know to iterate over subchunks.
@@ -177,6 +159,56 @@ QueryMapping::apply(qproc::ChunkSpecSingle const& s,
     return t.generate(m);
 }
 
+query::QueryTemplate::Compiled
+QueryMapping::compile(query::QueryTemplate const& t) const {
+    std::vector<std::string> placeholders;
+    for(auto const& sub : _subs) {
+        placeholders.push_back(sub.first);
+    }
+    return t.compile(placeholders);
+}
+
+std::string
+QueryMapping::apply(qproc::ChunkSpec const& s,
+                    query::QueryTemplate::Compiled const& t) const {
+    std::string subChunk;
+    if (!s.subChunks.empty()) {
+        subChunk = std::to_string(s.subChunks.front());
+    }
+    return t.render(_values(std::to_string(s.chunkId), subChunk));
+}
+
+std::string
+QueryMapping::apply(qproc::ChunkSpecSingle const& s,
+                    query::QueryTemplate::Compiled const& t) const {
+    return t.render(_values(std::to_string(s.chunkId), std::to_string(s.subChunkId)));
+}
+
+/// @return values of _subs parameters, in _subs order, as Mapping::lookup()
+std::vector<std::string>
+QueryMapping::_values(std::string const& chunk, std::string const& subChunk) const {
+    std::vector<std::string> values;
+    values.reserve(_subs.size());
+    for(auto const& sub : _subs) {
+        switch(sub.second) {
+        case INVALID:
+            values.push_back("INVALID");
+            break;
+        case CHUNK:
+            values.push_back(chunk);
+            break;
+        case SUBCHUNK:
+            values.push_back(subChunk);
+            break;
+        case HTM1:
+            throw std::range_error("HTM unimplemented");
+        default:
+            throw std::range_error("Unknown mapping parameter");
+        }
+    }
+    return values;
+}
+
 void
 QueryMapping::update(QueryMapping const& m) {
     // Update this mapping to reflect the union of the two mappings.
@@ -33,13 +33,14 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
+
+// Qserv headers
+#include "query/QueryTemplate.h"
 
 // Forward declarations
 namespace lsst {
 namespace qserv {
-namespace query {
-    class QueryTemplate;
-}
 namespace qproc {
     struct ChunkSpec;
     class ChunkSpecSingle;
@@ -84,6 +85,17 @@ public:
     std::string apply(qproc::ChunkSpecSingle const& s,
                       query::QueryTemplate const& t) const;
 
+    /// @return template compiled for the placeholders of this mapping. Use
+    ///         it with apply() to generate many queries from the template.
+    query::QueryTemplate::Compiled compile(query::QueryTemplate const& t) const;
+
+    /// Same as apply() on the template t was compiled from, compile() must
+    /// have been called on this mapping, not modified since.
+    std::string apply(qproc::ChunkSpec const& s,
+                      query::QueryTemplate::Compiled const& t) const;
+    std::string apply(qproc::ChunkSpecSingle const& s,
+                      query::QueryTemplate::Compiled const& t) const;
+
     // Modifiers
     void insertSubChunkTable(std::string const& table) {
         _subChunkTables.insert(table); }
@@ -99,6 +111,8 @@ public:
     StringSet const& getSubChunkTables() const { return _subChunkTables; }
 
 private:
+    std::vector<std::string> _values(std::string const& chunk, std::string const& subChunk) const;
+
     ParameterMap _subs;
     StringSet _subChunkTables;
 };
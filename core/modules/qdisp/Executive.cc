@@ -41,7 +41,6 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
-#include <deque>
 #include <functional>
 #include <iostream>
 #include <sstream>
@@ -129,15 +128,12 @@ void Executive::add(JobDescription const& jobDesc) {
         MarkCompleteFunc::Ptr mcf = std::make_shared<MarkCompleteFunc>(thisPtr, jobDesc.id());
         jobQuery = JobQuery::newJobQuery(thisPtr, jobDesc, jobStatus, mcf, _id);
 
-        if (!_addJobToMap(jobQuery)) {
-            LOGS(_log, LOG_LVL_ERROR, "Executive ignoring duplicate job add " << jobQuery->getIdStr());
-            return;
-        }
-
-        if (!_track(jobQuery->getIdInt(), jobQuery)) {
-            LOGS(_log, LOG_LVL_ERROR, "Executive ignoring duplicate track add" << jobQuery->getIdStr());
+        if (!_jobs.add(jobQuery->getIdInt(), jobQuery)) {
+            LOGS(_log, LOG_LVL_ERROR, "Executive ignoring duplicate or out of range job add "
+                 << jobQuery->getIdStr());
             return;
         }
+        LOGS(_log, LOG_LVL_DEBUG, "Success TRACKING " << jobQuery->getIdStr());
 
         if (_empty.exchange(false)) {
             LOGS(_log, LOG_LVL_DEBUG, "Flag _empty set to false by " << jobQuery->getIdStr());
@@ -167,41 +163,36 @@ bool Executive::xrdSsiProvision(std::shared_ptr<QueryResource> &jobQueryResource
 }
 
 
-/// Add a JobQuery to this Executive.
-/// Return true if it was successfully added to the map.
-///
-bool Executive::_addJobToMap(JobQuery::Ptr const& job) {
-    auto entry = std::pair<int, JobQuery::Ptr>(job->getIdInt(), job);
-    return _jobMap.insert(entry).second;
-}
-
 bool Executive::join() {
     // To join, we make sure that all of the chunks added so far are complete.
     // Check to see if _requesters is empty, if not, then sleep on a condition.
     _waitAllUntilEmpty();
     // Okay to merge. probably not the Executive's responsibility
-    struct successF {
-        static bool f(Executive::JobMap::value_type const& entry) {
-            JobStatus::Info const& esI = entry.second->getStatus()->getInfo();
-            LOGS(_log, LOG_LVL_DEBUG, "entry state:" << (void*)entry.second.get() << " " << esI);
-            return (esI.state == JobStatus::RESPONSE_DONE) || (esI.state == JobStatus::COMPLETE);
-        }
-    };
-
     int sCount = 0;
-    {
-        std::lock_guard<std::recursive_mutex> lock(_jobsMutex);
-        sCount = std::count_if(_jobMap.begin(), _jobMap.end(), successF::f);
+    _jobs.forEach([&sCount](int, JobQuery::Ptr const& job, bool) {
+        JobStatus::Info const& esI = job->getStatus()->getInfo();
+        LOGS(_log, LOG_LVL_DEBUG, "entry state:" << (void*)job.get() << " " << esI);
+        if ((esI.state == JobStatus::RESPONSE_DONE) || (esI.state == JobStatus::COMPLETE)) {
+            ++sCount;
+        }
+    });
+    bool limitReached = false;
+    if (sCount != _requestCount && _limitReached) {
+        std::lock_guard<std::mutex> lock(_errorsMutex);
+        limitReached = _multiError.empty();
     }
     if (sCount == _requestCount) {
         LOGS(_log, LOG_LVL_DEBUG, "Query execution succeeded: " << _requestCount
              << " jobs dispatched and completed.");
+    } else if (limitReached) {
+        LOGS(_log, LOG_LVL_DEBUG, "Query execution succeeded: " << _requestCount
+             << " jobs dispatched, " << sCount << " jobs completed before the limit was reached");
     } else {
         LOGS(_log, LOG_LVL_ERROR, "Query execution failed: " << _requestCount
              << " jobs dispatched, but only " << sCount << " jobs completed");
     }
     _updateProxyMessages();
-    bool empty = (sCount == _requestCount);
+    bool empty = (sCount == _requestCount) || limitReached;
     _empty.store(empty);
     LOGS(_log, LOG_LVL_DEBUG, "Flag set to _empty=" << empty << ", sCount=" << sCount
          << ", requestCount=" << _requestCount);
@@ -213,30 +204,32 @@ void Executive::markCompleted(int jobId, bool success) {
     std::string idStr = QueryIdHelper::makeIdStr(_id, jobId);
     LOGS(_log, LOG_LVL_DEBUG, "Executive::markCompleted " << idStr
             << " " << success);
+    if (!success && _limitReached) {
+        // The job was most likely cancelled, its rows are not needed anyway.
+        LOGS(_log, LOG_LVL_DEBUG, "Executive: " << idStr << " ended after the limit was reached");
+        _unTrack(jobId);
+        return;
+    }
     if (!success) {
-        {
-            std::lock_guard<std::mutex> lock(_incompleteJobsMutex);
-            auto iter = _incompleteJobs.find(jobId);
-            if (iter != _incompleteJobs.end()) {
-                err = iter->second->getDescription().respHandler()->getError();
-            } else {
-                std::string msg = "Executive::markCompleted failed to find tracked " + idStr +
-                        " size=" + std::to_string(_incompleteJobs.size());
-                LOGS(_log, LOG_LVL_DEBUG, msg);
-                // If the user query has been cancelled, this is expected for jobs that have not yet
-                // been tracked. In all other cases, it indicates a serious problem.
-                if (!getCancelled()) {
-                    throw Bug(msg);
-                }
-                return;
+        JobQuery::Ptr job;
+        if (_jobs.isIncomplete(jobId)) {
+            job = _jobs.get(jobId);
+        }
+        if (job == nullptr) {
+            std::string msg = "Executive::markCompleted failed to find tracked " + idStr +
+                    " size=" + std::to_string(_jobs.getIncomplete());
+            LOGS(_log, LOG_LVL_DEBUG, msg);
+            // If the user query has been cancelled, this is expected for jobs that have not yet
+            // been tracked. In all other cases, it indicates a serious problem.
+            if (!getCancelled()) {
+                throw Bug(msg);
             }
+            return;
         }
+        err = job->getDescription().respHandler()->getError();
         LOGS(_log, LOG_LVL_ERROR, "Executive: error executing " << idStr
              << " " << err << " (status: " << err.getStatus() << ")");
-        {
-            std::lock_guard<std::recursive_mutex> lock(_jobsMutex);
-            _jobMap[jobId]->getStatus()->updateInfo(JobStatus::RESULT_ERROR, err.getCode(), err.getMsg());
-        }
+        job->getStatus()->updateInfo(JobStatus::RESULT_ERROR, err.getCode(), err.getMsg());
         {
             std::lock_guard<std::mutex> lock(_errorsMutex);
             _multiError.push_back(err);
@@ -261,38 +254,34 @@ void Executive::squash() {
     }
 
     LOGS(_log, LOG_LVL_DEBUG, getIdStr() << " Executive::squash Trying to cancel all queries...");
-    std::deque<JobQuery::Ptr> jobsToCancel;
-    {
-        std::lock_guard<std::recursive_mutex> lock(_jobsMutex);
-        for(auto const& jobEntry : _jobMap) {
-            jobsToCancel.push_back(jobEntry.second);
-        }
-    }
-
-    for (auto const& job : jobsToCancel) {
+    _jobs.forEach([](int, JobQuery::Ptr const& job, bool) {
         job->cancel();
-    }
+    });
     LOGS_DEBUG(getIdStr() << " Executive::squash done");
 }
 
-int Executive::getNumInflight() {
-    std::unique_lock<std::mutex> lock(_incompleteJobsMutex);
-    return _incompleteJobs.size();
+void Executive::squashLimitReached() {
+    LOGS(_log, LOG_LVL_DEBUG, getIdStr() << " Executive::squashLimitReached");
+    _limitReached = true;
+    squash();
+}
+
+void Executive::waitInflight(int count) {
+    while (_jobs.getIncomplete() > count) {
+        _reapRequesters();
+        if (_jobs.getIncomplete() <= count) break;
+        _jobs.waitIncomplete(count, std::chrono::seconds(5));
+    }
 }
 
 std::string Executive::getProgressDesc() const {
     std::ostringstream os;
-    {
-        std::lock_guard<std::recursive_mutex> lock(_jobsMutex);
-        auto first = true;
-        for (auto entry : _jobMap) {
-            JobQuery::Ptr job = entry.second;
-            if (!first) { os << "\n"; }
-            first = false;
-            os << "Ref=" << entry.first << " " << job;
-
-        }
-    }
+    auto first = true;
+    _jobs.forEach([&os, &first](int jobId, JobQuery::Ptr const& job, bool) {
+        if (!first) { os << "\n"; }
+        first = false;
+        os << "Ref=" << jobId << " " << job;
+    });
     std::string msg_progress = os.str();
     LOGS(_log, LOG_LVL_ERROR, msg_progress);
     return msg_progress;
@@ -316,70 +305,32 @@ void Executive::_setup() {
     assert(_xrdSsiService);
 }
 
-/** Add (jobId,r) entry to _requesters map if not here yet
-  *  else leave _requesters untouched.
-  *
-  *  @param jobId id of the job related to current chunk query
-  *  @param r pointer to job which will store chunk query result
-  *
-  *  @return true if (jobId,r) was added to _requesters
-  *          false if this entry was previously in the map
-  */
-bool Executive::_track(int jobId, std::shared_ptr<JobQuery> const& r) {
-    assert(r);
-    std::string idStr = QueryIdHelper::makeIdStr(_id, jobId);
-    {
-        std::lock_guard<std::mutex> lock(_incompleteJobsMutex);
-        if (_incompleteJobs.find(jobId) != _incompleteJobs.end()) {
-            LOGS(_log, LOG_LVL_WARN, "Attempt to TRACK " << idStr
-                 << " failed as jobId already found in incomplete jobs.");
-            return false;
-        }
-        _incompleteJobs[jobId] = r;
-    }
-    LOGS(_log, LOG_LVL_DEBUG, "Success TRACKING " << idStr);
-    return true;
-}
-
+/// Mark job complete. Lock-free, it is called for every job from the
+/// threads delivering results.
 void Executive::_unTrack(int jobId) {
-    bool untracked = false;
-    int size = -1;
-    std::ostringstream s;
-    {
-        std::lock_guard<std::mutex> lock(_incompleteJobsMutex);
-        auto i = _incompleteJobs.find(jobId);
-        if (i != _incompleteJobs.end()) {
-            _incompleteJobs.erase(i);
-            untracked = true;
-            if (_incompleteJobs.empty()) _allJobsComplete.notify_all();
-        }
-        size = _incompleteJobs.size();
+    bool const untracked = _jobs.complete(jobId);
+    if (untracked) {
+        LOGS(_log, LOG_LVL_DEBUG, "Executive UNTRACKING " << QueryIdHelper::makeIdStr(_id, jobId)
+             << " size=" << _jobs.getIncomplete() << " success");
+    } else {
         // Log up to 5 incomplete jobs. Very useful when jobs do not finish.
-        int c = 0;
-        for(auto j = _incompleteJobs.begin(), e = _incompleteJobs.end(); j != e && c < 5; ++j) {
-            s << j->first << " ";
-            ++c;
-        }
+        LOGS(_log, LOG_LVL_WARN, "Executive UNTRACKING " << QueryIdHelper::makeIdStr(_id, jobId)
+             << " size=" << _jobs.getIncomplete() << " failed::" << _incompleteIdsStr(5));
     }
-    LOGS(_log, (untracked ? LOG_LVL_DEBUG : LOG_LVL_WARN),
-         "Executive UNTRACKING " << QueryIdHelper::makeIdStr(_id, jobId)
-         << " size=" << size << " " << (untracked ? "success":"failed") << "::" << s.str());
 }
 
-/// Remove all jobs from the _incompleteJobs map that have errors.
+/// Mark complete all incomplete jobs that have errors.
 // This function only acts when there are errors. In there are no errors,
 // markCompleted() does the cleanup, while we are waiting (in _waitAllUntilEmpty()).
-void Executive::_reapRequesters(std::unique_lock<std::mutex> const&) {
-    for(auto iter=_incompleteJobs.begin(), e=_incompleteJobs.end(); iter != e;) {
-        if (!iter->second->getDescription().respHandler()->getError().isNone()) {
+void Executive::_reapRequesters() {
+    _jobs.forEach([this](int jobId, JobQuery::Ptr const& job, bool incomplete) {
+        if (incomplete && !job->getDescription().respHandler()->getError().isNone()
+            && _jobs.complete(jobId)) {
             // Requester should have logged the error to the messageStore
             LOGS(_log, LOG_LVL_DEBUG, "Executive reaped requester for "
-                 << QueryIdHelper::makeIdStr(_id, iter->first));
-            iter = _incompleteJobs.erase(iter);
-        } else {
-            ++iter;
+                 << QueryIdHelper::makeIdStr(_id, jobId));
         }
-    }
+    });
 }
 
 /** Store job status and execution errors in the current user query message store
@@ -390,22 +341,17 @@ void Executive::_reapRequesters(std::unique_lock<std::mutex> const&) {
  * @see python module lsst.qserv.czar.proxy.unlock()
  */
 void Executive::_updateProxyMessages() {
-    {
-        std::lock_guard<std::recursive_mutex> lock(_jobsMutex);
-        for (auto const& entry : _jobMap) {
-            JobQuery::Ptr const& job = entry.second;
-            auto const& info = job->getStatus()->getInfo();
-            std::ostringstream os;
-            os << info.state << " " << info.stateCode;
-            if (!info.stateDesc.empty()) {
-                os << " (" << info.stateDesc << ")";
-            }
-            os << " " << info.stateTime;
-            _messageStore->addMessage(job->getDescription().resource().chunk(),
-                    info.state, os.str());
-
+    _jobs.forEach([this](int, JobQuery::Ptr const& job, bool) {
+        auto const& info = job->getStatus()->getInfo();
+        std::ostringstream os;
+        os << info.state << " " << info.stateCode;
+        if (!info.stateDesc.empty()) {
+            os << " (" << info.stateDesc << ")";
         }
-    }
+        os << " " << info.stateTime;
+        _messageStore->addMessage(job->getDescription().resource().chunk(),
+                info.state, os.str());
+    });
     {
         std::lock_guard<std::mutex> lock(_errorsMutex);
         if (not _multiError.empty()) {
@@ -418,15 +364,13 @@ void Executive::_updateProxyMessages() {
 /// Typically the requesters are handled by markCompleted().
 /// _reapRequesters() deals with cases that involve errors.
 void Executive::_waitAllUntilEmpty() {
-    std::unique_lock<std::mutex> lock(_incompleteJobsMutex);
     int lastCount = -1;
     int count;
     int moreDetailThreshold = 5;
     int complainCount = 0;
     const std::chrono::seconds statePrintDelay(5);
-    while(!_incompleteJobs.empty()) {
-        count = _incompleteJobs.size();
-        _reapRequesters(lock);
+    while((count = _jobs.getIncomplete()) > 0) {
+        _reapRequesters();
         if (count != lastCount) {
             lastCount = count;
             ++complainCount;
@@ -436,38 +380,38 @@ void Executive::_waitAllUntilEmpty() {
                     _printState(os);
                     os << "\n";
                 }
-                os << _idStr << " Still " << count << " in flight.";
+                os << _idStr << " Still " << count << " in flight: " << _incompleteIdsStr(5);
                 complainCount = 0;
-                lock.unlock(); // release the lock while we trigger logging.
                 LOGS(_log, LOG_LVL_DEBUG, os.str());
-                lock.lock();
             }
         }
-        _allJobsComplete.wait_for(lock, statePrintDelay);
+        _jobs.waitIncomplete(0, statePrintDelay);
     }
 }
 
-std::ostream& operator<<(std::ostream& os, Executive::JobMap::value_type const& v) {
-    JobStatus::Ptr status = v.second->getStatus();
-    os << v.first << ": " << *status;
-    return os;
+void Executive::_printState(std::ostream& os) const {
+    _jobs.forEach([&os](int, JobQuery::Ptr const& job, bool incomplete) {
+        if (incomplete) {
+            os << *job << "\n";
+        }
+    });
 }
 
-/// precondition: _requestersMutex is held by current thread.
-void Executive::_printState(std::ostream& os) {
-    for (auto const& entry : _incompleteJobs) {
-        JobQuery::Ptr job = entry.second;
-        os << *job << "\n";
-    }
+/// @return ids of up to maxIds incomplete jobs, built only when logged
+std::string Executive::_incompleteIdsStr(int maxIds) const {
+    std::ostringstream os;
+    int c = 0;
+    _jobs.forEach([&os, &c, maxIds](int jobId, JobQuery::Ptr const&, bool incomplete) {
+        if (incomplete && c < maxIds) {
+            os << jobId << " ";
+            ++c;
+        }
+    });
+    return os.str();
 }
 
 JobQuery::Ptr Executive::getJobQuery(int jobId) {
-    qdisp::JobQuery::Ptr job;
-    auto i = _jobMap.find(jobId);
-    if (i != _jobMap.end()) {
-        job = i->second;
-    }
-    return job;
+    return _jobs.get(jobId);
 }
 
 }}} // namespace lsst::qserv::qdisp
@@ -38,6 +38,7 @@
 #include "global/stringTypes.h"
 #include "qdisp/JobDescription.h"
 #include "qdisp/JobStatus.h"
+#include "qdisp/JobTable.h"
 #include "qdisp/ResponseHandler.h"
 #include "util/InstanceCount.h"
 #include "util/MultiError.h"
@@ -60,7 +61,6 @@ class QueryResource;
 class Executive : public std::enable_shared_from_this<Executive> {
 public:
     typedef std::shared_ptr<Executive> Ptr;
-    typedef std::map<int, std::shared_ptr<JobQuery>> JobMap;
 
     struct Config {
         typedef std::shared_ptr<Config> Ptr;
@@ -92,6 +92,17 @@ public:
     /// Squash all the jobs.
     void squash();
 
+    /// Squash the jobs because the rows already received satisfy the query.
+    /// Jobs added later are refused and jobs in progress are cancelled as
+    /// with squash(), but the query does not fail because of them.
+    void squashLimitReached();
+
+    /// @return true if squashLimitReached() was called.
+    bool getLimitReached() const { return _limitReached; }
+
+    /// Block until at most 'count' jobs are in flight.
+    void waitInflight(int count);
+
     bool getEmpty() { return _empty; }
 
     void setQueryId(QueryId id);
@@ -101,7 +112,7 @@ public:
     std::shared_ptr<JobQuery> getJobQuery(int id);
 
     /// @return number of items in flight.
-    int getNumInflight(); // non-const, requires a mutex.
+    int getNumInflight() const { return _jobs.getIncomplete(); }
 
     /// @return a description of the current execution progress.
     std::string getProgressDesc() const;
@@ -119,41 +130,34 @@ private:
 
     void _setup();
 
-    bool _track(int refNum, std::shared_ptr<JobQuery> const& r);
     void _unTrack(int refNum);
-    bool _addJobToMap(std::shared_ptr<JobQuery> const& job);
 
-    void _reapRequesters(std::unique_lock<std::mutex> const& requestersLock);
+    void _reapRequesters();
 
     void _updateProxyMessages();
 
     void _waitAllUntilEmpty();
 
     // for debugging
-    void _printState(std::ostream& os);
+    void _printState(std::ostream& os) const;
+    std::string _incompleteIdsStr(int maxIds) const;
 
     Config _config; ///< Personal copy of config
     std::atomic<bool> _empty {true};
     std::shared_ptr<MessageStore> _messageStore; ///< MessageStore for logging
     XrdSsiService* _xrdSsiService; ///< RPC interface
-    JobMap _jobMap; ///< Contains information about all jobs.
-    JobMap _incompleteJobs; ///< Map of incomplete jobs.
+    JobTable _jobs; ///< All jobs, and which of them are incomplete.
 
     /** Execution errors */
     util::MultiError _multiError;
 
     int _requestCount; ///< Count of submitted jobs
     util::Flag<bool> _cancelled {false}; ///< Has execution been cancelled.
-
-    // Mutexes
-    std::mutex _incompleteJobsMutex; ///< protect incompleteJobs map.
+    std::atomic<bool> _limitReached {false}; ///< Cancelled because enough rows arrived.
 
     /** Used to record execution errors */
     mutable std::mutex _errorsMutex;
 
-    std::condition_variable _allJobsComplete;
-    mutable std::recursive_mutex _jobsMutex;
-
     QueryId _id{0}; ///< Unique identifier for this query.
     std::string    _idStr{QueryIdHelper::makeIdStr(0, true)};
     util::InstanceCount _instC{"Executive"};
@@ -0,0 +1,121 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "qdisp/JobTable.h"
+
+namespace lsst {
+namespace qserv {
+namespace qdisp {
+
+JobTable::JobTable() {
+    for (auto& segment : _segments) {
+        segment.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+JobTable::~JobTable() {
+    for (auto& segment : _segments) {
+        delete segment.load(std::memory_order_relaxed);
+    }
+}
+
+bool JobTable::add(int jobId, std::shared_ptr<JobQuery> const& job) {
+    if (jobId < 0 || jobId >= maxJobs) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_addMutex);
+    auto& segmentPtr = _segments[jobId >> _segmentBits];
+    Segment* segment = segmentPtr.load(std::memory_order_relaxed);
+    if (segment == nullptr) {
+        segment = new Segment();
+        segmentPtr.store(segment, std::memory_order_release);
+    }
+    Slot& slot = segment->slots[jobId & (_segmentSize - 1)];
+    if (slot.state.load(std::memory_order_relaxed) != EMPTY) {
+        return false;
+    }
+    slot.job = job;
+    // Count first, so that a completion never sees it drop below zero.
+    ++_incomplete;
+    slot.state.store(INCOMPLETE, std::memory_order_release);
+    if (jobId >= _end.load(std::memory_order_relaxed)) {
+        _end.store(jobId + 1, std::memory_order_release);
+    }
+    return true;
+}
+
+JobTable::Slot const* JobTable::_slot(int jobId) const {
+    if (jobId < 0 || jobId >= _end.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    Segment const* segment = _segments[jobId >> _segmentBits].load(std::memory_order_acquire);
+    if (segment == nullptr) {
+        return nullptr;
+    }
+    Slot const& slot = segment->slots[jobId & (_segmentSize - 1)];
+    return slot.state.load(std::memory_order_acquire) == EMPTY ? nullptr : &slot;
+}
+
+std::shared_ptr<JobQuery> JobTable::get(int jobId) const {
+    Slot const* slot = _slot(jobId);
+    return slot == nullptr ? nullptr : slot->job;
+}
+
+bool JobTable::isIncomplete(int jobId) const {
+    Slot const* slot = _slot(jobId);
+    return slot != nullptr && slot->state.load(std::memory_order_acquire) == INCOMPLETE;
+}
+
+bool JobTable::complete(int jobId) {
+    Slot* slot = const_cast<Slot*>(_slot(jobId));
+    if (slot == nullptr) {
+        return false;
+    }
+    int expected = INCOMPLETE;
+    if (!slot->state.compare_exchange_strong(expected, COMPLETE)) {
+        return false;
+    }
+    int const left = --_incomplete;
+    if (left <= _notifyAt.load()) {
+        std::lock_guard<std::mutex> lock(_waitMutex);
+        _waitCV.notify_all();
+    }
+    return true;
+}
+
+bool JobTable::waitIncomplete(int count, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(_waitMutex);
+    ++_waiters;
+    int notifyAt = _notifyAt.load();
+    while (notifyAt < count && !_notifyAt.compare_exchange_weak(notifyAt, count)) {}
+    bool const reached = _waitCV.wait_for(lock, timeout, [this, count]() {
+        return _incomplete.load() <= count;
+    });
+    if (--_waiters == 0) {
+        _notifyAt = -1;
+    }
+    return reached;
+}
+
+}}} // namespace lsst::qserv::qdisp
@@ -0,0 +1,131 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef LSST_QSERV_QDISP_JOBTABLE_H
+#define LSST_QSERV_QDISP_JOBTABLE_H
+
+// System headers
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace lsst {
+namespace qserv {
+namespace qdisp {
+
+class JobQuery;
+
+/// JobTable keeps the jobs of an Executive in an array indexed by job id,
+/// with an atomic completion state per job and an atomic count of incomplete
+/// jobs. Job ids are expected to be dense, as the ones UserQuerySelect
+/// assigns. The array is allocated in segments as ids grow, so sparse ids
+/// only cost the segments they touch.
+///
+/// get(), complete() and getIncomplete() are lock-free, so job completions
+/// arriving from many threads do not contend. A completion only takes a
+/// mutex to wake a thread in waitIncomplete() whose target it reached.
+class JobTable {
+public:
+    /// Largest job id plus one
+    static int const maxJobs = (1 << 22);
+
+    JobTable();
+    ~JobTable();
+
+    JobTable(JobTable const&) = delete;
+    JobTable& operator=(JobTable const&) = delete;
+
+    /// Add an incomplete job.
+    /// @return false if jobId is out of range or already used.
+    bool add(int jobId, std::shared_ptr<JobQuery> const& job);
+
+    /// @return the job with given id, nullptr if there is none.
+    std::shared_ptr<JobQuery> get(int jobId) const;
+
+    /// @return true if job was added and is not complete yet.
+    bool isIncomplete(int jobId) const;
+
+    /// Mark job complete.
+    /// @return true if job was incomplete, false if it was unknown or
+    ///         already complete.
+    bool complete(int jobId);
+
+    /// @return number of incomplete jobs.
+    int getIncomplete() const { return _incomplete; }
+
+    /// Wait until at most 'count' jobs are incomplete, or timeout expires.
+    /// @return true if at most 'count' jobs are incomplete.
+    bool waitIncomplete(int count, std::chrono::milliseconds timeout);
+
+    /// Call func(jobId, job, incomplete) for each job in id order.
+    /// Jobs added concurrently may or may not be visited.
+    template <typename Func>
+    void forEach(Func func) const {
+        int const end = _end.load(std::memory_order_acquire);
+        for (int seg = 0; seg <= (end - 1) >> _segmentBits; ++seg) {
+            Segment const* segment = _segments[seg].load(std::memory_order_acquire);
+            if (segment == nullptr) continue;
+            for (int i = 0; i < _segmentSize; ++i) {
+                Slot const& slot = segment->slots[i];
+                int const state = slot.state.load(std::memory_order_acquire);
+                if (state != EMPTY) {
+                    func((seg << _segmentBits) + i, slot.job, state == INCOMPLETE);
+                }
+            }
+        }
+    }
+
+private:
+    enum State { EMPTY = 0, INCOMPLETE, COMPLETE };
+
+    static int const _segmentBits = 10;
+    static int const _segmentSize = (1 << _segmentBits);
+
+    struct Slot {
+        std::shared_ptr<JobQuery> job; ///< Written once, before state leaves EMPTY
+        std::atomic<int> state{EMPTY};
+    };
+    struct Segment {
+        Slot slots[_segmentSize];
+    };
+
+    Slot const* _slot(int jobId) const;
+
+    std::array<std::atomic<Segment*>, (maxJobs >> _segmentBits)> _segments;
+    std::atomic<int> _end{0};        ///< Largest added job id plus one
+    std::atomic<int> _incomplete{0}; ///< Number of incomplete jobs
+    std::mutex _addMutex;            ///< Serializes add()
+
+    // Threads in waitIncomplete() register the largest count they wait for,
+    // completions notify only when the count drops to it.
+    std::atomic<int> _waiters{0};
+    std::atomic<int> _notifyAt{-1};
+    std::mutex _waitMutex;
+    std::condition_variable _waitCV;
+};
+
+}}} // namespace lsst::qserv::qdisp
+
+#endif // LSST_QSERV_QDISP_JOBTABLE_H
@@ -41,6 +41,7 @@
 #include "global/MsgReceiver.h"
 #include "qdisp/Executive.h"
 #include "qdisp/JobQuery.h"
+#include "qdisp/JobTable.h"
 #include "qdisp/MessageStore.h"
 #include "qdisp/XrdSsiMocks.h"
 #include "util/threadSafe.h"
@@ -462,6 +463,77 @@ BOOST_AUTO_TEST_CASE(ExecutiveCancel) {
 
 }
 
+BOOST_AUTO_TEST_CASE(ExecutiveLimitReached) {
+    // Test that jobs cancelled once enough rows arrived do not fail the query.
+    LOGS_DEBUG("Check that executive squashLimitReached succeeds");
+    util::Flag<bool> done(false);
+    std::thread timeoutT(&timeoutFunc, std::ref(done), 5000);
+    std::string str = qdisp::Executive::Config::getMockStr();
+    qdisp::Executive::Config::Ptr conf = std::make_shared<qdisp::Executive::Config>(str);
+    std::shared_ptr<qdisp::MessageStore> ms = std::make_shared<qdisp::MessageStore>();
+    qdisp::Executive::Ptr ex = qdisp::Executive::newExecutive(conf, ms);
+    ResourceUnit ru;
+    std::shared_ptr<ResponseHandlerTest> respReq = std::make_shared<ResponseHandlerTest>();
+    qdisp::XrdSsiServiceMock::_go.exchangeNotify(false);
+    for (int jobId=1; jobId<=5; ++jobId) {
+        qdisp::JobDescription jobDesc(jobId, ru, "a message", respReq);
+        ex->add(jobDesc);
+    }
+    ex->squashLimitReached();
+    BOOST_CHECK(ex->getCancelled());
+    BOOST_CHECK(ex->getLimitReached());
+    // Jobs added after the limit was reached are refused.
+    qdisp::JobDescription lateDesc(6, ru, "a message", respReq);
+    ex->add(lateDesc);
+    BOOST_CHECK(ex->getJobQuery(6) == nullptr);
+    qdisp::XrdSsiServiceMock::_go.exchangeNotify(true);
+    BOOST_CHECK(ex->join());
+    done.exchange(true);
+    timeoutT.join();
+}
+
+BOOST_AUTO_TEST_CASE(JobTableTracking) {
+    // Test job tracking used by Executive, jobs need not exist for it.
+    LOGS_DEBUG("Check JobTable");
+    qdisp::JobTable table;
+    int const nJobs = 3000; // spans several segments
+    for (int jobId=0; jobId < nJobs; ++jobId) {
+        BOOST_CHECK(table.add(jobId, nullptr));
+    }
+    BOOST_CHECK(!table.add(17, nullptr));
+    BOOST_CHECK(!table.add(-1, nullptr));
+    BOOST_CHECK(!table.add(qdisp::JobTable::maxJobs, nullptr));
+    BOOST_CHECK_EQUAL(table.getIncomplete(), nJobs);
+    BOOST_CHECK(!table.complete(nJobs));
+    BOOST_CHECK(!table.waitIncomplete(0, std::chrono::milliseconds(1)));
+
+    // Complete jobs from several threads while waiting for them.
+    int const nThreads = 4;
+    std::vector<std::thread> threads;
+    for (int t=0; t < nThreads; ++t) {
+        threads.emplace_back([&table, t]() {
+            for (int jobId=t; jobId < nJobs; jobId += nThreads) {
+                table.complete(jobId);
+            }
+        });
+    }
+    BOOST_CHECK(table.waitIncomplete(0, std::chrono::seconds(10)));
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    BOOST_CHECK_EQUAL(table.getIncomplete(), 0);
+    BOOST_CHECK(!table.complete(5));
+    BOOST_CHECK(!table.isIncomplete(5));
+
+    int count = 0;
+    table.forEach([&count](int jobId, qdisp::JobQuery::Ptr const&, bool incomplete) {
+        BOOST_CHECK_EQUAL(jobId, count);
+        BOOST_CHECK(!incomplete);
+        ++count;
+    });
+    BOOST_CHECK_EQUAL(count, nJobs);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
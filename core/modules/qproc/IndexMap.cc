@@ -35,8 +35,13 @@
 #include <algorithm>
 #include <cassert>
 #include <iterator>
+#include <list>
+#include <map>
+#include <mutex>
 #include <stdexcept>
 #include <set>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 // Third-party headers
@@ -133,6 +138,31 @@ std::shared_ptr<Region> getRegion(lsst::qserv::query::Constraint const& c) {
     return covered_region;
 }
 
+/*  Make a key identifying spatial constraints in a constraint vector
+ *
+ *  @param cv:  Constraints issued from SQL query
+ *  @return:    String built from names and parameters of all spatial
+ *              constraints, empty if there are none
+ */
+std::string makeRegionKey(lsst::qserv::query::ConstraintVector const& cv) {
+    std::string key;
+    for (auto const& c: cv) {
+        if (funcMap.fMap.count(c.name) == 0) continue;
+        key += c.name;
+        char sep = '(';
+        for (auto const& param: c.params) {
+            key += sep;
+            key += param;
+            sep = ',';
+        }
+        key += ");";
+    }
+    return key;
+}
+
+// Max number of region coverages memoized for each partitioning map
+size_t const regionCacheSize = 256;
+
 lsst::qserv::qproc::ChunkSpec convertSgSubChunks(SubChunks const& sc) {
     lsst::qserv::qproc::ChunkSpec cs;
     cs.chunkId = sc.chunkId;
@@ -159,23 +189,52 @@ public:
         NoRegion() : std::invalid_argument("No region specified")
             {}
     };
+    typedef std::shared_ptr<SubChunksVector const> SubChunksVectorPtr;
+    typedef std::shared_ptr<ChunkSpecVector const> ChunkSpecVectorPtr;
+
     explicit PartitioningMap(css::StripingParams const& sp) {
         _chunker = std::make_shared<lsst::sphgeom::Chunker>(sp.stripes,
                                                             sp.subStripes);
 
     }
+
+    /// @return the map shared by all users of the same striping parameters
+    static std::shared_ptr<PartitioningMap> get(css::StripingParams const& sp) {
+        static std::mutex mutex;
+        static std::map<std::pair<int, int>, std::shared_ptr<PartitioningMap>> maps;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& pm = maps[std::make_pair(sp.stripes, sp.subStripes)];
+        if (!pm) {
+            LOGS(_log, LOG_LVL_DEBUG, "New partitioning map, stripes=" << sp.stripes
+                 << " subStripes=" << sp.subStripes);
+            pm = std::make_shared<PartitioningMap>(sp);
+        }
+        return pm;
+    }
+
     /// @return un-canonicalized vector<SubChunks> of concatenated region
     /// results. Regions are assumed to be joined by implicit "OR" and not "AND"
+    /// Results are memoized by regionKey, which must identify regions in rv.
     /// Throws NoRegion if no region is passed.
-    SubChunksVector getIntersect(RegionPtrVector const& rv) {
-        SubChunksVector scv;
+    SubChunksVectorPtr getIntersect(RegionPtrVector const& rv, std::string const& regionKey) {
+        {
+            std::lock_guard<std::mutex> lock(_regionMutex);
+            auto iter = _regionIndex.find(regionKey);
+            if (iter != _regionIndex.end()) {
+                // move to the front of LRU list
+                _regionLru.splice(_regionLru.begin(), _regionLru, iter->second);
+                return iter->second->second;
+            }
+        }
+
+        auto scv = std::make_shared<SubChunksVector>();
         bool hasRegion = false;
         for(RegionPtrVector::const_iterator i=rv.begin(), e=rv.end();
             i != e;
             ++i) {
             if (*i) {
                 SubChunksVector area = getCoverage(**i);
-                scv.insert(scv.end(), area.begin(), area.end());
+                scv->insert(scv->end(), area.begin(), area.end());
                 hasRegion = true;
             } else {
                 // Ignore null-regions
@@ -185,24 +244,82 @@ public:
         if (!hasRegion) {
             throw NoRegion();
         }
+
+        std::lock_guard<std::mutex> lock(_regionMutex);
+        if (_regionIndex.count(regionKey) == 0) {
+            _regionLru.emplace_front(regionKey, scv);
+            _regionIndex[regionKey] = _regionLru.begin();
+            if (_regionLru.size() > regionCacheSize) {
+                _regionIndex.erase(_regionLru.back().first);
+                _regionLru.pop_back();
+            }
+        }
         return scv;
     }
 
     inline SubChunksVector getCoverage(Region const& r) {
         return _chunker->getSubChunksIntersecting(r);
     }
-    ChunkSpecVector getAllChunks() const {
-        Int32Vector allChunks = _chunker->getAllChunks();
-        ChunkSpecVector csv;
-        csv.reserve(allChunks.size());
-        for(IntVector::const_iterator i=allChunks.begin(), e=allChunks.end();
-            i != e; ++i) {
-            csv.push_back(ChunkSpec(*i, _chunker->getAllSubChunks(*i)));
+
+    /// @return all chunks of the partitioning scheme, computed once
+    ChunkSpecVectorPtr getAllChunks() {
+        std::lock_guard<std::mutex> lock(_allMutex);
+        if (!_allChunks) {
+            Int32Vector allChunks = _chunker->getAllChunks();
+            auto csv = std::make_shared<ChunkSpecVector>();
+            csv->reserve(allChunks.size());
+            for(IntVector::const_iterator i=allChunks.begin(), e=allChunks.end();
+                i != e; ++i) {
+                csv->push_back(ChunkSpec(*i, _chunker->getAllSubChunks(*i)));
+            }
+            _allChunks = csv;
         }
+        return _allChunks;
+    }
+
+    /// @return all chunks of the partitioning scheme not present in emptyChunks,
+    /// computed once per empty chunk set
+    ChunkSpecVectorPtr getNonEmptyChunks(std::shared_ptr<IntSet const> const& emptyChunks) {
+        ChunkSpecVectorPtr all = getAllChunks();
+        if (!emptyChunks || emptyChunks->empty()) {
+            return all;
+        }
+
+        std::lock_guard<std::mutex> lock(_allMutex);
+        // Empty chunk sets are cached by css::EmptyChunks, so pointer
+        // identity is a sufficient key, weak pointer guards against reuse.
+        for (auto iter = _nonEmpty.begin(); iter != _nonEmpty.end(); ) {
+            auto set = iter->first.lock();
+            if (set == emptyChunks) {
+                return iter->second;
+            } else if (!set) {
+                iter = _nonEmpty.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+        auto csv = std::make_shared<ChunkSpecVector>();
+        csv->reserve(all->size());
+        for (auto const& cs: *all) {
+            if (emptyChunks->count(cs.chunkId) == 0) {
+                csv->push_back(cs);
+            }
+        }
+        _nonEmpty.emplace_back(emptyChunks, csv);
         return csv;
     }
 private:
+    typedef std::list<std::pair<std::string, SubChunksVectorPtr>> RegionLru;
+
     std::shared_ptr<lsst::sphgeom::Chunker> _chunker;
+
+    std::mutex _allMutex;           ///< protects _allChunks and _nonEmpty
+    ChunkSpecVectorPtr _allChunks;  ///< full-sky chunks, null until needed
+    std::vector<std::pair<std::weak_ptr<IntSet const>, ChunkSpecVectorPtr>> _nonEmpty;
+
+    std::mutex _regionMutex;        ///< protects _regionLru and _regionIndex
+    RegionLru _regionLru;           ///< recent region coverage, most recent first
+    std::unordered_map<std::string, RegionLru::iterator> _regionIndex;
 };
 
 ////////////////////////////////////////////////////////////////////////
@@ -210,13 +327,19 @@ private:
 ////////////////////////////////////////////////////////////////////////
 IndexMap::IndexMap(css::StripingParams const& sp,
                    std::shared_ptr<SecondaryIndex> si)
-    : _pm(std::make_shared<PartitioningMap>(sp)),
+    : _pm(PartitioningMap::get(sp)),
       _si(si) {
 }
 
 // Compute the chunks list for the whole partitioning scheme
 ChunkSpecVector IndexMap::getAllChunks() {
-    return _pm->getAllChunks();
+    return *_pm->getAllChunks();
+}
+
+// Return the chunks list for the whole partitioning scheme without empty chunks
+std::shared_ptr<ChunkSpecVector const>
+IndexMap::getNonEmptyChunks(std::shared_ptr<IntSet const> const& emptyChunks) {
+    return _pm->getNonEmptyChunks(emptyChunks);
 }
 
 //  Compute chunks coverage of spatial and secondary index constraints
@@ -240,9 +363,9 @@ ChunkSpecVector IndexMap::getChunks(query::ConstraintVector const& cv) {
     // Spatial area lookups
     RegionPtrVector rv;
     std::transform(cv.begin(), cv.end(), std::back_inserter(rv), getRegion);
-    SubChunksVector scv;
+    PartitioningMap::SubChunksVectorPtr scv = std::make_shared<SubChunksVector>();
     try {
-        scv = _pm->getIntersect(rv);
+        scv = _pm->getIntersect(rv, makeRegionKey(cv));
     } catch(PartitioningMap::NoRegion& e) {
         hasRegion = false;
     } catch(std::invalid_argument& a) {
@@ -251,7 +374,7 @@ ChunkSpecVector IndexMap::getChunks(query::ConstraintVector const& cv) {
         throw QueryProcessingError(e.what());
     }
     ChunkSpecVector regionSpecs;
-    std::transform(scv.begin(), scv.end(),
+    std::transform(scv->begin(), scv->end(),
                    std::back_inserter(regionSpecs), convertSgSubChunks);
 
     // FIXME: Index and spatial lookup are supported in AND format only right now.
@@ -30,8 +30,12 @@
   * @author Daniel L. Wang, SLAC
   */
 
+// System headers
+#include <memory>
+
 // Qserv headers
 #include "css/StripingParams.h"
+#include "global/intTypes.h"
 #include "query/Constraint.h"
 #include "qproc/ChunkSpec.h"
 
@@ -41,6 +45,9 @@ namespace qproc {
 
 class SecondaryIndex;
 
+/// IndexMap instances are cheap, partitioning maps (sphgeom::Chunker plus
+/// precomputed full-sky chunk lists and recent region coverage) are shared
+/// by all instances with the same striping parameters.
 class IndexMap {
 public:
     IndexMap(css::StripingParams const& sp,
@@ -53,6 +60,17 @@ public:
      */
     ChunkSpecVector getAllChunks();
 
+    /** Return the chunks list for the whole partitioning scheme without empty chunks
+     *
+     *  The list is computed once per striping and empty chunk set, and shared
+     *  by all queries, callers must not expect a private copy.
+     *
+     *  @param emptyChunks: set of empty chunks to exclude, may be null
+     *  @returns non-empty chunks of the partitioning scheme
+     */
+    std::shared_ptr<ChunkSpecVector const> getNonEmptyChunks(
+        std::shared_ptr<IntSet const> const& emptyChunks);
+
     /**  Compute chunks coverage of spatial and secondary index constraints
      *
      *   Index constraints are combined with OR, and spatial constraints are
@@ -143,6 +143,10 @@ bool QuerySession::hasChunks() const {
     return _context->hasChunks();
 }
 
+int QuerySession::getRowLimit() const {
+    return _context->rowLimit;
+}
+
 std::shared_ptr<query::ConstraintVector> QuerySession::getConstraints() const {
     std::shared_ptr<query::ConstraintVector> cv;
     std::shared_ptr<query::QsRestrictor::PtrVector const> p = _context->restrictors;
@@ -341,6 +345,7 @@ void QuerySession::print(std::ostream& os) const {
     os << "  has chunks: " << this->hasChunks() << "\n";
     os << "  chunks: " << util::printable(this->_chunks) << "\n";
     os << "  needs merge: " << this->needsMerge() << "\n";
+    os << "  row limit: " << this->getRowLimit() << "\n";
     os << "  1st parallel statement: " << par << "\n";
     os << "  merge statement: " << mer << "\n";
     os << "  scanRating:" << _context->scanInfo.scanRating;
@@ -362,89 +367,58 @@ std::vector<std::string> QuerySession::_buildChunkQueries(ChunkSpec const& s) co
     }
     qana::QueryMapping const& queryMapping = *_context->queryMapping;
 
-    typedef std::vector<query::QueryTemplate> QueryTplVector;
-    typedef QueryTplVector::const_iterator QueryTplVectorIter;
-    QueryTplVector queryTemplates;
-
-    typedef query::SelectStmtPtrVector::const_iterator Iter;
-    for(Iter i=_stmtParallel.begin(), e=_stmtParallel.end();
-        i != e; ++i) {
-        queryTemplates.push_back((**i).getQueryTemplate());
-    }
+    std::vector<query::QueryTemplate::Compiled> const& queryTemplates = _getChunkTemplates();
     if (!queryMapping.hasSubChunks()) { // Non-subchunked?
         LOGS(_log, LOG_LVL_DEBUG, "Non-subchunked");
 
-        for(QueryTplVectorIter i=queryTemplates.begin(), e=queryTemplates.end(); i != e; ++i) {
-            q.push_back(_context->queryMapping->apply(s, *i));
+        for(auto const& tpl : queryTemplates) {
+            q.push_back(queryMapping.apply(s, tpl));
         }
     } else { // subchunked:
         ChunkSpecSingle::Vector sVector = ChunkSpecSingle::makeVector(s);
-        typedef ChunkSpecSingle::Vector::const_iterator ChunkIter;
-        for(ChunkIter i=sVector.begin(), e=sVector.end(); i != e; ++i) {
-            for(QueryTplVectorIter j=queryTemplates.begin(), je=queryTemplates.end(); j != je; ++j) {
-                LOGS(_log, LOG_LVL_DEBUG, "adding query " << _context->queryMapping->apply(*i, *j));
-                q.push_back(_context->queryMapping->apply(*i, *j));
+        q.reserve(sVector.size() * queryTemplates.size());
+        for(auto const& single : sVector) {
+            for(auto const& tpl : queryTemplates) {
+                q.push_back(queryMapping.apply(single, tpl));
+                LOGS(_log, LOG_LVL_TRACE, "adding query " << q.back());
             }
         }
     }
     return q;
 }
 
-std::ostream& operator<<(std::ostream& out, QuerySession const& querySession) {
-    querySession.print(out);
-    return out;
-}
-
-////////////////////////////////////////////////////////////////////////
-// QuerySession::Iter
-////////////////////////////////////////////////////////////////////////
-QuerySession::Iter::Iter(QuerySession& qs, ChunkSpecVector::iterator i)
-    : _qs(&qs), _chunkSpecsIter(i), _dirty(true) {
-    if (!qs._context) {
-        throw QueryProcessingBug("NULL QuerySession");
-    }
-    _hasChunks = qs._context->hasChunks();
-    _hasSubChunks = qs._context->hasSubChunks();
-}
-
-ChunkQuerySpec& QuerySession::Iter::dereference() const {
-    if (_dirty) { _updateCache(); }
-    return _cache;
-}
-
-void QuerySession::Iter::_buildCache() const {
-    assert(_qs != nullptr);
-    _cache.db = _qs->_context->dominantDb;
-    _cache.scanInfo = _qs->_context->scanInfo;
-    _cache.chunkId = _chunkSpecsIter->chunkId;
-    _cache.nextFragment.reset();
-    // Reset subChunkTables
-    _cache.subChunkTables.clear();
-    qana::QueryMapping const& queryMapping = *(_qs->_context->queryMapping);
+std::shared_ptr<ChunkQuerySpec>
+QuerySession::buildChunkQuerySpec(ChunkSpec const& chunkSpec) const {
+    auto spec = std::make_shared<ChunkQuerySpec>();
+    spec->db = _context->dominantDb;
+    spec->scanInfo = _context->scanInfo;
+    spec->chunkId = chunkSpec.chunkId;
+    qana::QueryMapping const& queryMapping = *(_context->queryMapping);
     qana::QueryMapping::StringSet const& sTables = queryMapping.getSubChunkTables();
-    _cache.subChunkTables.insert(_cache.subChunkTables.begin(),
-                                 sTables.begin(), sTables.end());
+    spec->subChunkTables.insert(spec->subChunkTables.begin(),
+                                sTables.begin(), sTables.end());
     // Build queries.
-    if (!_hasSubChunks) {
-        _cache.queries = _qs->_buildChunkQueries(*_chunkSpecsIter);
+    if (!_context->hasSubChunks()) {
+        spec->queries = _buildChunkQueries(chunkSpec);
     } else {
-        if (_chunkSpecsIter->shouldSplit()) {
-            ChunkSpecFragmenter frag(*_chunkSpecsIter);
+        if (chunkSpec.shouldSplit()) {
+            ChunkSpecFragmenter frag(chunkSpec);
             ChunkSpec s = frag.get();
-            _cache.queries = _qs->_buildChunkQueries(s);
-            _cache.subChunkIds.assign(s.subChunks.begin(), s.subChunks.end());
+            spec->queries = _buildChunkQueries(s);
+            spec->subChunkIds.assign(s.subChunks.begin(), s.subChunks.end());
             frag.next();
-            _cache.nextFragment = _buildFragment(frag);
+            spec->nextFragment = _buildFragment(frag);
         } else {
-            _cache.queries = _qs->_buildChunkQueries(*_chunkSpecsIter);
-            _cache.subChunkIds.assign(_chunkSpecsIter->subChunks.begin(),
-                                      _chunkSpecsIter->subChunks.end());
+            spec->queries = _buildChunkQueries(chunkSpec);
+            spec->subChunkIds.assign(chunkSpec.subChunks.begin(),
+                                     chunkSpec.subChunks.end());
         }
     }
+    return spec;
 }
 
 std::shared_ptr<ChunkQuerySpec>
-QuerySession::Iter::_buildFragment(ChunkSpecFragmenter& f) const {
+QuerySession::_buildFragment(ChunkSpecFragmenter& f) const {
     std::shared_ptr<ChunkQuerySpec> first;
     std::shared_ptr<ChunkQuerySpec> last;
     while(!f.isDone()) {
@@ -457,10 +431,49 @@ QuerySession::Iter::_buildFragment(ChunkSpecFragmenter& f) const {
         }
         ChunkSpec s = f.get();
         last->subChunkIds.assign(s.subChunks.begin(), s.subChunks.end());
-        last->queries = _qs->_buildChunkQueries(s);
+        last->queries = _buildChunkQueries(s);
         f.next();
     }
     return first;
 }
 
+std::vector<query::QueryTemplate::Compiled> const& QuerySession::_getChunkTemplates() const {
+    // Parallel statements and the mapping do not change once chunk queries
+    // are built, so templates are compiled once for all chunks.
+    std::call_once(_chunkTemplatesFlag, [this]() {
+        qana::QueryMapping const& queryMapping = *_context->queryMapping;
+        for(auto const& stmt : _stmtParallel) {
+            _chunkTemplates.push_back(queryMapping.compile(stmt->getQueryTemplate()));
+        }
+    });
+    return _chunkTemplates;
+}
+
+std::ostream& operator<<(std::ostream& out, QuerySession const& querySession) {
+    querySession.print(out);
+    return out;
+}
+
+////////////////////////////////////////////////////////////////////////
+// QuerySession::Iter
+////////////////////////////////////////////////////////////////////////
+QuerySession::Iter::Iter(QuerySession& qs, ChunkSpecVector::iterator i)
+    : _qs(&qs), _chunkSpecsIter(i), _dirty(true) {
+    if (!qs._context) {
+        throw QueryProcessingBug("NULL QuerySession");
+    }
+    _hasChunks = qs._context->hasChunks();
+    _hasSubChunks = qs._context->hasSubChunks();
+}
+
+ChunkQuerySpec& QuerySession::Iter::dereference() const {
+    if (_dirty) { _updateCache(); }
+    return _cache;
+}
+
+void QuerySession::Iter::_buildCache() const {
+    assert(_qs != nullptr);
+    _cache = *_qs->buildChunkQuerySpec(*_chunkSpecsIter);
+}
+
 }}} // namespace lsst::qserv::qproc
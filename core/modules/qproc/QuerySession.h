@@ -33,6 +33,7 @@
 // System headers
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -46,6 +47,7 @@
 #include "qproc/ChunkQuerySpec.h"
 #include "qproc/ChunkSpec.h"
 #include "query/Constraint.h"
+#include "query/QueryTemplate.h"
 #include "query/typedefs.h"
 
 
@@ -91,6 +93,9 @@ public:
     void analyzeQuery(std::string const& sql);
     bool needsMerge() const;
     bool hasChunks() const;
+    /// @return the number of merged rows, from any chunks, after which
+    ///         remaining chunks need not run, NOTSET if all chunks are needed.
+    int getRowLimit() const;
 
     std::shared_ptr<query::ConstraintVector> getConstraints() const;
     void addChunk(ChunkSpec const& cs);
@@ -129,6 +134,13 @@ public:
     Iter cQueryBegin();
     Iter cQueryEnd();
 
+    /// @return chunks added so far, in dispatch order
+    ChunkSpecVector const& getChunks() const { return _chunks; }
+
+    /// Build the queries and sub-chunk lists of one chunk, as the iterator
+    /// does. May be called from several threads at once after finalize().
+    std::shared_ptr<ChunkQuerySpec> buildChunkQuerySpec(ChunkSpec const& chunkSpec) const;
+
     // For test harnesses.
     struct Test {
         int cfgNum;
@@ -159,6 +171,8 @@ private:
 
     // Iterator help
     std::vector<std::string> _buildChunkQueries(ChunkSpec const& s) const;
+    std::shared_ptr<ChunkQuerySpec> _buildFragment(ChunkSpecFragmenter& f) const;
+    std::vector<query::QueryTemplate::Compiled> const& _getChunkTemplates() const;
 
     // Fields
     std::shared_ptr<css::CssAccess> _css; ///< Metadata access
@@ -206,6 +220,10 @@ private:
     ChunkSpecVector _chunks; ///< Chunk coverage
     std::shared_ptr<QueryPluginPtrVector> _plugins; ///< Analysis plugin chain
 
+    /// Parallel statement templates compiled for _context->queryMapping
+    mutable std::vector<query::QueryTemplate::Compiled> _chunkTemplates;
+    mutable std::once_flag _chunkTemplatesFlag;
+
 };
 
 /**
@@ -243,7 +261,6 @@ private:
             _dirty = false;
         }
     }
-    std::shared_ptr<ChunkQuerySpec> _buildFragment(ChunkSpecFragmenter& f) const;
 
     QuerySession* _qs;
     ChunkSpecVector::const_iterator _chunkSpecsIter;
@@ -33,28 +33,55 @@
 
 // System headers
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
 
 // LSST headers
 #include "lsst/log/Log.h"
 
-// Third-party headers
-#include "boost/format.hpp"
-
 // Qserv headers
 #include "global/Bug.h"
 #include "global/intTypes.h"
 #include "global/constants.h"
 #include "global/stringUtil.h"
 #include "qproc/ChunkSpec.h"
+#include "qproc/QueryProcessingError.h"
+#include "qproc/SecondaryIndexFile.h"
 #include "query/Constraint.h"
 #include "sql/SqlConnection.h"
+#include "sql/SqlConnectionPool.h"
+#include "sql/SqlErrorObject.h"
+#include "sql/SqlResults.h"
 #include "util/IterableFormatter.h"
 
 namespace {
 
 LOG_LOGGER _log = LOG_GET("lsst.qserv.qproc.SecondaryIndex");
 
-enum QueryType { IN, BETWEEN };
+/// Parse decimal integer in a buffer which need not be zero-terminated.
+/// @return false if buffer does not contain an integer fitting into int64_t
+bool parseInt(char const* buf, size_t len, int64_t& value) {
+    if (buf == nullptr or len == 0) return false;
+    bool const negative = buf[0] == '-';
+    size_t i = (negative or buf[0] == '+') ? 1 : 0;
+    if (i == len) return false;
+    uint64_t const limit = negative ? uint64_t(std::numeric_limits<int64_t>::max()) + 1
+                                    : uint64_t(std::numeric_limits<int64_t>::max());
+    uint64_t v = 0;
+    for (; i != len; ++i) {
+        unsigned const digit = static_cast<unsigned char>(buf[i]) - '0';
+        if (digit > 9 or v > (limit - digit) / 10) return false;
+        v = v * 10 + digit;
+    }
+    // negate via v - 1 to avoid overflow for the minimum value
+    value = (negative and v > 0) ? -static_cast<int64_t>(v - 1) - 1 : static_cast<int64_t>(v);
+    return true;
+}
 
 } // anonymous namespace
 
@@ -62,18 +89,56 @@ namespace lsst {
 namespace qserv {
 namespace qproc {
 
+namespace {
+
+/// @return name of the secondary index table of a director table
+std::string buildIndexTableName(std::string const& db, std::string const& table) {
+    return (std::string(SEC_INDEX_DB) + "."
+            + sanitizeName(db) + "__" + sanitizeName(table));
+}
+
+/// Group locations by chunk and add them to existing ChunkSpec vector
+void addLocations(ChunkSpecVector& output,
+                  std::vector<SecondaryIndexCache::Location> const& locations) {
+    std::map<int, Int32Vector> tmp;
+    for (auto const& loc: locations) {
+        tmp[loc.chunkId].push_back(loc.subChunkId);
+    }
+    for(auto i=tmp.begin(), e=tmp.end();
+        i != e; ++i) {
+        output.push_back(ChunkSpec(i->first, i->second));
+    }
+}
+
+} // anonymous namespace
+
 class SecondaryIndex::Backend {
 public:
     virtual ~Backend() {}
     /// Lookup an index constraint. Ignore constraints that are not "sIndex"
     /// constraints.
     virtual ChunkSpecVector lookup(query::ConstraintVector const& cv) = 0;
+
+    /// @return key location cache counters
+    virtual SecondaryIndexCache::Stats getCacheStats() const {
+        return SecondaryIndexCache::Stats();
+    }
+
+    /// Forget what is known about the index of table 'table' of database
+    /// 'db', or of all its tables if 'table' is empty.
+    virtual void invalidate(std::string const& db, std::string const& table) {}
 };
 
 class MySqlBackend : public SecondaryIndex::Backend {
 public:
-    MySqlBackend(mysql::MySqlConfig const& c)
-        : _sqlConnection(c, true) {
+    typedef SecondaryIndexCache::Location Location;
+
+    MySqlBackend(mysql::MySqlConfig const& c, unsigned batchSize, unsigned maxConnections,
+                 size_t cacheSize)
+        : _connPool(c, std::max(maxConnections, 1u)),
+          _batchSize(std::max(batchSize, 1u)),
+          _maxConnections(std::max(maxConnections, 1u)),
+          _cache(cacheSize) {
     }
 
     virtual ChunkSpecVector lookup(query::ConstraintVector const& cv) {
@@ -84,11 +149,11 @@ public:
             ++i) {
             if (i->name == "sIndex"){
                 hasIndex = true;
-                _sqlLookup(output, i->params, IN);
+                _lookupIn(output, i->params);
             }
             else if (i->name == "sIndexBetween") {
                 hasIndex = true;
-                _sqlLookup(output, i->params, BETWEEN);
+                _lookupBetween(output, i->params);
             }
         }
         if (!hasIndex) {
@@ -98,115 +163,295 @@ public:
         return output;
     }
 
+    virtual SecondaryIndexCache::Stats getCacheStats() const {
+        return _cache.getStats();
+    }
+
+    virtual void invalidate(std::string const& db, std::string const& table) {
+        if (table.empty()) {
+            _cache.invalidatePrefix(buildIndexTableName(db, std::string()));
+        } else {
+            _cache.invalidate(buildIndexTableName(db, table));
+        }
+    }
 
 private:
-    static std::string _buildIndexTableName(
-        std::string const& db,
-        std::string const& table) {
-        return (std::string(SEC_INDEX_DB) + "."
-                + sanitizeName(db) + "__" + sanitizeName(table));
+    /// @return beginning of the lookup query, up to the key condition
+    static std::string _buildSelect(std::string const& indexTable, std::string const& keyColumn) {
+        return "SELECT " + keyColumn + ", " + CHUNK_COLUMN + ", " + SUB_CHUNK_COLUMN
+            + " FROM " + indexTable + " WHERE " + keyColumn;
     }
 
     /**
-     *  Build sql query string to run against secondary index
+     *  Look up locations of a list of keys
      *
-     *  @param params:  vector of string used to build the query,
-     *                  format is:
-     *                  [db, table, keyColumn, id_0, ..., id_n]
-     *                  where:
-     *                  - db.table is the director table,
-     *                  - keyColumn is its primary key,
-     *                  - id_x are keyColumn values
+     *  @param output:  existing ChunkSpec vector to add results to
+     *  @param params:  [db, table, keyColumn, id_0, ..., id_n] where db.table
+     *                  is the director table, keyColumn is its primary key,
+     *                  and id_x are keyColumn values
+     */
+    void _lookupIn(ChunkSpecVector& output, StringVector const& params) {
+        LOGS(_log, LOG_LVL_TRACE, "params: " << util::printable(params));
+        if (params.size() < 3) {
+            throw Bug("Incorrect parameters for secondary index lookup");
+        }
+        std::string const indexTable = buildIndexTableName(params[0], params[1]);
+        std::string const select = _buildSelect(indexTable, params[2]) + " IN (";
+        auto const tableKey = _cache.getTableKey(indexTable);
+
+        // Keys in the cache need no query
+        std::vector<Location> locations;
+        std::vector<std::string const*> missing;
+        for (auto i = std::next(params.begin(), 3); i != params.end(); ++i) {
+            int64_t key;
+            Location loc;
+            if (parseInt(i->data(), i->size(), key) and _cache.get(tableKey, key, loc)) {
+                locations.push_back(loc);
+            } else {
+                missing.push_back(&*i);
+            }
+        }
+        LOGS(_log, LOG_LVL_DEBUG, "Secondary index lookup of " << params.size() - 3 << " keys in "
+             << indexTable << ", " << missing.size() << " not cached");
+
+        // Remaining keys are looked up in batches of limited size, batches
+        // are shared among up to _maxConnections threads
+        size_t const nBatches = (missing.size() + _batchSize - 1) / _batchSize;
+        std::atomic<size_t> nextBatch(0);
+        std::mutex mutex; // protects locations and error
+        std::string error;
+        auto worker = [&]() {
+            try {
+                auto conn = _connPool.acquire();
+                std::vector<Location> found;
+                std::string sql;
+                for (size_t b = nextBatch++; b < nBatches; b = nextBatch++) {
+                    auto begin = missing.begin() + b * _batchSize;
+                    auto end = missing.begin() + std::min(missing.size(), (b + 1) * _batchSize);
+                    sql = select;
+                    for (auto i = begin; i != end; ++i) {
+                        if (i != begin) sql += ',';
+                        sql += **i;
+                    }
+                    sql += ')';
+                    _runQuery(*conn, sql, tableKey, true, found);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                locations.insert(locations.end(), found.begin(), found.end());
+            } catch (std::exception const& exc) {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = exc.what();
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < std::min<size_t>(nBatches, _maxConnections); ++i) {
+            threads.emplace_back(worker);
+        }
+        if (nBatches > 0) worker();
+        for (auto& thread: threads) {
+            thread.join();
+        }
+        if (not error.empty()) {
+            throw QueryProcessingError(error);
+        }
+
+        addLocations(output, locations);
+    }
+
+    /**
+     *  Look up locations of a range of keys
      *
-     *  @param query_type: Type of the query launched against
-     *                     secondary index. Use IN or BETWEEN on object ids
-     *                     to find chunk ids.
+     *  @param output:  existing ChunkSpec vector to add results to
+     *  @param params:  [db, table, keyColumn, id_min, id_max]
+     */
+    void _lookupBetween(ChunkSpecVector& output, StringVector const& params) {
+        LOGS(_log, LOG_LVL_TRACE, "params: " << util::printable(params));
+        if (params.size() != 5) {
+            throw Bug("Incorrect parameters for bounded secondary index lookup ");
+        }
+        std::string const indexTable = buildIndexTableName(params[0], params[1]);
+        std::string const sql = _buildSelect(indexTable, params[2])
+            + " BETWEEN " + params[3] + " AND " + params[4];
+
+        // ranges may be large, so they are neither split nor cached
+        std::vector<Location> locations;
+        auto conn = _connPool.acquire();
+        _runQuery(*conn, sql, 0, false, locations);
+        addLocations(output, locations);
+    }
+
+    /**
+     *  Run secondary index query and collect locations from its result
      *
-     *  @return:   the sql query string to run against secondary index in
-     *             order to get (chunks, subchunks) couples containing [id_0, ..., id_n]
+     *  @param conn:        connection to use
+     *  @param sql:         query returning key, chunk and sub-chunk columns
+     *  @param tableKey:    cache key of the index table
+     *  @param cacheRows:   if true then remember found locations in cache
+     *  @param locations:   vector to add found locations to
      */
-    static std::string _buildLookupQuery(
-        std::vector<std::string> const& params,
-        QueryType const& query_type) {
+    void _runQuery(sql::SqlConnection& conn, std::string const& sql,
+                   SecondaryIndexCache::TableKey tableKey, bool cacheRows,
+                   std::vector<Location>& locations) {
+        LOGS(_log, LOG_LVL_TRACE, "sql: " << sql.substr(0, 256));
+        sql::SqlResults results;
+        sql::SqlErrorObject errObj;
+        if (not conn.runQuery(sql, results, errObj)) {
+            throw QueryProcessingError("Secondary index lookup failed: " + errObj.errMsg());
+        }
+        for (auto& row: results) {
+            // row is a vector of (value, length) pairs, parsed in place
+            int64_t key, chunkId, subChunkId;
+            if (not parseInt(row[1].first, row[1].second, chunkId) or
+                not parseInt(row[2].first, row[2].second, subChunkId)) {
+                throw QueryProcessingError("Secondary index returned non-integer chunk number");
+            }
+            Location const loc{static_cast<int32_t>(chunkId), static_cast<int32_t>(subChunkId)};
+            locations.push_back(loc);
+            if (cacheRows and parseInt(row[0].first, row[0].second, key)) {
+                _cache.put(tableKey, key, loc);
+            }
+        }
+    }
 
+    sql::SqlConnectionPool _connPool;
+    unsigned const _batchSize;
+    unsigned const _maxConnections;
+    SecondaryIndexCache _cache;
+};
 
-        LOGS(_log, LOG_LVL_TRACE, "params: " << util::printable(params));
+/// Serves lookups from local secondary index files, one per director table,
+/// and passes constraints on tables without a file to another backend.
+class LocalFileBackend : public SecondaryIndex::Backend {
+public:
+    typedef SecondaryIndexCache::Location Location;
+
+    LocalFileBackend(std::string const& indexDir,
+                     std::shared_ptr<SecondaryIndex::Backend> const& fallback)
+        : _indexDir(indexDir), _fallback(fallback) {
+    }
 
-        std::string const& db = params[0];
-        std::string const& table = params[1];
-        std::string const& key_column = params[2];
-
-        std::string sql;
-        std::string index_table = _buildIndexTableName(db, table);
-        if (query_type == QueryType::IN) {
-            char const IN_LOOKUP_SQL_TEMPLATE[] = "SELECT %s, %s FROM %s WHERE %s IN (%s)";
-            char const *const empty_bracket = "";
-            auto id_start = std::next(params.begin(), 3);
-            auto ids_formatter = util::printable( id_start, params.end(), empty_bracket, empty_bracket);
-            sql = (boost::format(IN_LOOKUP_SQL_TEMPLATE) % CHUNK_COLUMN
-                                                         % SUB_CHUNK_COLUMN
-                                                         % index_table
-                                                         % key_column
-                                                         % ids_formatter).str();
-        } else if (query_type == QueryType::BETWEEN) {
-            if (params.size() != 5) {
-                throw Bug("Incorrect parameters for bounded secondary index lookup ");
+    virtual ChunkSpecVector lookup(query::ConstraintVector const& cv) {
+        ChunkSpecVector output;
+        query::ConstraintVector remaining;
+        bool hasIndex = false;
+        for (auto const& c: cv) {
+            if (c.name != "sIndex" and c.name != "sIndexBetween") continue;
+            hasIndex = true;
+            if (not _lookup(output, c)) {
+                remaining.push_back(c);
             }
-            char const BETWEEN_LOOKUP_SQL_TEMPLATE[] = "SELECT %s, %s FROM %s WHERE %s BETWEEN %s AND %s";
-            sql = (boost::format(BETWEEN_LOOKUP_SQL_TEMPLATE) % CHUNK_COLUMN
-                                                              % SUB_CHUNK_COLUMN % index_table % key_column % params[3]
-                                                              % params[4]).str();
         }
+        if (!hasIndex) {
+            throw SecondaryIndex::NoIndexConstraint();
+        }
+        if (not remaining.empty()) {
+            ChunkSpecVector const other = _fallback->lookup(remaining);
+            output.insert(output.end(), other.begin(), other.end());
+        }
+        normalize(output);
+        return output;
+    }
 
-        LOGS(_log, LOG_LVL_TRACE, "sql: " << sql);
-        return sql;
+    virtual SecondaryIndexCache::Stats getCacheStats() const {
+        return _fallback->getCacheStats();
     }
 
+    virtual void invalidate(std::string const& db, std::string const& table) {
+        {
+            // the file of a dropped table must not be used for a new one
+            std::string const prefix = sanitizeName(db) + "__";
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (not table.empty()) {
+                _files.erase(prefix + sanitizeName(table));
+            } else {
+                for (auto iter = _files.lower_bound(prefix);
+                     iter != _files.end() and iter->first.compare(0, prefix.size(), prefix) == 0; ) {
+                    iter = _files.erase(iter);
+                }
+            }
+        }
+        _fallback->invalidate(db, table);
+    }
+
+private:
     /**
-     *  Add results from secondary index sql query to existing ChunkSpec vector
+     *  Look up a constraint in a local file
      *
-     *  @param output:      existing ChunkSpec vector
-     *  @param params:      parameters used to query secondary index
-     *  @param query_type:  Type of the query launched against
-     *                      secondary index. Use IN or BETWEEN on object ids
-     *                      to find chunk ids.
+     *  @param output:  existing ChunkSpec vector to add results to
+     *  @param c:       "sIndex" or "sIndexBetween" constraint
+     *  @return false if there is no file for the table or some key is not an
+     *          integer, nothing is added to output in that case
      */
-    void _sqlLookup(ChunkSpecVector& output, StringVector const& params, QueryType const& query_type) {
-        IntVector ids;
-
-        std::string sql = _buildLookupQuery(params, query_type);
-        std::map<int, Int32Vector> tmp;
-
-        // Insert sql query result:
-        //   chunkId_x1, subChunkId_y1
-        //   chunkId_x1, subChunkId_y2
-        //   ...
-        //   chunkId_xi, subChunkId_yj
-        //   ...
-        //   chunkId_xm, subChunkId_yn
-        //
-        // in a std::map<int, Int32Vector>:
-        // key       , value
-        // chunkId_x1, [subChunkId_y1, subChunkId_y2, ...]
-        // chunkId_xi, [subChunkId_yj, ..., subChunkId_yk]
-        // chunkId_xm, [subChunkId_yl, ..., subChunkId_yn]
-        for(std::shared_ptr<sql::SqlResultIter> results = _sqlConnection.getQueryIter(sql);
-            not results->done();
-            ++(*results)) {
-            StringVector const& row = **results;
-            int chunkId = std::stoi(row[0]);
-            int subChunkId = std::stoi(row[1]);
-            tmp[chunkId].push_back(subChunkId);
-        }
-
-        // Add results to output
-        for(auto i=tmp.begin(), e=tmp.end();
-            i != e; ++i) {
-            output.push_back(ChunkSpec(i->first, i->second));
-        }
-    }
-
-    sql::SqlConnection _sqlConnection;
+    bool _lookup(ChunkSpecVector& output, query::Constraint const& c) {
+        auto const& params = c.params;
+        if (params.size() < 3 or (c.name == "sIndexBetween" and params.size() != 5)) {
+            throw Bug("Incorrect parameters for secondary index lookup");
+        }
+        std::vector<int64_t> keys;
+        keys.reserve(params.size() - 3);
+        for (auto i = std::next(params.begin(), 3); i != params.end(); ++i) {
+            int64_t key;
+            if (not parseInt(i->data(), i->size(), key)) return false;
+            keys.push_back(key);
+        }
+        auto file = _getFile(params[0], params[1]);
+        if (file == nullptr) return false;
+
+        std::vector<Location> locations;
+        if (c.name == "sIndex") {
+            file->lookup(std::move(keys), locations);
+        } else {
+            file->lookupRange(keys[0], keys[1], locations);
+        }
+        LOGS(_log, LOG_LVL_DEBUG, "Local secondary index lookup in " << params[0] << "."
+             << params[1] << " found " << locations.size() << " rows");
+        addLocations(output, locations);
+        return true;
+    }
+
+    /// @return file for a director table, or nullptr if it does not exist
+    ///         or cannot be used
+    std::shared_ptr<SecondaryIndexFile> _getFile(std::string const& db, std::string const& table) {
+        std::string const name = sanitizeName(db) + "__" + sanitizeName(table);
+        std::string const path = _indexDir + "/" + name + ".sindex";
+        // missing files are looked for again next time, they may be built
+        // while czar runs
+        struct stat st;
+        bool const exists = ::stat(path.c_str(), &st) == 0;
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto iter = _files.find(name);
+        if (iter != _files.end()) {
+            // qserv-build-sindex.py renames a rebuilt file over the old one
+            if (exists and iter->second.inode == st.st_ino and iter->second.mtime == st.st_mtime) {
+                return iter->second.file;
+            }
+            LOGS(_log, LOG_LVL_INFO, "Local secondary index " << path << " changed");
+            _files.erase(iter);
+        }
+        if (not exists) return nullptr;
+        try {
+            auto file = std::make_shared<SecondaryIndexFile>(path);
+            LOGS(_log, LOG_LVL_INFO, "Using local secondary index " << path
+                 << " with " << file->size() << " keys");
+            _files[name] = MappedFile{file, st.st_ino, st.st_mtime};
+            return file;
+        } catch (SecondaryIndexFile::Error const& exc) {
+            LOGS(_log, LOG_LVL_WARN, exc.what());
+            return nullptr;
+        }
+    }
+
+    std::string const _indexDir;
+    std::shared_ptr<SecondaryIndex::Backend> const _fallback;
+    /// A mapped file and the identity of the file it was mapped from
+    struct MappedFile {
+        std::shared_ptr<SecondaryIndexFile> file;
+        ino_t inode;
+        time_t mtime;
+    };
+
+    std::mutex _mutex; ///< protects _files
+    std::map<std::string, MappedFile> _files;
 };
 
 class FakeBackend : public SecondaryIndex::Backend {
@@ -233,8 +478,15 @@ private:
     }
 };
 
-SecondaryIndex::SecondaryIndex(mysql::MySqlConfig const& c)
-    : _backend(std::make_shared<MySqlBackend>(c)) {
+SecondaryIndex::SecondaryIndex(mysql::MySqlConfig const& c,
+                               unsigned batchSize,
+                               unsigned maxConnections,
+                               size_t cacheSize,
+                               std::string const& localIndexDir)
+    : _backend(std::make_shared<MySqlBackend>(c, batchSize, maxConnections, cacheSize)) {
+    if (not localIndexDir.empty()) {
+        _backend = std::make_shared<LocalFileBackend>(localIndexDir, _backend);
+    }
 }
 
 SecondaryIndex::SecondaryIndex()
@@ -249,5 +501,18 @@ ChunkSpecVector SecondaryIndex::lookup(query::ConstraintVector const& cv) {
     }
 }
 
+void SecondaryIndex::invalidate(std::string const& db, std::string const& table) {
+    if (_backend) {
+        _backend->invalidate(db, table);
+    }
+}
+
+SecondaryIndexCache::Stats SecondaryIndex::getCacheStats() const {
+    if (_backend) {
+        return _backend->getCacheStats();
+    }
+    return SecondaryIndexCache::Stats();
+}
+
 }}} // namespace lsst::qserv::qproc
 
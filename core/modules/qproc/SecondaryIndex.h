@@ -33,10 +33,12 @@
 // System headers
 #include <memory>
 #include <stdexcept>
+#include <string>
 
 // Qserv headers
 #include "mysql/MySqlConfig.h"
 #include "qproc/ChunkSpec.h"
+#include "qproc/SecondaryIndexCache.h"
 #include "query/Constraint.h"
 
 namespace lsst {
@@ -51,7 +53,19 @@ namespace qproc {
  */
 class SecondaryIndex {
 public:
-    explicit SecondaryIndex(mysql::MySqlConfig const& c);
+    /** Construct an instance doing lookups in MySQL
+     *
+     *  Long key lists are split into batches of at most batchSize keys,
+     *  batches are looked up in parallel using up to maxConnections
+     *  connections. Locations of up to cacheSize keys are remembered.
+     *  If localIndexDir is not empty then tables which have a local index
+     *  file there, see SecondaryIndexFile, are looked up in the file instead.
+     */
+    explicit SecondaryIndex(mysql::MySqlConfig const& c,
+                            unsigned batchSize=10000,
+                            unsigned maxConnections=4,
+                            size_t cacheSize=100000,
+                            std::string const& localIndexDir=std::string());
 
     /** Construct a fake instance
      *
@@ -66,6 +80,14 @@ public:
      */
     ChunkSpecVector lookup(query::ConstraintVector const& cv);
 
+    /// @return key location cache counters
+    SecondaryIndexCache::Stats getCacheStats() const;
+
+    /// Forget cached locations from the index of table 'table' of database
+    /// 'db', or of all its tables if 'table' is empty. Must be called when
+    /// a table or database is dropped, it may be loaded again later.
+    void invalidate(std::string const& db, std::string const& table=std::string());
+
     class NoIndexConstraint : public std::invalid_argument {
     public:
         NoIndexConstraint()
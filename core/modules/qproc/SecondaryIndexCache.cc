@@ -0,0 +1,139 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "qproc/SecondaryIndexCache.h"
+
+// System headers
+#include <algorithm>
+
+namespace {
+
+// Number of shards, keys are spread among them by hash
+size_t const shardCount = 16;
+
+} // anonymous namespace
+
+namespace lsst {
+namespace qserv {
+namespace qproc {
+
+SecondaryIndexCache::SecondaryIndexCache(size_t capacity)
+    : _shardCapacity((capacity + shardCount - 1) / shardCount),
+      _shards(capacity > 0 ? shardCount : 0) {
+}
+
+SecondaryIndexCache::TableKey SecondaryIndexCache::getTableKey(std::string const& indexTable) {
+    std::lock_guard<std::mutex> lock(_tableMutex);
+    auto result = _tables.insert(std::make_pair(indexTable, _nextTableKey));
+    if (result.second) ++_nextTableKey;
+    return result.first->second;
+}
+
+bool SecondaryIndexCache::get(TableKey table, int64_t key, Location& loc) {
+    if (_shards.empty()) {
+        ++_misses;
+        return false;
+    }
+    Shard& shard = _shard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.index.find(std::make_pair(table, key));
+    if (iter == shard.index.end()) {
+        ++_misses;
+        return false;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, iter->second);
+    loc = iter->second->loc;
+    ++_hits;
+    return true;
+}
+
+void SecondaryIndexCache::put(TableKey table, int64_t key, Location const& loc) {
+    if (_shards.empty()) return;
+    Shard& shard = _shard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.index.find(std::make_pair(table, key));
+    if (iter != shard.index.end()) {
+        iter->second->loc = loc;
+        shard.lru.splice(shard.lru.begin(), shard.lru, iter->second);
+        return;
+    }
+    shard.lru.push_front(Entry{table, key, loc});
+    shard.index.insert(std::make_pair(std::make_pair(table, key), shard.lru.begin()));
+    if (shard.lru.size() > _shardCapacity) {
+        Entry const& last = shard.lru.back();
+        shard.index.erase(std::make_pair(last.table, last.key));
+        shard.lru.pop_back();
+    }
+}
+
+void SecondaryIndexCache::invalidate(std::string const& indexTable) {
+    _invalidate(indexTable, indexTable);
+}
+
+void SecondaryIndexCache::invalidatePrefix(std::string const& prefix) {
+    // names starting with prefix sort between prefix and prefix + '\xff'
+    _invalidate(prefix, prefix + '\xff');
+}
+
+/// Forget the keys of the index tables with names in [first, last].
+void SecondaryIndexCache::_invalidate(std::string const& first, std::string const& last) {
+    std::vector<TableKey> dropped;
+    {
+        std::lock_guard<std::mutex> lock(_tableMutex);
+        auto const end = _tables.upper_bound(last);
+        for (auto iter = _tables.lower_bound(first); iter != end; ++iter) {
+            dropped.push_back(iter->second);
+            iter->second = _nextTableKey++;
+        }
+    }
+    if (dropped.empty()) return;
+    for (auto& shard: _shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto iter = shard.lru.begin(); iter != shard.lru.end(); ) {
+            if (std::find(dropped.begin(), dropped.end(), iter->table) != dropped.end()) {
+                shard.index.erase(std::make_pair(iter->table, iter->key));
+                iter = shard.lru.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+}
+
+SecondaryIndexCache::Stats SecondaryIndexCache::getStats() const {
+    Stats stats;
+    stats.hits = _hits;
+    stats.misses = _misses;
+    for (auto& shard: _shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.size += shard.lru.size();
+    }
+    return stats;
+}
+
+SecondaryIndexCache::Shard& SecondaryIndexCache::_shard(int64_t key) {
+    return _shards[std::hash<int64_t>()(key) % _shards.size()];
+}
+
+}}} // namespace lsst::qserv::qproc
@@ -0,0 +1,122 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef LSST_QSERV_QPROC_SECONDARYINDEXCACHE_H
+#define LSST_QSERV_QPROC_SECONDARYINDEXCACHE_H
+
+// System headers
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lsst {
+namespace qserv {
+namespace qproc {
+
+/// SecondaryIndexCache remembers where recently looked up director table
+/// keys live, so that repeated lookups of the same keys skip the secondary
+/// index database. It is a bounded LRU map split into independently locked
+/// shards, all methods are thread-safe.
+class SecondaryIndexCache {
+public:
+    /// Chunk and sub-chunk containing a key
+    struct Location {
+        int32_t chunkId;
+        int32_t subChunkId;
+    };
+
+    /// Identifies an index table, see getTableKey()
+    typedef uint32_t TableKey;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t size = 0;
+    };
+
+    /// @param capacity: max number of keys kept, 0 disables the cache
+    explicit SecondaryIndexCache(size_t capacity);
+
+    SecondaryIndexCache(SecondaryIndexCache const&) = delete;
+    SecondaryIndexCache& operator=(SecondaryIndexCache const&) = delete;
+
+    /// @return compact key for an index table name, to be used with get() and put()
+    TableKey getTableKey(std::string const& indexTable);
+
+    /// Look up a key, on success set loc and return true
+    bool get(TableKey table, int64_t key, Location& loc);
+
+    /// Remember location of a key, evicting the least recently used key if full
+    void put(TableKey table, int64_t key, Location const& loc);
+
+    /// Forget the locations of the keys of 'indexTable', its table key
+    /// changes so that lookups still in progress do not add them again.
+    void invalidate(std::string const& indexTable);
+
+    /// Same as invalidate() for all index tables whose name starts with 'prefix'.
+    void invalidatePrefix(std::string const& prefix);
+
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        TableKey table;
+        int64_t key;
+        Location loc;
+    };
+    typedef std::list<Entry> EntryList;
+
+    struct Hash {
+        size_t operator()(std::pair<TableKey, int64_t> const& k) const {
+            return std::hash<int64_t>()(k.second) * 31 + k.first;
+        }
+    };
+
+    /// One independently locked part of the cache
+    struct Shard {
+        mutable std::mutex mutex;
+        EntryList lru; ///< most recently used first
+        std::unordered_map<std::pair<TableKey, int64_t>, EntryList::iterator, Hash> index;
+    };
+
+    Shard& _shard(int64_t key);
+    void _invalidate(std::string const& first, std::string const& last);
+
+    size_t const _shardCapacity;
+    std::vector<Shard> _shards;
+
+    std::mutex _tableMutex; ///< protects _tables and _nextTableKey
+    std::map<std::string, TableKey> _tables;
+    TableKey _nextTableKey{0};
+
+    std::atomic<uint64_t> _hits{0};
+    std::atomic<uint64_t> _misses{0};
+};
+
+}}} // namespace lsst::qserv::qproc
+
+#endif // LSST_QSERV_QPROC_SECONDARYINDEXCACHE_H
@@ -0,0 +1,303 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsstcorp.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "qproc/SecondaryIndexFile.h"
+
+// System headers
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+char const magic[8] = {'Q', 'S', 'V', 'S', 'I', 'D', 'X', '1'};
+size_t const headerSize = 32;
+size_t const dirEntrySize = 16;
+
+template <typename T>
+T readLE(char const* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void writeLE(std::ostream& out, T value) {
+    out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+} // anonymous namespace
+
+namespace lsst {
+namespace qserv {
+namespace qproc {
+
+/// Position of an entry in the file, moves forward only
+class SecondaryIndexFile::Cursor {
+public:
+    explicit Cursor(SecondaryIndexFile const& file) : _file(file) {}
+
+    /// Move to the first entry with key not less than given key
+    void seek(int64_t key) {
+        _load(_file._findBlock(key));
+        while (valid and this->key < key) next();
+    }
+
+    void next() {
+        if (_ptr == _end) {
+            if (_block + 1 < _file._nBlocks) {
+                _load(_block + 1);
+            } else {
+                valid = false;
+            }
+            return;
+        }
+        key = static_cast<int64_t>(static_cast<uint64_t>(key) + _varint());
+        loc.chunkId = static_cast<int32_t>(_varint());
+        loc.subChunkId = static_cast<int32_t>(_varint());
+    }
+
+    /// @return true if keys up to the given one are all in the current block
+    bool isNear(int64_t key) const {
+        return _block + 1 >= _file._nBlocks or key <= _file._firstKey(_block + 1);
+    }
+
+    bool valid = false;
+    int64_t key = 0;
+    Location loc{0, 0};
+
+private:
+    void _load(size_t block) {
+        _block = block;
+        _ptr = _file._blockBegin(block);
+        _end = _file._blockEnd(block);
+        key = _file._firstKey(block);
+        valid = _ptr != _end;
+        if (valid) next();
+    }
+
+    uint64_t _varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (_ptr == _end) break;
+            unsigned char const byte = *_ptr++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+        throw Error("Corrupted secondary index file " + _file._path);
+    }
+
+    SecondaryIndexFile const& _file;
+    size_t _block = 0;
+    char const* _ptr = nullptr;
+    char const* _end = nullptr;
+};
+
+SecondaryIndexFile::SecondaryIndexFile(std::string const& path) : _path(path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat sBuff;
+    if (fd < 0 || fstat(fd, &sBuff)) {
+        int const err = errno;
+        if (fd >= 0) close(fd);
+        throw Error("Cannot open secondary index file " + path + ": " + std::strerror(err));
+    }
+    _size = static_cast<size_t>(sBuff.st_size);
+    if (_size < headerSize) {
+        close(fd);
+        throw Error("Secondary index file " + path + " is too short");
+    }
+    void* addr = mmap(0, _size, PROT_READ, MAP_SHARED, fd, 0);
+    int const err = errno;
+    close(fd);
+    if (addr == MAP_FAILED) {
+        throw Error("Cannot map secondary index file " + path + ": " + std::strerror(err));
+    }
+    _data = static_cast<char const*>(addr);
+
+    uint64_t const dirOffset = readLE<uint64_t>(_data + 24);
+    if (std::memcmp(_data, magic, sizeof(magic)) != 0 or dirOffset < headerSize
+        or dirOffset > _size or (_size - dirOffset) % dirEntrySize != 0) {
+        munmap(const_cast<char*>(_data), _size);
+        throw Error("Not a secondary index file: " + path);
+    }
+    _nEntries = readLE<uint64_t>(_data + 16);
+    _directory = _data + dirOffset;
+    _nBlocks = (_size - dirOffset) / dirEntrySize;
+    for (size_t b = 0; b != _nBlocks; ++b) {
+        uint64_t const offset = readLE<uint64_t>(_directory + b * dirEntrySize + 8);
+        uint64_t const prevEnd = b == 0 ? headerSize
+            : readLE<uint64_t>(_directory + (b - 1) * dirEntrySize + 8);
+        if (offset < prevEnd or offset > dirOffset) {
+            munmap(const_cast<char*>(_data), _size);
+            throw Error("Corrupted secondary index file " + path);
+        }
+    }
+}
+
+SecondaryIndexFile::~SecondaryIndexFile() {
+    munmap(const_cast<char*>(_data), _size);
+}
+
+void SecondaryIndexFile::lookup(std::vector<int64_t> keys, std::vector<Location>& locations) const {
+    if (_nBlocks == 0) return;
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    Cursor cursor(*this);
+    bool positioned = false;
+    for (int64_t key: keys) {
+        // keys in the current block are reached by scanning forward,
+        // anything further away by a new search
+        if (not positioned or not cursor.isNear(key)) {
+            cursor.seek(key);
+            positioned = true;
+        } else {
+            while (cursor.valid and cursor.key < key) cursor.next();
+        }
+        if (not cursor.valid) break;
+        for (; cursor.valid and cursor.key == key; cursor.next()) {
+            locations.push_back(cursor.loc);
+        }
+    }
+}
+
+void SecondaryIndexFile::lookupRange(int64_t minKey, int64_t maxKey,
+                                     std::vector<Location>& locations) const {
+    if (_nBlocks == 0 or minKey > maxKey) return;
+    Cursor cursor(*this);
+    for (cursor.seek(minKey); cursor.valid and cursor.key <= maxKey; cursor.next()) {
+        locations.push_back(cursor.loc);
+    }
+}
+
+size_t SecondaryIndexFile::_findBlock(int64_t key) const {
+    if (_firstKey(0) >= key) return 0;
+    if (_firstKey(_nBlocks - 1) < key) return _nBlocks - 1;
+    // invariant: _firstKey(lo) < key <= _firstKey(hi)
+    size_t lo = 0;
+    size_t hi = _nBlocks - 1;
+    // interpolation steps alternate with bisection, which bounds the
+    // number of steps for skewed key distributions
+    for (bool interpolate = true; hi - lo > 1; interpolate = not interpolate) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (interpolate) {
+            long double const loKey = _firstKey(lo);
+            long double const hiKey = _firstKey(hi);
+            long double const guess = lo + (key - loKey) / (hiKey - loKey) * (hi - lo);
+            mid = std::min(std::max(static_cast<size_t>(guess), lo + 1), hi - 1);
+        }
+        if (_firstKey(mid) < key) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+int64_t SecondaryIndexFile::_firstKey(size_t block) const {
+    return readLE<int64_t>(_directory + block * dirEntrySize);
+}
+
+char const* SecondaryIndexFile::_blockBegin(size_t block) const {
+    return _data + readLE<uint64_t>(_directory + block * dirEntrySize + 8);
+}
+
+char const* SecondaryIndexFile::_blockEnd(size_t block) const {
+    return block + 1 < _nBlocks ? _blockBegin(block + 1) : _directory;
+}
+
+SecondaryIndexFileWriter::SecondaryIndexFileWriter(std::string const& path, unsigned blockSize)
+    : _path(path), _blockSize(std::max(blockSize, 1u)),
+      _out(path, std::ios::binary | std::ios::trunc) {
+    // header is rewritten by close()
+    _out.write(std::string(headerSize, '\0').data(), headerSize);
+    if (not _out) {
+        throw SecondaryIndexFile::Error("Cannot create secondary index file " + path);
+    }
+}
+
+SecondaryIndexFileWriter::~SecondaryIndexFileWriter() {
+    try {
+        close();
+    } catch (std::exception const&) {
+    }
+}
+
+void SecondaryIndexFileWriter::add(int64_t key, Location const& loc) {
+    if (_nEntries > 0 and key < _prevKey) {
+        throw SecondaryIndexFile::Error("Secondary index keys are not sorted: "
+                                        + std::to_string(key) + " follows "
+                                        + std::to_string(_prevKey));
+    }
+    if (loc.chunkId < 0 or loc.subChunkId < 0) {
+        throw SecondaryIndexFile::Error("Negative chunk number for key " + std::to_string(key));
+    }
+    if (_nEntries % _blockSize == 0) {
+        _directory.emplace_back(key, static_cast<uint64_t>(_out.tellp()));
+        _prevKey = key;
+    }
+    _putVarint(static_cast<uint64_t>(key) - static_cast<uint64_t>(_prevKey));
+    _putVarint(static_cast<uint64_t>(loc.chunkId));
+    _putVarint(static_cast<uint64_t>(loc.subChunkId));
+    _prevKey = key;
+    ++_nEntries;
+}
+
+void SecondaryIndexFileWriter::close() {
+    if (_closed) return;
+    _closed = true;
+    uint64_t const dirOffset = _out.tellp();
+    for (auto const& entry: _directory) {
+        writeLE<int64_t>(_out, entry.first);
+        writeLE<uint64_t>(_out, entry.second);
+    }
+    _out.seekp(0);
+    _out.write(magic, sizeof(magic));
+    writeLE<uint32_t>(_out, _blockSize);
+    writeLE<uint32_t>(_out, 0);
+    writeLE<uint64_t>(_out, _nEntries);
+    writeLE<uint64_t>(_out, dirOffset);
+    _out.close();
+    if (not _out) {
+        throw SecondaryIndexFile::Error("Failed to write secondary index file " + _path);
+    }
+}
+
+void SecondaryIndexFileWriter::_putVarint(uint64_t value) {
+    char buf[10];
+    int n = 0;
+    do {
+        unsigned char byte = value & 0x7f;
+        value >>= 7;
+        if (value != 0) byte |= 0x80;
+        buf[n++] = static_cast<char>(byte);
+    } while (value != 0);
+    _out.write(buf, n);
+}
+
+}}} // namespace lsst::qserv::qproc
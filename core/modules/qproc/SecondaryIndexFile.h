@@ -0,0 +1,139 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef LSST_QSERV_QPROC_SECONDARYINDEXFILE_H
+#define LSST_QSERV_QPROC_SECONDARYINDEXFILE_H
+/**
+  * @file
+  *
+  * @brief Local secondary index file, written by SecondaryIndexFileWriter
+  *        or admin/bin/qserv-build-sindex.py and read by SecondaryIndexFile
+  *
+  * File layout, all integers little-endian:
+  *
+  *   header     "QSVSIDX1", uint32 entries per block, uint32 zero,
+  *              uint64 number of entries, uint64 offset of the directory
+  *   blocks     entries sorted by key, each entry three unsigned LEB128
+  *              varints: key minus previous key (0 for the first entry of
+  *              a block), chunkId, subChunkId
+  *   directory  one (int64 first key, uint64 block offset) pair per block
+  */
+
+// System headers
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Qserv headers
+#include "qproc/SecondaryIndexCache.h"
+
+namespace lsst {
+namespace qserv {
+namespace qproc {
+
+/// SecondaryIndexFile gives read-only access to a memory-mapped secondary
+/// index file. Blocks are found by interpolation search in the directory,
+/// then decoded sequentially. All methods are const and thread-safe.
+class SecondaryIndexFile {
+public:
+    typedef SecondaryIndexCache::Location Location;
+
+    /// Thrown if file cannot be read or is not a valid index file
+    class Error : public std::runtime_error {
+    public:
+        explicit Error(std::string const& msg) : std::runtime_error(msg) {}
+    };
+
+    /// Map file into memory, throws Error on failure
+    explicit SecondaryIndexFile(std::string const& path);
+    ~SecondaryIndexFile();
+
+    SecondaryIndexFile(SecondaryIndexFile const&) = delete;
+    SecondaryIndexFile& operator=(SecondaryIndexFile const&) = delete;
+
+    /// Add locations of all given keys to locations. Keys need not be
+    /// sorted, neighbouring keys are found in one forward scan.
+    void lookup(std::vector<int64_t> keys, std::vector<Location>& locations) const;
+
+    /// Add locations of keys in [minKey, maxKey] to locations
+    void lookupRange(int64_t minKey, int64_t maxKey, std::vector<Location>& locations) const;
+
+    /// @return number of entries in the file
+    uint64_t size() const { return _nEntries; }
+
+private:
+    class Cursor;
+
+    /// @return index of the last block whose first key is less than key, or 0
+    size_t _findBlock(int64_t key) const;
+
+    int64_t _firstKey(size_t block) const;
+    char const* _blockBegin(size_t block) const;
+    char const* _blockEnd(size_t block) const;
+
+    std::string const _path;
+    char const* _data = nullptr;
+    size_t _size = 0;
+    uint64_t _nEntries = 0;
+    size_t _nBlocks = 0;
+    char const* _directory = nullptr;
+};
+
+/// SecondaryIndexFileWriter writes a secondary index file from entries
+/// added in non-decreasing key order.
+class SecondaryIndexFileWriter {
+public:
+    typedef SecondaryIndexCache::Location Location;
+
+    /// Create file, throws SecondaryIndexFile::Error on failure
+    explicit SecondaryIndexFileWriter(std::string const& path, unsigned blockSize=256);
+
+    /// Calls close(), errors are ignored
+    ~SecondaryIndexFileWriter();
+
+    SecondaryIndexFileWriter(SecondaryIndexFileWriter const&) = delete;
+    SecondaryIndexFileWriter& operator=(SecondaryIndexFileWriter const&) = delete;
+
+    /// Add an entry, throws SecondaryIndexFile::Error if key is smaller
+    /// than the previous one or location is negative
+    void add(int64_t key, Location const& loc);
+
+    /// Write directory and header, throws SecondaryIndexFile::Error on failure
+    void close();
+
+private:
+    void _putVarint(uint64_t value);
+
+    std::string const _path;
+    unsigned const _blockSize;
+    std::ofstream _out;
+    uint64_t _nEntries = 0;
+    int64_t _prevKey = 0;
+    std::vector<std::pair<int64_t, uint64_t>> _directory;
+    bool _closed = false;
+};
+
+}}} // namespace lsst::qserv::qproc
+
+#endif // LSST_QSERV_QPROC_SECONDARYINDEXFILE_H
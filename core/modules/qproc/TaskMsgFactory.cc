@@ -60,18 +60,20 @@ namespace qproc {
 ////////////////////////////////////////////////////////////////////////
 class TaskMsgFactory::Impl {
 public:
-    Impl(uint64_t session, std::string const& resultTable)
-        : _session(session), _resultTable(resultTable) {
+    Impl(uint64_t session, std::string const& resultTable,
+         proto::ProtoHeader::ChecksumType checksumType, int protocol)
+        : _session(session), _resultTable(resultTable), _checksumType(checksumType),
+          _protocol(protocol) {
     }
     std::shared_ptr<proto::TaskMsg> makeMsg(ChunkQuerySpec const& s,
                                             std::string const& chunkResultName,
-                                            uint64_t queryId, int jobId);
+                                            uint64_t queryId, int jobId) const;
 private:
     template <class C1, class C2, class C3>
     void addFragment(proto::TaskMsg& m, std::string const& resultName,
                      C1 const& subChunkTables,
                      C2 const& subChunkIds,
-                     C3 const& queries) {
+                     C3 const& queries) const {
         proto::TaskMsg::Fragment* frag = m.add_fragment();
         frag->set_resulttable(resultName);
         // For each query, apply: frag->add_query(q)
@@ -93,22 +95,24 @@ private:
 
     uint64_t _session;
     std::string _resultTable;
-    std::shared_ptr<proto::TaskMsg> _taskMsg;
+    proto::ProtoHeader::ChecksumType _checksumType;
+    int _protocol;
 };
 
 std::shared_ptr<proto::TaskMsg>
 TaskMsgFactory::Impl::makeMsg(ChunkQuerySpec const& s,
                               std::string const& chunkResultName,
-                              uint64_t queryId, int jobId) {
+                              uint64_t queryId, int jobId) const {
     std::string resultTable = _resultTable;
     if (!chunkResultName.empty()) { resultTable = chunkResultName; }
-    _taskMsg = std::make_shared<proto::TaskMsg>();
+    auto taskMsg = std::make_shared<proto::TaskMsg>();
     // shared
-    _taskMsg->set_session(_session);
-    _taskMsg->set_db(s.db);
-    _taskMsg->set_protocol(2);
-    _taskMsg->set_queryid(queryId);
-    _taskMsg->set_jobid(jobId);
+    taskMsg->set_session(_session);
+    taskMsg->set_db(s.db);
+    taskMsg->set_protocol(_protocol); // 3 is column-based, see proto/worker.proto
+    taskMsg->set_queryid(queryId);
+    taskMsg->set_jobid(jobId);
+    taskMsg->set_checksumtype(_checksumType);
     // scanTables (for shared scans)
     // check if more than 1 db in scanInfo
     std::string db;
@@ -121,14 +125,14 @@ TaskMsgFactory::Impl::makeMsg(ChunkQuerySpec const& s,
     }
 
     for(auto const& sTbl : s.scanInfo.infoTables) {
-        lsst::qserv::proto::TaskMsg_ScanTable *msgScanTbl = _taskMsg->add_scantable();
+        lsst::qserv::proto::TaskMsg_ScanTable *msgScanTbl = taskMsg->add_scantable();
         sTbl.copyToScanTable(msgScanTbl);
     }
 
-    _taskMsg->set_scanpriority(s.scanInfo.scanRating);
+    taskMsg->set_scanpriority(s.scanInfo.scanRating);
 
     // per-chunk
-    _taskMsg->set_chunkid(s.chunkId);
+    taskMsg->set_chunkid(s.chunkId);
     // per-fragment
     // TODO refactor to simplify
     if (s.nextFragment.get()) {
@@ -140,7 +144,7 @@ TaskMsgFactory::Impl::makeMsg(ChunkQuerySpec const& s,
             }
             // Linked fragments will not have valid subChunkTables vectors,
             // So, we reuse the root fragment's vector.
-            addFragment(*_taskMsg, resultTable,
+            addFragment(*taskMsg, resultTable,
                         s.subChunkTables,
                         sPtr->subChunkIds,
                         sPtr->queries);
@@ -151,26 +155,35 @@ TaskMsgFactory::Impl::makeMsg(ChunkQuerySpec const& s,
         for(unsigned int t=0;t<(s.queries).size();t++){
             LOGS(_log, LOG_LVL_DEBUG, (s.queries).at(t));
         }
-        addFragment(*_taskMsg, resultTable,
+        addFragment(*taskMsg, resultTable,
                     s.subChunkTables, s.subChunkIds, s.queries);
     }
-    return _taskMsg;
+    return taskMsg;
 }
 
 
 ////////////////////////////////////////////////////////////////////////
 // class TaskMsgFactory
 ////////////////////////////////////////////////////////////////////////
-TaskMsgFactory::TaskMsgFactory(uint64_t session)
-    : _impl(std::make_shared<Impl>(session, "Asdfasfd" )) {
+TaskMsgFactory::TaskMsgFactory(uint64_t session, proto::ProtoHeader::ChecksumType checksumType,
+                               int protocol)
+    : _impl(std::make_shared<Impl>(session, "Asdfasfd", checksumType, protocol)) {
 }
 
 void TaskMsgFactory::serializeMsg(ChunkQuerySpec const& s,
                                   std::string const& chunkResultName,
                                   uint64_t queryId, int jobId,
-                                  std::ostream& os) {
+                                  std::ostream& os) const {
     std::shared_ptr<proto::TaskMsg> m = _impl->makeMsg(s, chunkResultName, queryId, jobId);
     m->SerializeToOstream(&os);
 }
 
+std::string TaskMsgFactory::serializeMsg(ChunkQuerySpec const& s,
+                                         std::string const& chunkResultName,
+                                         uint64_t queryId, int jobId) const {
+    std::string msg;
+    _impl->makeMsg(s, chunkResultName, queryId, jobId)->SerializeToString(&msg);
+    return msg;
+}
+
 }}} // namespace lsst::qserv::qproc
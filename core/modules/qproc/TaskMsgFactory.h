@@ -34,6 +34,10 @@
 // System headers
 #include <iostream>
 #include <memory>
+#include <string>
+
+// Qserv headers
+#include "proto/worker.pb.h"
 
 namespace lsst {
 namespace qserv {
@@ -41,16 +45,25 @@ namespace qproc {
 
 class ChunkQuerySpec;
 
-/// TaskMsgFactory is a factory for TaskMsg (protobuf) objects.
+/// TaskMsgFactory is a factory for TaskMsg (protobuf) objects. It may be
+/// used from several threads at once.
 class TaskMsgFactory {
 public:
-    TaskMsgFactory(uint64_t session);
+    /// @param checksumType checksum workers should attach to result messages
+    /// @param protocol result protocol workers should use, 2 or 3
+    TaskMsgFactory(uint64_t session, proto::ProtoHeader::ChecksumType checksumType,
+                   int protocol=2);
 
     /// Construct a TaskMsg and serialize it to a stream
     void serializeMsg(ChunkQuerySpec const& s,
                       std::string const& chunkResultName,
                       uint64_t queryId, int jobId,
-                      std::ostream& os);
+                      std::ostream& os) const;
+
+    /// Construct a TaskMsg and return it serialized
+    std::string serializeMsg(ChunkQuerySpec const& s,
+                             std::string const& chunkResultName,
+                             uint64_t queryId, int jobId) const;
 private:
     class Impl;
 
@@ -42,8 +42,10 @@
 #include "boost/algorithm/string.hpp"
 
 // Qserv headers
+#include "css/StripingParams.h"
 #include "global/intTypes.h"
 #include "qproc/ChunkSpec.h"
+#include "qproc/IndexMap.h"
 #include "qproc/SecondaryIndex.h"
 #include "query/Constraint.h"
 
@@ -56,9 +58,11 @@ namespace test = boost::test_tools;
 
 using lsst::qserv::qproc::ChunkSpec;
 using lsst::qserv::qproc::ChunkSpecVector;
+using lsst::qserv::qproc::IndexMap;
 using lsst::qserv::qproc::SecondaryIndex;
 using lsst::qserv::query::Constraint;
 using lsst::qserv::query::ConstraintVector;
+using lsst::qserv::IntSet;
 using lsst::qserv::IntVector;
 
 struct Fixture {
@@ -121,6 +125,35 @@ BOOST_AUTO_TEST_CASE(SecLookupMultipleObjectIdBETWEEN) {
               std::ostream_iterator<ChunkSpec>(std::cout, ",\n"));
 }
 
+BOOST_AUTO_TEST_CASE(NonEmptyChunks) {
+    lsst::qserv::css::StripingParams sp(18, 3, 1, 0.01);
+    IndexMap im1(sp, nullptr);
+    IndexMap im2(sp, nullptr);
+
+    ChunkSpecVector all = im1.getAllChunks();
+    BOOST_REQUIRE(all.size() > 2U);
+    BOOST_CHECK_EQUAL(im2.getAllChunks().size(), all.size());
+
+    // no empty chunks
+    BOOST_CHECK_EQUAL(im1.getNonEmptyChunks(nullptr)->size(), all.size());
+    BOOST_CHECK_EQUAL(im1.getNonEmptyChunks(std::make_shared<IntSet>())->size(), all.size());
+
+    // filtered list is computed once and shared by maps with same striping
+    auto eSet = std::make_shared<IntSet>();
+    eSet->insert(all[0].chunkId);
+    eSet->insert(all[1].chunkId);
+    auto nonEmpty = im1.getNonEmptyChunks(eSet);
+    BOOST_CHECK_EQUAL(nonEmpty->size(), all.size() - 2);
+    BOOST_CHECK_EQUAL(nonEmpty->front().chunkId, all[2].chunkId);
+    BOOST_CHECK_EQUAL(nonEmpty->front().subChunks.size(), all[2].subChunks.size());
+    BOOST_CHECK(im2.getNonEmptyChunks(eSet) == nonEmpty);
+
+    // different set of empty chunks
+    auto eSet2 = std::make_shared<IntSet>(*eSet);
+    eSet2->insert(all[2].chunkId);
+    BOOST_CHECK_EQUAL(im2.getNonEmptyChunks(eSet2)->size(), all.size() - 3);
+}
+
 #if 0 // TODO
 BOOST_AUTO_TEST_CASE(IndLookupArea) {
     // Lookup area using IndexMap interface
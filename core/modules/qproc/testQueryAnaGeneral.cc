@@ -134,6 +134,23 @@ BOOST_AUTO_TEST_CASE(Limit) {
     }
 
     BOOST_CHECK_EQUAL(ss.getLimit(), 2);
+    // Any 2 rows will do, chunk dispatch may stop once they arrive.
+    BOOST_CHECK_EQUAL(context->rowLimit, 2);
+}
+
+BOOST_AUTO_TEST_CASE(LimitNeedsAllChunks) {
+    // The rows of some chunks do not satisfy these queries.
+    std::string stmts[] = {
+        "select * from LSST.Object WHERE ra_PS BETWEEN 150 AND 150.2 ORDER BY objectId limit 2;",
+        "select count(*) from LSST.Object limit 2;",
+        "select DISTINCT objectId from LSST.Object limit 2;",
+        "SELECT objectId as id, COUNT(sourceId) AS c FROM Source GROUP BY objectId LIMIT 10;"
+    };
+    for (auto const& stmt : stmts) {
+        std::shared_ptr<QuerySession> qs = queryAnaHelper.buildQuerySession(qsTest, stmt);
+        std::shared_ptr<QueryContext> context = qs->dbgGetContext();
+        BOOST_CHECK_EQUAL(context->rowLimit, lsst::qserv::NOTSET);
+    }
 }
 
 BOOST_AUTO_TEST_CASE(OrderBy) {
@@ -0,0 +1,153 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+/**
+  * @brief Test SecondaryIndexCache.
+  */
+
+// System headers
+#include <thread>
+#include <vector>
+
+// Qserv headers
+#include "qproc/SecondaryIndexCache.h"
+
+// Boost unit test header
+#define BOOST_TEST_MODULE SecondaryIndexCache
+#include "boost/test/included/unit_test.hpp"
+
+using lsst::qserv::qproc::SecondaryIndexCache;
+
+BOOST_AUTO_TEST_SUITE(Suite)
+
+BOOST_AUTO_TEST_CASE(GetPut) {
+    SecondaryIndexCache cache(1000);
+    auto object = cache.getTableKey("qservMeta.LSST__Object");
+    auto source = cache.getTableKey("qservMeta.LSST__Source");
+    BOOST_CHECK(object != source);
+    BOOST_CHECK_EQUAL(cache.getTableKey("qservMeta.LSST__Object"), object);
+
+    SecondaryIndexCache::Location loc;
+    BOOST_CHECK(not cache.get(object, 386942193651348, loc));
+    cache.put(object, 386942193651348, SecondaryIndexCache::Location{7, 42});
+    BOOST_CHECK(cache.get(object, 386942193651348, loc));
+    BOOST_CHECK_EQUAL(loc.chunkId, 7);
+    BOOST_CHECK_EQUAL(loc.subChunkId, 42);
+
+    // same key in a different table is a different entry
+    BOOST_CHECK(not cache.get(source, 386942193651348, loc));
+
+    auto stats = cache.getStats();
+    BOOST_CHECK_EQUAL(stats.hits, 1U);
+    BOOST_CHECK_EQUAL(stats.misses, 2U);
+    BOOST_CHECK_EQUAL(stats.size, 1U);
+}
+
+BOOST_AUTO_TEST_CASE(Eviction) {
+    // 16 shards of 2 entries each
+    SecondaryIndexCache cache(32);
+    auto table = cache.getTableKey("t");
+    for (int64_t key = 0; key < 1000; ++key) {
+        cache.put(table, key, SecondaryIndexCache::Location{int32_t(key), 0});
+    }
+    BOOST_CHECK_EQUAL(cache.getStats().size, 32U);
+
+    // most recent keys survive
+    SecondaryIndexCache::Location loc;
+    BOOST_CHECK(cache.get(table, 999, loc));
+    BOOST_CHECK_EQUAL(loc.chunkId, 999);
+    BOOST_CHECK(not cache.get(table, 0, loc));
+
+    // reading a key keeps it from being evicted, keys 0, 16 and 32
+    // go to the same shard
+    SecondaryIndexCache small(32);
+    table = small.getTableKey("t");
+    small.put(table, 0, SecondaryIndexCache::Location{0, 0});
+    small.put(table, 16, SecondaryIndexCache::Location{16, 0});
+    BOOST_CHECK(small.get(table, 0, loc));
+    small.put(table, 32, SecondaryIndexCache::Location{32, 0});
+    BOOST_CHECK(small.get(table, 0, loc));
+    BOOST_CHECK(not small.get(table, 16, loc));
+    BOOST_CHECK(small.get(table, 32, loc));
+}
+
+BOOST_AUTO_TEST_CASE(Invalidate) {
+    SecondaryIndexCache cache(1000);
+    auto object = cache.getTableKey("qservMeta.LSST__Object");
+    auto source = cache.getTableKey("qservMeta.LSST__Source");
+    auto other = cache.getTableKey("qservMeta.LSST2__Object");
+    cache.put(object, 1, SecondaryIndexCache::Location{1, 1});
+    cache.put(source, 2, SecondaryIndexCache::Location{2, 2});
+    cache.put(other, 3, SecondaryIndexCache::Location{3, 3});
+
+    // a dropped table gets a new key, entries added under the old one by
+    // lookups still in progress are never found
+    cache.invalidate("qservMeta.LSST__Object");
+    auto newObject = cache.getTableKey("qservMeta.LSST__Object");
+    BOOST_CHECK(newObject != object);
+    SecondaryIndexCache::Location loc;
+    BOOST_CHECK(not cache.get(newObject, 1, loc));
+    BOOST_CHECK(cache.get(source, 2, loc));
+    BOOST_CHECK_EQUAL(cache.getStats().size, 2U);
+
+    // a dropped database
+    cache.invalidatePrefix("qservMeta.LSST__");
+    BOOST_CHECK(not cache.get(cache.getTableKey("qservMeta.LSST__Source"), 2, loc));
+    BOOST_CHECK(cache.get(other, 3, loc));
+    BOOST_CHECK_EQUAL(cache.getStats().size, 1U);
+}
+
+BOOST_AUTO_TEST_CASE(Disabled) {
+    SecondaryIndexCache cache(0);
+    auto table = cache.getTableKey("t");
+    cache.put(table, 1, SecondaryIndexCache::Location{1, 1});
+    SecondaryIndexCache::Location loc;
+    BOOST_CHECK(not cache.get(table, 1, loc));
+    BOOST_CHECK_EQUAL(cache.getStats().size, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(Threads) {
+    SecondaryIndexCache cache(10000);
+    auto table = cache.getTableKey("t");
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(4, 0);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, &mismatches, table, t]() {
+            SecondaryIndexCache::Location loc;
+            for (int64_t key = 0; key < 20000; ++key) {
+                cache.put(table, key, SecondaryIndexCache::Location{int32_t(key % 1000), 0});
+                if (cache.get(table, key / 2, loc) and loc.chunkId != (key / 2) % 1000) {
+                    ++mismatches[t];
+                }
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    for (auto n: mismatches) {
+        BOOST_CHECK_EQUAL(n, 0);
+    }
+    BOOST_CHECK(cache.getStats().size <= 10000U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,182 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+/**
+  * @brief Test SecondaryIndexFile and SecondaryIndexFileWriter.
+  */
+
+// System headers
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Qserv headers
+#include "qproc/SecondaryIndexFile.h"
+
+// Boost unit test header
+#define BOOST_TEST_MODULE SecondaryIndexFile
+#include "boost/test/included/unit_test.hpp"
+
+using lsst::qserv::qproc::SecondaryIndexFile;
+using lsst::qserv::qproc::SecondaryIndexFileWriter;
+
+namespace {
+
+typedef SecondaryIndexFile::Location Location;
+
+/// Temporary file name, file is removed when object goes away
+struct TmpPath {
+    TmpPath() : path("/tmp/testSecondaryIndexFile-" + std::to_string(getpid())) {}
+    ~TmpPath() { std::remove(path.c_str()); }
+    std::string const path;
+};
+
+/// Key k lives in chunk k / 100 and sub-chunk k % 100, every third key
+/// below 10^6 exists, keys 3 * 10^5 and 9 * 10^5 appear twice
+void writeIndex(std::string const& path, unsigned blockSize) {
+    SecondaryIndexFileWriter writer(path, blockSize);
+    for (int64_t key = 0; key < 1000000; key += 3) {
+        Location loc{int32_t(key / 100), int32_t(key % 100)};
+        writer.add(key, loc);
+        if (key == 300000 or key == 900000) writer.add(key, loc);
+    }
+    writer.close();
+}
+
+std::vector<int32_t> chunks(std::vector<Location> const& locations) {
+    std::vector<int32_t> result;
+    for (auto const& loc: locations) {
+        result.push_back(loc.chunkId * 100 + loc.subChunkId);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(Suite)
+
+BOOST_AUTO_TEST_CASE(Lookup) {
+    TmpPath tmp;
+    // block sizes dividing and not dividing the duplicate key positions
+    for (unsigned blockSize: {1, 7, 100000, 256}) {
+        writeIndex(tmp.path, blockSize);
+        SecondaryIndexFile index(tmp.path);
+        BOOST_CHECK_EQUAL(index.size(), 333336U);
+
+        std::vector<Location> locations;
+        index.lookup({999999, 3, 4, 3, -5, 300000, 2000000}, locations);
+        BOOST_CHECK(chunks(locations) == (std::vector<int32_t>{3, 300000, 300000, 999999}));
+
+        locations.clear();
+        index.lookup({}, locations);
+        BOOST_CHECK(locations.empty());
+
+        // many keys, most of them missing
+        std::vector<int64_t> keys;
+        for (int64_t key = 500000; key < 600000; key += 7) keys.push_back(key);
+        locations.clear();
+        index.lookup(keys, locations);
+        BOOST_CHECK_EQUAL(locations.size(), keys.size() / 3);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(LookupRange) {
+    TmpPath tmp;
+    for (unsigned blockSize: {1, 7, 256}) {
+        writeIndex(tmp.path, blockSize);
+        SecondaryIndexFile index(tmp.path);
+
+        std::vector<Location> locations;
+        index.lookupRange(299990, 300010, locations);
+        BOOST_CHECK(chunks(locations)
+                    == (std::vector<int32_t>{299991, 299994, 299997, 300000, 300000,
+                                             300003, 300006, 300009}));
+
+        locations.clear();
+        index.lookupRange(-100, 2, locations);
+        BOOST_CHECK(chunks(locations) == (std::vector<int32_t>{0}));
+
+        locations.clear();
+        index.lookupRange(10, 5, locations);
+        BOOST_CHECK(locations.empty());
+
+        locations.clear();
+        index.lookupRange(0, 999999, locations);
+        BOOST_CHECK_EQUAL(locations.size(), index.size());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(NegativeAndLargeKeys) {
+    TmpPath tmp;
+    int64_t const minKey = std::numeric_limits<int64_t>::min();
+    int64_t const maxKey = std::numeric_limits<int64_t>::max();
+    std::vector<int64_t> const keys = {minKey, -1000, -1, 0, 1LL << 40, maxKey};
+    {
+        SecondaryIndexFileWriter writer(tmp.path, 2);
+        for (size_t i = 0; i != keys.size(); ++i) {
+            writer.add(keys[i], Location{int32_t(i), 0});
+        }
+    }
+    SecondaryIndexFile index(tmp.path);
+    for (size_t i = 0; i != keys.size(); ++i) {
+        std::vector<Location> locations;
+        index.lookup({keys[i]}, locations);
+        BOOST_REQUIRE_EQUAL(locations.size(), 1U);
+        BOOST_CHECK_EQUAL(locations[0].chunkId, int32_t(i));
+    }
+    std::vector<Location> locations;
+    index.lookupRange(minKey, maxKey, locations);
+    BOOST_CHECK_EQUAL(locations.size(), keys.size());
+}
+
+BOOST_AUTO_TEST_CASE(Empty) {
+    TmpPath tmp;
+    SecondaryIndexFileWriter(tmp.path).close();
+    SecondaryIndexFile index(tmp.path);
+    BOOST_CHECK_EQUAL(index.size(), 0U);
+    std::vector<Location> locations;
+    index.lookup({1, 2, 3}, locations);
+    index.lookupRange(0, 10, locations);
+    BOOST_CHECK(locations.empty());
+}
+
+BOOST_AUTO_TEST_CASE(Errors) {
+    TmpPath tmp;
+    BOOST_CHECK_THROW(SecondaryIndexFile("/nonexistent/file"), SecondaryIndexFile::Error);
+    {
+        std::ofstream out(tmp.path);
+        out << "This is not a secondary index file at all";
+    }
+    BOOST_CHECK_THROW(SecondaryIndexFile index(tmp.path), SecondaryIndexFile::Error);
+
+    SecondaryIndexFileWriter writer(tmp.path);
+    writer.add(10, Location{1, 1});
+    BOOST_CHECK_THROW(writer.add(9, Location{1, 1}), SecondaryIndexFile::Error);
+    BOOST_CHECK_THROW(writer.add(11, Location{-1, 1}), SecondaryIndexFile::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
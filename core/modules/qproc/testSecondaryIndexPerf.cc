@@ -0,0 +1,111 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+/// Micro-benchmark for secondary index lookups of 10^3 to 10^6 keys.
+/// Always reports the rate of SecondaryIndexCache misses and hits. If MySQL
+/// parameters are given then also times SecondaryIndex::lookup() of keys
+/// 1..n in db.table, once with a cold and once with a warm cache. Not run
+/// as a unit test.
+///
+/// Usage: testSecondaryIndexPerf [socket user password db table keyColumn]
+
+// System headers
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Qserv headers
+#include "mysql/MySqlConfig.h"
+#include "qproc/SecondaryIndex.h"
+#include "qproc/SecondaryIndexCache.h"
+#include "query/Constraint.h"
+
+namespace {
+
+using lsst::qserv::qproc::SecondaryIndex;
+using lsst::qserv::qproc::SecondaryIndexCache;
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(std::string const& name, int64_t keys, double secs) {
+    std::cout << std::setw(24) << std::left << name
+              << " keys=" << keys
+              << " sec=" << std::fixed << std::setprecision(3) << secs
+              << " keys/s=" << std::setprecision(0) << (secs > 0 ? keys / secs : 0) << std::endl;
+}
+
+/// Fill the cache with n keys then read them all back.
+void runCache(int64_t n) {
+    SecondaryIndexCache cache(n);
+    auto table = cache.getTableKey("qservMeta.LSST__Object");
+    auto start = std::chrono::steady_clock::now();
+    SecondaryIndexCache::Location loc;
+    for (int64_t key = 1; key <= n; ++key) {
+        if (not cache.get(table, key, loc)) {
+            cache.put(table, key, SecondaryIndexCache::Location{int32_t(key % 10000), 0});
+        }
+    }
+    report("cache miss+put", n, secondsSince(start));
+    start = std::chrono::steady_clock::now();
+    int64_t found = 0;
+    for (int64_t key = 1; key <= n; ++key) {
+        found += cache.get(table, key, loc);
+    }
+    report("cache hit", found, secondsSince(start));
+}
+
+/// Look up keys 1..n twice, the second lookup is served by the cache.
+void runLookup(SecondaryIndex& index, std::string const& db, std::string const& table,
+               std::string const& keyColumn, int64_t n) {
+    lsst::qserv::query::Constraint c;
+    c.name = "sIndex";
+    c.params = {db, table, keyColumn};
+    for (int64_t key = 1; key <= n; ++key) {
+        c.params.push_back(std::to_string(key));
+    }
+    lsst::qserv::query::ConstraintVector cv(1, c);
+    for (auto pass: {"lookup, cold", "lookup, warm"}) {
+        auto start = std::chrono::steady_clock::now();
+        index.lookup(cv);
+        report(pass, n, secondsSince(start));
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    for (int64_t n = 1000; n <= 1000000; n *= 10) {
+        runCache(n);
+    }
+    if (argc > 6) {
+        lsst::qserv::mysql::MySqlConfig config(argv[2], argv[3], argv[1]);
+        for (int64_t n = 1000; n <= 1000000; n *= 10) {
+            SecondaryIndex index(config, 10000, 4, n);
+            runLookup(index, argv[4], argv[5], argv[6], n);
+        }
+    }
+    return 0;
+}
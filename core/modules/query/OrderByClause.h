@@ -67,8 +67,8 @@ public:
 
     std::string sqlFragment() const;
     std::shared_ptr<ValueExpr>& getExpr() { return _expr; }
-    Order getOrder() const;
-    std::string getCollate() const;
+    Order getOrder() const { return _order; }
+    std::string getCollate() const { return _collate; }
     void renderTo(QueryTemplate& qt) const;
 
 private:
@@ -96,6 +96,9 @@ public:
     std::shared_ptr<OrderByClause> copySyntax();
 
     void findValueExprs(ValueExprPtrVector& list);
+
+    /// @return the terms, in order.
+    OrderByTermVector& getTerms() { return *_terms; }
 private:
     friend std::ostream& operator<<(std::ostream& os, OrderByClause const& oc);
     friend class parser::ModFactory;
@@ -39,6 +39,7 @@
 #include "qana/QueryMapping.h"
 #include "query/DbTablePair.h"
 #include "query/TableAlias.h"
+#include "global/constants.h"
 #include "global/stringTypes.h"
 
 namespace lsst {
@@ -60,7 +61,7 @@ class QueryContext {
 public:
     typedef std::shared_ptr<QueryContext> Ptr;
 
-    QueryContext() : chunkCount(0), needsMerge(false) {}
+    QueryContext() : chunkCount(0), needsMerge(false), rowLimit(NOTSET) {}
     typedef std::vector<std::shared_ptr<QsRestrictor> > RestrList;
 
     std::shared_ptr<css::CssAccess> css;  ///< interface to CSS
@@ -83,6 +84,10 @@ public:
     int chunkCount; //< -1: all, 0: none, N: #chunks
 
     bool needsMerge; ///< Does this query require a merge/post-processing step?
+    /// Number of rows from any chunks that satisfies the query, so that chunks
+    /// need not be dispatched once that many rows are merged. NOTSET if the
+    /// results of all chunks are needed.
+    int rowLimit;
 
     css::StripingParams getDbStriping() {
         return css->getDbStriping(dominantDb); }
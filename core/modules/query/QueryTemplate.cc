@@ -35,8 +35,11 @@
 #include "query/QueryTemplate.h"
 
 // System headers
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 
 // Third-party headers
 
@@ -45,6 +48,7 @@
 
 // Qserv headers
 #include "global/sqltoken.h" // sqlShouldSeparate
+#include "global/stringUtil.h"
 #include "query/ColumnRef.h"
 #include "query/TableRef.h"
 
@@ -87,6 +91,34 @@ namespace lsst {
 namespace qserv {
 namespace query {
 
+namespace {
+
+/// Stands for placeholder values when deciding whether entries of a
+/// compiled template are separated
+std::string const sampleValue("0");
+
+/// Replaces placeholders by values in each entry, one placeholder after another
+class ReplaceMapping : public QueryTemplate::EntryMapping {
+public:
+    ReplaceMapping(std::vector<std::string> const& placeholders,
+                   std::vector<std::string> const& values)
+        : _placeholders(placeholders), _values(values) {}
+
+    virtual std::shared_ptr<QueryTemplate::Entry> mapEntry(QueryTemplate::Entry const& e) const {
+        std::string s = e.getValue();
+        for (size_t k = 0; k != _placeholders.size(); ++k) {
+            s = replaceAll(s, _placeholders[k], _values[k]);
+        }
+        return std::make_shared<QueryTemplate::StringEntry>(s);
+    }
+
+private:
+    std::vector<std::string> const& _placeholders;
+    std::vector<std::string> const& _values;
+};
+
+} // anonymous namespace
+
 struct MappingWrapper {
     MappingWrapper(QueryTemplate::EntryMapping const& em_,
                    QueryTemplate& qt_)
@@ -176,6 +208,105 @@ QueryTemplate::generate(EntryMapping const& em) const {
     return newQt.sqlFragment();
 }
 
+QueryTemplate::Compiled
+QueryTemplate::compile(std::vector<std::string> const& placeholders) const {
+    Compiled c;
+    c._source = *this;
+    c._placeholders = placeholders;
+    std::string literal;
+    std::string lastEntry;
+    // Entry text split at placeholders, slot is -1 for text pieces
+    typedef std::vector<std::pair<std::string, int> > PieceVector;
+    for(auto const& entry : _entries) {
+        if (!entry) {
+            throw std::invalid_argument("NULL QueryTemplate::Entry");
+        }
+        PieceVector pieces(1, std::make_pair(entry->getValue(), -1));
+        for(size_t k = 0; k != placeholders.size(); ++k) {
+            std::string const& pat = placeholders[k];
+            if (pat.empty()) continue;
+            PieceVector split;
+            for(auto const& piece : pieces) {
+                if (piece.second >= 0) {
+                    split.push_back(piece);
+                    continue;
+                }
+                size_t i = 0;
+                for(size_t j = piece.first.find(pat); j != std::string::npos;
+                    i = j + pat.size(), j = piece.first.find(pat, i)) {
+                    split.push_back(std::make_pair(piece.first.substr(i, j - i), -1));
+                    split.push_back(std::make_pair(std::string(), int(k)));
+                }
+                split.push_back(std::make_pair(piece.first.substr(i), -1));
+            }
+            pieces.swap(split);
+        }
+        // Separation is decided on the entry as it would be generated
+        std::string entryStr;
+        for(auto const& piece : pieces) {
+            entryStr += piece.second < 0 ? piece.first : sampleValue;
+        }
+        if (entryStr.empty()) {
+            continue;
+        }
+        if (!lastEntry.empty() &&
+           sql::sqlShouldSeparate(lastEntry, *lastEntry.rbegin(), entryStr.at(0))) {
+            literal += ' ';
+        }
+        for(auto const& piece : pieces) {
+            if (piece.second < 0) {
+                literal += piece.first;
+            } else {
+                c._literalSize += literal.size();
+                c._literals.push_back(literal);
+                c._slots.push_back(piece.second);
+                literal.clear();
+            }
+        }
+        lastEntry = entryStr;
+    }
+    c._literalSize += literal.size();
+    c._literals.push_back(literal);
+    return c;
+}
+
+////////////////////////////////////////////////////////////////////////
+// QueryTemplate::Compiled
+////////////////////////////////////////////////////////////////////////
+std::string
+QueryTemplate::Compiled::render(std::vector<std::string> const& values) const {
+    if (values.size() < _placeholders.size()) {
+        throw std::invalid_argument("Missing QueryTemplate placeholder value");
+    }
+    if (_literals.empty()) { // default-constructed
+        return std::string();
+    }
+    size_t size = _literalSize;
+    for(size_t k = 0; k != _placeholders.size(); ++k) {
+        std::string const& v = values[k];
+        if (v.empty() || !std::isalnum(static_cast<unsigned char>(v.front()))
+            || !std::isalnum(static_cast<unsigned char>(v.back()))) {
+            return _source.generate(ReplaceMapping(_placeholders, values));
+        }
+        for(auto const& pat : _placeholders) {
+            if (!pat.empty() && v.find(pat) != std::string::npos) {
+                return _source.generate(ReplaceMapping(_placeholders, values));
+            }
+        }
+    }
+    for(int slot : _slots) {
+        size += values[slot].size();
+    }
+    std::string result;
+    result.reserve(size);
+    for(size_t i = 0; i != _slots.size(); ++i) {
+        result += _literals[i];
+        result += values[_slots[i]];
+    }
+    result += _literals.back();
+    return result;
+}
+
 void
 QueryTemplate::clear() {
     _entries.clear();
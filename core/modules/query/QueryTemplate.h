@@ -105,6 +105,8 @@ public:
         virtual std::shared_ptr<Entry> mapEntry(Entry const& e) const = 0;
     };
 
+    class Compiled;
+
     QueryTemplate() {}
 
     void append(std::string const& s);
@@ -132,6 +134,15 @@ public:
     friend std::ostream& operator<<(std::ostream& os, QueryTemplate const& queryTemplate);
 
     std::string generate(EntryMapping const& em) const;
+
+    /** Flatten the template for generating many queries that differ only in
+     *  placeholder values, see Compiled.
+     *
+     *  @param placeholders: strings to be replaced in entries, in the order
+     *                       the replacements are applied.
+     */
+    Compiled compile(std::vector<std::string> const& placeholders) const;
+
     void clear();
 
     template <class T>
@@ -145,6 +156,36 @@ private:
     EntryPtrVector _entries;
 };
 
+/// QueryTemplate::Compiled is a QueryTemplate rendered once into literal
+/// segments separated by placeholder slots. Rendering a query is then one
+/// pass over the segments into a preallocated string.
+///
+/// Whether entries are separated by a space depends on their first and last
+/// characters, so the segments assume values that are non-empty and begin
+/// and end with a letter or digit, as chunk numbers do. Other values are
+/// rendered through generate() on the original template.
+class QueryTemplate::Compiled {
+public:
+    Compiled() : _literalSize(0) {}
+
+    /** Render the query
+     *
+     *  @param values: values[i] replaces placeholder i given to compile()
+     *  @return the same string as generate() with a mapping replacing each
+     *          placeholder in every entry by its value.
+     */
+    std::string render(std::vector<std::string> const& values) const;
+
+private:
+    friend class QueryTemplate;
+
+    QueryTemplate _source;
+    std::vector<std::string> _placeholders;
+    std::vector<std::string> _literals; ///< one more than _slots
+    std::vector<int> _slots; ///< placeholder index following each literal
+    size_t _literalSize; ///< sum of literal sizes
+};
+
 }}} // namespace lsst::qserv::query
 
 #endif // LSST_QSERV_QUERY_QUERYTEMPLATE_H
@@ -37,6 +37,7 @@
 #include "query/ColumnRef.h"
 #include "query/Predicate.h"
 #include "query/QueryContext.h"
+#include "query/QueryTemplate.h"
 #include "query/SelectStmt.h"
 #include "query/SqlSQL2Tokens.h"
 #include "query/TestFactory.h"
@@ -229,6 +230,47 @@ BOOST_AUTO_TEST_CASE(DM_737_REGRESSION) {
     BOOST_CHECK_EQUAL(str0.str(), "WHERE (refObjectId IS NULL OR flags<>2) AND foo!=bar AND baz<3.14159");
 }
 
+BOOST_AUTO_TEST_CASE(CompiledQueryTemplate) {
+    // Mapping applying replacements in order, as qana::QueryMapping does
+    struct Replace : public QueryTemplate::EntryMapping {
+        std::vector<std::string> pats, values;
+        virtual std::shared_ptr<QueryTemplate::Entry> mapEntry(QueryTemplate::Entry const& e) const {
+            std::string s = e.getValue();
+            for (size_t k = 0; k != pats.size(); ++k) {
+                for (size_t i = s.find(pats[k]); i != std::string::npos; i = s.find(pats[k], i)) {
+                    s.replace(i, pats[k].size(), values[k]);
+                    i += values[k].size();
+                }
+            }
+            return std::make_shared<QueryTemplate::StringEntry>(s);
+        }
+    };
+    QueryTemplate qt;
+    for (auto s : {"SELECT", "o1.ra", ",", "o2.ra", "FROM"}) qt.append(s);
+    qt.append(QueryTemplate::TableEntry("LSST", "Object_%CC%"));
+    qt.append("AS");
+    qt.append("o1");
+    qt.append(",");
+    qt.append(QueryTemplate::TableEntry("Subchunks_LSST_%CC%", "Object_%CC%_%SS%"));
+    for (auto s : {"AS", "o2", "WHERE", "o1.x", "=", "%SS%", "AND", "%CC%%SS%", "", "LIMIT", "1"}) {
+        qt.append(s);
+    }
+    Replace m;
+    m.pats = {"%CC%", "%SS%"};
+    auto compiled = qt.compile(m.pats);
+    for (auto values : std::vector<std::vector<std::string>>{
+            {"1234", "56"}, {"0", "0"}, {"-1", "7"}, {"12", ""}, {"x%SS%y", "3"}}) {
+        m.values = values;
+        BOOST_CHECK_EQUAL(compiled.render(values), qt.generate(m));
+    }
+    m.values = {"1234", "56"};
+    BOOST_CHECK_EQUAL(qt.generate(m),
+        "SELECT o1.ra,o2.ra FROM LSST.Object_1234 AS o1,Subchunks_LSST_1234.Object_1234_56 "
+        "AS o2 WHERE o1.x=56 AND 123456 LIMIT 1");
+    BOOST_CHECK_THROW(compiled.render({"1"}), std::invalid_argument);
+    BOOST_CHECK_EQUAL(QueryTemplate::Compiled().render({}), "");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }}} // lsst::qserv::query
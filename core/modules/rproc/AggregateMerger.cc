@@ -0,0 +1,624 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "rproc/AggregateMerger.h"
+
+// System headers
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <string.h>
+
+// Third-party headers
+#include "boost/algorithm/string/case_conv.hpp"
+#include "boost/algorithm/string/predicate.hpp"
+#include <mysql/mysql.h>
+
+// Qserv headers
+#include "proto/ColumnBatchBuilder.h"
+#include "query/FuncExpr.h"
+#include "query/GroupByClause.h"
+#include "query/SelectList.h"
+#include "query/SelectStmt.h"
+#include "query/ValueExpr.h"
+#include "query/ValueFactor.h"
+
+namespace {
+
+using lsst::qserv::query::ValueFactor;
+
+/// Largest number of digits of an exact value, sums beyond it overflow.
+int const maxDigits = 36;
+
+/// Largest scale of a MySQL DECIMAL
+int const maxScale = 30;
+
+/// Decimals MySQL adds to the scale of a DECIMAL division (div_precision_increment)
+int const divScaleIncrement = 4;
+
+__int128 pow10(int n) {
+    __int128 p = 1;
+    for (int i = 0; i < n; ++i) {
+        p *= 10;
+    }
+    return p;
+}
+
+__int128 const exactLimit = pow10(maxDigits);
+
+/// @return the upper case name of the function that 'factor' applies to a
+/// single column, whose name goes to 'column', or an empty string.
+std::string columnFunction(ValueFactor const& factor, std::string& column) {
+    if (factor.getType() != ValueFactor::FUNCTION && factor.getType() != ValueFactor::AGGFUNC) {
+        return std::string();
+    }
+    auto funcExpr = factor.getFuncExpr();
+    if (!funcExpr || funcExpr->params.size() != 1 || !funcExpr->params[0]
+        || !funcExpr->params[0]->isColumnRef()) {
+        return std::string();
+    }
+    column = funcExpr->params[0]->getColumnRef()->column;
+    return boost::algorithm::to_upper_copy(funcExpr->name);
+}
+
+/// @return the scale of a DECIMAL sql type, -1 if it can not be read.
+int decimalScale(std::string const& sqlType) {
+    if (!boost::algorithm::istarts_with(sqlType, "DECIMAL")) {
+        return -1;
+    }
+    std::size_t const comma = sqlType.find(',');
+    if (comma == std::string::npos) {
+        return 0;
+    }
+    int const scale = std::atoi(sqlType.c_str() + comma + 1);
+    return (scale >= 0 && scale <= maxScale) ? scale : -1;
+}
+
+std::string decimalType(int scale) {
+    return "DECIMAL(65," + std::to_string(scale) + ")";
+}
+
+/// Parse decimal text with at most 'scale' decimals into a value scaled by
+/// 10^scale.
+/// @return false if the text is not such a number or has too many digits.
+bool parseExact(char const* begin, char const* end, int scale, __int128& out) {
+    char const* i = begin;
+    bool const negative = (i != end && *i == '-');
+    if (i != end && (*i == '-' || *i == '+')) {
+        ++i;
+    }
+    __int128 value = 0;
+    int digits = 0;
+    int decimals = -1;
+    for (; i != end; ++i) {
+        if (*i == '.' && decimals < 0) {
+            decimals = 0;
+            continue;
+        }
+        if (*i < '0' || *i > '9' || ++digits > maxDigits
+            || (decimals >= 0 && ++decimals > scale)) {
+            return false;
+        }
+        value = value * 10 + (*i - '0');
+    }
+    if (digits == 0) {
+        return false;
+    }
+    for (int d = std::max(decimals, 0); d < scale; ++d) {
+        if (++digits > maxDigits) {
+            return false;
+        }
+        value *= 10;
+    }
+    out = negative ? -value : value;
+    return true;
+}
+
+} // anonymous namespace
+
+namespace lsst {
+namespace qserv {
+namespace rproc {
+
+AggregateMerger::Ptr AggregateMerger::newMerger(query::SelectStmt& mergeStmt) {
+    if (mergeStmt.getDistinct() || mergeStmt.hasHaving() || mergeStmt.hasOrderBy()
+        || mergeStmt.hasLimit()) {
+        return nullptr;
+    }
+    auto selectList = mergeStmt.getSelectList().getValueExprList();
+    if (!selectList || selectList->empty()) {
+        return nullptr;
+    }
+    Ptr merger(new AggregateMerger());
+    if (mergeStmt.hasGroupBy()) {
+        query::ValueExprPtrVector groupBy;
+        mergeStmt.getGroupBy().findValueExprs(groupBy);
+        for (auto const& expr : groupBy) {
+            if (!expr || !expr->isColumnRef()) {
+                return nullptr;
+            }
+            merger->_keys.push_back(merger->_addInput(expr->getColumnRef()->column));
+        }
+    }
+    for (auto const& expr : *selectList) {
+        if (!expr || !expr->isFactor() || !expr->getFactor()) {
+            return nullptr;
+        }
+        ValueFactor const& factor = *expr->getFactor();
+        Item item;
+        item.name = expr->getAlias();
+        std::string column;
+        std::string const function = columnFunction(factor, column);
+        if (expr->isColumnRef()) {
+            // A column must be one of the GROUP BY columns to have a single value.
+            column = expr->getColumnRef()->column;
+            item.type = Item::GROUP;
+            item.input[0] = merger->_addInput(column);
+            auto key = std::find(merger->_keys.begin(), merger->_keys.end(), item.input[0]);
+            if (key == merger->_keys.end()) {
+                return nullptr;
+            }
+            item.slot[0] = key - merger->_keys.begin();
+            if (item.name.empty()) {
+                item.name = column;
+            }
+        } else if (function == "SUM" || function == "MIN" || function == "MAX") {
+            item.type = (function == "SUM") ? Item::SUM : (function == "MIN") ? Item::MIN : Item::MAX;
+            item.input[0] = merger->_addInput(column);
+            item.slot[0] = merger->_addAccumulator(item.type, item.input[0]);
+        } else if (factor.getType() == ValueFactor::EXPR && factor.getExpr()) {
+            // AVG is merged as (SUM(sum)/SUM(count)).
+            auto const& factorOps = factor.getExpr()->getFactorOps();
+            std::string countColumn;
+            if (factorOps.size() != 2 || factorOps[0].op != query::ValueExpr::DIVIDE
+                || !factorOps[0].factor || !factorOps[1].factor
+                || columnFunction(*factorOps[0].factor, column) != "SUM"
+                || columnFunction(*factorOps[1].factor, countColumn) != "SUM") {
+                return nullptr;
+            }
+            item.type = Item::AVG;
+            item.input[0] = merger->_addInput(column);
+            item.input[1] = merger->_addInput(countColumn);
+            item.slot[0] = merger->_addAccumulator(Item::SUM, item.input[0]);
+            item.slot[1] = merger->_addAccumulator(Item::SUM, item.input[1]);
+        } else {
+            return nullptr;
+        }
+        if (item.name.empty()) {
+            // MySQL names the column after the expression text.
+            item.name = expr->sqlFragment();
+        }
+        merger->_items.push_back(item);
+    }
+    return merger;
+}
+
+bool AggregateMerger::setSchema(proto::RowSchema const& schema) {
+    for (auto& input : _inputs) {
+        input.column = -1;
+        for (int i = 0, e = schema.columnschema_size(); i != e; ++i) {
+            if (boost::algorithm::iequals(schema.columnschema(i).name(), input.name)) {
+                if (input.column >= 0) {
+                    return false; // Ambiguous
+                }
+                input.column = i;
+            }
+        }
+        if (input.column < 0) {
+            return false;
+        }
+        input.schema = schema.columnschema(input.column);
+        if (!input.schema.has_mysqltype()) {
+            return false;
+        }
+        switch (input.schema.mysqltype()) {
+        case MYSQL_TYPE_TINY:
+        case MYSQL_TYPE_SHORT:
+        case MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_INT24:
+        case MYSQL_TYPE_LONGLONG:
+            input.exact = true;
+            input.scale = 0;
+            break;
+        case MYSQL_TYPE_DECIMAL:
+        case MYSQL_TYPE_NEWDECIMAL:
+            input.exact = true;
+            input.scale = decimalScale(input.schema.sqltype());
+            if (input.scale < 0) {
+                return false;
+            }
+            break;
+        case MYSQL_TYPE_FLOAT:
+        case MYSQL_TYPE_DOUBLE:
+            input.exact = false;
+            break;
+        default:
+            // Strings and dates compare and group according to their type and
+            // collation, leave them to MySQL.
+            return false;
+        }
+    }
+    if (_keys.empty()) {
+        // Without GROUP BY there is a single row, even without any partial rows.
+        _groups.emplace(std::string(), 0);
+        _values.resize(_accInputs.size());
+    }
+    return true;
+}
+
+bool AggregateMerger::add(proto::Result const& result, std::string& msg) {
+    int const rowCount = (result.columnbatch_size() > 0) ? result.rowcount() : result.row_size();
+    std::size_t const keyCount = _keys.size();
+    std::size_t const stride = keyCount + _accInputs.size();
+    std::vector<Value> keys(keyCount);
+    std::string key;
+    Value value;
+    for (int row = 0; row < rowCount; ++row) {
+        key.clear();
+        for (std::size_t k = 0; k < keyCount; ++k) {
+            if (!_read(result, row, _inputs[_keys[k]], keys[k], msg)) {
+                return false;
+            }
+            _appendKey(key, keys[k], _inputs[_keys[k]].exact);
+        }
+        auto inserted = _groups.emplace(key, _groups.size());
+        std::size_t const base = inserted.first->second * stride;
+        if (inserted.second) {
+            _values.resize(base + stride);
+            std::copy(keys.begin(), keys.end(), _values.begin() + base);
+        }
+        for (std::size_t a = 0; a < _accInputs.size(); ++a) {
+            Input const& input = _inputs[_accInputs[a]];
+            if (!_read(result, row, input, value, msg)) {
+                return false;
+            }
+            if (value.isNull) {
+                continue; // Aggregates ignore NULL.
+            }
+            Value& acc = _values[base + keyCount + a];
+            if (acc.isNull) {
+                acc = value;
+                continue;
+            }
+            switch (_accTypes[a]) {
+            case Item::SUM:
+                if (input.exact) {
+                    acc.exact += value.exact;
+                    if (acc.exact >= exactLimit || acc.exact <= -exactLimit) {
+                        msg = "Sum of " + input.name + " overflowed";
+                        return false;
+                    }
+                } else {
+                    acc.real += value.real;
+                }
+                break;
+            case Item::MIN:
+                if (_less(value, acc, input.exact)) {
+                    acc = value;
+                }
+                break;
+            case Item::MAX:
+                if (_less(acc, value, input.exact)) {
+                    acc = value;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+std::size_t AggregateMerger::getGroupCount() const {
+    return _groups.size();
+}
+
+bool AggregateMerger::getResult(proto::Result& result, std::string& msg) const {
+    result.set_continues(false);
+    result.set_queryid(0);
+    result.set_jobid(0);
+    result.set_largeresult(false);
+    result.set_transmitsize(0);
+    proto::RowSchema& schema = *result.mutable_rowschema();
+    for (auto const& item : _items) {
+        proto::ColumnSchema* cs = schema.add_columnschema();
+        Input const& input = _inputs[item.input[0]];
+        bool exact = input.exact;
+        int scale = input.scale;
+        switch (item.type) {
+        case Item::GROUP:
+        case Item::MIN:
+        case Item::MAX:
+            *cs = input.schema;
+            break;
+        case Item::AVG:
+            exact = exact && _inputs[item.input[1]].exact;
+            scale = std::min(scale + divScaleIncrement, maxScale);
+            // Fall through
+        case Item::SUM:
+            cs->set_sqltype(exact ? decimalType(scale) : "DOUBLE");
+            cs->set_mysqltype(exact ? MYSQL_TYPE_NEWDECIMAL : MYSQL_TYPE_DOUBLE);
+            break;
+        }
+        cs->set_name(item.name);
+        cs->set_hasdefault(false);
+        cs->clear_defaultvalue();
+    }
+
+    // Rows in GROUP BY order, NULL first, as MySQL returns them.
+    std::size_t const keyCount = _keys.size();
+    std::size_t const stride = keyCount + _accInputs.size();
+    std::vector<std::size_t> order(_groups.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this, keyCount, stride](std::size_t a, std::size_t b) {
+        for (std::size_t k = 0; k < keyCount; ++k) {
+            Value const& x = _values[a * stride + k];
+            Value const& y = _values[b * stride + k];
+            bool const exact = _inputs[_keys[k]].exact;
+            if (x.isNull != y.isNull) {
+                return x.isNull;
+            }
+            if (x.isNull) {
+                continue;
+            }
+            if (_less(x, y, exact)) {
+                return true;
+            }
+            if (_less(y, x, exact)) {
+                return false;
+            }
+        }
+        return false;
+    });
+
+    Value average;
+    for (std::size_t group : order) {
+        Value const* values = &_values[group * stride];
+        proto::RowBundle* row = result.add_row();
+        for (auto const& item : _items) {
+            Input const& input = _inputs[item.input[0]];
+            Value const* value = &values[keyCount + item.slot[0]];
+            bool exact = input.exact;
+            int scale = input.scale;
+            if (item.type == Item::GROUP) {
+                value = &values[item.slot[0]];
+            } else if (item.type == Item::AVG) {
+                Input const& countInput = _inputs[item.input[1]];
+                if (!_average(*value, input, values[keyCount + item.slot[1]], countInput,
+                              average, msg)) {
+                    return false;
+                }
+                value = &average;
+                exact = exact && countInput.exact;
+                scale = std::min(scale + divScaleIncrement, maxScale);
+            }
+            row->add_isnull(value->isNull);
+            row->add_column(value->isNull ? std::string() : _format(*value, exact, scale));
+        }
+    }
+    result.set_rowcount(order.size());
+    return true;
+}
+
+int AggregateMerger::_addInput(std::string const& name) {
+    for (std::size_t i = 0; i < _inputs.size(); ++i) {
+        if (boost::algorithm::iequals(_inputs[i].name, name)) {
+            return i;
+        }
+    }
+    Input input;
+    input.name = name;
+    _inputs.push_back(input);
+    return _inputs.size() - 1;
+}
+
+int AggregateMerger::_addAccumulator(Item::Type type, int input) {
+    _accTypes.push_back(type);
+    _accInputs.push_back(input);
+    return _accInputs.size() - 1;
+}
+
+/// Read the value of 'input' in row 'row' of 'result'.
+bool AggregateMerger::_read(proto::Result const& result, int row, Input const& input,
+                            Value& value, std::string& msg) const {
+    using Builder = proto::ColumnBatchBuilder;
+    value = Value();
+    char const* text = nullptr;
+    std::size_t length = 0;
+    if (result.columnbatch_size() > 0) {
+        // Protocol 3, the message has passed checkResultRows().
+        proto::ColumnBatch const& batch = result.columnbatch(input.column);
+        if (Builder::isNull(batch.nulls(), row)) {
+            return true;
+        }
+        std::size_t const width = Builder::fixedWidth(batch.encoding());
+        if (width != 0) {
+            std::uint64_t const bits = Builder::getUint(&batch.fixed()[width * row], width);
+            value.isNull = false;
+            switch (batch.encoding()) {
+            case proto::ColumnBatch::INT64:
+                if (input.exact) {
+                    value.exact = static_cast<std::int64_t>(bits) * pow10(input.scale);
+                } else {
+                    value.real = static_cast<std::int64_t>(bits);
+                }
+                break;
+            case proto::ColumnBatch::UINT64:
+                if (input.exact) {
+                    value.exact = bits * pow10(input.scale);
+                } else {
+                    value.real = bits;
+                }
+                break;
+            case proto::ColumnBatch::DOUBLE:
+                if (input.exact) {
+                    msg = "Unexpected floating point value in " + input.name;
+                    return false;
+                }
+                memcpy(&value.real, &bits, sizeof(value.real));
+                break;
+            case proto::ColumnBatch::FLOAT: {
+                if (input.exact) {
+                    msg = "Unexpected floating point value in " + input.name;
+                    return false;
+                }
+                std::uint32_t const floatBits = bits;
+                float f;
+                memcpy(&f, &floatBits, sizeof(f));
+                value.real = f;
+                break;
+            }
+            default:
+                break;
+            }
+            return true;
+        }
+        std::size_t const begin = (row == 0) ? 0 : Builder::getUint(&batch.offsets()[4 * (row - 1)], 4);
+        std::size_t const end = Builder::getUint(&batch.offsets()[4 * row], 4);
+        text = batch.data().data() + begin;
+        length = end - begin;
+    } else {
+        proto::RowBundle const& rowBundle = result.row(row);
+        if (input.column >= rowBundle.column_size()) {
+            msg = "Missing column " + input.name + " in result row";
+            return false;
+        }
+        if (input.column < rowBundle.isnull_size() && rowBundle.isnull(input.column)) {
+            return true;
+        }
+        text = rowBundle.column(input.column).data();
+        length = rowBundle.column(input.column).size();
+    }
+    value.isNull = false;
+    if (input.exact) {
+        if (!parseExact(text, text + length, input.scale, value.exact)) {
+            msg = "Invalid value of " + input.name + ": " + std::string(text, length);
+            return false;
+        }
+    } else {
+        std::string const str(text, length);
+        char* parsedEnd = nullptr;
+        value.real = std::strtod(str.c_str(), &parsedEnd);
+        if (str.empty() || parsedEnd != str.c_str() + str.size()) {
+            msg = "Invalid value of " + input.name + ": " + str;
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Compute sum/count as MySQL does: exactly, rounded half away from zero to
+/// divScaleIncrement more decimals than the sum, if both are exact, and in
+/// floating point otherwise. Division by zero is NULL.
+bool AggregateMerger::_average(Value const& sum, Input const& sumInput, Value const& count,
+                               Input const& countInput, Value& average, std::string& msg) {
+    average = Value();
+    if (sum.isNull || count.isNull) {
+        return true;
+    }
+    if (!sumInput.exact || !countInput.exact) {
+        // Exact values are converted through their text, as MySQL does.
+        double const s = sumInput.exact ? std::strtod(_format(sum, true, sumInput.scale).c_str(), nullptr)
+                                        : sum.real;
+        double const c = countInput.exact ? std::strtod(_format(count, true, countInput.scale).c_str(), nullptr)
+                                          : count.real;
+        if (c != 0) {
+            average.isNull = false;
+            average.real = s / c;
+        }
+        return true;
+    }
+    if (count.exact == 0) {
+        return true;
+    }
+    // sum/10^s1 / (count/10^s2) = result/10^scale
+    int const scale = std::min(sumInput.scale + divScaleIncrement, maxScale);
+    int const shift = scale - sumInput.scale + countInput.scale;
+    __int128 const magnitude = (sum.exact < 0) ? -sum.exact : sum.exact;
+    if (shift > maxDigits || magnitude >= exactLimit / pow10(shift)) {
+        msg = "Average of " + sumInput.name + " overflowed";
+        return false;
+    }
+    __int128 const numerator = sum.exact * pow10(shift);
+    __int128 quotient = numerator / count.exact;
+    __int128 const remainder = numerator % count.exact;
+    __int128 const absRemainder = (remainder < 0) ? -remainder : remainder;
+    __int128 const absCount = (count.exact < 0) ? -count.exact : count.exact;
+    if (2 * absRemainder >= absCount) {
+        quotient += ((numerator < 0) != (count.exact < 0)) ? -1 : 1;
+    }
+    average.isNull = false;
+    average.exact = quotient;
+    return true;
+}
+
+bool AggregateMerger::_less(Value const& a, Value const& b, bool exact) {
+    return exact ? a.exact < b.exact : a.real < b.real;
+}
+
+/// Append the encoding of a GROUP BY value to 'key'.
+void AggregateMerger::_appendKey(std::string& key, Value const& value, bool exact) {
+    if (value.isNull) {
+        key.push_back('\0');
+        return;
+    }
+    key.push_back('\1');
+    if (exact) {
+        key.append(reinterpret_cast<char const*>(&value.exact), sizeof(value.exact));
+    } else {
+        double const real = (value.real == 0) ? 0.0 : value.real; // -0 groups with 0
+        key.append(reinterpret_cast<char const*>(&real), sizeof(real));
+    }
+}
+
+/// @return 'value' as text that MySQL reads back as the same value.
+std::string AggregateMerger::_format(Value const& value, bool exact, int scale) {
+    if (!exact) {
+        char buf[32];
+        int const n = snprintf(buf, sizeof(buf), "%.17g", value.real);
+        return std::string(buf, n);
+    }
+    bool const negative = value.exact < 0;
+    unsigned __int128 magnitude = negative ? -static_cast<unsigned __int128>(value.exact)
+                                           : static_cast<unsigned __int128>(value.exact);
+    char buf[64];
+    char* cursor = buf + sizeof(buf);
+    int digits = 0;
+    do {
+        *--cursor = '0' + static_cast<int>(magnitude % 10);
+        magnitude /= 10;
+        if (++digits == scale) {
+            *--cursor = '.';
+        }
+    } while (magnitude != 0 || digits <= scale);
+    if (negative) {
+        *--cursor = '-';
+    }
+    return std::string(cursor, buf + sizeof(buf) - cursor);
+}
+
+}}} // namespace lsst::qserv::rproc
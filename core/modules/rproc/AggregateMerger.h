@@ -0,0 +1,138 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef LSST_QSERV_RPROC_AGGREGATEMERGER_H
+#define LSST_QSERV_RPROC_AGGREGATEMERGER_H
+
+// System headers
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Qserv headers
+#include "proto/worker.pb.h"
+#include "rproc/RowFolder.h"
+
+// Forward declarations
+namespace lsst {
+namespace qserv {
+namespace query {
+    class SelectStmt;
+}}} // End of forward declarations
+
+namespace lsst {
+namespace qserv {
+namespace rproc {
+
+/// AggregateMerger folds the partial aggregates of chunk results into their
+/// final values as the results arrive, so that neither a merge table nor a
+/// final aggregation query is needed. It handles merge statements, as
+/// written by qana::AggregatePlugin, whose select list only has GROUP BY
+/// columns, SUM(), MIN(), MAX() of a column (COUNT is a SUM of counts) and
+/// SUM(a)/SUM(b) (AVG), without DISTINCT, HAVING, ORDER BY or LIMIT.
+/// Memory use grows with the number of groups, not with the number of rows.
+///
+/// Values are combined the way MySQL combines them: integer and DECIMAL
+/// values exactly, AVG of those with 4 more decimals, and floating point
+/// values as doubles. Groups are returned in GROUP BY order.
+///
+/// AggregateMerger is not thread safe.
+class AggregateMerger : public RowFolder {
+public:
+    typedef std::shared_ptr<AggregateMerger> Ptr;
+
+    /// @return a merger for 'mergeStmt', nullptr if its form is not supported.
+    static Ptr newMerger(query::SelectStmt& mergeStmt);
+
+    AggregateMerger(AggregateMerger const&) = delete;
+    AggregateMerger& operator=(AggregateMerger const&) = delete;
+
+    /// @return false if a partial column is not numeric.
+    bool setSchema(proto::RowSchema const& schema) override;
+
+    /// @return false, with a description in 'msg', if a value could not be
+    ///         read or a sum overflowed.
+    bool add(proto::Result const& result, std::string& msg) override;
+
+    /// @return the number of groups so far.
+    std::size_t getGroupCount() const;
+
+    /// @return false, with a description in 'msg', if an average overflowed.
+    bool getResult(proto::Result& result, std::string& msg) const override;
+
+private:
+    typedef __int128 Exact; ///< Integer and DECIMAL values, scaled by 10^scale
+
+    /// A value of a partial column or of an accumulator.
+    struct Value {
+        bool isNull{true};
+        Exact exact{0};
+        double real{0};
+    };
+
+    /// A partial column read by the merger.
+    struct Input {
+        std::string name;
+        int column{-1}; ///< Index in the partial schema
+        bool exact{false}; ///< Integer or DECIMAL, otherwise floating point
+        int scale{0}; ///< Decimals of exact values
+        proto::ColumnSchema schema;
+    };
+
+    /// A column of the final result.
+    struct Item {
+        enum Type { GROUP, SUM, MIN, MAX, AVG };
+        Type type;
+        std::string name; ///< Column name
+        int input[2]; ///< Inputs, [1] is the divisor of AVG
+        int slot[2]; ///< Key or accumulator index of each input
+    };
+
+    AggregateMerger() {}
+
+    int _addInput(std::string const& name);
+    int _addAccumulator(Item::Type type, int input);
+    bool _read(proto::Result const& result, int row, Input const& input, Value& value,
+               std::string& msg) const;
+    static bool _average(Value const& sum, Input const& sumInput, Value const& count,
+                         Input const& countInput, Value& average, std::string& msg);
+    static bool _less(Value const& a, Value const& b, bool exact);
+    static void _appendKey(std::string& key, Value const& value, bool exact);
+    static std::string _format(Value const& value, bool exact, int scale);
+
+    std::vector<Item> _items;
+    std::vector<Input> _inputs;
+    std::vector<int> _keys; ///< Input of each GROUP BY column
+    std::vector<Item::Type> _accTypes; ///< Type of each accumulator
+    std::vector<int> _accInputs; ///< Input of each accumulator
+
+    /// Keys then accumulators of each group, one group after the other.
+    std::vector<Value> _values;
+    /// Group index of each encoded key.
+    std::unordered_map<std::string, std::size_t> _groups;
+};
+
+}}} // namespace lsst::qserv::rproc
+
+#endif // LSST_QSERV_RPROC_AGGREGATEMERGER_H
@@ -39,6 +39,7 @@
 #include "rproc/InfileMerger.h"
 
 // System headers
+#include <algorithm>
 #include <chrono>
 #include <cstddef>
 #include <iostream>
@@ -57,8 +58,12 @@
 #include "global/intTypes.h"
 #include "proto/WorkerResponse.h"
 #include "proto/ProtoImporter.h"
+#include "query/SelectList.h"
 #include "query/SelectStmt.h"
+#include "query/ValueExpr.h"
+#include "rproc/AggregateMerger.h"
 #include "rproc/ProtoRowBuffer.h"
+#include "rproc/TopNMerger.h"
 #include "sql/Schema.h"
 #include "sql/SqlConnection.h"
 #include "sql/SqlResults.h"
@@ -89,6 +94,59 @@ std::string getTimeStampId() {
     // Alternative (for production?) Use boost::uuid to construct ids that are
     // guaranteed to be unique.
 }
+
+/// @return true if 'mergeStmt' only selects columns of the chunk results,
+/// whose names go to 'columns' (left empty for a lone *).
+bool directColumns(lsst::qserv::query::SelectStmt& mergeStmt, std::vector<std::string>& columns) {
+    if (mergeStmt.getDistinct() || mergeStmt.hasGroupBy() || mergeStmt.hasHaving()
+        || mergeStmt.hasOrderBy()) {
+        return false;
+    }
+    auto selectList = mergeStmt.getSelectList().getValueExprList();
+    if (!selectList || selectList->empty()) {
+        return false;
+    }
+    columns.clear();
+    for (auto const& expr : *selectList) {
+        if (!expr) {
+            return false;
+        }
+        if (expr->isStar()) {
+            if (selectList->size() != 1) {
+                return false;
+            }
+        } else if (expr->isColumnRef()) {
+            std::string const& alias = expr->getAlias();
+            columns.push_back(alias.empty() ? expr->getColumnRef()->column : alias);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @return the table schema of result rows described by 'rs'.
+lsst::qserv::sql::Schema schemaFromProto(lsst::qserv::proto::RowSchema const& rs) {
+    lsst::qserv::sql::Schema s;
+    for(int i=0, e=rs.columnschema_size(); i != e; ++i) {
+        lsst::qserv::proto::ColumnSchema const& cs = rs.columnschema(i);
+        lsst::qserv::sql::ColSchema scs;
+        scs.name = cs.name();
+        if (cs.hasdefault()) {
+            scs.defaultValue = cs.defaultvalue();
+            scs.hasDefault = true;
+        } else {
+            scs.hasDefault = false;
+        }
+        if (cs.has_mysqltype()) {
+            scs.colType.mysqlType = cs.mysqltype();
+        }
+        scs.colType.sqlType = cs.sqltype();
+
+        s.columns.push_back(scs);
+    }
+    return s;
+}
 } // anonymous namespace
 
 namespace lsst {
@@ -97,27 +155,55 @@ namespace rproc {
 
 util::ThreadPool::Ptr InfileMerger::_largeResultPool;
 std::mutex largeResultPoolMutex;
+util::ThreadPool::Ptr InfileMerger::_mergePool;
+std::mutex mergePoolMutex;
 
 ////////////////////////////////////////////////////////////////////////
 // InfileMerger public
 ////////////////////////////////////////////////////////////////////////
 InfileMerger::InfileMerger(InfileMergerConfig const& c)
     : _config{c},
-      _mysqlConn{_config.mySqlConfig} {
+      _queuedMax{2 * std::max(1, c.mergeConnections)} {
+    if (_config.mergeStmt) {
+        if (_config.aggregateMerge) {
+            _folder = AggregateMerger::newMerger(*_config.mergeStmt);
+        }
+        if (_folder == nullptr && _config.topNMerge) {
+            _folder = TopNMerger::newMerger(*_config.mergeStmt);
+        }
+        if (_folder == nullptr && _config.directMerge) {
+            _direct = directColumns(*_config.mergeStmt, _directColumns);
+            if (_direct && _config.mergeStmt->hasLimit()) {
+                _directLimited = true;
+                _directLimit = std::max(0, _config.mergeStmt->getLimit());
+            }
+        }
+    }
     _fixupTargetName();
     if (_config.mergeStmt) {
         _config.mergeStmt->setFromListAsTable(_mergeTable);
     }
-    if (!_setupConnection()) {
-        throw InfileMergerError(util::ErrorCode::MYSQLCONNECT, "InfileMerger mysql connect failure.");
+    int const shardCount = std::max(1, _config.mergeConnections);
+    for (int j = 0; j < shardCount; ++j) {
+        std::unique_ptr<MergeShard> shard(new MergeShard(_config.mySqlConfig));
+        if (!_setupConnection(*shard)) {
+            throw InfileMergerError(util::ErrorCode::MYSQLCONNECT, "InfileMerger mysql connect failure.");
+        }
+        _shards.push_back(std::move(shard));
     }
+    _nameShardTables();
 
     if (_largeResultPool == nullptr) {
         throw InfileMergerError(util::ErrorCode::INTERNAL, "InfileMerger largeResultPool uninitialized");
     }
+    if (_shards.size() > 1 && _mergePool == nullptr) {
+        throw InfileMergerError(util::ErrorCode::INTERNAL, "InfileMerger mergePool uninitialized");
+    }
 }
 
 InfileMerger::~InfileMerger() {
+    // Queued loads refer to this instance.
+    _waitForQueuedMerges();
 }
 
 
@@ -133,6 +219,18 @@ int InfileMerger::setLargeResultPoolSize(int size) {
     return size;
 }
 
+int InfileMerger::setMergePoolSize(int size) {
+    std::lock_guard<std::mutex> lock(mergePoolMutex);
+    size = std::max(1, size); // size must be at least 1
+    if (_mergePool == nullptr) {
+        _mergePool = util::ThreadPool::newThreadPool(size, nullptr);
+    } else {
+        _mergePool->resize(size);
+    }
+    LOGS(_log, LOG_LVL_DEBUG, "InfileMerger::setMergePoolSize sz=" << size);
+    return size;
+}
+
 bool InfileMerger::merge(std::shared_ptr<proto::WorkerResponse> response) {
     static std::atomic<int> cmdCount{0}; // Count of large results in process.
     if (!response) {
@@ -151,34 +249,53 @@ bool InfileMerger::merge(std::shared_ptr<proto::WorkerResponse> response) {
          << ", " << response->protoHeader.size()
          << ", rowCount=" << response->result.rowcount()
          << ", row_size=" << response->result.row_size()
+         << ", columnbatch_size=" << response->result.columnbatch_size()
          << ", errCode=" << response->result.has_errorcode()
          << " hasErMsg=" << response->result.has_errormsg() << ")");
 
     if (response->result.has_errorcode() || response->result.has_errormsg()) {
-        _error = util::Error(response->result.errorcode(), response->result.errormsg(), util::ErrorCode::MYSQLEXEC);
-        LOGS(_log, LOG_LVL_ERROR, "Error in response data: " << _error);
+        InfileMergerError const error(response->result.errorcode(), response->result.errormsg(),
+                                      util::ErrorCode::MYSQLEXEC);
+        _setError(error);
+        LOGS(_log, LOG_LVL_ERROR, "Error in response data: " << error);
         return false;
     }
+    // Nothing to do if size is zero.
+    bool const hasColumns = response->result.columnbatch_size() > 0 && response->result.rowcount() > 0;
+    bool const hasRows = response->result.row_size() > 0 || hasColumns;
     if (_needCreateTable) {
         if (!_setupTable(*response)) {
             return false;
         }
     }
-
-    // Nothing to do if size is zero.
-    if (response->result.row_size() == 0) {
+    if (!hasRows) {
         return true;
     }
+    std::string rowsMsg;
+    if (!checkResultRows(response->result, rowsMsg)) {
+        InfileMergerError const error(util::ErrorCode::RESULT_IMPORT,
+                                      queryIdStr + " Invalid result columns: " + rowsMsg);
+        _setError(error);
+        LOGS(_log, LOG_LVL_ERROR, error.getMsg());
+        return false;
+    }
+
+    if (_direct && _directLimited && !_limitRows(response->result)) {
+        return true; // The LIMIT is reached, the rows are not needed.
+    }
+    if (_folding) {
+        return _foldResult(response, queryIdStr);
+    }
+    if (_shards.size() > 1) {
+        // Load in the background so the caller can receive the next message.
+        return _queueMerge(response, queryIdStr);
+    }
 
     bool ret = false;
     auto runSql = [this, &response, &queryIdStr, &ret](util::CmdData*){
-        std::string const virtFile = _infileMgr.prepareSrc(newProtoRowBuffer(response->result));
-        std::string const infileStatement = sql::formLoadInfile(_mergeTable, virtFile);
-        auto start = std::chrono::system_clock::now();
-        ret = _applyMysql(infileStatement);
-        auto end = std::chrono::system_clock::now();
-        auto mergeDur = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-        LOGS(_log, LOG_LVL_DEBUG, queryIdStr << " mergeDur=" << mergeDur.count());
+        MergeShard& shard = *_shards[0];
+        std::lock_guard<std::mutex> lock(shard.mysqlMutex);
+        ret = _loadResult(shard, response, queryIdStr);
     };
     if (largeResult) {
         // Queuing on the limited size thread pool should keep the czar from getting
@@ -198,22 +315,191 @@ bool InfileMerger::merge(std::shared_ptr<proto::WorkerResponse> response) {
         // First transmit, run asap to avoid slowing down the worker.
         runSql(nullptr);
     }
+    _checkRowLimit();
+    return ret;
+}
+
+
+void InfileMerger::setRowLimitHandler(uint64_t rows, std::function<void()> const& func) {
+    _rowLimit = rows;
+    _rowLimitFunc = func;
+}
+
+
+/// Call the row limit handler if enough rows have been merged, at most once.
+/// Must not be called while holding a shard lock, the handler may cancel jobs.
+void InfileMerger::_checkRowLimit() {
+    if (_rowLimit == 0 || _rowsMerged < _rowLimit || _rowLimitReached.exchange(true)) {
+        return;
+    }
+    LOGS(_log, LOG_LVL_DEBUG, "InfileMerger merged " << _rowsMerged << " rows, limit=" << _rowLimit);
+    if (_rowLimitFunc) {
+        _rowLimitFunc();
+    }
+}
+
+
+/// Load the rows of a response into the table of 'shard'.
+/// The caller must hold shard.mysqlMutex.
+bool InfileMerger::_loadResult(MergeShard& shard,
+                               std::shared_ptr<proto::WorkerResponse> const& response,
+                               std::string const& queryIdStr) {
+    std::string const virtFile = shard.infileMgr.prepareSrc(newProtoRowBuffer(response->result));
+    std::string const infileStatement = sql::formLoadInfile(shard.table, virtFile);
+    auto start = std::chrono::system_clock::now();
+    bool ret = _applyMysql(shard, infileStatement);
+    if (ret) {
+        _rowsMerged += response->result.rowcount();
+    }
+    auto end = std::chrono::system_clock::now();
+    auto mergeDur = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    LOGS(_log, LOG_LVL_DEBUG, queryIdStr << " mergeDur=" << mergeDur.count()
+         << " table=" << shard.table);
     return ret;
 }
 
 
-bool InfileMerger::_applyMysql(std::string const& query) {
-    std::lock_guard<std::mutex> lock(_mysqlMutex);
-    if (!_mysqlConn.connected()) {
+/// Drop the rows of 'result' beyond the LIMIT of a direct merge.
+/// @return false if no row is left.
+bool InfileMerger::_limitRows(proto::Result& result) {
+    uint64_t const rowCount = (result.columnbatch_size() > 0) ? result.rowcount() : result.row_size();
+    std::lock_guard<std::mutex> lock(_limitMutex);
+    uint64_t const left = _directLimit - _rowsAccepted;
+    if (rowCount > left) {
+        truncateResultRows(result, left);
+    }
+    _rowsAccepted += std::min(rowCount, left);
+    return left > 0;
+}
+
+/// @return true if the columns of the chunk results are those selected by
+/// a direct merge, so that they can be loaded as they are.
+bool InfileMerger::_directColumnsMatch(proto::RowSchema const& schema) const {
+    if (_directColumns.empty()) {
+        return true; // SELECT *
+    }
+    if (schema.columnschema_size() != static_cast<int>(_directColumns.size())) {
+        return false;
+    }
+    for (int i = 0, e = schema.columnschema_size(); i != e; ++i) {
+        if (schema.columnschema(i).name() != _directColumns[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Name the tables loaded through each shard after _mergeTable.
+void InfileMerger::_nameShardTables() {
+    for (std::size_t j = 0; j < _shards.size(); ++j) {
+        // The first shard loads the merge table, the others load siblings of it.
+        _shards[j]->table = (j == 0) ? _mergeTable : _mergeTable + "_s" + std::to_string(j);
+    }
+}
+
+/// Fold the rows of a response into _folder.
+bool InfileMerger::_foldResult(std::shared_ptr<proto::WorkerResponse> const& response,
+                               std::string const& queryIdStr) {
+    std::string msg;
+    std::lock_guard<std::mutex> lock(_folderMutex);
+    if (!_folder->add(response->result, msg)) {
+        _setMergeError(InfileMergerError(util::ErrorCode::RESULT_IMPORT, queryIdStr + " " + msg));
+        return false;
+    }
+    _rowsMerged += response->result.rowcount();
+    return true;
+}
+
+
+/// Queue a response to be loaded by the merge pool through whichever shard
+/// is free. Blocks while _queuedMax responses are already waiting.
+/// @return false if an earlier queued load failed.
+bool InfileMerger::_queueMerge(std::shared_ptr<proto::WorkerResponse> const& response,
+                               std::string const& queryIdStr) {
+    if (_mergeFailed) {
+        return false;
+    }
+    {
+        std::unique_lock<std::mutex> lock(_queuedMutex);
+        _queuedCV.wait(lock, [this](){ return _queued < _queuedMax; });
+        ++_queued;
+    }
+    auto load = [this, response, queryIdStr](util::CmdData*) {
+        if (!_mergeFailed) {
+            std::unique_lock<std::mutex> shardLock;
+            MergeShard& shard = _lockShard(shardLock);
+            if (!_loadResult(shard, response, queryIdStr)) {
+                _setMergeError(InfileMergerError(util::ErrorCode::MERGEWRITE,
+                               queryIdStr + " Error loading result into " + shard.table));
+            }
+        }
+        _checkRowLimit();
+        std::lock_guard<std::mutex> lock(_queuedMutex);
+        --_queued;
+        _queuedCV.notify_all();
+    };
+    _mergePool->getQueue()->queCmd(std::make_shared<util::Command>(load));
+    return true;
+}
+
+
+/// Lock the first free shard, starting from a round-robin position, or wait
+/// for the shard at that position if all of them are busy.
+/// @return the shard now locked by 'lock'.
+InfileMerger::MergeShard& InfileMerger::_lockShard(std::unique_lock<std::mutex>& lock) {
+    unsigned int const count = _shards.size();
+    unsigned int const start = _nextShard++ % count;
+    for (unsigned int j = 0; j < count; ++j) {
+        MergeShard& shard = *_shards[(start + j) % count];
+        std::unique_lock<std::mutex> tryLock(shard.mysqlMutex, std::try_to_lock);
+        if (tryLock.owns_lock()) {
+            lock = std::move(tryLock);
+            return shard;
+        }
+    }
+    MergeShard& shard = *_shards[start];
+    lock = std::unique_lock<std::mutex>(shard.mysqlMutex);
+    return shard;
+}
+
+
+/// Block until all queued loads have completed.
+void InfileMerger::_waitForQueuedMerges() {
+    std::unique_lock<std::mutex> lock(_queuedMutex);
+    _queuedCV.wait(lock, [this](){ return _queued == 0; });
+}
+
+
+/// Record an error, merge() runs in the threads of all the jobs of a query.
+void InfileMerger::_setError(InfileMergerError const& error) {
+    std::lock_guard<std::mutex> lock(_errorMutex);
+    _error = error;
+}
+
+
+/// Record the first error from a queued load or a fold, the merge has failed.
+void InfileMerger::_setMergeError(InfileMergerError const& error) {
+    std::lock_guard<std::mutex> lock(_errorMutex);
+    if (!_mergeFailed) {
+        _error = error;
+        _mergeFailed = true;
+        LOGS(_log, LOG_LVL_ERROR, "InfileMerger merge error: " << _error.getMsg());
+    }
+}
+
+
+/// The caller must hold shard.mysqlMutex.
+bool InfileMerger::_applyMysql(MergeShard& shard, std::string const& query) {
+    if (!shard.mysqlConn.connected()) {
         // should have connected during construction
         // Try reconnecting--maybe we timed out.
-        if (!_setupConnection()) {
+        if (!_setupConnection(shard)) {
             LOGS(_log, LOG_LVL_ERROR, "InfileMerger::_applyMysql _setupConnection() failed!!!");
             return false; // Reconnection failed. This is an error.
         }
     }
 
-    int rc = mysql_real_query(_mysqlConn.getMySql(),
+    int rc = mysql_real_query(shard.mysqlConn.getMySql(),
                               query.data(), query.size());
     return rc == 0;
 }
@@ -225,14 +511,23 @@ bool InfileMerger::finalize() {
     if (_isFinished) {
         LOGS(_log, LOG_LVL_ERROR, "InfileMerger::finalize(), but _isFinished == true");
     }
-    if (_mergeTable != _config.targetTable) {
-        // Aggregation needed: Do the aggregation.
-        std::string mergeSelect = _config.mergeStmt->getQueryTemplate().sqlFragment();
-        // Using MyISAM as single thread writing with no need to recover from errors.
-        std::string createMerge = "CREATE TABLE " + _config.targetTable
-            + " ENGINE=MyISAM " + mergeSelect;
-        LOGS(_log, LOG_LVL_DEBUG, "Merging w/" << createMerge);
-        finalizeOk = _applySqlLocal(createMerge);
+    if (_folding) {
+        // Only the final rows are left to write, there is no merge table.
+        finalizeOk = _writeFolded();
+    } else if (_shards.size() > 1) {
+        _waitForQueuedMerges();
+        finalizeOk = _combineShards();
+    }
+    if (_mergeTable != _config.targetTable && !_folding) {
+        if (finalizeOk) {
+            // Aggregation needed: Do the aggregation.
+            std::string mergeSelect = _config.mergeStmt->getQueryTemplate().sqlFragment();
+            // Using MyISAM as single thread writing with no need to recover from errors.
+            std::string createMerge = "CREATE TABLE " + _config.targetTable
+                + " ENGINE=MyISAM " + mergeSelect;
+            LOGS(_log, LOG_LVL_DEBUG, "Merging w/" << createMerge);
+            finalizeOk = _applySqlLocal(createMerge);
+        }
 
         // Cleanup merge table.
         sql::SqlErrorObject eObj;
@@ -254,6 +549,11 @@ bool InfileMerger::finalize() {
     return finalizeOk;
 }
 
+InfileMergerError InfileMerger::getError() const {
+    std::lock_guard<std::mutex> lock(_errorMutex);
+    return _error;
+}
+
 bool InfileMerger::isFinished() const {
     return _isFinished;
 }
@@ -262,6 +562,61 @@ bool InfileMerger::isFinished() const {
 // InfileMerger private
 ////////////////////////////////////////////////////////////////////////
 
+/// Append the rows of the sibling shard tables to _mergeTable and drop the
+/// siblings. Siblings are dropped even if an earlier step failed.
+/// @return true if all rows were loaded and combined.
+bool InfileMerger::_combineShards() {
+    bool combineOk = !_mergeFailed;
+    if (_needCreateTable) {
+        return combineOk; // No rows were received, so no tables were created.
+    }
+    for (std::size_t j = 1; j < _shards.size(); ++j) {
+        std::string const& table = _shards[j]->table;
+        if (combineOk) {
+            combineOk = _applySqlLocal("INSERT INTO " + _mergeTable + " SELECT * FROM " + table);
+        }
+        if (!_applySqlLocal("DROP TABLE IF EXISTS " + table)) {
+            LOGS(_log, LOG_LVL_DEBUG, "Failure cleaning up table " << table);
+        }
+    }
+    LOGS(_log, LOG_LVL_DEBUG, "Combined " << _shards.size() << " shards into " << _mergeTable);
+    return combineOk;
+}
+
+/// Create the target table and write the rows of _folder into it.
+bool InfileMerger::_writeFolded() {
+    proto::Result result;
+    std::string msg;
+    {
+        std::lock_guard<std::mutex> lock(_folderMutex);
+        if (!_folder->getResult(result, msg)) {
+            _setError(InfileMergerError(util::ErrorCode::MERGEWRITE, msg));
+            LOGS(_log, LOG_LVL_ERROR, "InfileMerger error: " << msg);
+            return false;
+        }
+    }
+    std::string const createStmt = sql::formCreateTable(_config.targetTable,
+                                                        schemaFromProto(result.rowschema()))
+        + " ENGINE=MyISAM";
+    if (not _applySqlLocal(createStmt)) {
+        return false;
+    }
+    if (result.rowcount() > 0) {
+        MergeShard& shard = *_shards[0];
+        std::lock_guard<std::mutex> lock(shard.mysqlMutex);
+        std::string const virtFile = shard.infileMgr.prepareSrc(newProtoRowBuffer(result));
+        if (!_applyMysql(shard, sql::formLoadInfile(_config.targetTable, virtFile))) {
+            std::string const msg = "Error writing folded rows into " + _config.targetTable;
+            _setError(InfileMergerError(util::ErrorCode::MERGEWRITE, msg));
+            LOGS(_log, LOG_LVL_ERROR, "InfileMerger error: " << msg);
+            return false;
+        }
+    }
+    LOGS(_log, LOG_LVL_DEBUG, "InfileMerger wrote " << result.rowcount() << " rows folded from "
+         << _rowsMerged << " rows into " << _config.targetTable);
+    return true;
+}
+
 /// Apply a SQL query, setting the appropriate error upon failure.
 bool InfileMerger::_applySqlLocal(std::string const& sql) {
     std::lock_guard<std::mutex> m(_sqlMutex);
@@ -269,18 +624,18 @@ bool InfileMerger::_applySqlLocal(std::string const& sql) {
     if (not _sqlConn.get()) {
         _sqlConn = std::make_shared<sql::SqlConnection>(_config.mySqlConfig, true);
         if (not _sqlConn->connectToDb(errObj)) {
-            _error = util::Error(errObj.errNo(), "Error connecting to db: " + errObj.printErrMsg(),
-                           util::ErrorCode::MYSQLCONNECT);
+            std::string const msg = "Error connecting to db: " + errObj.printErrMsg();
+            _setError(util::Error(errObj.errNo(), msg, util::ErrorCode::MYSQLCONNECT));
             _sqlConn.reset();
-            LOGS(_log, LOG_LVL_ERROR, "InfileMerger error: " << _error.getMsg());
+            LOGS(_log, LOG_LVL_ERROR, "InfileMerger error: " << msg);
             return false;
         }
         LOGS(_log, LOG_LVL_DEBUG, "InfileMerger " << (void*) this << " connected to db");
     }
     if (not _sqlConn->runQuery(sql, errObj)) {
-        _error = util::Error(errObj.errNo(), "Error applying sql: " + errObj.printErrMsg(),
-                       util::ErrorCode::MYSQLEXEC);
-        LOGS(_log, LOG_LVL_ERROR, "InfileMerger error: " << _error.getMsg());
+        std::string const msg = "Error applying sql: " + errObj.printErrMsg();
+        _setError(util::Error(errObj.errNo(), msg, util::ErrorCode::MYSQLEXEC));
+        LOGS(_log, LOG_LVL_ERROR, "InfileMerger error: " << msg);
         return false;
     }
     LOGS(_log, LOG_LVL_DEBUG, "InfileMerger query success: " << sql);
@@ -292,7 +647,7 @@ bool InfileMerger::_applySqlLocal(std::string const& sql) {
 int InfileMerger::_readHeader(proto::ProtoHeader& header, char const* buffer, int length) {
     if (not proto::ProtoImporter<proto::ProtoHeader>::setMsgFrom(header, buffer, length)) {
         // This is only a real error if there are no more bytes.
-        _error = InfileMergerError(util::ErrorCode::HEADER_IMPORT, "Error decoding protobuf header");
+        _setError(InfileMergerError(util::ErrorCode::HEADER_IMPORT, "Error decoding protobuf header"));
         return 0;
     }
     return length;
@@ -301,8 +656,9 @@ int InfileMerger::_readHeader(proto::ProtoHeader& header, char const* buffer, in
 /// Read a Result message and return the number of bytes consumed.
 int InfileMerger::_readResult(proto::Result& result, char const* buffer, int length) {
     if (not proto::ProtoImporter<proto::Result>::setMsgFrom(result, buffer, length)) {
-        _error = InfileMergerError(util::ErrorCode::RESULT_IMPORT, "Error decoding result message");
-        throw _error;
+        InfileMergerError const error(util::ErrorCode::RESULT_IMPORT, "Error decoding result message");
+        _setError(error);
+        throw error;
     }
     // result.PrintDebugString();
     return length;
@@ -314,7 +670,7 @@ int InfileMerger::_readResult(proto::Result& result, char const* buffer, int len
 /// TODO: this is incomplete.
 bool InfileMerger::_verifySession(int sessionId) {
     if (false) {
-        _error = InfileMergerError(util::ErrorCode::RESULT_IMPORT, "Session id mismatch");
+        _setError(InfileMergerError(util::ErrorCode::RESULT_IMPORT, "Session id mismatch"));
     }
     return true; // TODO: for better message integrity
 }
@@ -325,27 +681,28 @@ bool InfileMerger::_verifySession(int sessionId) {
 bool InfileMerger::_setupTable(proto::WorkerResponse const& response) {
     // Create table, using schema
     std::lock_guard<std::mutex> lock(_createTableMutex);
+    if (_needCreateTable && _folder != nullptr) {
+        // Results are folded in memory when their column types allow it.
+        if (_folder->setSchema(response.result.rowschema())) {
+            LOGS(_log, LOG_LVL_DEBUG, "InfileMerger folding results for " << _config.targetTable);
+            _folding = true;
+            _needCreateTable = false;
+            return true;
+        }
+        LOGS(_log, LOG_LVL_DEBUG, "InfileMerger results need MySQL for " << _config.targetTable);
+        _folder.reset();
+    }
+    if (_needCreateTable && _direct && !_directColumnsMatch(response.result.rowschema())) {
+        // Let MySQL pick the selected columns from a merge table.
+        LOGS(_log, LOG_LVL_DEBUG, "InfileMerger result columns need MySQL for " << _config.targetTable);
+        _direct = false;
+        _mergeTable = _config.targetTable + "_m";
+        _config.mergeStmt->setFromListAsTable(_mergeTable);
+        _nameShardTables();
+    }
     if (_needCreateTable) {
         // create schema
-        proto::RowSchema const& rs = response.result.rowschema();
-        sql::Schema s;
-        for(int i=0, e=rs.columnschema_size(); i != e; ++i) {
-            proto::ColumnSchema const& cs = rs.columnschema(i);
-            sql::ColSchema scs;
-            scs.name = cs.name();
-            if (cs.hasdefault()) {
-                scs.defaultValue = cs.defaultvalue();
-                scs.hasDefault = true;
-            } else {
-                scs.hasDefault = false;
-            }
-            if (cs.has_mysqltype()) {
-                scs.colType.mysqlType = cs.mysqltype();
-            }
-            scs.colType.sqlType = cs.sqltype();
-
-            s.columns.push_back(scs);
-        }
+        sql::Schema s = schemaFromProto(response.result.rowschema());
         std::string createStmt = sql::formCreateTable(_mergeTable, s);
         // Specifying engine. There is some question about whether InnoDB or MyISAM is the better
         // choice when multiple threads are writing to the result table.
@@ -353,11 +710,23 @@ bool InfileMerger::_setupTable(proto::WorkerResponse const& response) {
         LOGS(_log, LOG_LVL_DEBUG, "InfileMerger query prepared: " << createStmt);
 
         if (not _applySqlLocal(createStmt)) {
-            _error = InfileMergerError(util::ErrorCode::CREATE_TABLE, "Error creating table (" + _mergeTable + ")");
+            std::string const msg = "Error creating table (" + _mergeTable + ")";
+            _setError(InfileMergerError(util::ErrorCode::CREATE_TABLE, msg));
             _isFinished = true; // Cannot continue.
-            LOGS(_log, LOG_LVL_ERROR, "InfileMerger sql error: " << _error.getMsg());
+            LOGS(_log, LOG_LVL_ERROR, "InfileMerger sql error: " << msg);
             return false;
         }
+        // Sibling tables for the other merge connections.
+        for (std::size_t j = 1; j < _shards.size(); ++j) {
+            std::string const& table = _shards[j]->table;
+            if (not _applySqlLocal("CREATE TABLE " + table + " LIKE " + _mergeTable)) {
+                std::string const msg = "Error creating table (" + table + ")";
+                _setError(InfileMergerError(util::ErrorCode::CREATE_TABLE, msg));
+                _isFinished = true; // Cannot continue.
+                LOGS(_log, LOG_LVL_ERROR, "InfileMerger sql error: " << msg);
+                return false;
+            }
+        }
         _needCreateTable = false;
     } else {
         // Do nothing, table already created.
@@ -375,7 +744,7 @@ void InfileMerger::_fixupTargetName() {
                                % _config.mySqlConfig.dbName % getTimeStampId()).str();
     }
 
-    if (_config.mergeStmt) {
+    if (_config.mergeStmt && !_direct) {
         // Set merging temporary if needed.
         _mergeTable = _config.targetTable + "_m";
     } else {
@@ -30,14 +30,21 @@
 /// (see individual class documentation for more information)
 
 // System headers
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 // Qserv headers
 #include "mysql/LocalInfile.h"
 #include "mysql/MySqlConfig.h"
 #include "mysql/MySqlConnection.h"
+#include "proto/worker.pb.h"
+#include "rproc/RowFolder.h"
 #include "util/Error.h"
 #include "util/EventThread.h"
 
@@ -48,8 +55,6 @@ namespace mysql {
     class MySqlConfig;
 }
 namespace proto {
-    class ProtoHeader;
-    class Result;
     struct WorkerResponse;
 }
 namespace qdisp {
@@ -89,6 +94,26 @@ public:
     mysql::MySqlConfig const mySqlConfig;
     std::string targetTable;
     std::shared_ptr<query::SelectStmt> mergeStmt;
+    /// Number of parallel merge connections. With 1, results are loaded
+    /// serially through a single connection as they arrive. With more than 1,
+    /// results are queued and loaded in parallel into sibling tables which
+    /// are combined in finalize().
+    int mergeConnections{1};
+    /// Checksum workers are asked to attach to each result message.
+    proto::ProtoHeader::ChecksumType resultChecksum{proto::ProtoHeader::CRC32C};
+    /// Result protocol workers are asked to use, 2 or 3.
+    int resultProtocol{2};
+    /// Fold partial aggregates with an AggregateMerger as they arrive, when
+    /// mergeStmt allows it, instead of loading them into a merge table.
+    bool aggregateMerge{true};
+    /// Keep the first rows of "ORDER BY ... LIMIT n" results with a
+    /// TopNMerger as they arrive, when mergeStmt allows it, instead of
+    /// loading all of them into a merge table.
+    bool topNMerge{true};
+    /// Load the rows of merge statements that only select columns, with an
+    /// optional LIMIT, straight into the target table, applying the LIMIT as
+    /// they arrive, instead of going through a merge table.
+    bool directMerge{true};
 };
 
 /// InfileMerger is a row-based merger that imports rows from result messages
@@ -103,6 +128,29 @@ public:
 /// Bytes 1 - size_ph : ProtoHeader message (containing size of result message)
 /// Bytes size_ph - size_ph + size_rm : Result message
 /// At present, Result messages are not chained.
+///
+/// When InfileMergerConfig::mergeConnections is greater than 1, merge() only
+/// queues the response on the shared merge pool and returns, so that the
+/// caller can go on receiving the next message while the rows are converted
+/// and loaded. Each queued response is loaded through one of several merge
+/// connections ("shards"), each writing to its own sibling of the merge
+/// table, so that LOAD DATA statements do not serialize on one table lock.
+/// The number of queued responses is bounded, merge() blocks once the bound
+/// is reached. Errors from queued loads are reported by later merge() calls
+/// and by finalize().
+///
+/// When InfileMergerConfig::aggregateMerge is set and the merge statement
+/// only groups and aggregates (see AggregateMerger), or when
+/// InfileMergerConfig::topNMerge is set and the merge statement only sorts
+/// and limits rows (see TopNMerger), merge() folds the rows in memory
+/// instead, and finalize() writes the final rows into the target table.
+/// No merge table is created in that case.
+///
+/// When InfileMergerConfig::directMerge is set and the merge statement only
+/// selects the columns of the chunk results, possibly with a LIMIT, rows are
+/// loaded into the target table as they arrive and rows beyond the LIMIT are
+/// dropped, so that results are written once and finalize() has no merge
+/// query to run.
 class InfileMerger {
 public:
     explicit InfileMerger(InfileMergerConfig const& c);
@@ -112,6 +160,11 @@ public:
     // @return the size of the large result thread pool.
     static int setLargeResultPoolSize(int size);
 
+    /// Create the shared thread pool used for parallel merging and/or
+    /// change its size.
+    // @return the size of the merge thread pool.
+    static int setMergePoolSize(int size);
+
     /// Merge a worker response, which contains:
     /// Size of ProtoHeader message
     /// ProtoHeader message
@@ -119,8 +172,15 @@ public:
     /// @return true if merge was successfully imported (queued)
     bool merge(std::shared_ptr<proto::WorkerResponse> response);
 
+    /// Call 'func' once, from a merging thread, as soon as 'rows' rows have
+    /// been merged. Must be called before the first merge().
+    void setRowLimitHandler(uint64_t rows, std::function<void()> const& func);
+
+    /// @return the number of rows merged so far.
+    uint64_t getRowsMerged() const { return _rowsMerged; }
+
     /// @return error details if finalize() returns false
-    InfileMergerError const& getError() const { return _error; }
+    InfileMergerError getError() const;
     /// @return final target table name  storing results after post processing
     std::string getTargetTable() const {return _config.targetTable; }
     /// Finalize a "merge" and perform postprocessing
@@ -129,7 +189,32 @@ public:
     bool isFinished() const;
 
 private:
-    bool _applyMysql(std::string const& query);
+    /// A merge connection and the table it loads rows into.
+    struct MergeShard {
+        explicit MergeShard(mysql::MySqlConfig const& config) : mysqlConn{config} {}
+        mysql::MySqlConnection mysqlConn;
+        std::mutex mysqlMutex; ///< Protection for mysqlConn
+        lsst::qserv::mysql::LocalInfile::Mgr infileMgr;
+        std::string table; ///< Table loaded through this connection
+    };
+
+    bool _applyMysql(MergeShard& shard, std::string const& query);
+    bool _loadResult(MergeShard& shard, std::shared_ptr<proto::WorkerResponse> const& response,
+                     std::string const& queryIdStr);
+    bool _queueMerge(std::shared_ptr<proto::WorkerResponse> const& response,
+                     std::string const& queryIdStr);
+    MergeShard& _lockShard(std::unique_lock<std::mutex>& lock);
+    void _waitForQueuedMerges();
+    void _setError(InfileMergerError const& error);
+    void _setMergeError(InfileMergerError const& error);
+    void _checkRowLimit();
+    bool _combineShards();
+    bool _foldResult(std::shared_ptr<proto::WorkerResponse> const& response,
+                     std::string const& queryIdStr);
+    bool _writeFolded();
+    bool _limitRows(proto::Result& result);
+    bool _directColumnsMatch(proto::RowSchema const& schema) const;
+    void _nameShardTables();
     bool _merge(std::shared_ptr<proto::WorkerResponse>& response);
     int _readHeader(proto::ProtoHeader& header, char const* buffer, int length);
     int _readResult(proto::Result& result, char const* buffer, int length);
@@ -140,9 +225,9 @@ private:
     bool _applySqlLocal(std::string const& sql);
     void _fixupTargetName();
 
-    bool _setupConnection() {
-        if (_mysqlConn.connect()) {
-            _infileMgr.attach(_mysqlConn.getMySql());
+    bool _setupConnection(MergeShard& shard) {
+        if (shard.mysqlConn.connect()) {
+            shard.infileMgr.attach(shard.mysqlConn.getMySql());
             return true;
         }
         return false;
@@ -151,18 +236,46 @@ private:
     InfileMergerConfig _config; ///< Configuration
     std::shared_ptr<sql::SqlConnection> _sqlConn; ///< SQL connection
     std::string _mergeTable; ///< Table for result loading
-    InfileMergerError _error; ///< Error state
+    InfileMergerError _error; ///< Error state, protected by _errorMutex
     bool _isFinished{false}; ///< Completed?
     std::mutex _createTableMutex; ///< protection from creating tables
     std::mutex _sqlMutex; ///< Protection for SQL connection
-    bool _needCreateTable{true}; ///< Does the target table need creating?
+    /// Does the target table need creating? Set to false by _setupTable() once
+    /// _mergeTable, the shard tables, _direct and _folding are final, so that
+    /// merge() threads seeing false may use them without _createTableMutex.
+    std::atomic<bool> _needCreateTable{true};
+
+    RowFolder::Ptr _folder; ///< nullptr unless results may be folded
+    std::atomic<bool> _folding{false}; ///< true if results are folded by _folder
+    std::mutex _folderMutex; ///< Protection for _folder
+
+    std::atomic<bool> _direct{false}; ///< true if rows are loaded straight into the target table
+    std::vector<std::string> _directColumns; ///< Names selected by a direct merge, empty for *
+    bool _directLimited{false}; ///< true if a direct merge has a LIMIT
+    uint64_t _directLimit{0}; ///< LIMIT of a direct merge
+    uint64_t _rowsAccepted{0}; ///< Rows of a direct merge within its LIMIT so far
+    std::mutex _limitMutex; ///< Protection for _rowsAccepted
+
+    std::vector<std::unique_ptr<MergeShard>> _shards; ///< Merge connections, [0] loads _mergeTable
+    std::atomic<unsigned int> _nextShard{0}; ///< Round-robin start for shard selection
+
+    // Parallel merge bookkeeping, only used with more than one shard.
+    int _queuedMax; ///< Maximum number of queued responses before merge() blocks
+    int _queued{0}; ///< Number of queued, not yet loaded, responses
+    std::mutex _queuedMutex; ///< Protection for _queued
+    std::condition_variable _queuedCV;
+    std::atomic<bool> _mergeFailed{false}; ///< true if a queued load failed
+    mutable std::mutex _errorMutex; ///< Protection for _error written by merge threads
 
-    mysql::MySqlConnection _mysqlConn;
-    std::mutex _mysqlMutex;
-    lsst::qserv::mysql::LocalInfile::Mgr _infileMgr;
+    std::atomic<uint64_t> _rowsMerged{0}; ///< Rows loaded into the merge tables
+    uint64_t _rowLimit{0}; ///< Rows after which _rowLimitFunc is called, 0 for never
+    std::function<void()> _rowLimitFunc;
+    std::atomic<bool> _rowLimitReached{false};
 
     // The limited size pool will keep large queries from using up all the czar's time.
     static util::ThreadPool::Ptr _largeResultPool;
+    // Pool running queued loads for all InfileMerger instances with more than one shard.
+    static util::ThreadPool::Ptr _mergePool;
 };
 
 }}} // namespace lsst::qserv::rproc
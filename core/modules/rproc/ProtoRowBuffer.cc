@@ -23,16 +23,24 @@
 #include "rproc/ProtoRowBuffer.h"
 
 // System headers
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <string.h>
+#include <utility>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 // Third-party headers
 #include <mysql/mysql.h>
 
 // Qserv headers
+#include "proto/ColumnBatchBuilder.h"
 #include "proto/worker.pb.h"
 #include "sql/Schema.h"
 
@@ -96,84 +104,182 @@ inline int copyColumn(T& dest, std::string const& rawColumn) {
     dest.resize(existingSize + 2 + valSize);
     return 2 + valSize;
 }
+
+/// @return true if escapeString() would rewrite the byte c.
+inline bool needsEscape(char c) {
+    switch(c) {
+      case '\0': case '\b': case '\n': case '\r': case '\t': case '\032':
+        return true;
+      default:
+        return false;
+    }
+}
+
+/// @return the length of the leading run of [begin, end) that contains no
+/// byte needing escaping. Uses SSE2, when available, to test 16 bytes at a
+/// time.
+inline std::size_t cleanPrefixLength(char const* begin, char const* end) {
+    char const* i = begin;
+#ifdef __SSE2__
+    __m128i const nul = _mm_set1_epi8('\0');
+    __m128i const bs = _mm_set1_epi8('\b');
+    __m128i const nl = _mm_set1_epi8('\n');
+    __m128i const cr = _mm_set1_epi8('\r');
+    __m128i const tab = _mm_set1_epi8('\t');
+    __m128i const ctrlZ = _mm_set1_epi8('\032');
+    for(; end - i >= 16; i += 16) {
+        __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(i));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(v, nul), _mm_cmpeq_epi8(v, bs));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(v, nl));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(v, cr));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(v, tab));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(v, ctrlZ));
+        int const mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return (i - begin) + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for(; i != end; ++i) {
+        if (needsEscape(*i)) {
+            break;
+        }
+    }
+    return i - begin;
+}
+
+/// Escape a column for LOAD DATA INFILE, like escapeString(), but copy runs
+/// of bytes that need no escaping with memcpy.
+/// dest must have room for 2 * srcLen bytes.
+/// @return the number of bytes written to dest
+inline std::size_t escapeColumn(char* dest, char const* src, std::size_t srcLen) {
+    char* destI = dest;
+    char const* const srcEnd = src + srcLen;
+    while(src != srcEnd) {
+        std::size_t const run = cleanPrefixLength(src, srcEnd);
+        memcpy(destI, src, run);
+        destI += run;
+        src += run;
+        if (src == srcEnd) {
+            break;
+        }
+        destI += escapeString(destI, src, src + 1);
+        ++src;
+    }
+    return destI - dest;
+}
+
 ////////////////////////////////////////////////////////////////////////
-// ProtoRowBuffer
+// ResultRowBuffer
 ////////////////////////////////////////////////////////////////////////
 
-/// ProtoRowBuffer is an implementation of RowBuffer designed to allow a
-/// LocalInfile object to use a Protobufs Result message as a row source
-class ProtoRowBuffer : public mysql::RowBuffer {
+/// ResultRowBuffer is the base of the RowBuffer implementations that allow a
+/// LocalInfile object to use a Protobufs Result message as a row source.
+///
+/// Rows are encoded directly into the buffer passed to fetch(). Only a row
+/// that is larger than an entire fetch() buffer is encoded into an internal
+/// buffer, which is then handed out in pieces through a cursor.
+class ResultRowBuffer : public mysql::RowBuffer {
 public:
-    ProtoRowBuffer(proto::Result& res);
+    explicit ResultRowBuffer(int rowTotal);
     virtual unsigned fetch(char* buffer, unsigned bufLen);
 
-private:
-    void _initCurrentRow();
-    void _initSchema();
-    void _readNextRow();
-    // Copy a row bundle into a destination STL char container
-    template <typename T>
-    int _copyRowBundle(T& dest, proto::RowBundle const& rb) {
-        int sizeBefore = dest.size();
-        for(int ci=0, ce=rb.column_size(); ci != ce; ++ci) {
-            if (ci != 0) {
-                dest.insert(dest.end(), _colSep.begin(), _colSep.end());
-            }
+protected:
+    /// @return an upper bound of the encoded size of row _rowIdx, including
+    /// the row separator preceding every row but the first.
+    virtual std::size_t _maxRowSize() const = 0;
 
-            if (!rb.isnull(ci)) {
-                copyColumn(dest, rb.column(ci));
-            } else {
-                dest.insert(dest.end(), _nullToken.begin(), _nullToken.end() );
-            }
-        }
-        return dest.size() - sizeBefore;
+    /// Encode row _rowIdx into dest, which has room for _maxRowSize() bytes.
+    /// @return the number of bytes written
+    virtual std::size_t _writeRow(char* dest) const = 0;
+
+    /// Append a separator or the NULL token at cursor.
+    static char* _add(char* cursor, std::string const& s) {
+        memcpy(cursor, s.data(), s.size());
+        return cursor + s.size();
     }
 
     std::string _colSep; ///< Column separator
     std::string _rowSep; ///< Row separator
     std::string _nullToken; ///< Null indicator (e.g. \N)
-    proto::Result& _result; ///< Ref to Resultmessage
+    int _rowIdx; ///< Index of the next row to encode
 
-    sql::Schema _schema; ///< Schema object
-    int _rowIdx; ///< Row index
+private:
     int _rowTotal; ///< Total row count
-    std::vector<char> _currentRow; ///< char buffer representing current row.
+    std::vector<char> _largeRow; ///< Encoded row too large for a fetch() buffer
+    std::size_t _largeRowPos; ///< Bytes of _largeRow already fetched
 };
 
-ProtoRowBuffer::ProtoRowBuffer(proto::Result& res)
+ResultRowBuffer::ResultRowBuffer(int rowTotal)
     : _colSep("\t"),
       _rowSep("\n"),
       _nullToken("\\N"),
-      _result(res),
       _rowIdx(0),
-      _rowTotal(res.row_size()),
-      _currentRow(0) {
-    _initSchema();
-    if (_result.row_size() > 0) {
-        _initCurrentRow();
-    }
+      _rowTotal(rowTotal),
+      _largeRowPos(0) {
 }
 
-/// Fetch a up to a single row from from the Result message
-unsigned ProtoRowBuffer::fetch(char* buffer, unsigned bufLen) {
-    unsigned fetched = 0;
-    if (bufLen <= _currentRow.size()) {
-        memcpy(buffer, &_currentRow[0], bufLen);
-        _currentRow.erase(_currentRow.begin(), _currentRow.begin() + bufLen);
-        fetched = bufLen;
-    } else { // Want more than we have.
-        if (_currentRow.size()) {
-            memcpy(buffer, &_currentRow[0], _currentRow.size());
-            fetched = _currentRow.size();
-            _currentRow.clear();
+/// Fetch as many whole rows from the Result message as fit in buffer.
+unsigned ResultRowBuffer::fetch(char* buffer, unsigned bufLen) {
+    std::size_t fetched = 0;
+    // Continue a large row from a previous fetch.
+    if (_largeRowPos < _largeRow.size()) {
+        fetched = std::min<std::size_t>(bufLen, _largeRow.size() - _largeRowPos);
+        memcpy(buffer, &_largeRow[_largeRowPos], fetched);
+        _largeRowPos += fetched;
+        if (_largeRowPos < _largeRow.size()) {
+            return fetched;
         }
+        _largeRow.clear(); // Keep the capacity for the next large row.
+        _largeRowPos = 0;
     }
-    if ((_currentRow.size() == 0) && (_rowIdx < _rowTotal)) {
-        _readNextRow();
+    while (_rowIdx < _rowTotal) {
+        std::size_t const maxSize = _maxRowSize();
+        if (maxSize <= bufLen - fetched) {
+            fetched += _writeRow(buffer + fetched);
+            ++_rowIdx;
+        } else if (fetched > 0) {
+            break; // The row goes at the start of the next buffer.
+        } else {
+            // The row may not fit even in an empty buffer.
+            _largeRow.resize(maxSize);
+            _largeRow.resize(_writeRow(&_largeRow[0]));
+            ++_rowIdx;
+            fetched = std::min<std::size_t>(bufLen, _largeRow.size());
+            memcpy(buffer, &_largeRow[0], fetched);
+            _largeRowPos = fetched;
+            break;
+        }
     }
     return fetched;
 }
 
+////////////////////////////////////////////////////////////////////////
+// ProtoRowBuffer
+////////////////////////////////////////////////////////////////////////
+
+/// ProtoRowBuffer reads the row-based results of protocol 2 (Result.row).
+class ProtoRowBuffer : public ResultRowBuffer {
+public:
+    ProtoRowBuffer(proto::Result& res);
+
+protected:
+    std::size_t _maxRowSize() const override;
+    std::size_t _writeRow(char* dest) const override;
+
+private:
+    void _initSchema();
+
+    proto::Result& _result; ///< Ref to Resultmessage
+    sql::Schema _schema; ///< Schema object
+};
+
+ProtoRowBuffer::ProtoRowBuffer(proto::Result& res)
+    : ResultRowBuffer(res.row_size()),
+      _result(res) {
+    _initSchema();
+}
+
 /// Import schema from the proto message into a Schema object
 void ProtoRowBuffer::_initSchema() {
     _schema.columns.clear();
@@ -195,23 +301,130 @@ void ProtoRowBuffer::_initSchema() {
         _schema.columns.push_back(cs);
     }
 }
-/// Import the next row into the buffer
-void ProtoRowBuffer::_readNextRow() {
-    ++_rowIdx;
-    if (_rowIdx >= _rowTotal) {
-        return;
+
+std::size_t ProtoRowBuffer::_maxRowSize() const {
+    proto::RowBundle const& rb = _result.row(_rowIdx);
+    std::size_t size = (_rowIdx > 0) ? _rowSep.size() : 0;
+    for(int ci=0, ce=rb.column_size(); ci != ce; ++ci) {
+        if (ci != 0) {
+            size += _colSep.size();
+        }
+        if (!rb.isnull(ci)) {
+            size += 2 + 2 * rb.column(ci).size(); // quotes + escaping
+        } else {
+            size += _nullToken.size();
+        }
     }
-    _currentRow.clear();
-    // Row separator
-    _currentRow.insert(_currentRow.end(), _rowSep.begin(), _rowSep.end());
-    _copyRowBundle(_currentRow, _result.row(_rowIdx));
+    return size;
 }
 
-/// Setup the row byte buffer
-void ProtoRowBuffer::_initCurrentRow() {
-    // Copy row and reserve 2x size.
-    int rowSize = _copyRowBundle(_currentRow, _result.row(_rowIdx));
-    _currentRow.reserve(rowSize*2); // for future usage
+std::size_t ProtoRowBuffer::_writeRow(char* dest) const {
+    proto::RowBundle const& rb = _result.row(_rowIdx);
+    char* cursor = dest;
+    if (_rowIdx > 0) {
+        cursor = _add(cursor, _rowSep);
+    }
+    for(int ci=0, ce=rb.column_size(); ci != ce; ++ci) {
+        if (ci != 0) {
+            cursor = _add(cursor, _colSep);
+        }
+        if (!rb.isnull(ci)) {
+            std::string const& col = rb.column(ci);
+            *cursor++ = '\'';
+            cursor += escapeColumn(cursor, col.data(), col.size());
+            *cursor++ = '\'';
+        } else {
+            cursor = _add(cursor, _nullToken);
+        }
+    }
+    return cursor - dest;
+}
+
+////////////////////////////////////////////////////////////////////////
+// ColumnarRowBuffer
+////////////////////////////////////////////////////////////////////////
+
+/// ColumnarRowBuffer reads the column-based results of protocol 3
+/// (Result.columnbatch). Fixed-width values are formatted as text directly
+/// into the fetch() buffer. The Result message must have passed
+/// checkResultRows().
+class ColumnarRowBuffer : public ResultRowBuffer {
+public:
+    ColumnarRowBuffer(proto::Result& res);
+
+protected:
+    std::size_t _maxRowSize() const override;
+    std::size_t _writeRow(char* dest) const override;
+
+private:
+    using Builder = proto::ColumnBatchBuilder;
+
+    /// @return the [begin, end) offsets of row _rowIdx in a STRING column
+    std::pair<std::size_t, std::size_t> _stringRange(proto::ColumnBatch const& batch) const {
+        std::size_t begin = (_rowIdx == 0) ? 0 : Builder::getUint(&batch.offsets()[4 * (_rowIdx - 1)], 4);
+        std::size_t end = Builder::getUint(&batch.offsets()[4 * _rowIdx], 4);
+        return std::make_pair(begin, end);
+    }
+
+    proto::Result& _result; ///< Ref to Resultmessage
+    std::vector<std::size_t> _widths; ///< Fixed width of each column, 0 for STRING
+};
+
+ColumnarRowBuffer::ColumnarRowBuffer(proto::Result& res)
+    : ResultRowBuffer(res.rowcount()),
+      _result(res) {
+    for(auto const& batch : _result.columnbatch()) {
+        _widths.push_back(Builder::fixedWidth(batch.encoding()));
+    }
+}
+
+std::size_t ColumnarRowBuffer::_maxRowSize() const {
+    std::size_t size = (_rowIdx > 0) ? _rowSep.size() : 0;
+    for(int ci=0, ce=_result.columnbatch_size(); ci != ce; ++ci) {
+        proto::ColumnBatch const& batch = _result.columnbatch(ci);
+        if (ci != 0) {
+            size += _colSep.size();
+        }
+        if (Builder::isNull(batch.nulls(), _rowIdx)) {
+            size += _nullToken.size();
+        } else if (_widths[ci] != 0) {
+            size += 2 + Builder::FORMAT_BUFFER_SIZE;
+        } else {
+            auto range = _stringRange(batch);
+            size += 2 + 2 * (range.second - range.first); // quotes + escaping
+        }
+    }
+    return size;
+}
+
+std::size_t ColumnarRowBuffer::_writeRow(char* dest) const {
+    char* cursor = dest;
+    if (_rowIdx > 0) {
+        cursor = _add(cursor, _rowSep);
+    }
+    for(int ci=0, ce=_result.columnbatch_size(); ci != ce; ++ci) {
+        proto::ColumnBatch const& batch = _result.columnbatch(ci);
+        if (ci != 0) {
+            cursor = _add(cursor, _colSep);
+        }
+        if (Builder::isNull(batch.nulls(), _rowIdx)) {
+            cursor = _add(cursor, _nullToken);
+            continue;
+        }
+        *cursor++ = '\'';
+        std::size_t const width = _widths[ci];
+        if (width != 0) {
+            // Formatted numbers never need escaping.
+            std::uint64_t bits = Builder::getUint(&batch.fixed()[width * _rowIdx], width);
+            cursor += Builder::formatFixed(cursor, batch.encoding(), bits);
+        } else {
+            auto range = _stringRange(batch);
+            cursor += escapeColumn(cursor, batch.data().data() + range.first,
+                                   range.second - range.first);
+        }
+        *cursor++ = '\'';
+    }
+    return cursor - dest;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -219,6 +432,84 @@ void ProtoRowBuffer::_initCurrentRow() {
 ////////////////////////////////////////////////////////////////////////
 
 mysql::RowBuffer::Ptr newProtoRowBuffer(proto::Result& res) {
+    if (res.columnbatch_size() > 0) {
+        return mysql::RowBuffer::Ptr(new ColumnarRowBuffer(res));
+    }
     return mysql::RowBuffer::Ptr(new ProtoRowBuffer(res));
 }
+
+bool checkResultRows(proto::Result const& res, std::string& msg) {
+    using Builder = proto::ColumnBatchBuilder;
+    if (res.columnbatch_size() == 0) {
+        return true;
+    }
+    std::size_t const rowCount = res.rowcount();
+    if (res.columnbatch_size() != res.rowschema().columnschema_size()) {
+        msg = "column count does not match schema";
+        return false;
+    }
+    for(auto const& batch : res.columnbatch()) {
+        std::size_t const width = Builder::fixedWidth(batch.encoding());
+        if (batch.nulls().size() > (rowCount + 7) / 8) {
+            msg = "null bitmap too large";
+            return false;
+        }
+        if (width != 0) {
+            if (batch.fixed().size() != width * rowCount) {
+                msg = "fixed-width column size does not match row count";
+                return false;
+            }
+            continue;
+        }
+        if (batch.offsets().size() != 4 * rowCount) {
+            msg = "string column offsets do not match row count";
+            return false;
+        }
+        std::size_t previous = 0;
+        for(std::size_t r = 0; r < rowCount; ++r) {
+            std::size_t end = Builder::getUint(&batch.offsets()[4 * r], 4);
+            if (end < previous || end > batch.data().size()) {
+                msg = "string column offsets out of range";
+                return false;
+            }
+            previous = end;
+        }
+    }
+    return true;
+}
+
+void truncateResultRows(proto::Result& res, unsigned int rows) {
+    using Builder = proto::ColumnBatchBuilder;
+    if (res.columnbatch_size() == 0) {
+        if (static_cast<int>(rows) < res.row_size()) {
+            res.mutable_row()->DeleteSubrange(rows, res.row_size() - rows);
+        }
+        res.set_rowcount(res.row_size());
+        return;
+    }
+    if (rows >= res.rowcount()) {
+        return;
+    }
+    for(auto& batch : *res.mutable_columnbatch()) {
+        std::size_t const width = Builder::fixedWidth(batch.encoding());
+        if (width != 0) {
+            batch.mutable_fixed()->resize(width * rows);
+        } else {
+            std::size_t const end = (rows == 0) ? 0
+                                  : Builder::getUint(&batch.offsets()[4 * (rows - 1)], 4);
+            batch.mutable_offsets()->resize(4 * rows);
+            batch.mutable_data()->resize(end);
+        }
+        std::size_t const nullBytes = (rows + 7) / 8;
+        if (batch.nulls().size() > nullBytes) {
+            batch.mutable_nulls()->resize(nullBytes);
+        }
+        if (rows % 8 != 0 && batch.nulls().size() == nullBytes) {
+            // Clear the bits of dropped rows in the last byte.
+            char& last = (*batch.mutable_nulls())[nullBytes - 1];
+            last = static_cast<char>(static_cast<unsigned char>(last) & ((1u << (rows % 8)) - 1));
+        }
+    }
+    res.set_rowcount(rows);
+}
 }}} // lsst::qserv::mysql
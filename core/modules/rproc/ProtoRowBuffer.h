@@ -23,14 +23,28 @@
 #ifndef LSST_QSERV_RPROC_PROTOROWBUFFER_H
 #define LSST_QSERV_RPROC_PROTOROWBUFFER_H
 
+// System headers
+#include <string>
+
+// Qserv headers
 #include "mysql/RowBuffer.h"
 #include "proto/worker.pb.h"
 
 namespace lsst {
 namespace qserv {
 namespace rproc {
-/// Construct a RowBuffer with a Result message row source.
+/// Construct a RowBuffer with a Result message row source. Both the
+/// row-based (protocol 2) and column-based (protocol 3) forms are read.
 mysql::RowBuffer::Ptr newProtoRowBuffer(proto::Result& r);
 
+/// Check that the column batches of a protocol 3 Result message are
+/// consistent with its row count and schema, so that they can be read safely.
+/// @return false, with a description in msg, if they are not.
+bool checkResultRows(proto::Result const& r, std::string& msg);
+
+/// Drop all but the first 'rows' rows of a Result message, in either form.
+/// A protocol 3 message must have passed checkResultRows().
+void truncateResultRows(proto::Result& r, unsigned int rows);
+
 }}} // namespace lsst::qserv::rproc
 #endif // LSST_QSERV_RPROC_PROTOROWBUFFER_H
@@ -0,0 +1,65 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef LSST_QSERV_RPROC_ROWFOLDER_H
+#define LSST_QSERV_RPROC_ROWFOLDER_H
+
+// System headers
+#include <memory>
+#include <string>
+
+// Qserv headers
+#include "proto/worker.pb.h"
+
+namespace lsst {
+namespace qserv {
+namespace rproc {
+
+/// RowFolder is the interface of the mergers that combine chunk results in
+/// memory as they arrive, in place of a merge table and a merge query run by
+/// MySQL. InfileMerger only writes the rows of getResult() into the result
+/// table. Implementations need not be thread safe.
+class RowFolder {
+public:
+    typedef std::shared_ptr<RowFolder> Ptr;
+
+    virtual ~RowFolder() {}
+
+    /// Find the columns used by the merge statement in the schema of the
+    /// chunk results. Must be called once, before the first add().
+    /// @return false if a column is missing or of a type that can not be
+    ///         handled here, the results must then be merged by MySQL.
+    virtual bool setSchema(proto::RowSchema const& schema) = 0;
+
+    /// Fold the rows of a chunk result, in either result protocol.
+    /// @return false, with a description in 'msg', if the rows could not
+    ///         be folded.
+    virtual bool add(proto::Result const& result, std::string& msg) = 0;
+
+    /// Put the final rows and their schema into 'result' (protocol 2).
+    /// @return false, with a description in 'msg', upon failure.
+    virtual bool getResult(proto::Result& result, std::string& msg) const = 0;
+};
+
+}}} // namespace lsst::qserv::rproc
+
+#endif // LSST_QSERV_RPROC_ROWFOLDER_H
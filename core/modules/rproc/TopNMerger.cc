@@ -0,0 +1,441 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "rproc/TopNMerger.h"
+
+// System headers
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <string.h>
+
+// Third-party headers
+#include "boost/algorithm/string/predicate.hpp"
+#include <mysql/mysql.h>
+
+// Qserv headers
+#include "proto/ColumnBatchBuilder.h"
+#include "query/OrderByClause.h"
+#include "query/SelectList.h"
+#include "query/SelectStmt.h"
+#include "query/ValueExpr.h"
+
+namespace {
+
+/// @return the index of the column named 'name' in 'schema', -1 if there is
+/// no such column or more than one.
+int findColumn(lsst::qserv::proto::RowSchema const& schema, std::string const& name) {
+    int found = -1;
+    for (int i = 0, e = schema.columnschema_size(); i != e; ++i) {
+        if (boost::algorithm::iequals(schema.columnschema(i).name(), name)) {
+            if (found >= 0) {
+                return -1;
+            }
+            found = i;
+        }
+    }
+    return found;
+}
+
+/// Split decimal text into its sign and its digits without leading zeros
+/// before the point nor trailing zeros after it.
+/// @return false if the text is not a decimal number.
+bool splitDecimal(std::string const& text, bool& negative, std::string& intDigits,
+                  std::string& fracDigits) {
+    std::size_t i = 0;
+    negative = (!text.empty() && text[0] == '-');
+    if (!text.empty() && (text[0] == '-' || text[0] == '+')) {
+        ++i;
+    }
+    std::size_t const point = text.find('.', i);
+    std::size_t const intEnd = (point == std::string::npos) ? text.size() : point;
+    if (intEnd == i && (point == std::string::npos || point + 1 == text.size())) {
+        return false;
+    }
+    for (std::size_t j = i; j < text.size(); ++j) {
+        if (j != point && (text[j] < '0' || text[j] > '9')) {
+            return false;
+        }
+    }
+    while (i < intEnd && text[i] == '0') {
+        ++i;
+    }
+    intDigits.assign(text, i, intEnd - i);
+    fracDigits.clear();
+    if (point != std::string::npos) {
+        std::size_t fracEnd = text.size();
+        while (fracEnd > point + 1 && text[fracEnd - 1] == '0') {
+            --fracEnd;
+        }
+        fracDigits.assign(text, point + 1, fracEnd - point - 1);
+    }
+    if (intDigits.empty() && fracDigits.empty()) {
+        negative = false; // -0.00 is 0
+    }
+    return true;
+}
+
+/// @return <0, 0 or >0 as decimal text 'a' is less than, equal to or
+/// greater than 'b'. Both must be valid decimal numbers.
+int compareDecimal(std::string const& a, std::string const& b) {
+    bool aNegative, bNegative;
+    std::string aInt, aFrac, bInt, bFrac;
+    splitDecimal(a, aNegative, aInt, aFrac);
+    splitDecimal(b, bNegative, bInt, bFrac);
+    if (aNegative != bNegative) {
+        return aNegative ? -1 : 1;
+    }
+    int c = (aInt.size() != bInt.size()) ? (aInt.size() < bInt.size() ? -1 : 1)
+                                         : aInt.compare(bInt);
+    if (c == 0) {
+        c = aFrac.compare(bFrac);
+    }
+    return aNegative ? -c : c;
+}
+
+template <typename T>
+int compareValues(T const& a, T const& b) {
+    return (a < b) ? -1 : (b < a) ? 1 : 0;
+}
+
+} // anonymous namespace
+
+namespace lsst {
+namespace qserv {
+namespace rproc {
+
+TopNMerger::Ptr TopNMerger::newMerger(query::SelectStmt& mergeStmt) {
+    if (!mergeStmt.hasOrderBy() || !mergeStmt.hasLimit() || mergeStmt.getLimit() < 0
+        || mergeStmt.hasGroupBy() || mergeStmt.hasHaving() || mergeStmt.getDistinct()) {
+        return nullptr;
+    }
+    auto selectList = mergeStmt.getSelectList().getValueExprList();
+    if (!selectList || selectList->empty()) {
+        return nullptr;
+    }
+    Ptr merger(new TopNMerger(mergeStmt.getLimit()));
+    for (auto const& expr : *selectList) {
+        if (!expr) {
+            return nullptr;
+        }
+        if (expr->isStar()) {
+            // Only a lone * keeps the columns of the chunk results as they are.
+            if (selectList->size() != 1) {
+                return nullptr;
+            }
+            merger->_star = true;
+        } else if (expr->isColumnRef()) {
+            OutColumn out;
+            out.name = expr->getColumnRef()->column;
+            out.alias = expr->getAlias();
+            merger->_out.push_back(out);
+        } else {
+            return nullptr;
+        }
+    }
+    for (auto& term : mergeStmt.getOrderBy().getTerms()) {
+        auto const& expr = term.getExpr();
+        if (!expr || !expr->isColumnRef() || !term.getCollate().empty()) {
+            return nullptr;
+        }
+        SortColumn sort;
+        sort.name = expr->getColumnRef()->column;
+        sort.descending = (term.getOrder() == query::OrderByTerm::DESC);
+        merger->_sort.push_back(sort);
+    }
+    if (merger->_sort.empty()) {
+        return nullptr;
+    }
+    return merger;
+}
+
+bool TopNMerger::setSchema(proto::RowSchema const& schema) {
+    for (auto& sort : _sort) {
+        sort.column = findColumn(schema, sort.name);
+        if (sort.column < 0 || !schema.columnschema(sort.column).has_mysqltype()) {
+            return false;
+        }
+        switch (schema.columnschema(sort.column).mysqltype()) {
+        case MYSQL_TYPE_TINY:
+        case MYSQL_TYPE_SHORT:
+        case MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_INT24:
+        case MYSQL_TYPE_LONGLONG:
+        case MYSQL_TYPE_YEAR:
+            sort.kind = INTEGER;
+            break;
+        case MYSQL_TYPE_FLOAT:
+        case MYSQL_TYPE_DOUBLE:
+            sort.kind = REAL;
+            break;
+        case MYSQL_TYPE_DECIMAL:
+        case MYSQL_TYPE_NEWDECIMAL:
+            sort.kind = DECIMAL;
+            break;
+        case MYSQL_TYPE_DATE:
+        case MYSQL_TYPE_NEWDATE:
+        case MYSQL_TYPE_DATETIME:
+        case MYSQL_TYPE_TIMESTAMP:
+            // Their text, zero padded from the year down, sorts as they do.
+            sort.kind = TEMPORAL;
+            break;
+        default:
+            // Strings sort according to their collation, leave them to MySQL.
+            return false;
+        }
+    }
+    if (_star) {
+        _out.clear();
+        for (int i = 0, e = schema.columnschema_size(); i != e; ++i) {
+            OutColumn out;
+            out.name = schema.columnschema(i).name();
+            _out.push_back(out);
+        }
+    }
+    _schema.Clear();
+    for (std::size_t c = 0; c < _out.size(); ++c) {
+        OutColumn& out = _out[c];
+        out.column = _star ? static_cast<int>(c) : findColumn(schema, out.name);
+        if (out.column < 0) {
+            return false;
+        }
+        proto::ColumnSchema* cs = _schema.add_columnschema();
+        *cs = schema.columnschema(out.column);
+        if (!out.alias.empty()) {
+            cs->set_name(out.alias);
+        }
+    }
+    _keys.resize(_sort.size());
+    return true;
+}
+
+bool TopNMerger::add(proto::Result const& result, std::string& msg) {
+    if (_limit == 0) {
+        return true;
+    }
+    int const rowCount = (result.columnbatch_size() > 0) ? result.rowcount() : result.row_size();
+    auto const heapLess = [this](Row const& a, Row const& b) { return _before(a.keys, b.keys); };
+    for (int row = 0; row < rowCount; ++row) {
+        for (std::size_t k = 0; k < _sort.size(); ++k) {
+            if (!_readKey(result, row, _sort[k], _keys[k], msg)) {
+                return false;
+            }
+        }
+        bool const full = (_rows.size() >= _limit);
+        if (full && !_before(_keys, _rows.front().keys)) {
+            continue; // Not better than the last kept row.
+        }
+        Row newRow;
+        if (full) {
+            // Reuse the storage of the row being dropped.
+            std::pop_heap(_rows.begin(), _rows.end(), heapLess);
+            newRow = std::move(_rows.back());
+            _rows.pop_back();
+        }
+        newRow.keys.swap(_keys);
+        newRow.values.resize(_out.size());
+        newRow.nulls.resize(_out.size());
+        for (std::size_t c = 0; c < _out.size(); ++c) {
+            _readValue(result, row, _out[c].column, newRow.values[c], newRow.nulls[c]);
+        }
+        _rows.push_back(std::move(newRow));
+        std::push_heap(_rows.begin(), _rows.end(), heapLess);
+        _keys.resize(_sort.size());
+    }
+    return true;
+}
+
+bool TopNMerger::getResult(proto::Result& result, std::string& msg) const {
+    result.set_continues(false);
+    result.set_queryid(0);
+    result.set_jobid(0);
+    result.set_largeresult(false);
+    result.set_transmitsize(0);
+    *result.mutable_rowschema() = _schema;
+    std::vector<Row const*> order;
+    order.reserve(_rows.size());
+    for (auto const& row : _rows) {
+        order.push_back(&row);
+    }
+    std::sort(order.begin(), order.end(), [this](Row const* a, Row const* b) {
+        return _before(a->keys, b->keys);
+    });
+    for (Row const* row : order) {
+        proto::RowBundle* rowBundle = result.add_row();
+        for (std::size_t c = 0; c < row->values.size(); ++c) {
+            rowBundle->add_column(row->values[c]);
+            rowBundle->add_isnull(row->nulls[c] != 0);
+        }
+    }
+    result.set_rowcount(order.size());
+    return true;
+}
+
+bool TopNMerger::_readKey(proto::Result const& result, int row, SortColumn const& sort,
+                          Key& key, std::string& msg) const {
+    using Builder = proto::ColumnBatchBuilder;
+    key.isNull = true;
+    char const* text = nullptr;
+    std::size_t length = 0;
+    if (result.columnbatch_size() > 0) {
+        // Protocol 3, the message has passed checkResultRows().
+        proto::ColumnBatch const& batch = result.columnbatch(sort.column);
+        if (Builder::isNull(batch.nulls(), row)) {
+            return true;
+        }
+        std::size_t const width = Builder::fixedWidth(batch.encoding());
+        if (width != 0) {
+            std::uint64_t const bits = Builder::getUint(&batch.fixed()[width * row], width);
+            if (sort.kind == INTEGER && batch.encoding() == proto::ColumnBatch::INT64) {
+                key.integer = static_cast<std::int64_t>(bits);
+            } else if (sort.kind == INTEGER && batch.encoding() == proto::ColumnBatch::UINT64) {
+                key.integer = bits;
+            } else if (sort.kind == REAL && batch.encoding() == proto::ColumnBatch::DOUBLE) {
+                memcpy(&key.real, &bits, sizeof(key.real));
+            } else if (sort.kind == REAL && batch.encoding() == proto::ColumnBatch::FLOAT) {
+                std::uint32_t const floatBits = bits;
+                float f;
+                memcpy(&f, &floatBits, sizeof(f));
+                key.real = f;
+            } else {
+                msg = "Unexpected encoding of " + sort.name;
+                return false;
+            }
+            key.isNull = false;
+            return true;
+        }
+        std::size_t const begin = (row == 0) ? 0 : Builder::getUint(&batch.offsets()[4 * (row - 1)], 4);
+        std::size_t const end = Builder::getUint(&batch.offsets()[4 * row], 4);
+        text = batch.data().data() + begin;
+        length = end - begin;
+    } else {
+        proto::RowBundle const& rowBundle = result.row(row);
+        if (sort.column >= rowBundle.column_size()) {
+            msg = "Missing column " + sort.name + " in result row";
+            return false;
+        }
+        if (sort.column < rowBundle.isnull_size() && rowBundle.isnull(sort.column)) {
+            return true;
+        }
+        text = rowBundle.column(sort.column).data();
+        length = rowBundle.column(sort.column).size();
+    }
+    key.text.assign(text, length);
+    char* parsedEnd = nullptr;
+    errno = 0;
+    switch (sort.kind) {
+    case INTEGER:
+        if (!key.text.empty() && key.text[0] == '-') {
+            key.integer = std::strtoll(key.text.c_str(), &parsedEnd, 10);
+        } else {
+            key.integer = std::strtoull(key.text.c_str(), &parsedEnd, 10);
+        }
+        break;
+    case REAL:
+        key.real = std::strtod(key.text.c_str(), &parsedEnd);
+        break;
+    case DECIMAL: {
+        bool negative;
+        std::string intDigits, fracDigits;
+        if (splitDecimal(key.text, negative, intDigits, fracDigits)) {
+            parsedEnd = &key.text[0] + key.text.size();
+        }
+        break;
+    }
+    case TEMPORAL:
+        key.isNull = false;
+        return true;
+    }
+    if (key.text.empty() || errno == ERANGE || parsedEnd != &key.text[0] + key.text.size()) {
+        msg = "Invalid value of " + sort.name + ": " + key.text;
+        return false;
+    }
+    key.isNull = false;
+    return true;
+}
+
+void TopNMerger::_readValue(proto::Result const& result, int row, int column,
+                            std::string& value, char& isNull) {
+    using Builder = proto::ColumnBatchBuilder;
+    value.clear();
+    isNull = 1;
+    if (result.columnbatch_size() > 0) {
+        proto::ColumnBatch const& batch = result.columnbatch(column);
+        if (Builder::isNull(batch.nulls(), row)) {
+            return;
+        }
+        isNull = 0;
+        std::size_t const width = Builder::fixedWidth(batch.encoding());
+        if (width != 0) {
+            char buf[Builder::FORMAT_BUFFER_SIZE];
+            std::uint64_t const bits = Builder::getUint(&batch.fixed()[width * row], width);
+            value.assign(buf, Builder::formatFixed(buf, batch.encoding(), bits));
+            return;
+        }
+        std::size_t const begin = (row == 0) ? 0 : Builder::getUint(&batch.offsets()[4 * (row - 1)], 4);
+        std::size_t const end = Builder::getUint(&batch.offsets()[4 * row], 4);
+        value.assign(batch.data(), begin, end - begin);
+        return;
+    }
+    proto::RowBundle const& rowBundle = result.row(row);
+    if (column >= rowBundle.column_size()
+        || (column < rowBundle.isnull_size() && rowBundle.isnull(column))) {
+        return;
+    }
+    isNull = 0;
+    value = rowBundle.column(column);
+}
+
+/// @return true if sort key 'a' comes before 'b' in ORDER BY order.
+bool TopNMerger::_before(std::vector<Key> const& a, std::vector<Key> const& b) const {
+    for (std::size_t k = 0; k < _sort.size(); ++k) {
+        int c = _compare(a[k], b[k], _sort[k].kind);
+        if (c != 0) {
+            return _sort[k].descending ? c > 0 : c < 0;
+        }
+    }
+    return false;
+}
+
+/// @return <0, 0 or >0 as 'a' is less than, equal to or greater than 'b',
+/// NULL being the least value.
+int TopNMerger::_compare(Key const& a, Key const& b, Kind kind) {
+    if (a.isNull || b.isNull) {
+        return compareValues(!a.isNull, !b.isNull);
+    }
+    switch (kind) {
+    case INTEGER:
+        return compareValues(a.integer, b.integer);
+    case REAL:
+        return compareValues(a.real, b.real);
+    case DECIMAL:
+        return compareDecimal(a.text, b.text);
+    case TEMPORAL:
+        return a.text.compare(b.text);
+    }
+    return 0;
+}
+
+}}} // namespace lsst::qserv::rproc
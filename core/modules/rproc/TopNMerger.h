@@ -0,0 +1,137 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef LSST_QSERV_RPROC_TOPNMERGER_H
+#define LSST_QSERV_RPROC_TOPNMERGER_H
+
+// System headers
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Qserv headers
+#include "proto/worker.pb.h"
+#include "rproc/RowFolder.h"
+
+// Forward declarations
+namespace lsst {
+namespace qserv {
+namespace query {
+    class SelectStmt;
+}}} // End of forward declarations
+
+namespace lsst {
+namespace qserv {
+namespace rproc {
+
+/// TopNMerger keeps the first n rows of "SELECT ... ORDER BY ... LIMIT n"
+/// chunk results in a bounded heap, so that only n rows are written to the
+/// result table whatever the number of chunks. It handles merge statements
+/// whose select list only has columns (or *), without GROUP BY, DISTINCT or
+/// HAVING, and that order by columns of the chunk results.
+///
+/// Rows are ordered as MySQL orders them: NULL first in ascending order,
+/// integer and DECIMAL values exactly, floating point values as doubles,
+/// DATE, DATETIME and TIMESTAMP values by their text. Other types (notably
+/// strings, whose order depends on their collation) are left to MySQL.
+/// Rows that do not sort before the last kept row are dropped as soon as
+/// their sort columns are read.
+class TopNMerger : public RowFolder {
+public:
+    typedef std::shared_ptr<TopNMerger> Ptr;
+
+    /// @return a merger for 'mergeStmt', nullptr if its form is not supported.
+    static Ptr newMerger(query::SelectStmt& mergeStmt);
+
+    TopNMerger(TopNMerger const&) = delete;
+    TopNMerger& operator=(TopNMerger const&) = delete;
+
+    /// @return false if a sort column can not be compared here.
+    bool setSchema(proto::RowSchema const& schema) override;
+
+    /// @return false, with a description in 'msg', if a sort value could
+    ///         not be read.
+    bool add(proto::Result const& result, std::string& msg) override;
+
+    /// @return the number of rows kept so far.
+    std::size_t getRowCount() const { return _rows.size(); }
+
+    /// Rows come in ORDER BY order.
+    bool getResult(proto::Result& result, std::string& msg) const override;
+
+private:
+    enum Kind { INTEGER, REAL, DECIMAL, TEMPORAL };
+
+    /// A value of a sort column.
+    struct Key {
+        bool isNull{true};
+        __int128 integer{0};
+        double real{0};
+        std::string text; ///< DECIMAL and TEMPORAL values
+    };
+
+    /// A column of the sort key.
+    struct SortColumn {
+        std::string name;
+        bool descending{false};
+        int column{-1}; ///< Index in the chunk schema
+        Kind kind{INTEGER};
+    };
+
+    /// A column of the final result.
+    struct OutColumn {
+        std::string name; ///< Name in the chunk results
+        std::string alias; ///< Name in the final result, empty for name
+        int column{-1}; ///< Index in the chunk schema
+    };
+
+    /// A kept row, its values are empty when NULL.
+    struct Row {
+        std::vector<Key> keys;
+        std::vector<std::string> values;
+        std::vector<char> nulls;
+    };
+
+    explicit TopNMerger(std::size_t limit) : _limit(limit) {}
+
+    bool _readKey(proto::Result const& result, int row, SortColumn const& sort, Key& key,
+                  std::string& msg) const;
+    static void _readValue(proto::Result const& result, int row, int column,
+                           std::string& value, char& isNull);
+    bool _before(std::vector<Key> const& a, std::vector<Key> const& b) const;
+    static int _compare(Key const& a, Key const& b, Kind kind);
+
+    std::size_t const _limit;
+    bool _star{false}; ///< Output all the columns of the chunk results
+    std::vector<SortColumn> _sort;
+    std::vector<OutColumn> _out;
+    proto::RowSchema _schema; ///< Schema of the final result
+
+    /// Kept rows, a heap whose front sorts last.
+    std::vector<Row> _rows;
+    std::vector<Key> _keys; ///< Sort key of the row being read
+};
+
+}}} // namespace lsst::qserv::rproc
+
+#endif // LSST_QSERV_RPROC_TOPNMERGER_H
@@ -0,0 +1,147 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+ /**
+  * @file
+  *
+  * @brief Simple testing for AggregateMerger
+  */
+
+// System headers
+#include <string>
+#include <vector>
+
+// Third-party headers
+#include "mysql/mysql.h"
+
+// Qserv headers
+#include "proto/ColumnBatchBuilder.h"
+#include "proto/worker.pb.h"
+#include "rproc/AggregateMerger.h"
+#include "rproc/testMergerUtils.h"
+
+// Boost unit test header
+#define BOOST_TEST_MODULE AggregateMerger_1
+#include "boost/test/included/unit_test.hpp"
+
+namespace test = boost::test_tools;
+
+using lsst::qserv::proto::ColumnBatch;
+using lsst::qserv::proto::ColumnBatchBuilder;
+using lsst::qserv::proto::Result;
+using lsst::qserv::proto::RowSchema;
+using lsst::qserv::rproc::AggregateMerger;
+using lsst::qserv::rproc::testing::addColumn;
+using lsst::qserv::rproc::testing::addRow;
+using lsst::qserv::rproc::testing::cell;
+using lsst::qserv::rproc::testing::newMerger;
+
+BOOST_AUTO_TEST_SUITE(Suite)
+
+BOOST_AUTO_TEST_CASE(Supported) {
+    // Merge statements as written by AggregatePlugin.
+    BOOST_CHECK(newMerger<AggregateMerger>("SELECT SUM(QS1_COUNT) AS n FROM r"));
+    BOOST_CHECK(newMerger<AggregateMerger>("SELECT f,MIN(QS1_MIN),MAX(QS2_MAX) FROM r GROUP BY f"));
+    BOOST_CHECK(newMerger<AggregateMerger>("SELECT (SUM(QS1_SUM)/SUM(QS2_COUNT)) AS a FROM r"));
+    // Anything else is left to MySQL.
+    BOOST_CHECK(!newMerger<AggregateMerger>("SELECT f,SUM(QS1_COUNT) FROM r"));
+    BOOST_CHECK(!newMerger<AggregateMerger>(
+        "SELECT f,SUM(QS1_COUNT) AS n FROM r GROUP BY f ORDER BY n"));
+    BOOST_CHECK(!newMerger<AggregateMerger>("SELECT f,SUM(QS1_COUNT) FROM r GROUP BY f LIMIT 3"));
+    BOOST_CHECK(!newMerger<AggregateMerger>(
+        "SELECT f,SUM(QS1_COUNT) AS n FROM r GROUP BY f HAVING n > 2"));
+    BOOST_CHECK(!newMerger<AggregateMerger>("SELECT DISTINCT f FROM r GROUP BY f"));
+    BOOST_CHECK(!newMerger<AggregateMerger>("SELECT SUM(QS1_COUNT)+1 FROM r"));
+    BOOST_CHECK(!newMerger<AggregateMerger>("SELECT a FROM r"));
+}
+
+BOOST_AUTO_TEST_CASE(Fold) {
+    auto merger = newMerger<AggregateMerger>(
+        "SELECT filterId,SUM(QS1_COUNT) AS n,(SUM(QS2_SUM)/SUM(QS3_COUNT)) AS a,"
+        "MIN(QS4_MIN) AS lo,MAX(QS5_MAX) AS hi FROM r GROUP BY filterId");
+    BOOST_REQUIRE(merger);
+    RowSchema schema;
+    addColumn(schema, "filterId", "INT(11)", MYSQL_TYPE_LONG);
+    addColumn(schema, "QS1_COUNT", "BIGINT(21)", MYSQL_TYPE_LONGLONG);
+    addColumn(schema, "QS2_SUM", "DECIMAL(32,2)", MYSQL_TYPE_NEWDECIMAL);
+    addColumn(schema, "QS3_COUNT", "BIGINT(21)", MYSQL_TYPE_LONGLONG);
+    addColumn(schema, "QS4_MIN", "DOUBLE", MYSQL_TYPE_DOUBLE);
+    addColumn(schema, "QS5_MAX", "INT(11)", MYSQL_TYPE_LONG);
+    BOOST_REQUIRE(merger->setSchema(schema));
+
+    std::string msg;
+    Result r2;
+    *r2.mutable_rowschema() = schema;
+    addRow(r2, {"2", "3", "10.01", "3", "1.5", "-3"});
+    addRow(r2, {"1", "1", "-0.05", "1", "-2", "1"});
+    addRow(r2, {nullptr, "2", "1.00", "2", "7", nullptr});
+    BOOST_REQUIRE(merger->add(r2, msg));
+
+    // The same columns in result protocol 3, DECIMAL arrives as text.
+    ColumnBatchBuilder builder({ColumnBatch::INT64, ColumnBatch::INT64, ColumnBatch::STRING,
+                                ColumnBatch::INT64, ColumnBatch::DOUBLE, ColumnBatch::INT64});
+    char const* row[] = {"2", "4", "5.00", "4", "0.25", "8"};
+    unsigned long lengths[] = {1, 1, 4, 1, 4, 1};
+    builder.addRow(row, lengths);
+    Result r3;
+    *r3.mutable_rowschema() = schema;
+    r3.set_rowcount(builder.getRowCount());
+    builder.moveTo(r3);
+    BOOST_REQUIRE(merger->add(r3, msg));
+    BOOST_CHECK_EQUAL(merger->getGroupCount(), 3U);
+
+    Result out;
+    BOOST_REQUIRE(merger->getResult(out, msg));
+    BOOST_REQUIRE_EQUAL(out.rowschema().columnschema_size(), 5);
+    BOOST_CHECK_EQUAL(out.rowschema().columnschema(0).name(), "filterId");
+    BOOST_CHECK_EQUAL(out.rowschema().columnschema(1).name(), "n");
+    BOOST_CHECK_EQUAL(out.rowschema().columnschema(1).sqltype(), "DECIMAL(65,0)");
+    BOOST_CHECK_EQUAL(out.rowschema().columnschema(2).sqltype(), "DECIMAL(65,6)");
+    BOOST_CHECK_EQUAL(out.rowschema().columnschema(3).sqltype(), "DOUBLE");
+    BOOST_REQUIRE_EQUAL(out.rowcount(), 3U);
+    BOOST_REQUIRE_EQUAL(out.row_size(), 3);
+    // Groups come in GROUP BY order, NULL first.
+    BOOST_CHECK_EQUAL(cell(out, 0, 0), "NULL");
+    BOOST_CHECK_EQUAL(cell(out, 0, 1), "2");
+    BOOST_CHECK_EQUAL(cell(out, 0, 2), "0.500000");
+    BOOST_CHECK_EQUAL(cell(out, 0, 3), "7");
+    BOOST_CHECK_EQUAL(cell(out, 0, 4), "NULL");
+    BOOST_CHECK_EQUAL(cell(out, 1, 0), "1");
+    BOOST_CHECK_EQUAL(cell(out, 1, 2), "-0.050000");
+    BOOST_CHECK_EQUAL(cell(out, 1, 3), "-2");
+    BOOST_CHECK_EQUAL(cell(out, 2, 0), "2");
+    BOOST_CHECK_EQUAL(cell(out, 2, 1), "7");
+    BOOST_CHECK_EQUAL(cell(out, 2, 2), "2.144286");
+    BOOST_CHECK_EQUAL(cell(out, 2, 3), "0.25");
+    BOOST_CHECK_EQUAL(cell(out, 2, 4), "8");
+}
+
+BOOST_AUTO_TEST_CASE(UnsupportedType) {
+    auto merger = newMerger<AggregateMerger>("SELECT f,MIN(QS1_MIN) FROM r GROUP BY f");
+    BOOST_REQUIRE(merger);
+    RowSchema schema;
+    addColumn(schema, "f", "INT(11)", MYSQL_TYPE_LONG);
+    addColumn(schema, "QS1_MIN", "VARCHAR(10)", MYSQL_TYPE_VAR_STRING);
+    BOOST_CHECK(!merger->setSchema(schema));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+ /**
+  * @file
+  *
+  * @brief Test functions shared by the AggregateMerger and TopNMerger tests
+  */
+
+#ifndef LSST_QSERV_RPROC_TESTMERGERUTILS_H
+#define LSST_QSERV_RPROC_TESTMERGERUTILS_H
+
+// System headers
+#include <string>
+#include <vector>
+
+// Qserv headers
+#include "parser/SelectParser.h"
+#include "proto/worker.pb.h"
+#include "query/SelectStmt.h"
+
+namespace lsst {
+namespace qserv {
+namespace rproc {
+namespace testing {
+
+/// Parse a merge statement and ask MergerT for a merger of it.
+template <typename MergerT>
+typename MergerT::Ptr newMerger(std::string const& mergeSql) {
+    parser::SelectParser::Ptr p = parser::SelectParser::newInstance(mergeSql);
+    p->setup();
+    return MergerT::newMerger(*p->getSelectStmt());
+}
+
+inline void addColumn(proto::RowSchema& schema, std::string const& name,
+                      std::string const& sqlType, int mysqlType) {
+    auto cs = schema.add_columnschema();
+    cs->set_name(name);
+    cs->set_hasdefault(false);
+    cs->set_sqltype(sqlType);
+    cs->set_mysqltype(mysqlType);
+}
+
+/// Add a row of string columns to a Result message, nullptr is NULL.
+inline void addRow(proto::Result& result, std::vector<char const*> const& cols) {
+    proto::RowBundle* rb = result.add_row();
+    for (auto col : cols) {
+        rb->add_column(col ? col : "");
+        rb->add_isnull(col == nullptr);
+    }
+    result.set_rowcount(result.row_size());
+}
+
+inline std::string cell(proto::Result const& result, int row, int col) {
+    auto const& rb = result.row(row);
+    return rb.isnull(col) ? "NULL" : rb.column(col);
+}
+
+}}}} // namespace lsst::qserv::rproc::testing
+
+#endif // LSST_QSERV_RPROC_TESTMERGERUTILS_H
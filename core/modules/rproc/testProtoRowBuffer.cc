@@ -22,6 +22,7 @@
  */
 
 // Qserv headers
+#include "proto/ColumnBatchBuilder.h"
 #include "proto/worker.pb.h"
 #include "proto/FakeProtocolFixture.h"
 
@@ -39,7 +40,35 @@ struct Fixture {
     ~Fixture(void) { }
 };
 using lsst::qserv::rproc::copyColumn;
+using lsst::qserv::rproc::escapeColumn;
 using lsst::qserv::rproc::escapeString;
+using lsst::qserv::rproc::newProtoRowBuffer;
+using lsst::qserv::rproc::truncateResultRows;
+
+namespace {
+/// Add a row of string columns to a Result message, column nullCol is
+/// marked NULL.
+void addRow(lsst::qserv::proto::Result& result, std::vector<std::string> const& cols,
+            int nullCol=-1) {
+    lsst::qserv::proto::RowBundle* rb = result.add_row();
+    for(int i=0, e=cols.size(); i != e; ++i) {
+        rb->add_column(cols[i]);
+        rb->add_isnull(i == nullCol);
+    }
+}
+
+/// Drain a RowBuffer using fetch() buffers of bufLen bytes.
+std::string fetchAll(lsst::qserv::mysql::RowBuffer& rowBuffer, unsigned bufLen) {
+    std::string out;
+    std::vector<char> buf(bufLen);
+    while(true) {
+        unsigned fetched = rowBuffer.fetch(&buf[0], bufLen);
+        if (fetched == 0) { break; }
+        out.append(&buf[0], fetched);
+    }
+    return out;
+}
+} // namespace
 
 BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
 
@@ -77,4 +106,120 @@ BOOST_AUTO_TEST_CASE(TestCopyColumn) {
     BOOST_CHECK_EQUAL(target, eSimple);
 }
 
+BOOST_AUTO_TEST_CASE(TestEscapeColumn) {
+    // Escapable bytes on both sides of a 16 byte boundary.
+    char src[] = "0123456789abcde\n\t0123456789abcdef0123456789\032";
+    std::string test1(src, (sizeof(src) / sizeof(src[0])) - 1);
+    std::string expected(test1.size() * 2, 'X');
+    int eCount = escapeString(expected.begin(), test1.begin(), test1.end());
+    std::string target(test1.size() * 2, 'X');
+    std::size_t count = escapeColumn(&target[0], test1.data(), test1.size());
+    BOOST_CHECK_EQUAL(count, static_cast<std::size_t>(eCount));
+    BOOST_CHECK_EQUAL(target.substr(0, count), expected.substr(0, eCount));
+}
+
+BOOST_AUTO_TEST_CASE(TestFetch) {
+    lsst::qserv::proto::Result result;
+    addRow(result, {"1", "a\tb"});
+    addRow(result, {"2", "x"}, 1);
+    addRow(result, {"3", std::string(100, 'z')});
+    std::string expected = "'1'\t'a\\tb'\n'2'\t\\N\n'3'\t'" + std::string(100, 'z') + "'";
+
+    // Buffer holding every row, buffers smaller than a row.
+    for(unsigned bufLen : {4096u, 7u, 1u}) {
+        auto rowBuffer = newProtoRowBuffer(result);
+        BOOST_CHECK_EQUAL(fetchAll(*rowBuffer, bufLen), expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestFetchColumnar) {
+    using lsst::qserv::proto::ColumnBatch;
+    lsst::qserv::proto::ColumnBatchBuilder builder({ColumnBatch::INT64, ColumnBatch::DOUBLE,
+                                                    ColumnBatch::STRING, ColumnBatch::UINT64});
+    std::vector<std::vector<char const*>> rows = {
+        {"-42", "0.5", "a\tb", "18446744073709551615"},
+        {nullptr, "1e-300", nullptr, "0"},
+        {"7", "-2.25", "", nullptr}};
+    for (auto const& row : rows) {
+        std::vector<unsigned long> lengths;
+        for (auto val : row) { lengths.push_back(val ? strlen(val) : 0); }
+        builder.addRow(row.data(), lengths.data());
+    }
+    lsst::qserv::proto::Result result;
+    for (int i=0; i < 4; ++i) { result.mutable_rowschema()->add_columnschema(); }
+    result.set_rowcount(builder.getRowCount());
+    builder.moveTo(result);
+    BOOST_CHECK_EQUAL(result.columnbatch(0).encoding(), ColumnBatch::INT64);
+    BOOST_CHECK_EQUAL(result.columnbatch(0).fixed().size(), 24u);
+
+    std::string msg;
+    BOOST_CHECK(lsst::qserv::rproc::checkResultRows(result, msg));
+    std::string expected = "'-42'\t'0.5'\t'a\\tb'\t'18446744073709551615'\n"
+        "\\N\t'1e-300'\t\\N\t'0'\n"
+        "'7'\t'-2.25'\t''\t\\N";
+    auto rowBuffer = newProtoRowBuffer(result);
+    BOOST_CHECK_EQUAL(fetchAll(*rowBuffer, 4096), expected);
+
+    // Truncated column data is rejected.
+    result.mutable_columnbatch(1)->mutable_fixed()->resize(16);
+    BOOST_CHECK(!lsst::qserv::rproc::checkResultRows(result, msg));
+}
+
+BOOST_AUTO_TEST_CASE(TestColumnarFallback) {
+    // A value that does not parse turns the column into a STRING column.
+    using lsst::qserv::proto::ColumnBatch;
+    lsst::qserv::proto::ColumnBatchBuilder builder({ColumnBatch::INT64});
+    char const* rows[] = {"12", nullptr, "abc"};
+    unsigned long lengths[] = {2, 0, 3};
+    for (int i=0; i < 3; ++i) {
+        builder.addRow(&rows[i], &lengths[i]);
+    }
+    lsst::qserv::proto::Result result;
+    result.mutable_rowschema()->add_columnschema();
+    result.set_rowcount(builder.getRowCount());
+    builder.moveTo(result);
+    BOOST_CHECK_EQUAL(result.columnbatch(0).encoding(), ColumnBatch::STRING);
+    std::string msg;
+    BOOST_CHECK(lsst::qserv::rproc::checkResultRows(result, msg));
+    auto rowBuffer = newProtoRowBuffer(result);
+    BOOST_CHECK_EQUAL(fetchAll(*rowBuffer, 4096), "'12'\n\\N\n'abc'");
+}
+
+BOOST_AUTO_TEST_CASE(TestTruncate) {
+    lsst::qserv::proto::Result r2;
+    r2.mutable_rowschema()->add_columnschema();
+    for (auto v : {"1", "2", "3"}) { addRow(r2, {v}); }
+    r2.set_rowcount(3);
+    truncateResultRows(r2, 2);
+    BOOST_CHECK_EQUAL(r2.rowcount(), 2u);
+    auto rowBuffer = newProtoRowBuffer(r2);
+    BOOST_CHECK_EQUAL(fetchAll(*rowBuffer, 4096), "'1'\n'2'");
+
+    using lsst::qserv::proto::ColumnBatch;
+    lsst::qserv::proto::ColumnBatchBuilder builder({ColumnBatch::INT64, ColumnBatch::STRING});
+    std::vector<std::vector<char const*>> rows;
+    for (int i=0; i < 10; ++i) {
+        rows.push_back({(i % 3 == 0) ? nullptr : "5", (i == 8) ? nullptr : "xy"});
+    }
+    for (auto const& row : rows) {
+        std::vector<unsigned long> lengths;
+        for (auto val : row) { lengths.push_back(val ? strlen(val) : 0); }
+        builder.addRow(row.data(), lengths.data());
+    }
+    lsst::qserv::proto::Result r3;
+    for (int i=0; i < 2; ++i) { r3.mutable_rowschema()->add_columnschema(); }
+    r3.set_rowcount(builder.getRowCount());
+    builder.moveTo(r3);
+    // Dropped rows must not leave NULL bits behind.
+    truncateResultRows(r3, 4);
+    BOOST_CHECK_EQUAL(r3.rowcount(), 4u);
+    std::string msg;
+    BOOST_CHECK(lsst::qserv::rproc::checkResultRows(r3, msg));
+    rowBuffer = newProtoRowBuffer(r3);
+    BOOST_CHECK_EQUAL(fetchAll(*rowBuffer, 4096), "\\N\t'xy'\n'5'\t'xy'\n'5'\t'xy'\n\\N\t'xy'");
+    truncateResultRows(r3, 0);
+    BOOST_CHECK_EQUAL(r3.rowcount(), 0u);
+    BOOST_CHECK(lsst::qserv::rproc::checkResultRows(r3, msg));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
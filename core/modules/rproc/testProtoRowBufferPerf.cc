@@ -0,0 +1,102 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsstcorp.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+/// Micro-benchmark for ProtoRowBuffer: reports the rate at which rows from
+/// a Result message are converted into LOAD DATA INFILE text, for a narrow
+/// and a wide schema. Not run as a unit test.
+///
+/// Usage: testProtoRowBufferPerf [rows-per-message]
+
+// System headers
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Qserv headers
+#include "proto/worker.pb.h"
+#include "rproc/ProtoRowBuffer.h"
+
+namespace {
+
+using lsst::qserv::proto::Result;
+using lsst::qserv::proto::RowBundle;
+
+/// Fill a Result message with rows of numeric-looking columns, one in
+/// every escapeEvery columns containing a tab that needs escaping.
+void fillResult(Result& result, int rows, int cols, int escapeEvery) {
+    for(int r=0; r < rows; ++r) {
+        RowBundle* rb = result.add_row();
+        for(int c=0; c < cols; ++c) {
+            std::string val = std::to_string(r * 1000003LL + c) + ".123456789012";
+            if (escapeEvery > 0 && c % escapeEvery == 0) {
+                val += "\tx";
+            }
+            rb->add_column(val);
+            rb->add_isnull(false);
+        }
+    }
+}
+
+/// Convert the rows of result, as LocalInfile does, several times.
+/// @return the total number of bytes produced
+double drain(Result& result, int passes, unsigned bufLen) {
+    std::vector<char> buffer(bufLen);
+    double total = 0;
+    for(int p=0; p < passes; ++p) {
+        auto rowBuffer = lsst::qserv::rproc::newProtoRowBuffer(result);
+        unsigned fetched;
+        while((fetched = rowBuffer->fetch(&buffer[0], bufLen)) > 0) {
+            total += fetched;
+        }
+    }
+    return total;
+}
+
+void run(std::string const& name, int rows, int cols, int escapeEvery) {
+    Result result;
+    fillResult(result, rows, cols, escapeEvery);
+    int const passes = 5;
+    unsigned const bufLen = 1024*1024; // Same as LocalInfile
+    drain(result, 1, bufLen); // warm up
+    auto start = std::chrono::steady_clock::now();
+    double bytes = drain(result, passes, bufLen);
+    auto end = std::chrono::steady_clock::now();
+    double secs = std::chrono::duration<double>(end - start).count();
+    std::cout << std::setw(24) << std::left << name
+              << " rows=" << rows << " cols=" << cols
+              << " MB=" << std::fixed << std::setprecision(1) << bytes / 1e6
+              << " MB/s=" << (secs > 0 ? bytes / 1e6 / secs : 0) << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int rows = (argc > 1) ? std::atoi(argv[1]) : 100000;
+    run("narrow", rows, 5, 0);
+    run("narrow, escaped", rows, 5, 2);
+    run("wide", rows / 50, 500, 0);
+    run("wide, escaped", rows / 50, 500, 10);
+    return 0;
+}
@@ -0,0 +1,169 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+ /**
+  * @file
+  *
+  * @brief Simple testing for TopNMerger
+  */
+
+// System headers
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+// Third-party headers
+#include "mysql/mysql.h"
+
+// Qserv headers
+#include "proto/ColumnBatchBuilder.h"
+#include "proto/worker.pb.h"
+#include "rproc/TopNMerger.h"
+#include "rproc/testMergerUtils.h"
+
+// Boost unit test header
+#define BOOST_TEST_MODULE TopNMerger_1
+#include "boost/test/included/unit_test.hpp"
+
+namespace test = boost::test_tools;
+
+using lsst::qserv::proto::ColumnBatch;
+using lsst::qserv::proto::ColumnBatchBuilder;
+using lsst::qserv::proto::Result;
+using lsst::qserv::proto::RowSchema;
+using lsst::qserv::rproc::TopNMerger;
+using lsst::qserv::rproc::testing::addColumn;
+using lsst::qserv::rproc::testing::addRow;
+using lsst::qserv::rproc::testing::cell;
+using lsst::qserv::rproc::testing::newMerger;
+
+BOOST_AUTO_TEST_SUITE(Suite)
+
+BOOST_AUTO_TEST_CASE(Supported) {
+    BOOST_CHECK(newMerger<TopNMerger>("SELECT * FROM r ORDER BY ra LIMIT 10"));
+    BOOST_CHECK(newMerger<TopNMerger>(
+        "SELECT objectId,ra AS x FROM r ORDER BY x DESC,objectId LIMIT 3"));
+    // Anything else is left to MySQL.
+    BOOST_CHECK(!newMerger<TopNMerger>("SELECT * FROM r ORDER BY ra"));
+    BOOST_CHECK(!newMerger<TopNMerger>("SELECT * FROM r LIMIT 10"));
+    BOOST_CHECK(!newMerger<TopNMerger>("SELECT DISTINCT ra FROM r ORDER BY ra LIMIT 10"));
+    BOOST_CHECK(!newMerger<TopNMerger>(
+        "SELECT f,SUM(QS1_SUM) FROM r GROUP BY f ORDER BY f LIMIT 3"));
+    BOOST_CHECK(!newMerger<TopNMerger>("SELECT ra+1 FROM r ORDER BY ra LIMIT 10"));
+    BOOST_CHECK(!newMerger<TopNMerger>("SELECT * FROM r ORDER BY ra+decl LIMIT 10"));
+}
+
+BOOST_AUTO_TEST_CASE(Keep) {
+    auto merger = newMerger<TopNMerger>("SELECT id AS x,d FROM r ORDER BY d DESC,id LIMIT 4");
+    BOOST_REQUIRE(merger);
+    RowSchema schema;
+    addColumn(schema, "id", "BIGINT(20)", MYSQL_TYPE_LONGLONG);
+    addColumn(schema, "d", "DECIMAL(10,2)", MYSQL_TYPE_NEWDECIMAL);
+    addColumn(schema, "name", "VARCHAR(10)", MYSQL_TYPE_VAR_STRING);
+    BOOST_REQUIRE(merger->setSchema(schema));
+
+    std::string msg;
+    Result r2;
+    *r2.mutable_rowschema() = schema;
+    addRow(r2, {"5", "1.50", "a"});
+    addRow(r2, {"3", "-0.5", "b"});
+    addRow(r2, {"9", nullptr, "c"});
+    addRow(r2, {"1", "10.00", "d"});
+    addRow(r2, {"2", "1.5", "e"});
+    BOOST_REQUIRE(merger->add(r2, msg));
+
+    // Result protocol 3, DECIMAL arrives as text.
+    ColumnBatchBuilder builder({ColumnBatch::INT64, ColumnBatch::STRING, ColumnBatch::STRING});
+    char const* row1[] = {"0", "1.5", "f"};
+    unsigned long lengths1[] = {1, 3, 1};
+    builder.addRow(row1, lengths1);
+    char const* row2[] = {"7", "2", "g"};
+    unsigned long lengths2[] = {1, 1, 1};
+    builder.addRow(row2, lengths2);
+    Result r3;
+    *r3.mutable_rowschema() = schema;
+    r3.set_rowcount(builder.getRowCount());
+    builder.moveTo(r3);
+    BOOST_REQUIRE(merger->add(r3, msg));
+    BOOST_CHECK_EQUAL(merger->getRowCount(), 4U);
+
+    Result out;
+    BOOST_REQUIRE(merger->getResult(out, msg));
+    BOOST_REQUIRE_EQUAL(out.rowschema().columnschema_size(), 2);
+    BOOST_CHECK_EQUAL(out.rowschema().columnschema(0).name(), "x");
+    BOOST_CHECK_EQUAL(out.rowschema().columnschema(1).sqltype(), "DECIMAL(10,2)");
+    BOOST_REQUIRE_EQUAL(out.row_size(), 4);
+    BOOST_CHECK_EQUAL(out.rowcount(), 4U);
+    BOOST_CHECK_EQUAL(cell(out, 0, 0), "1");
+    BOOST_CHECK_EQUAL(cell(out, 0, 1), "10.00");
+    BOOST_CHECK_EQUAL(cell(out, 1, 0), "7");
+    BOOST_CHECK_EQUAL(cell(out, 2, 0), "0");
+    BOOST_CHECK_EQUAL(cell(out, 3, 0), "2");
+}
+
+BOOST_AUTO_TEST_CASE(Random) {
+    // NULL sorts first in ascending order.
+    auto merger = newMerger<TopNMerger>("SELECT * FROM r ORDER BY v LIMIT 10");
+    BOOST_REQUIRE(merger);
+    RowSchema schema;
+    addColumn(schema, "k", "INT(11)", MYSQL_TYPE_LONG);
+    addColumn(schema, "v", "DOUBLE", MYSQL_TYPE_DOUBLE);
+    BOOST_REQUIRE(merger->setSchema(schema));
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<int> dist(-100000, 100000);
+    std::vector<int> all;
+    std::string msg;
+    for (int chunk = 0; chunk < 50; ++chunk) {
+        Result r;
+        *r.mutable_rowschema() = schema;
+        for (int i = 0; i < 20; ++i) {
+            all.push_back(dist(gen));
+            std::string const k = std::to_string(chunk * 20 + i);
+            std::string const v = std::to_string(all.back());
+            addRow(r, {k.c_str(), v.c_str()});
+        }
+        if (chunk == 17) {
+            addRow(r, {"-1", nullptr});
+        }
+        BOOST_REQUIRE(merger->add(r, msg));
+    }
+    std::sort(all.begin(), all.end());
+    Result out;
+    BOOST_REQUIRE(merger->getResult(out, msg));
+    BOOST_REQUIRE_EQUAL(out.row_size(), 10);
+    BOOST_CHECK_EQUAL(cell(out, 0, 0), "-1");
+    BOOST_CHECK_EQUAL(cell(out, 0, 1), "NULL");
+    for (int i = 1; i < 10; ++i) {
+        BOOST_CHECK_EQUAL(cell(out, i, 1), std::to_string(all[i - 1]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(UnsupportedType) {
+    auto merger = newMerger<TopNMerger>("SELECT * FROM r ORDER BY name LIMIT 3");
+    BOOST_REQUIRE(merger);
+    RowSchema schema;
+    addColumn(schema, "name", "VARCHAR(10)", MYSQL_TYPE_VAR_STRING);
+    BOOST_CHECK(!merger->setSchema(schema));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,58 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "sql/SqlConnectionPool.h"
+
+namespace lsst {
+namespace qserv {
+namespace sql {
+
+SqlConnectionPool::Lease::~Lease() {
+    if (_conn) {
+        _pool->_release(std::move(_conn));
+    }
+}
+
+
+SqlConnectionPool::Lease SqlConnectionPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        if (!_idle.empty()) {
+            std::unique_ptr<SqlConnection> conn = std::move(_idle.back());
+            _idle.pop_back();
+            return Lease(this, std::move(conn));
+        }
+    }
+    return Lease(this, std::unique_ptr<SqlConnection>(new SqlConnection(_mySqlConfig)));
+}
+
+
+void SqlConnectionPool::_release(std::unique_ptr<SqlConnection> conn) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    if (_idle.size() < _maxIdle) {
+        _idle.push_back(std::move(conn));
+    }
+}
+
+}}} // namespace lsst::qserv::sql
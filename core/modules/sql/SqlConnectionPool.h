@@ -0,0 +1,89 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_QSERV_SQL_SQLCONNECTIONPOOL_H
+#define LSST_QSERV_SQL_SQLCONNECTIONPOOL_H
+
+// System headers
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Qserv headers
+#include "mysql/MySqlConfig.h"
+#include "sql/SqlConnection.h"
+
+namespace lsst {
+namespace qserv {
+namespace sql {
+
+/// SqlConnectionPool lends SqlConnections to threads that need to run queries
+/// at the same time, so that they neither share one connection nor connect
+/// for every query. Returned connections are kept for the next borrower,
+/// at most maxIdle of them. The pool must outlive the leases it hands out.
+class SqlConnectionPool {
+public:
+    /// A borrowed connection, given back to the pool when destroyed.
+    class Lease {
+    public:
+        Lease(Lease&& other) : _pool(other._pool), _conn(std::move(other._conn)) {}
+        Lease(Lease const&) = delete;
+        Lease& operator=(Lease const&) = delete;
+        ~Lease();
+
+        SqlConnection& operator*() const { return *_conn; }
+        SqlConnection* operator->() const { return _conn.get(); }
+
+    private:
+        friend class SqlConnectionPool;
+        Lease(SqlConnectionPool* pool, std::unique_ptr<SqlConnection> conn)
+            : _pool(pool), _conn(std::move(conn)) {}
+
+        SqlConnectionPool* _pool;
+        std::unique_ptr<SqlConnection> _conn;
+    };
+
+    explicit SqlConnectionPool(mysql::MySqlConfig const& mySqlConfig, unsigned int maxIdle=8)
+        : _mySqlConfig(mySqlConfig), _maxIdle(maxIdle) {}
+
+    SqlConnectionPool(SqlConnectionPool const&) = delete;
+    SqlConnectionPool& operator=(SqlConnectionPool const&) = delete;
+
+    /// @return an idle connection, or a new one if none is idle. New
+    /// connections connect on first use.
+    Lease acquire();
+
+    mysql::MySqlConfig const& getMySqlConfig() const { return _mySqlConfig; }
+
+private:
+    void _release(std::unique_ptr<SqlConnection> conn);
+
+    mysql::MySqlConfig const _mySqlConfig;
+    unsigned int const _maxIdle;
+    std::mutex _mtx; ///< Protects _idle
+    std::vector<std::unique_ptr<SqlConnection>> _idle;
+};
+
+}}} // namespace lsst::qserv::sql
+
+#endif // LSST_QSERV_SQL_SQLCONNECTIONPOOL_H
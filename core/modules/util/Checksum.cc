@@ -0,0 +1,188 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "util/Checksum.h"
+
+// System headers
+#include <cstring>
+
+namespace {
+
+// CRC-32C, reflected Castagnoli polynomial.
+std::uint32_t const CRC32C_POLY = 0x82f63b78;
+
+struct Crc32cTable {
+    Crc32cTable() {
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t crc = i;
+            for (int j = 0; j < 8; ++j) {
+                crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+            }
+            entries[i] = crc;
+        }
+    }
+    std::uint32_t entries[256];
+};
+
+std::uint32_t crc32cSoftware(char const* buffer, std::size_t bufferSize, std::uint32_t crc) {
+    static Crc32cTable const table;
+    unsigned char const* p = reinterpret_cast<unsigned char const*>(buffer);
+    for (std::size_t i = 0; i < bufferSize; ++i) {
+        crc = table.entries[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define QSERV_HAVE_CRC32C_INSTRUCTION 1
+
+// Compiled for SSE4.2 regardless of the build flags, only called after
+// checking that the CPU has it.
+__attribute__((target("sse4.2")))
+std::uint32_t crc32cHardware(char const* buffer, std::size_t bufferSize, std::uint32_t crc) {
+    unsigned long long crc64 = crc;
+    std::size_t i = 0;
+    for (; i + 8 <= bufferSize; i += 8) {
+        unsigned long long word;
+        std::memcpy(&word, buffer + i, sizeof(word));
+        crc64 = __builtin_ia32_crc32di(crc64, word);
+    }
+    unsigned int crc32 = static_cast<unsigned int>(crc64);
+    for (; i < bufferSize; ++i) {
+        crc32 = __builtin_ia32_crc32qi(crc32, static_cast<unsigned char>(buffer[i]));
+    }
+    return crc32;
+}
+
+bool const cpuHasSse42 = __builtin_cpu_supports("sse4.2");
+#endif
+
+// xxHash64 primes.
+std::uint64_t const P1 = 11400714785074694791ULL;
+std::uint64_t const P2 = 14029467366897019727ULL;
+std::uint64_t const P3 = 1609587929392839161ULL;
+std::uint64_t const P4 = 9650029242287828579ULL;
+std::uint64_t const P5 = 2870177450012600261ULL;
+
+inline std::uint64_t rotl(std::uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// Input words are read little-endian, which is the host order on the
+// platforms Qserv runs on.
+inline std::uint64_t read64(char const* p) {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline std::uint32_t read32(char const* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline std::uint64_t xxRound(std::uint64_t acc, std::uint64_t input) {
+    acc += input * P2;
+    acc = rotl(acc, 31);
+    return acc * P1;
+}
+
+inline std::uint64_t xxMergeRound(std::uint64_t acc, std::uint64_t val) {
+    acc ^= xxRound(0, val);
+    return acc * P1 + P4;
+}
+
+} // anonymous namespace
+
+namespace lsst {
+namespace qserv {
+namespace util {
+
+std::uint32_t Checksum::crc32c(char const* buffer, std::size_t bufferSize, std::uint32_t crc) {
+    crc = ~crc;
+#ifdef QSERV_HAVE_CRC32C_INSTRUCTION
+    if (cpuHasSse42) {
+        return ~crc32cHardware(buffer, bufferSize, crc);
+    }
+#endif
+    return ~crc32cSoftware(buffer, bufferSize, crc);
+}
+
+bool Checksum::hasHardwareCrc32c() {
+#ifdef QSERV_HAVE_CRC32C_INSTRUCTION
+    return cpuHasSse42;
+#else
+    return false;
+#endif
+}
+
+std::uint64_t Checksum::xxHash64(char const* buffer, std::size_t bufferSize, std::uint64_t seed) {
+    char const* p = buffer;
+    char const* const end = buffer + bufferSize;
+    std::uint64_t h;
+    if (bufferSize >= 32) {
+        std::uint64_t v1 = seed + P1 + P2;
+        std::uint64_t v2 = seed + P2;
+        std::uint64_t v3 = seed;
+        std::uint64_t v4 = seed - P1;
+        char const* const limit = end - 32;
+        do {
+            v1 = xxRound(v1, read64(p));
+            v2 = xxRound(v2, read64(p + 8));
+            v3 = xxRound(v3, read64(p + 16));
+            v4 = xxRound(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = xxMergeRound(h, v1);
+        h = xxMergeRound(h, v2);
+        h = xxMergeRound(h, v3);
+        h = xxMergeRound(h, v4);
+    } else {
+        h = seed + P5;
+    }
+    h += bufferSize;
+    for (; p + 8 <= end; p += 8) {
+        h ^= xxRound(0, read64(p));
+        h = rotl(h, 27) * P1 + P4;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<std::uint64_t>(read32(p)) * P1;
+        h = rotl(h, 23) * P2 + P3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= static_cast<unsigned char>(*p) * P5;
+        h = rotl(h, 11) * P1;
+    }
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+}}} // namespace lsst::qserv::util
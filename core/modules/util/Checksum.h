@@ -0,0 +1,55 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef LSST_QSERV_UTIL_CHECKSUM_H
+#define LSST_QSERV_UTIL_CHECKSUM_H
+
+// System headers
+#include <cstddef>
+#include <cstdint>
+
+namespace lsst {
+namespace qserv {
+namespace util {
+
+/// Fast non-cryptographic checksums for detecting corrupted messages.
+/// Both are much cheaper than the digests in StringHash and are meant for
+/// the result transfer path, where throughput matters more than resistance
+/// to deliberate tampering.
+class Checksum {
+public:
+    /// @return the CRC-32C (Castagnoli) of the buffer. Uses the SSE4.2 crc32
+    /// instruction when the CPU supports it, a table-driven version otherwise.
+    /// @param crc the value returned for preceding data, to checksum a
+    ///            message in several pieces.
+    static std::uint32_t crc32c(char const* buffer, std::size_t bufferSize, std::uint32_t crc=0);
+
+    /// @return the xxHash64 hash of the buffer.
+    static std::uint64_t xxHash64(char const* buffer, std::size_t bufferSize, std::uint64_t seed=0);
+
+    /// @return true if crc32c() uses the hardware instruction.
+    static bool hasHardwareCrc32c();
+};
+
+}}} // namespace lsst::qserv::util
+
+#endif // LSST_QSERV_UTIL_CHECKSUM_H
@@ -0,0 +1,69 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+/**
+ *
+ * @brief test Checksum
+ */
+
+// System headers
+#include <cstring>
+#include <string>
+
+// Qserv headers
+#include "util/Checksum.h"
+
+// Boost unit test header
+#define BOOST_TEST_MODULE Checksum
+#include "boost/test/included/unit_test.hpp"
+
+namespace test = boost::test_tools;
+
+using lsst::qserv::util::Checksum;
+
+BOOST_AUTO_TEST_SUITE(Suite)
+
+BOOST_AUTO_TEST_CASE(Crc32c) {
+    std::string const check = "123456789";
+    BOOST_CHECK_EQUAL(Checksum::crc32c(check.data(), check.size()), 0xe3069283u);
+    BOOST_CHECK_EQUAL(Checksum::crc32c("", 0), 0u);
+    // Checksumming in pieces gives the same value.
+    std::string longer;
+    for (int i = 0; i < 1000; ++i) {
+        longer += static_cast<char>(i * 7);
+    }
+    std::uint32_t whole = Checksum::crc32c(longer.data(), longer.size());
+    std::uint32_t part = Checksum::crc32c(longer.data(), 333);
+    part = Checksum::crc32c(longer.data() + 333, longer.size() - 333, part);
+    BOOST_CHECK_EQUAL(whole, part);
+}
+
+BOOST_AUTO_TEST_CASE(XxHash64) {
+    // Reference values from the xxHash implementation.
+    BOOST_CHECK_EQUAL(Checksum::xxHash64("", 0), 0xef46db3751d8e999ULL);
+    BOOST_CHECK_EQUAL(Checksum::xxHash64("a", 1), 0xd24ec4f1a98c6e5bULL);
+    BOOST_CHECK_EQUAL(Checksum::xxHash64("abc", 3), 0x44bc2cf5ad770999ULL);
+    char const* phrase = "Nobody inspects the spammish repetition";
+    BOOST_CHECK_EQUAL(Checksum::xxHash64(phrase, std::strlen(phrase)), 0xfbcea83c8a378bf1ULL);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
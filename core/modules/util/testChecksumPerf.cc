@@ -0,0 +1,80 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+/// Benchmark for the result message checksums: reports MB/s for MD5,
+/// CRC-32C and xxHash64 on buffers from 1 to 64 MB. Not run as a unit test.
+///
+/// Usage: testChecksumPerf [passes]
+
+// System headers
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Qserv headers
+#include "util/Checksum.h"
+#include "util/StringHash.h"
+
+namespace {
+
+namespace util = lsst::qserv::util;
+
+/// @return MB/s of running fn over buffer, passes times.
+double rate(std::string const& buffer, int passes, std::function<std::uint64_t(std::string const&)> const& fn) {
+    volatile std::uint64_t sink = 0; // Keeps the work from being optimized away.
+    auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < passes; ++p) {
+        sink = sink + fn(buffer);
+    }
+    std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+    return passes * (buffer.size() / 1.0e6) / secs.count();
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    int const passes = argc > 1 ? std::atoi(argv[1]) : 5;
+    std::cout << "CRC-32C " << (util::Checksum::hasHardwareCrc32c() ? "hardware" : "software") << "\n";
+    std::cout << std::setw(6) << "MB" << std::setw(12) << "md5" << std::setw(12) << "crc32c"
+              << std::setw(12) << "xxhash64" << "  (MB/s)\n";
+    for (size_t mb = 1; mb <= 64; mb *= 4) {
+        std::string buffer(mb*1024*1024, '\0');
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            buffer[i] = static_cast<char>(i * 2654435761u >> 13);
+        }
+        double md5 = rate(buffer, passes, [](std::string const& b) {
+            return static_cast<std::uint64_t>(util::StringHash::getMd5(b.data(), b.size())[0]);
+        });
+        double crc = rate(buffer, passes, [](std::string const& b) {
+            return util::Checksum::crc32c(b.data(), b.size());
+        });
+        double xxh = rate(buffer, passes, [](std::string const& b) {
+            return util::Checksum::xxHash64(b.data(), b.size());
+        });
+        std::cout << std::setw(6) << mb << std::fixed << std::setprecision(0)
+                  << std::setw(12) << md5 << std::setw(12) << crc << std::setw(12) << xxh << "\n";
+    }
+    return 0;
+}
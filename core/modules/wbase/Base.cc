@@ -112,6 +112,43 @@ std::string const CREATE_DUMMY_SUBCHUNK_SCRIPT =
     "ENGINE = MEMORY "
     "AS SELECT * FROM %1%.%2%_%4% WHERE %3% = %5%;";
 
+// Batched subchunk creation: the rows of all wanted subchunks are read from
+// the chunk table in one pass into an in-memory staging table, hashed on the
+// subchunk column, then each subchunk table is filled from it by index lookup.
+// Used once for the table and once for its FullOverlap table.
+// The staging table holds all wanted subchunks at once, so it can exceed
+// max_heap_table_size where the per-subchunk script would not; the
+// SQLBackend then falls back to CREATE_SUBCHUNK_SCRIPT.
+// Parameters:
+// %1% database (e.g., LSST)
+// %2% table (e.g., Object or ObjectFullOverlap)
+// %3% subchunk column name (e.g. x_subChunkId)
+// %4% chunkId (e.g. 2523)
+// %5% comma-separated subChunkIds (e.g., 34,35,36)
+std::string const CREATE_SUBCHUNK_BATCH_SCRIPT =
+    "CREATE DATABASE IF NOT EXISTS " + SUBCHUNKDB_PREFIX_STR + "%1%_%4%;"
+    "DROP TEMPORARY TABLE IF EXISTS " + SUBCHUNKDB_PREFIX_STR + "%1%_%4%.%2%_%4%_batch;"
+    "CREATE TEMPORARY TABLE " + SUBCHUNKDB_PREFIX_STR + "%1%_%4%.%2%_%4%_batch "
+    "(INDEX USING HASH (%3%)) ENGINE = MEMORY "
+    "AS SELECT * FROM %1%.%2%_%4% WHERE %3% IN (%5%);";
+
+// Parameters:
+// %1% database (e.g., LSST)
+// %2% table (e.g., Object or ObjectFullOverlap)
+// %3% subchunk column name (e.g. x_subChunkId)
+// %4% chunkId (e.g. 2523)
+// %5% subChunkId (e.g., 34)
+std::string const FILL_SUBCHUNK_FROM_BATCH_SCRIPT =
+    "CREATE TABLE IF NOT EXISTS " + SUBCHUNKDB_PREFIX_STR + "%1%_%4%.%2%_%4%_%5% ENGINE = MEMORY "
+    "AS SELECT * FROM " + SUBCHUNKDB_PREFIX_STR + "%1%_%4%.%2%_%4%_batch WHERE %3% = %5%;";
+
+// Parameters:
+// %1% database (e.g., LSST)
+// %2% table (e.g., Object or ObjectFullOverlap)
+// %3% chunkId (e.g. 2523)
+std::string const DROP_SUBCHUNK_BATCH_SCRIPT =
+    "DROP TEMPORARY TABLE IF EXISTS " + SUBCHUNKDB_PREFIX_STR + "%1%_%3%.%2%_%3%_batch;";
+
 // Note:
 // Not all Object partitions will have overlap tables created by the
 // partitioner.  Thus we need to create empty overlap tables to prevent
@@ -60,6 +60,9 @@ extern std::string DUMP_BASE; // Non-const to allow runtime-update via config
 extern std::string const CREATE_SUBCHUNK_SCRIPT;
 extern std::string const CLEANUP_SUBCHUNK_SCRIPT;
 extern std::string const CREATE_DUMMY_SUBCHUNK_SCRIPT;
+extern std::string const CREATE_SUBCHUNK_BATCH_SCRIPT;
+extern std::string const FILL_SUBCHUNK_FROM_BATCH_SCRIPT;
+extern std::string const DROP_SUBCHUNK_BATCH_SCRIPT;
 
 // Result-writing
 void updateResultPath(char const* resultPath=0);
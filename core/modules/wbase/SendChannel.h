@@ -60,6 +60,21 @@ public:
         throw Bug("Streaming is unimplemented, should not see this");
     }
 
+    /// Send a bucket of bytes, handing over the storage of buf.
+    /// Channels that can take ownership of the data avoid copying it and
+    /// leave buf holding an empty, possibly recycled, buffer. This call may
+    /// block while the channel applies flow control.
+    /// @param last true if no more sendStream calls will be invoked.
+    virtual bool sendStreamBuffer(std::string& buf, bool last) {
+        bool sent = sendStream(buf.data(), buf.size(), last);
+        buf.clear();
+        return sent;
+    }
+
+    /// Abandon streaming. Wakes any sender blocked on flow control, which
+    /// then fails. Repeated calls must be harmless.
+    virtual void cancel() {}
+
     /// Set a function to be called when a resources from a deferred send*
     /// operation may be released. This allows a sendFile() caller to be
     /// notified when the file descriptor may be closed and perhaps reclaimed.
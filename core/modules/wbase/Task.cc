@@ -152,6 +152,9 @@ void Task::cancel() {
     if (qr != nullptr) {
         qr->cancel();
     }
+    if (sendChannel != nullptr) {
+        sendChannel->cancel(); // Release a transmit waiting on a slow czar.
+    }
 
     auto sched = _taskScheduler.lock();
     if (sched != nullptr) {
@@ -260,6 +263,11 @@ void Task::waitForMemMan() {
         cmd->waitComplete();
         if (cmd->errorCode) {
             LOGS(_log, LOG_LVL_WARN, _idStr << " mlock err=" << cmd->errorCode);
+        } else {
+            auto status = _memMan->getStatus(_memHandle);
+            LOGS(_log, LOG_LVL_DEBUG, _idStr << " mlock bytes=" << status.bytesLock
+                 << " fromCache=" << status.bytesCached
+                 << " fromDisk=" << status.bytesLock - status.bytesCached);
         }
     }
     LOGS(_log, LOG_LVL_DEBUG, _idStr << " waitForMemMan end");
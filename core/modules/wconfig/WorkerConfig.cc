@@ -49,9 +49,13 @@ WorkerConfig::WorkerConfig(const util::ConfigStore& configStore)
     : _mySqlConfig(configStore.getRequired("mysql.username"),
             configStore.get("mysql.password"),
             configStore.getRequired("mysql.socket")),
+      _mySqlPoolSize(configStore.getInt("mysql.pool_size", 20)),
       _memManClass(configStore.get("memman.class", "MemManReal")),
       _memManSizeMb(configStore.getInt("memman.memory", 1000)),
       _memManLocation(configStore.getRequired("memman.location")),
+      _subChunkCacheMb(configStore.getInt("memman.subchunk_cache_mb", 0)),
+      _subChunkCacheSeconds(configStore.getInt("memman.subchunk_cache_seconds", 300)),
+      _memManPrefetchThreads(configStore.getInt("memman.prefetch_threads", 2)),
       _threadPoolSize(configStore.getInt("scheduler.thread_pool_size", wsched::BlendScheduler::getMinPoolSize())),
       _maxGroupSize(configStore.getInt("scheduler.group_size", 1)),
       _requiredTasksCompleted(configStore.getInt("scheduler.required_tasks_completed", 25)),
@@ -71,7 +75,11 @@ WorkerConfig::WorkerConfig(const util::ConfigStore& configStore)
       _scanMaxMinutesMed(configStore.getInt("scheduler.scanmaxminutes_med", 60*8)),
       _scanMaxMinutesSlow(configStore.getInt("scheduler.scanmaxminutes_slow", 60*12)),
       _scanMaxMinutesSnail(configStore.getInt("scheduler.scanmaxminutes_snail", 60*24)),
-      _maxTasksBootedPerUserQuery(configStore.getInt("scheduler.maxtasksbootedperuserquery", 5)) {
+      _maxTasksBootedPerUserQuery(configStore.getInt("scheduler.maxtasksbootedperuserquery", 5)),
+      _sharedScanWindowMs(configStore.getInt("scheduler.shared_scan_window_ms", 20)),
+      _sharedScanMaxQueries(configStore.getInt("scheduler.shared_scan_max_queries", 16)),
+      _nearNeighborJoin(configStore.getInt("scheduler.near_neighbor_join", 1) != 0),
+      _resultStreamHighWaterMb(configStore.getInt("results.stream_high_water_mb", 16)) {
 }
 
 std::ostream& operator<<(std::ostream &out, WorkerConfig const& workerConfig) {
@@ -79,6 +87,10 @@ std::ostream& operator<<(std::ostream &out, WorkerConfig const& workerConfig) {
     if (workerConfig._memManClass == "MemManReal") {
         out << "MemManSizeMb=" << workerConfig._memManSizeMb;
     }
+    out << " subChunkCacheMb=" << workerConfig._subChunkCacheMb
+        << " subChunkCacheSeconds=" << workerConfig._subChunkCacheSeconds
+        << " memManPrefetchThreads=" << workerConfig._memManPrefetchThreads;
+    out << " mySqlPoolSize=" << workerConfig._mySqlPoolSize;
     out << " poolSize=" << workerConfig._threadPoolSize << ", maxGroupSize=" << workerConfig._maxGroupSize;
     out << " requiredTasksCompleted=" << workerConfig._requiredTasksCompleted;
 
@@ -89,6 +101,11 @@ std::ostream& operator<<(std::ostream &out, WorkerConfig const& workerConfig) {
     out << " Reserved threads fast=" << workerConfig._maxReserveFast
          << " med=" << workerConfig._maxReserveMed << " slow=" << workerConfig._maxReserveSlow;
 
+    out << " sharedScanWindowMs=" << workerConfig._sharedScanWindowMs
+        << " sharedScanMaxQueries=" << workerConfig._sharedScanMaxQueries;
+    out << " nearNeighborJoin=" << workerConfig._nearNeighborJoin;
+    out << " resultStreamHighWaterMb=" << workerConfig._resultStreamHighWaterMb;
+
     return out;
 }
 
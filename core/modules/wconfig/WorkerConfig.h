@@ -185,6 +185,67 @@ public:
         return _memManSizeMb;
     }
 
+    /* Get the part of the Memory Manager memory kept for subchunk tables
+     * that are no longer used but may be needed again soon
+     *
+     * @return subchunk table cache size, in MB, 0 if the cache is disabled
+     */
+    uint64_t getSubChunkCacheMb() const {
+        return _subChunkCacheMb;
+    }
+
+    /* Get the time an unused subchunk table may stay in the cache
+     *
+     * @return maximum subchunk table cache age, in seconds
+     */
+    unsigned int getSubChunkCacheSeconds() const {
+        return _subChunkCacheSeconds;
+    }
+
+    /* Get the number of threads reading the tables of upcoming chunks into
+     * the page cache while the current chunk is scanned
+     *
+     * @return number of prefetch threads, 0 if prefetching is disabled
+     */
+    unsigned int getMemManPrefetchThreads() const {
+        return _memManPrefetchThreads;
+    }
+
+    /* Get the time the first of several simple scans of the same chunk table
+     * waits for others to share its pass over the table
+     *
+     * @return shared scan window, in milliseconds, 0 if scans are never shared
+     */
+    unsigned int getSharedScanWindowMs() const {
+        return _sharedScanWindowMs;
+    }
+
+    /* Get the maximum number of queries served by one pass over a table
+     *
+     * @return maximum number of queries in a shared scan
+     */
+    unsigned int getSharedScanMaxQueries() const {
+        return _sharedScanMaxQueries;
+    }
+
+    /* Get whether near-neighbour joins of sub-chunk tables are done by the
+     * worker rather than by MySQL
+     *
+     * @return true if the worker joins near-neighbour queries
+     */
+    bool getNearNeighborJoin() const {
+        return _nearNeighborJoin;
+    }
+
+    /* Get the number of result bytes a query may queue for the czar before
+     * the worker stops producing more rows and waits.
+     *
+     * @return result stream high-water mark, in MB
+     */
+    unsigned int getResultStreamHighWaterMb() const {
+        return _resultStreamHighWaterMb;
+    }
+
     /* Get MySQL configuration for worker MySQL instance
      *
      * @return a structure containing MySQL parameters
@@ -193,6 +254,14 @@ public:
         return _mySqlConfig;
     }
 
+    /* Get the number of MySQL connections kept open between tasks
+     *
+     * @return maximum number of idle pooled connections, 0 disables pooling
+     */
+    unsigned int getMySqlPoolSize() const {
+        return _mySqlPoolSize;
+    }
+
     /* Get fast shared scan priority
      *
      * @return fast shared scan priority
@@ -271,10 +340,14 @@ private:
     WorkerConfig(util::ConfigStore const& configStore);
 
     mysql::MySqlConfig const _mySqlConfig;
+    unsigned int const _mySqlPoolSize;
 
     std::string const _memManClass;
     uint64_t const _memManSizeMb;
     std::string const _memManLocation;
+    uint64_t const _subChunkCacheMb;
+    unsigned int const _subChunkCacheSeconds;
+    unsigned int const _memManPrefetchThreads;
 
     unsigned int const _threadPoolSize;
     unsigned int const _maxGroupSize;
@@ -300,6 +373,11 @@ private:
     unsigned int const _scanMaxMinutesSlow;
     unsigned int const _scanMaxMinutesSnail;
     unsigned int const _maxTasksBootedPerUserQuery;
+    unsigned int const _sharedScanWindowMs;
+    unsigned int const _sharedScanMaxQueries;
+    bool const _nearNeighborJoin;
+
+    unsigned int const _resultStreamHighWaterMb;
 };
 
 }}} // namespace qserv::core::wconfig
@@ -42,7 +42,9 @@
 #include "wbase/Base.h"
 #include "wbase/SendChannel.h"
 #include "wdb/ChunkResource.h"
+#include "wdb/ConnectionPool.h"
 #include "wdb/QueryRunner.h"
+#include "wdb/SharedScan.h"
 
 namespace {
 LOG_LOGGER _log = LOG_GET("lsst.qserv.wcontrol.Foreman");
@@ -53,15 +55,22 @@ namespace qserv {
 namespace wcontrol {
 
 Foreman::Foreman(Scheduler::Ptr const& s, uint poolSize, mysql::MySqlConfig const& mySqlConfig,
-    wpublish::QueriesAndChunks::Ptr const& queries)
-    : _scheduler{s}, _mySqlConfig(mySqlConfig), _queries{queries} {
+    wpublish::QueriesAndChunks::Ptr const& queries, uint64_t subChunkCacheBytes,
+    std::chrono::seconds subChunkCacheMaxAge, unsigned int maxPooledConnections,
+    std::chrono::milliseconds sharedScanWindow, unsigned int sharedScanMaxQueries,
+    bool nearNeighborJoin)
+    : _nearNeighborJoin(nearNeighborJoin), _scheduler{s}, _mySqlConfig(mySqlConfig), _queries{queries} {
     // Make the chunk resource mgr
     // Creating backend makes a connection to the database for making temporary tables.
     // It will delete temporary tables that it can identify as being created by a worker.
     // Previous instances of the worker will terminate when they try to use or create temporary tables.
     // Previous instances of the worker should be terminated before a new worker is started.
     _backend = std::make_shared<wdb::SQLBackend>(_mySqlConfig);
-    _chunkResourceMgr = wdb::ChunkResourceMgr::newMgr(_backend);
+    _chunkResourceMgr = wdb::ChunkResourceMgr::newMgr(_backend, subChunkCacheBytes, subChunkCacheMaxAge);
+    _connPool = std::make_shared<wdb::ConnectionPool>(_mySqlConfig, maxPooledConnections);
+    if (sharedScanWindow.count() > 0 && sharedScanMaxQueries > 1) {
+        _sharedScanMgr = std::make_shared<wdb::SharedScanMgr>(sharedScanWindow, sharedScanMaxQueries);
+    }
     assert(s); // Cannot operate without scheduler.
 
     LOGS(_log, LOG_LVL_DEBUG, "poolSize=" << poolSize);
@@ -78,7 +87,16 @@ Foreman::~Foreman() {
 /// Put the task on the scheduler to be run later.
 void Foreman::processTask(std::shared_ptr<wbase::Task> const& task) {
 
-    auto func = [this, task](util::CmdData*){
+    // Tasks that may share a table pass are counted until they run, so a
+    // leader only waits for others while some are queued.
+    wdb::SharedScanMgr::Ticket::Ptr sharedScanTicket;
+    wdb::SharedScanQuery sharedQuery;
+    std::string sharedKey;
+    if (_sharedScanMgr != nullptr && wdb::QueryRunner::sharedScanKey(*task, sharedQuery, sharedKey)) {
+        sharedScanTicket = _sharedScanMgr->expect(sharedKey);
+    }
+
+    auto func = [this, task, sharedScanTicket](util::CmdData*){
         proto::TaskMsg const& msg = *task->msg;
         int const resultProtocol = 2; // See proto/worker.proto Result protocol
         if (!msg.has_protocol() || msg.protocol() < resultProtocol) {
@@ -88,7 +106,9 @@ void Foreman::processTask(std::shared_ptr<wbase::Task> const& task) {
                 task->sendChannel->sendError("Unsupported wire protocol", 1);
             }
         } else {
-            auto qr = wdb::QueryRunner::newQueryRunner(task, _chunkResourceMgr, _mySqlConfig);
+            auto qr = wdb::QueryRunner::newQueryRunner(task, _chunkResourceMgr, _connPool,
+                                                       _sharedScanMgr, _nearNeighborJoin,
+                                                       sharedScanTicket);
             qr->runQuery();
         }
     };
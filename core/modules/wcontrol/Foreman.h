@@ -26,6 +26,8 @@
 
 // System headers
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 
 // Qserv headers
@@ -42,7 +44,9 @@ namespace qserv {
 namespace wdb {
     class SQLBackend;
     class ChunkResourceMgr;
+    class ConnectionPool;
     class QueryRunner;
+    class SharedScanMgr;
 }}}
 
 namespace lsst {
@@ -69,8 +73,21 @@ public:
 /// The schedulers may limit the number of threads they will use from the thread pool.
 class Foreman : public wbase::MsgProcessor {
 public:
+    /// @param subChunkCacheBytes memory unused sub-chunk tables may keep, see ChunkResourceMgr.
+    /// @param subChunkCacheMaxAge time unused sub-chunk tables are kept at most.
+    /// @param maxPooledConnections MySQL connections kept open between tasks.
+    /// @param sharedScanWindow time a simple scan waits for others on the same table
+    ///                         to share its pass over the table, 0 disables sharing.
+    /// @param sharedScanMaxQueries maximum number of queries sharing one pass.
+    /// @param nearNeighborJoin join near-neighbour sub-chunk queries in the worker
+    ///                         instead of MySQL, see wdb::NearNeighborQuery.
     Foreman(Scheduler::Ptr const& s, uint poolSize, mysql::MySqlConfig const& mySqlConfig,
-            wpublish::QueriesAndChunks::Ptr const& queries);
+            wpublish::QueriesAndChunks::Ptr const& queries, uint64_t subChunkCacheBytes=0,
+            std::chrono::seconds subChunkCacheMaxAge=std::chrono::seconds(300),
+            unsigned int maxPooledConnections=0,
+            std::chrono::milliseconds sharedScanWindow=std::chrono::milliseconds(0),
+            unsigned int sharedScanMaxQueries=16,
+            bool nearNeighborJoin=false);
     virtual ~Foreman();
     // This class should not be copied.
     Foreman(Foreman const&) = delete;
@@ -81,6 +98,9 @@ public:
 private:
     std::shared_ptr<wdb::SQLBackend> _backend;
     std::shared_ptr<wdb::ChunkResourceMgr> _chunkResourceMgr;
+    std::shared_ptr<wdb::ConnectionPool> _connPool;
+    std::shared_ptr<wdb::SharedScanMgr> _sharedScanMgr; ///< nullptr if scans are not shared.
+    bool const _nearNeighborJoin;
     util::ThreadPool::Ptr _pool;
     Scheduler::Ptr _scheduler;
     mysql::MySqlConfig const _mySqlConfig;
@@ -34,6 +34,8 @@
 
 // System headers
 #include <cstddef>
+#include <list>
+#include <map>
 #include <mutex>
 
 // Third-party headers
@@ -194,9 +196,13 @@ public:
 
 
     /// Acquire a resource, loading if needed
+    /// @param loaded receives the subchunk tables that had to be loaded.
+    /// @param revived receives the subchunk tables that were kept loaded
+    ///                while nobody needed them.
     void acquire(std::string const& db,
                  StringVector const& tables,
-                 IntVector const& sc, SQLBackend::Ptr backend) {
+                 IntVector const& sc, SQLBackend::Ptr backend,
+                 ScTableVector& loaded, ScTableVector& revived) {
         ScTableVector needed;
         std::lock_guard<std::mutex> lock(_mutex);
         backend->memLockRequireOwnership();
@@ -212,6 +218,9 @@ public:
                     needed.push_back(ScTable(db, _chunkId, *ti, *i));
                 } else {
                     last = it->second;
+                    if (last == 0) {
+                        revived.push_back(ScTable(db, _chunkId, *ti, *i));
+                    }
                 }
                 scm[*i] = last + 1; // write new value
             } // All subchunks
@@ -223,16 +232,21 @@ public:
             bool loadOk = backend->load(needed, err);
             if (!loadOk) {
                 // Release
-                _release(needed);
+                _release(tables, sc, needed);
+                revived.clear();
                 throw err;
             }
         }
+        loaded = needed;
     }
 
     /// Release a resource, flushing if no more users need it.
+    /// @param idle if not null, subchunk tables no more users need are kept
+    ///             and appended to idle instead of being flushed.
     void release(std::string const& db,
                  StringVector const& tables,
-                 IntVector const& sc, SQLBackend::Ptr backend) {
+                 IntVector const& sc, SQLBackend::Ptr backend,
+                 ScTableVector* idle=nullptr) {
         {
             std::lock_guard<std::mutex> lock(_mutex);
             backend->memLockRequireOwnership();
@@ -246,15 +260,50 @@ public:
                         throw Bug("ChunkResource ChunkEntry::release: Error releasing un-acquired resource");
                     }
                     scm[*i] = it->second - 1; // write new value
+                    if (idle != nullptr && it->second == 0) {
+                        idle->push_back(ScTable(db, _chunkId, *ti, *i));
+                    }
                 } // All subchunks
             } // All tables
             --_refCount;
         }
+        if (idle != nullptr) {
+            return; // The caller decides when idle tables are discarded.
+        }
         flush(db, backend); // Discard resources no longer needed by anyone.
         // flush could be detached from the release function, to be called at a
         // high-water mark and/or on periodic intervals
     }
 
+    /// @return true if the subchunk table scTbl is loaded but nobody needs it.
+    bool isIdle(ScTable const& scTbl) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto ti = _tableMap.find(scTbl.table);
+        if (ti == _tableMap.end()) {
+            return false;
+        }
+        auto si = ti->second.find(scTbl.subChunkId);
+        return si != ti->second.end() && si->second == 0;
+    }
+
+    /// Discard the tables in v that are still not needed by anybody.
+    void discardIdle(ScTableVector const& v, SQLBackend::Ptr backend) {
+        ScTableVector discardable;
+        std::lock_guard<std::mutex> lock(_mutex);
+        backend->memLockRequireOwnership();
+        for (auto const& scTbl : v) {
+            SubChunkMap& scm = _tableMap[scTbl.table];
+            SubChunkMap::iterator it = scm.find(scTbl.subChunkId);
+            if (it != scm.end() && it->second == 0) {
+                scm.erase(it);
+                discardable.push_back(scTbl);
+            }
+        }
+        if (discardable.size() > 0) {
+            backend->discard(discardable);
+        }
+    }
+
     /// Flush resources no longer needed by anybody
     void flush(std::string const& db, SQLBackend::Ptr backend) {
         ScTableVector discardable;
@@ -289,15 +338,21 @@ public:
         }
     }
 private:
-    void _release(ScTableVector const& needed) {
+    /// Undo a failed acquire(), forgetting the tables that were not loaded.
+    void _release(StringVector const& tables, IntVector const& sc,
+                  ScTableVector const& needed) {
         // _mutex should be held.
-        // Release subChunkId for the right table
+        for (auto const& table : tables) {
+            SubChunkMap& scm = _tableMap[table];
+            for (int subChunkId : sc) {
+                --scm[subChunkId];
+            }
+        }
         for(ScTableVector::const_iterator i=needed.begin(), e=needed.end();
             i != e; ++i) {
-            SubChunkMap& scm = _tableMap[i->table];
-            int last = scm[i->subChunkId];
-            scm[i->subChunkId] = last - 1;
+            _tableMap[i->table].erase(i->subChunkId);
         }
+        --_refCount;
     }
 
     std::shared_ptr<SQLBackend> _backend; ///< Delegate stage/unstage
@@ -329,10 +384,27 @@ public:
     }
 
     void release(ChunkResource::Info const& i) override {
+        ScTableVector idle;
+        {
+            std::lock_guard<std::mutex> lock(_mapMutex);
+            Map& map = _getMap(i.db);
+            ChunkEntry& ce = _getChunkEntry(map, i.chunkId);
+            if (_cacheBytes == 0) {
+                ce.release(i.db, i.tables, i.subChunkIds, _backend);
+                return;
+            }
+            ce.release(i.db, i.tables, i.subChunkIds, _backend, &idle);
+            if (idle.empty()) {
+                _cacheEvict();
+                return;
+            }
+        }
+        // Sizing the tables queries MySQL, keep acquire() and release()
+        // calls of other tasks going meanwhile.
+        std::vector<uint64_t> bytes = _backend->getTableBytes(idle);
         std::lock_guard<std::mutex> lock(_mapMutex);
-        Map& map = _getMap(i.db);
-        ChunkEntry& ce = _getChunkEntry(map, i.chunkId);
-        ce.release(i.db, i.tables, i.subChunkIds, _backend);
+        _cacheInsert(idle, bytes);
+        _cacheEvict();
     }
 
     void acquireUnit(ChunkResource::Info const& i) override {
@@ -340,7 +412,17 @@ public:
         Map& map = _getMap(i.db); // Select db
         ChunkEntry& ce = _getChunkEntry(map, i.chunkId);
         // Actually acquire
-        ce.acquire(i.db, i.tables, i.subChunkIds, _backend);
+        ScTableVector loaded;
+        ScTableVector revived;
+        ce.acquire(i.db, i.tables, i.subChunkIds, _backend, loaded, revived);
+        _stats.misses += loaded.size();
+        _stats.hits += revived.size();
+        for (auto const& scTbl : revived) {
+            _cacheErase(scTbl);
+        }
+        if (_cacheBytes != 0) {
+            _cacheEvict(); // Drop tables that aged out while nothing was released.
+        }
     }
 
     int getRefCount(std::string const& db, int chunkId) {
@@ -354,8 +436,78 @@ public:
         return ce.getRefCount();
     }
 
+    CacheStats getCacheStats() override {
+        std::lock_guard<std::mutex> lock(_mapMutex);
+        return _stats;
+    }
+
 private:
-    Impl(std::shared_ptr<SQLBackend> const& backend) : _backend(backend) {}
+    /// A subchunk table that is kept loaded although nobody needs it.
+    struct CachedTable {
+        CachedTable(ScTable const& table_, uint64_t bytes_)
+            : table(table_), bytes(bytes_), released(std::chrono::steady_clock::now()) {}
+        ScTable table;
+        uint64_t bytes;
+        std::chrono::steady_clock::time_point released;
+    };
+    using CacheList = std::list<CachedTable>; // most recently released first
+
+    Impl(std::shared_ptr<SQLBackend> const& backend, uint64_t cacheBytes,
+         std::chrono::seconds cacheMaxAge)
+        : _backend(backend), _cacheBytes(cacheBytes), _cacheMaxAge(cacheMaxAge) {}
+
+    /// precondition: _mapMutex is held (locked by the caller)
+    /// Add tables nobody needs anymore to the cache. Tables acquired again,
+    /// or cached by another release, since they were found idle are skipped.
+    void _cacheInsert(ScTableVector const& idle, std::vector<uint64_t> const& bytes) {
+        for (size_t j = 0; j < idle.size(); ++j) {
+            if (_cacheIndex.count(_cacheKey(idle[j])) != 0
+                || !_getChunkEntry(_getMap(idle[j].db), idle[j].chunkId).isIdle(idle[j])) {
+                continue;
+            }
+            _cache.emplace_front(idle[j], bytes[j]);
+            _cacheIndex[_cacheKey(idle[j])] = _cache.begin();
+            _stats.bytes += bytes[j];
+        }
+        _stats.tables = _cache.size();
+    }
+
+    /// precondition: _mapMutex is held (locked by the caller)
+    /// Remove a table that is needed again from the cache.
+    void _cacheErase(ScTable const& scTbl) {
+        auto iter = _cacheIndex.find(_cacheKey(scTbl));
+        if (iter == _cacheIndex.end()) {
+            return;
+        }
+        _stats.bytes -= iter->second->bytes;
+        _cache.erase(iter->second);
+        _cacheIndex.erase(iter);
+        _stats.tables = _cache.size();
+    }
+
+    /// precondition: _mapMutex is held (locked by the caller)
+    /// Discard the least recently released tables until the cache is within
+    /// its memory budget and holds no table older than the maximum age.
+    void _cacheEvict() {
+        auto const oldest = std::chrono::steady_clock::now() - _cacheMaxAge;
+        uint64_t evicted = 0;
+        while (!_cache.empty()
+               && (_stats.bytes > _cacheBytes || _cache.back().released < oldest)) {
+            ScTable scTbl = _cache.back().table;
+            _cacheErase(scTbl);
+            _getChunkEntry(_getMap(scTbl.db), scTbl.chunkId).discardIdle(ScTableVector{scTbl}, _backend);
+            ++evicted;
+        }
+        if (evicted > 0) {
+            _stats.evictions += evicted;
+            LOGS(_log, LOG_LVL_DEBUG, "Evicted " << evicted << " subchunk tables " << _stats);
+        }
+    }
+
+    static std::string _cacheKey(ScTable const& scTbl) {
+        return scTbl.db + ":" + std::to_string(scTbl.chunkId) + ":" + scTbl.table
+               + ":" + std::to_string(scTbl.subChunkId);
+    }
 
     /// precondition: _mapMutex is held (locked by the caller)
     /// Get the ChunkEntry map for a db, creating if necessary
@@ -389,14 +541,28 @@ private:
     // a problem.
     std::shared_ptr<SQLBackend> _backend;
     std::mutex _mapMutex; // Do not alter map without this mutex
+
+    uint64_t const _cacheBytes; ///< Memory budget of the cache, 0 disables it.
+    std::chrono::seconds const _cacheMaxAge;
+    CacheList _cache; ///< Tables nobody needs, still loaded.
+    std::map<std::string, CacheList::iterator> _cacheIndex;
+    CacheStats _stats;
 };
 
 ////////////////////////////////////////////////////////////////////////
 // ChunkResourceMgr
 ////////////////////////////////////////////////////////////////////////
 
-ChunkResourceMgr::Ptr ChunkResourceMgr::newMgr(SQLBackend::Ptr const& backend) {
-    return std::shared_ptr<ChunkResourceMgr>(new Impl(backend));
+ChunkResourceMgr::Ptr ChunkResourceMgr::newMgr(SQLBackend::Ptr const& backend, uint64_t cacheBytes,
+                                               std::chrono::seconds cacheMaxAge) {
+    return std::shared_ptr<ChunkResourceMgr>(new Impl(backend, cacheBytes, cacheMaxAge));
+}
+
+std::ostream& operator<<(std::ostream& os, ChunkResourceMgr::CacheStats const& stats) {
+    os << "CacheStats(hits=" << stats.hits << " misses=" << stats.misses
+       << " evictions=" << stats.evictions << " tables=" << stats.tables
+       << " bytes=" << stats.bytes << ")";
+    return os;
 }
 
 }}} // namespace lsst::qserv::wdb
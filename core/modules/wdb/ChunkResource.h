@@ -33,6 +33,8 @@
   */
 
 // System headers
+#include <chrono>
+#include <cstdint>
 #include <deque>
 #include <memory>
 #include <ostream>
@@ -90,12 +92,29 @@ private:
 
 
 /// ChunkResourceMgr is a lightweight manager for holding reservations on subchunks.
+/// Subchunk tables nobody holds a reservation on are normally dropped at once.
+/// With a cache budget, they are kept until they are older than the maximum
+/// age or the least recently released tables have to make room for newer ones,
+/// so that later tasks and queries on the same subchunks skip reloading them.
 class ChunkResourceMgr {
 public:
     using Ptr = std::shared_ptr<ChunkResourceMgr>;
 
+    /// Statistics of the cache of unreserved subchunk tables.
+    struct CacheStats {
+        uint64_t hits{0};      ///< Subchunk tables reserved from the cache
+        uint64_t misses{0};    ///< Subchunk tables that had to be loaded
+        uint64_t evictions{0}; ///< Cached subchunk tables dropped
+        uint64_t tables{0};    ///< Subchunk tables currently cached
+        uint64_t bytes{0};     ///< Memory used by the cached subchunk tables
+    };
+
     /// Factory
-    static Ptr newMgr(SQLBackend::Ptr const& backend);
+    /// @param cacheBytes memory that unreserved subchunk tables may keep using,
+    ///                   0 drops them as soon as they are released.
+    /// @param cacheMaxAge time an unreserved subchunk table is kept at most.
+    static Ptr newMgr(SQLBackend::Ptr const& backend, uint64_t cacheBytes=0,
+                      std::chrono::seconds cacheMaxAge=std::chrono::seconds(300));
     virtual ~ChunkResourceMgr() {}
 
     /// Reserve a chunk. Currently, this does not result in any explicit chunk
@@ -126,10 +145,15 @@ public:
     /// @return the reference count for the database and chunkId.
     virtual int getRefCount(std::string const& db, int chunkId) = 0;
 
+    /// @return the statistics of the subchunk table cache.
+    virtual CacheStats getCacheStats() = 0;
+
 private:
     class Impl; // Nested to share friend access to ChunkResource
 };
 
+std::ostream& operator<<(std::ostream& os, ChunkResourceMgr::CacheStats const& stats);
+
 }}} // namespace lsst::qserv::wdb
 
 #endif // LSST_QSERV_WDB_CHUNKRESOURCE_H
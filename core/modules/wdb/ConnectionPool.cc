@@ -0,0 +1,132 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "wdb/ConnectionPool.h"
+
+// LSST headers
+#include "lsst/log/Log.h"
+
+namespace {
+
+LOG_LOGGER _log = LOG_GET("lsst.qserv.wdb.ConnectionPool");
+
+} // anonymous namespace
+
+namespace lsst {
+namespace qserv {
+namespace wdb {
+
+ConnectionPool::ConnectionPool(mysql::MySqlConfig const& mySqlConfig, unsigned int maxIdle)
+    : _mySqlConfig(mySqlConfig), _maxIdle(maxIdle) {
+}
+
+
+ConnectionPool::ConnPtr ConnectionPool::acquire(std::string const& user) {
+    while (true) {
+        ConnPtr conn;
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            auto iter = _idle.find(user);
+            if (iter == _idle.end() || iter->second.empty()) {
+                break;
+            }
+            conn = std::move(iter->second.back());
+            iter->second.pop_back();
+            --_stats.idle;
+        }
+        // Check without holding the mutex, it is a round trip to the server.
+        bool ok = _check(*conn);
+        std::lock_guard<std::mutex> lock(_mtx);
+        if (ok) {
+            ++_stats.reused;
+            ++_stats.inUse;
+            return conn;
+        }
+        ++_stats.discarded;
+        LOGS(_log, LOG_LVL_DEBUG, "Dropping stale connection for " << user);
+    }
+
+    mysql::MySqlConfig config(_mySqlConfig);
+    config.username = user;
+    ConnPtr conn = _connect(config);
+    if (!conn) {
+        LOGS(_log, LOG_LVL_ERROR, "Unable to connect to MySQL: " << config);
+        return conn;
+    }
+    std::lock_guard<std::mutex> lock(_mtx);
+    ++_stats.created;
+    ++_stats.inUse;
+    LOGS(_log, LOG_LVL_DEBUG, "New connection for " << user << " " << _stats);
+    return conn;
+}
+
+
+void ConnectionPool::release(ConnPtr conn, bool reusable) {
+    if (!conn) {
+        return;
+    }
+    std::string const user = conn->getConfig().username;
+    bool room = false;
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        room = _stats.idle < _maxIdle;
+    }
+    // Reset without holding the mutex, it is a round trip to the server.
+    bool resetOk = reusable && room && _reset(*conn);
+    std::lock_guard<std::mutex> lock(_mtx);
+    --_stats.inUse;
+    if (reusable && room && !resetOk) {
+        ++_stats.discarded;
+    }
+    if (resetOk && _stats.idle < _maxIdle) {
+        _idle[user].push_back(std::move(conn));
+        ++_stats.idle;
+    }
+    // Otherwise conn is closed on leaving scope.
+}
+
+
+ConnectionPool::Stats ConnectionPool::getStats() {
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _stats;
+}
+
+
+ConnectionPool::ConnPtr ConnectionPool::_connect(mysql::MySqlConfig const& config) {
+    ConnPtr conn(new mysql::MySqlConnection(config));
+    if (!conn->connect()) {
+        conn.reset();
+    }
+    return conn;
+}
+
+
+std::ostream& operator<<(std::ostream& os, ConnectionPool::Stats const& stats) {
+    os << "ConnectionPool(created=" << stats.created << " reused=" << stats.reused
+       << " discarded=" << stats.discarded << " idle=" << stats.idle
+       << " inUse=" << stats.inUse << ")";
+    return os;
+}
+
+}}} // namespace lsst::qserv::wdb
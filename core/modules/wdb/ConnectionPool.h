@@ -0,0 +1,100 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_QSERV_WDB_CONNECTIONPOOL_H
+#define LSST_QSERV_WDB_CONNECTIONPOOL_H
+
+// System headers
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+// Qserv headers
+#include "mysql/MySqlConfig.h"
+#include "mysql/MySqlConnection.h"
+
+namespace lsst {
+namespace qserv {
+namespace wdb {
+
+/// ConnectionPool keeps MySQL connections that finished their Task open so
+/// that later Tasks run by the same user can borrow them instead of
+/// connecting and authenticating again.
+/// Idle connections are checked before they are handed out and their
+/// session is reset when they are returned. At most maxIdle connections are
+/// kept, across all users; 0 closes every connection when it is returned.
+class ConnectionPool {
+public:
+    using Ptr = std::shared_ptr<ConnectionPool>;
+    using ConnPtr = std::unique_ptr<mysql::MySqlConnection>;
+
+    struct Stats {
+        uint64_t created{0};   ///< Connections opened
+        uint64_t reused{0};    ///< Checkouts served by an idle connection
+        uint64_t discarded{0}; ///< Connections closed because they failed a check
+        unsigned int idle{0};  ///< Connections waiting in the pool
+        unsigned int inUse{0}; ///< Connections borrowed
+    };
+
+    ConnectionPool(mysql::MySqlConfig const& mySqlConfig, unsigned int maxIdle);
+    virtual ~ConnectionPool() {}
+
+    ConnectionPool(ConnectionPool const&) = delete;
+    ConnectionPool& operator=(ConnectionPool const&) = delete;
+
+    /// @return a connection logged in as user, nullptr if none could be made.
+    ConnPtr acquire(std::string const& user);
+
+    /// Give back a connection obtained from acquire().
+    /// @param reusable false if the connection may be in an unknown state,
+    ///                 for example after its query was killed.
+    void release(ConnPtr conn, bool reusable);
+
+    Stats getStats();
+
+protected:
+    /// @return a new connection using config, nullptr on failure.
+    virtual ConnPtr _connect(mysql::MySqlConfig const& config);
+    /// @return true if an idle connection can still be used.
+    virtual bool _check(mysql::MySqlConnection& conn) { return conn.ping(); }
+    /// @return true if the session of a returned connection was reset.
+    virtual bool _reset(mysql::MySqlConnection& conn) { return conn.resetSession(); }
+
+private:
+    mysql::MySqlConfig const _mySqlConfig;
+    unsigned int const _maxIdle;
+
+    std::mutex _mtx; ///< Protects _idle and _stats
+    std::map<std::string, std::deque<ConnPtr>> _idle; ///< user -> idle connections, newest last
+    Stats _stats;
+};
+
+std::ostream& operator<<(std::ostream& os, ConnectionPool::Stats const& stats);
+
+}}} // namespace lsst::qserv::wdb
+
+#endif // LSST_QSERV_WDB_CONNECTIONPOOL_H
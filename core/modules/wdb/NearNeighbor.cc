@@ -0,0 +1,587 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "wdb/NearNeighbor.h"
+
+// System headers
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <strings.h>
+
+// Qserv headers
+#include "wdb/SqlWords.h"
+
+using namespace lsst::qserv::wdb::sqlwords;
+
+namespace {
+
+// Same constants as scisql.
+double const RAD_PER_DEG = 0.0174532925199432957692369076849;
+double const DEG_PER_RAD = 57.2957795130823208767981548141;
+
+/// Words that may not appear outside of parentheses in a near-neighbour
+/// query, besides sqlwords::rowChangingWords.
+std::set<std::string> const refusedWords = {
+    "ON", "USING", "NATURAL", "OR", "XOR", "BETWEEN", "CASE"
+};
+
+/// Words that may appear in a condition besides columns and functions.
+std::set<std::string> const conditionWords = {
+    "AND", "OR", "XOR", "NOT", "IS", "NULL", "IN", "LIKE", "REGEXP", "RLIKE", "ESCAPE",
+    "DIV", "MOD", "TRUE", "FALSE", "BINARY", "CASE", "WHEN", "THEN", "ELSE", "END"
+};
+
+std::string noSpace(std::string const& str) {
+    std::string result;
+    for (char c : str) {
+        if (!std::isspace(static_cast<unsigned char>(c))) result += c;
+    }
+    return result;
+}
+
+/// Split 'text' at each 'sep' of 'top', its top level copy.
+std::vector<std::string> splitTop(std::string const& text, std::string const& top, char sep) {
+    std::vector<std::string> parts;
+    std::size_t start = 0;
+    for (std::size_t i = 0; i <= top.size(); ++i) {
+        if (i == top.size() || top[i] == sep) {
+            parts.push_back(trim(text.substr(start, i - start)));
+            start = i + 1;
+        }
+    }
+    return parts;
+}
+
+/// @return true if 'str' is an identifier.
+bool isIdentifier(std::string const& str) {
+    if (str.empty() || !isIdentifierStart(str[0])) return false;
+    return std::all_of(str.begin(), str.end(), isWordChar);
+}
+
+/// Split "alias.column" into its parts.
+bool splitColumn(std::string const& str, std::string& alias, std::string& column) {
+    auto dot = str.find('.');
+    if (dot == std::string::npos) return false;
+    alias = str.substr(0, dot);
+    column = str.substr(dot + 1);
+    return isIdentifier(alias) && isIdentifier(column);
+}
+
+/// @return 'str' without parentheses around all of it.
+std::string stripParens(std::string str) {
+    while (str.size() >= 2 && str.front() == '(' && str.back() == ')') {
+        int depth = 0;
+        std::size_t i = 0;
+        for (; i < str.size(); ++i) {
+            if (str[i] == '(') ++depth;
+            else if (str[i] == ')' && --depth == 0) break;
+        }
+        if (i != str.size() - 1) break;
+        str = trim(str.substr(1, str.size() - 2));
+    }
+    return str;
+}
+
+/// Split "scisql_angSep(a,b,c,d)", without white space, into its arguments.
+bool parseAngSep(std::string const& str, std::string args[4]) {
+    std::string const name = "SCISQL_ANGSEP(";
+    if (str.size() <= name.size() || upper(str.substr(0, name.size())) != name
+        || str.back() != ')') {
+        return false;
+    }
+    std::string inner = str.substr(name.size(), str.size() - name.size() - 1);
+    if (inner.find_first_of("()") != std::string::npos) return false;
+    int n = 0;
+    std::size_t start = 0;
+    for (std::size_t i = 0; i <= inner.size(); ++i) {
+        if (i == inner.size() || inner[i] == ',') {
+            if (n == 4) return false;
+            args[n++] = inner.substr(start, i - start);
+            start = i + 1;
+        }
+    }
+    return n == 4;
+}
+
+/// @return true if all of 'str' is a number, stored in 'value'.
+bool parseNumber(std::string const& str, double& value) {
+    if (str.empty()) return false;
+    char* end = nullptr;
+    value = std::strtod(str.c_str(), &end);
+    return end == str.c_str() + str.size() && std::isfinite(value);
+}
+
+/// Find which of 'aliases' condition 'cond' refers to.
+/// @return false if 'cond' has identifiers that are neither columns of an
+///         alias, nor functions, nor operators.
+bool conditionAliases(std::string const& cond, std::string const aliases[2], bool refers[2]) {
+    // Blank out string literals, refuse quoted identifiers.
+    std::string str = cond;
+    char quote = 0;
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        char c = str[i];
+        if (quote != 0) {
+            if (c == '\\' && i + 1 < str.size()) {
+                str[i] = str[i+1] = ' ';
+                ++i;
+                continue;
+            }
+            if (c == quote) quote = 0;
+            str[i] = ' ';
+        } else if (c == '`') {
+            return false;
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            str[i] = ' ';
+        }
+    }
+    auto prevChar = [&str](std::size_t i) {
+        while (i > 0 && std::isspace(static_cast<unsigned char>(str[i-1]))) --i;
+        return i > 0 ? str[i-1] : ' ';
+    };
+    auto nextChar = [&str](std::size_t i) {
+        while (i < str.size() && std::isspace(static_cast<unsigned char>(str[i]))) ++i;
+        return i < str.size() ? str[i] : ' ';
+    };
+    std::size_t i = 0;
+    while (i < str.size()) {
+        char c = str[i];
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            // A number, exponents included.
+            while (i < str.size() && (isWordChar(str[i]) || str[i] == '.')) ++i;
+            continue;
+        }
+        if (!isIdentifierStart(c)) {
+            ++i;
+            continue;
+        }
+        std::size_t end = i;
+        while (end < str.size() && isWordChar(str[end])) ++end;
+        std::string word = str.substr(i, end - i);
+        if (prevChar(i) == '.') {
+            // Column of an alias, the alias itself was checked.
+        } else if (nextChar(end) == '.') {
+            if (word == aliases[0]) refers[0] = true;
+            else if (word == aliases[1]) refers[1] = true;
+            else return false;
+        } else if (nextChar(end) != '(' && conditionWords.count(upper(word)) == 0) {
+            return false;
+        }
+        i = end;
+    }
+    return true;
+}
+
+/// Cross product, norm and dot product the way scisql computes them.
+inline double separation(double x1, double y1, double z1, double x2, double y2, double z2) {
+    double const nx = y1*z2 - z1*y2;
+    double const ny = z1*x2 - x1*z2;
+    double const nz = x1*y2 - y1*x2;
+    double const ss = std::sqrt(nx*nx + ny*ny + nz*nz);
+    double const cs = x1*x2 + y1*y2 + z1*z2;
+    if (cs == 0.0 && ss == 0.0) {
+        return 0.0;
+    }
+    return std::atan2(ss, cs) * DEG_PER_RAD;
+}
+
+inline void unitVector(double ra, double decl, double& x, double& y, double& z) {
+    double const cosDecl = std::cos(RAD_PER_DEG * decl);
+    x = std::cos(RAD_PER_DEG * ra) * cosDecl;
+    y = std::sin(RAD_PER_DEG * ra) * cosDecl;
+    z = std::sin(RAD_PER_DEG * decl);
+}
+
+} // anonymous namespace
+
+namespace lsst {
+namespace qserv {
+namespace wdb {
+
+int NearNeighborQuery::Side::addColumn(std::string const& column) {
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        // MySQL column names are not case sensitive.
+        if (strcasecmp(columns[i].c_str(), column.c_str()) == 0) return i;
+    }
+    columns.push_back(column);
+    return columns.size() - 1;
+}
+
+bool NearNeighborQuery::parse(std::string const& sql, NearNeighborQuery& out) {
+    std::string query = trimStatement(sql);
+    std::string unquoted;
+    std::string topLevel;
+    if (!blankOut(query, unquoted, topLevel)) return false;
+
+    // Find SELECT, FROM and WHERE, refuse anything else at the top level
+    // and subqueries.
+    auto topWords = words(topLevel);
+    if (topWords.empty() || topWords[0].text != "SELECT" || topWords[0].pos != 0) return false;
+    std::size_t fromPos = std::string::npos;
+    std::size_t wherePos = std::string::npos;
+    for (std::size_t j = 1; j < topWords.size(); ++j) {
+        auto const& word = topWords[j];
+        if (rowChangingWords.count(word.text) != 0 || refusedWords.count(word.text) != 0) return false;
+        if (word.text == "FROM") {
+            if (fromPos != std::string::npos) return false;
+            fromPos = word.pos;
+        } else if (word.text == "WHERE") {
+            if (fromPos == std::string::npos || wherePos != std::string::npos) return false;
+            wherePos = word.pos;
+        }
+    }
+    if (wherePos == std::string::npos) return false;
+    for (auto const& word : words(unquoted)) {
+        if (word.text == "SELECT" && word.pos != 0) return false;
+    }
+
+    // Two tables, each with an alias.
+    NearNeighborQuery q;
+    std::size_t const fromStart = fromPos + 4;
+    auto tables = splitTop(query.substr(fromStart, wherePos - fromStart),
+                           topLevel.substr(fromStart, wherePos - fromStart), ',');
+    if (tables.size() != 2) return false;
+    for (int i = 0; i < 2; ++i) {
+        std::vector<std::string> tokens;
+        std::string token;
+        for (char c : tables[i] + " ") {
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                if (!token.empty()) tokens.push_back(token);
+                token.clear();
+            } else {
+                token += c;
+            }
+        }
+        if (tokens.size() == 3 && upper(tokens[1]) == "AS") {
+            tokens.erase(tokens.begin() + 1);
+        }
+        if (tokens.size() != 2 || !isIdentifier(tokens[1])) return false;
+        std::string db, table;
+        if (!isIdentifier(tokens[0]) && !splitColumn(tokens[0], db, table)) return false;
+        q.sides[i].table = tokens[0];
+        q.sides[i].alias = tokens[1];
+    }
+    if (q.sides[0].alias == q.sides[1].alias) return false;
+    std::string const aliases[2] = {q.sides[0].alias, q.sides[1].alias};
+    auto sideOf = [&aliases](std::string const& alias) {
+        return alias == aliases[0] ? 0 : (alias == aliases[1] ? 1 : -1);
+    };
+
+    // Conditions, split on AND.
+    std::vector<std::string> conditions;
+    std::size_t const whereStart = wherePos + 5;
+    std::size_t condStart = whereStart;
+    for (auto const& word : topWords) {
+        if (word.pos > wherePos && word.text == "AND") {
+            conditions.push_back(trim(query.substr(condStart, word.pos - condStart)));
+            condStart = word.pos + 3;
+        }
+    }
+    conditions.push_back(trim(query.substr(condStart)));
+
+    // The join condition.
+    std::string joinArgs[4];
+    bool found = false;
+    std::vector<std::string> others;
+    for (auto const& condition : conditions) {
+        std::string cond = noSpace(stripParens(condition));
+        std::string call;
+        std::string op;
+        std::string literal;
+        auto callPos = upper(cond).find("SCISQL_ANGSEP(");
+        if (callPos == 0) {
+            auto close = cond.find(')');
+            if (close == std::string::npos) return false;
+            call = cond.substr(0, close + 1);
+            std::string rest = cond.substr(close + 1);
+            op = rest.compare(0, 2, "<=") == 0 ? "<=" : rest.substr(0, 1);
+            literal = rest.substr(op.size());
+        } else if (callPos != std::string::npos && cond.back() == ')') {
+            call = cond.substr(callPos);
+            std::string rest = cond.substr(0, callPos);
+            op = (rest.size() >= 2 && rest.compare(rest.size() - 2, 2, ">=") == 0) ? ">=" : rest.substr(rest.size() - 1);
+            literal = rest.substr(0, rest.size() - op.size());
+        }
+        double radius;
+        std::string args[4];
+        if (call.empty() || !parseAngSep(call, args) || !parseNumber(literal, radius)
+            || (op != "<" && op != "<=" && op != ">" && op != ">=")
+            || (callPos == 0) != (op[0] == '<')) {
+            others.push_back(condition);
+            continue;
+        }
+        if (found) return false;
+        found = true;
+        std::copy(args, args + 4, joinArgs);
+        q.radius = radius;
+        q.inclusive = op.size() == 2;
+    }
+    if (!found) return false;
+    std::string alias[4];
+    std::string column[4];
+    for (int i = 0; i < 4; ++i) {
+        if (!splitColumn(joinArgs[i], alias[i], column[i])) return false;
+    }
+    if (alias[0] != alias[1] || alias[2] != alias[3] || sideOf(alias[0]) < 0
+        || sideOf(alias[2]) < 0 || alias[0] == alias[2]) {
+        return false;
+    }
+    for (int i = 0; i < 4; i += 2) {
+        auto& side = q.sides[sideOf(alias[i])];
+        side.columns.push_back(column[i]);
+        side.columns.push_back(column[i + 1]);
+    }
+
+    // Other conditions.
+    for (auto const& condition : others) {
+        bool refers[2] = {false, false};
+        if (!conditionAliases(condition, aliases, refers)) return false;
+        if (!refers[0] || !refers[1]) {
+            q.sides[refers[1] ? 1 : 0].where.push_back(condition);
+            continue;
+        }
+        std::string cond = noSpace(stripParens(condition));
+        std::size_t pos;
+        std::string op;
+        if ((pos = cond.find("<>")) != std::string::npos) {
+            op = "<>";
+        } else if ((pos = cond.find("!=")) != std::string::npos) {
+            op = "!=";
+        } else if ((pos = cond.find('=')) != std::string::npos && pos > 0
+                   && cond.find_first_of("<>!", pos - 1) != pos - 1) {
+            op = "=";
+        } else {
+            return false;
+        }
+        std::string lAlias, lColumn, rAlias, rColumn;
+        if (!splitColumn(cond.substr(0, pos), lAlias, lColumn)
+            || !splitColumn(cond.substr(pos + op.size()), rAlias, rColumn)
+            || sideOf(lAlias) < 0 || sideOf(rAlias) < 0 || lAlias == rAlias
+            || strcasecmp(lColumn.c_str(), rColumn.c_str()) != 0) {
+            // Only values of the same column are compared as text.
+            return false;
+        }
+        Match match;
+        match.column[sideOf(lAlias)] = q.sides[sideOf(lAlias)].addColumn(lColumn);
+        match.column[sideOf(rAlias)] = q.sides[sideOf(rAlias)].addColumn(rColumn);
+        match.equal = (op == "=");
+        q.matches.push_back(match);
+    }
+
+    // Result items.
+    auto items = splitTop(query.substr(6, fromPos - 6), topLevel.substr(6, fromPos - 6), ',');
+    for (auto const& itemText : items) {
+        // Drop "AS name", the result schema comes from MySQL.
+        std::string itemTop;
+        std::string itemUnquoted;
+        if (!blankOut(itemText, itemUnquoted, itemTop)) return false;
+        std::string expr = itemText;
+        for (auto const& word : words(itemTop)) {
+            if (word.text == "AS") expr = trim(itemText.substr(0, word.pos));
+        }
+        Item item;
+        std::string exprAlias, exprColumn;
+        std::string args[4];
+        if (upper(noSpace(expr)) == "COUNT(*)") {
+            item.kind = Item::COUNT;
+        } else if (parseAngSep(noSpace(expr), args)) {
+            bool same = true;
+            bool swapped = true;
+            for (int i = 0; i < 4; ++i) {
+                same = same && args[i] == joinArgs[i];
+                swapped = swapped && args[i] == joinArgs[(i + 2) % 4];
+            }
+            if (!same && !swapped) return false;
+            item.kind = Item::DISTANCE;
+        } else if (splitColumn(expr, exprAlias, exprColumn) && sideOf(exprAlias) >= 0) {
+            item.kind = Item::COLUMN;
+            item.side = sideOf(exprAlias);
+            item.column = q.sides[item.side].addColumn(exprColumn);
+        } else {
+            return false;
+        }
+        q.items.push_back(item);
+    }
+    for (auto const& item : q.items) {
+        if (item.kind == Item::COUNT && q.items.size() != 1) return false;
+    }
+    out = q;
+    return true;
+}
+
+std::string NearNeighborQuery::makeSideQuery(int i) const {
+    Side const& side = sides[i];
+    std::string sql = "SELECT ";
+    for (std::size_t j = 0; j < side.columns.size(); ++j) {
+        sql += (j == 0 ? "" : ",") + side.alias + "." + side.columns[j];
+    }
+    sql += " FROM " + side.table + " AS " + side.alias;
+    for (std::size_t j = 0; j < side.where.size(); ++j) {
+        sql += (j == 0 ? " WHERE (" : " AND (") + side.where[j] + ")";
+    }
+    return sql;
+}
+
+void NearNeighborTable::addRow(char const* ra, char const* decl,
+                               char const* const* values, unsigned long const* lengths) {
+    if (ra == nullptr || decl == nullptr) {
+        return;
+    }
+    char* raEnd = nullptr;
+    char* declEnd = nullptr;
+    double const raValue = std::strtod(ra, &raEnd);
+    double const declValue = std::strtod(decl, &declEnd);
+    if (raEnd == ra || declEnd == decl) {
+        return;
+    }
+    addRow(raValue, declValue, values, lengths);
+}
+
+void NearNeighborTable::addRow(double ra, double decl,
+                               char const* const* values, unsigned long const* lengths) {
+    // scisql_angSep() is NULL for declinations out of range.
+    if (!(decl >= -90.0 && decl <= 90.0) || !std::isfinite(ra)) {
+        return;
+    }
+    double x, y, z;
+    unitVector(ra, decl, x, y, z);
+    _row.push_back(_row.size());
+    _x.push_back(x);
+    _y.push_back(y);
+    _z.push_back(z);
+    _decl.push_back(decl);
+    for (int i = 0; i < _numColumns; ++i) {
+        _offsets.push_back(_text.size());
+        if (values[i] == nullptr) {
+            _lengths.push_back(0);
+            _nulls.push_back(true);
+        } else {
+            _text.append(values[i], lengths[i]);
+            _lengths.push_back(lengths[i]);
+            _nulls.push_back(false);
+        }
+        _text.push_back('\0');
+    }
+}
+
+void NearNeighborTable::finish() {
+    std::vector<std::size_t> order(_row.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [this](std::size_t i, std::size_t j) { return _decl[i] < _decl[j]; });
+    auto reorder = [&order](std::vector<double>& v) {
+        std::vector<double> sorted(v.size());
+        for (std::size_t i = 0; i < order.size(); ++i) sorted[i] = v[order[i]];
+        v.swap(sorted);
+    };
+    reorder(_x);
+    reorder(_y);
+    reorder(_z);
+    reorder(_decl);
+    _row = order;
+}
+
+char const* NearNeighborTable::getValue(std::size_t row, int column) const {
+    std::size_t const i = row * _numColumns + column;
+    return _nulls[i] ? nullptr : _text.data() + _offsets[i];
+}
+
+unsigned long NearNeighborTable::getLength(std::size_t row, int column) const {
+    return _lengths[row * _numColumns + column];
+}
+
+bool NearNeighborTable::join(NearNeighborTable const& a, NearNeighborTable const& b,
+                             double radius, bool inclusive, PairFunc const& func) {
+    std::size_t const na = a._x.size();
+    std::size_t const nb = b._x.size();
+    if (na == 0 || nb == 0 || !(radius >= 0.0)) {
+        return true;
+    }
+    // Candidates are chosen with some slack for rounding, the separation of
+    // each candidate is then computed as scisql does and compared to radius.
+    double const window = std::min(radius, 180.0) * (1.0 + 1e-9) + 1e-12;
+    double limit2 = std::numeric_limits<double>::infinity();
+    if (window < 180.0) {
+        double const chord = 2.0 * std::sin(0.5 * window * RAD_PER_DEG) + 1e-15;
+        limit2 = chord * chord * (1.0 + 1e-9);
+    }
+
+    std::vector<double> dist2;
+    std::size_t lo = 0;
+    std::size_t hi = 0;
+    for (std::size_t i = 0; i < na; ++i) {
+        // Rows of 'a' are sorted by declination, so the window of rows of 'b'
+        // close enough in declination only moves forward.
+        double const declMin = a._decl[i] - window;
+        double const declMax = a._decl[i] + window;
+        while (lo < nb && b._decl[lo] < declMin) ++lo;
+        if (hi < lo) hi = lo;
+        while (hi < nb && b._decl[hi] <= declMax) ++hi;
+        std::size_t const n = hi - lo;
+        if (n == 0) continue;
+
+        // Squared chord lengths, a loop the compiler vectorizes.
+        double const ax = a._x[i];
+        double const ay = a._y[i];
+        double const az = a._z[i];
+        double const* bx = b._x.data() + lo;
+        double const* by = b._y.data() + lo;
+        double const* bz = b._z.data() + lo;
+        dist2.resize(n);
+        double* d2 = dist2.data();
+        for (std::size_t k = 0; k < n; ++k) {
+            double const dx = ax - bx[k];
+            double const dy = ay - by[k];
+            double const dz = az - bz[k];
+            d2[k] = dx*dx + dy*dy + dz*dz;
+        }
+        for (std::size_t k = 0; k < n; ++k) {
+            if (d2[k] > limit2) continue;
+            double const sep = separation(ax, ay, az, bx[k], by[k], bz[k]);
+            if (inclusive ? sep <= radius : sep < radius) {
+                if (!func(a._row[i], b._row[lo + k], sep)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+double NearNeighborTable::angSep(double ra1, double decl1, double ra2, double decl2) {
+    if (!(decl1 >= -90.0 && decl1 <= 90.0 && decl2 >= -90.0 && decl2 <= 90.0)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double x1, y1, z1, x2, y2, z2;
+    unitVector(ra1, decl1, x1, y1, z1);
+    unitVector(ra2, decl2, x2, y2, z2);
+    return separation(x1, y1, z1, x2, y2, z2);
+}
+
+}}} // namespace lsst::qserv::wdb
@@ -0,0 +1,157 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef LSST_QSERV_WDB_NEARNEIGHBOR_H
+#define LSST_QSERV_WDB_NEARNEIGHBOR_H
+
+// System headers
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace lsst {
+namespace qserv {
+namespace wdb {
+
+/// The parts of a sub-chunk near-neighbour query, a join of two tables on
+/// scisql_angSep(a.ra,a.decl,b.ra,b.decl) < radius, that NearNeighborTable
+/// can evaluate. Conditions on one table are left to MySQL when it reads the
+/// rows of that table, the join itself is done by NearNeighborTable::join().
+struct NearNeighborQuery {
+    /// One of the joined tables.
+    struct Side {
+        std::string table;               ///< Table, with its database if given.
+        std::string alias;
+        std::vector<std::string> where;  ///< Conditions on this table only.
+        /// Columns read from the table, the first two are the coordinates.
+        std::vector<std::string> columns;
+
+        /// @return the index of 'column' in columns, added if needed.
+        int addColumn(std::string const& column);
+    };
+
+    /// A column of the result.
+    struct Item {
+        enum Kind { COLUMN, DISTANCE, COUNT };
+        Kind kind;
+        int side;   ///< Side of a COLUMN.
+        int column; ///< Index of a COLUMN in Side::columns.
+    };
+
+    /// A condition a.column = b.column, or <> when 'equal' is false.
+    /// The worker only evaluates it for integer columns, see QueryRunner.
+    struct Match {
+        int column[2];
+        bool equal;
+    };
+
+    Side sides[2];
+    double radius{0};
+    bool inclusive{false};  ///< true for angSep <= radius.
+    std::vector<Item> items;
+    std::vector<Match> matches;
+
+    /// Split 'sql' into its parts when it is of the form
+    /// "SELECT <items> FROM <table> AS <a>,<table> AS <b> WHERE <conditions>"
+    /// where the conditions are combined with AND and include exactly one
+    /// "scisql_angSep(a.ra,a.decl,b.ra,b.decl) < radius" (or <=, or the mirror
+    /// image), all other conditions either refer to one table only or are
+    /// a.column = b.column or a.column <> b.column. The result items may be
+    /// columns of either table, the same scisql_angSep() or a lone COUNT(*).
+    /// Anything else, including unqualified columns, is refused.
+    /// @return true if 'sql' was split into 'out'.
+    static bool parse(std::string const& sql, NearNeighborQuery& out);
+
+    /// @return the query reading the columns of side 'i'.
+    std::string makeSideQuery(int i) const;
+};
+
+/// NearNeighborTable holds the rows of one side of a near-neighbour join as
+/// unit vectors in struct-of-arrays layout sorted by declination, with the
+/// text of all their columns. Angular separations are computed the way
+/// scisql_angSep() computes them, so that a join gives the same pairs as
+/// MySQL.
+class NearNeighborTable {
+public:
+    /// Called for each pair found by join() with the row numbers, counting
+    /// the rows kept by addRow(), and the separation in degrees. Returning false
+    /// stops the join.
+    typedef std::function<bool(std::size_t, std::size_t, double)> PairFunc;
+
+    /// @param numColumns number of values of each row, the coordinate columns included.
+    explicit NearNeighborTable(int numColumns) : _numColumns(numColumns) {}
+
+    NearNeighborTable(NearNeighborTable const&) = delete;
+    NearNeighborTable& operator=(NearNeighborTable const&) = delete;
+
+    /// Add a row from text as returned by the MySQL C API, nullptr for NULL.
+    /// Rows without a valid position, for which scisql_angSep() is NULL, can
+    /// not be part of a pair and are skipped.
+    void addRow(char const* ra, char const* decl,
+                char const* const* values, unsigned long const* lengths);
+
+    /// Add a row with the given coordinates, in degrees.
+    void addRow(double ra, double decl, char const* const* values, unsigned long const* lengths);
+
+    /// Sort rows by declination, must be called after the last addRow().
+    void finish();
+
+    /// @return the number of rows kept.
+    std::size_t getRowCount() const { return _row.size(); }
+
+    /// @return the value of 'column' of row number 'row', nullptr for NULL.
+    char const* getValue(std::size_t row, int column) const;
+    unsigned long getLength(std::size_t row, int column) const;
+
+    /// Find all pairs of a row of 'a' and a row of 'b' that are less than
+    /// 'radius' degrees apart, or not more than that if 'inclusive'.
+    /// @return false if 'func' stopped the join.
+    static bool join(NearNeighborTable const& a, NearNeighborTable const& b,
+                     double radius, bool inclusive, PairFunc const& func);
+
+    /// @return the separation in degrees of two positions as scisql_angSep()
+    ///         computes it, NaN if a declination is out of range.
+    static double angSep(double ra1, double decl1, double ra2, double decl2);
+
+private:
+    int const _numColumns;
+
+    // Kept rows, sorted by declination after finish().
+    std::vector<double> _x;
+    std::vector<double> _y;
+    std::vector<double> _z;
+    std::vector<double> _decl;
+    std::vector<std::size_t> _row; ///< Row number of each kept row.
+
+    // Values of kept rows, _numColumns per row, in row number order.
+    // Each value is followed by '\0' in _text.
+    std::string _text;
+    std::vector<std::size_t> _offsets;
+    std::vector<unsigned long> _lengths;
+    std::vector<bool> _nulls;
+};
+
+}}} // namespace lsst::qserv::wdb
+
+#endif // LSST_QSERV_WDB_NEARNEIGHBOR_H
@@ -34,6 +34,8 @@
 // System headers
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
 #include <memory>
 
@@ -53,13 +55,13 @@
 #include "mysql/MySqlConfig.h"
 #include "mysql/MySqlConnection.h"
 #include "mysql/SchemaFactory.h"
+#include "proto/ColumnBatchBuilder.h"
 #include "proto/ProtoHeaderWrap.h"
 #include "proto/worker.pb.h"
 #include "sql/Schema.h"
 #include "sql/SqlErrorObject.h"
 #include "util/common.h"
 #include "util/MultiError.h"
-#include "util/StringHash.h"
 #include "util/threadSafe.h"
 #include "wbase/Base.h"
 #include "wbase/SendChannel.h"
@@ -67,6 +69,42 @@
 
 namespace {
 LOG_LOGGER _log = LOG_GET("lsst.qserv.wdb.QueryRunner");
+
+using lsst::qserv::proto::ColumnBatch;
+
+/// @return the protocol 3 encoding for the values of a MySQL result field.
+ColumnBatch::Encoding encodingFor(MYSQL_FIELD const& field) {
+    switch (field.type) {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONGLONG:
+        return (field.flags & UNSIGNED_FLAG) ? ColumnBatch::UINT64 : ColumnBatch::INT64;
+    case MYSQL_TYPE_DOUBLE:
+        return ColumnBatch::DOUBLE;
+    case MYSQL_TYPE_FLOAT:
+        return ColumnBatch::FLOAT;
+    default:
+        // DECIMAL is sent as text to keep its exact value.
+        return ColumnBatch::STRING;
+    }
+}
+
+/// @return true if the text of values of 'field' is equal exactly when the
+///         values are, which holds for integers without ZEROFILL.
+bool isPlainInteger(MYSQL_FIELD const& field) {
+    switch (field.type) {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONGLONG:
+        return (field.flags & ZEROFILL_FLAG) == 0;
+    default:
+        return false;
+    }
+}
 }
 
 namespace lsst {
@@ -75,8 +113,12 @@ namespace wdb {
 
 QueryRunner::Ptr QueryRunner::newQueryRunner(wbase::Task::Ptr const& task,
                                              ChunkResourceMgr::Ptr const& chunkResourceMgr,
-                                             mysql::MySqlConfig const& mySqlConfig) {
-    Ptr qr{new QueryRunner{task, chunkResourceMgr, mySqlConfig}}; // Private constructor.
+                                             ConnectionPool::Ptr const& connPool,
+                                             SharedScanMgr::Ptr const& sharedScanMgr,
+                                             bool nearNeighborJoin,
+                                             SharedScanMgr::Ticket::Ptr const& sharedScanTicket) {
+    Ptr qr{new QueryRunner{task, chunkResourceMgr, connPool, sharedScanMgr,
+                           nearNeighborJoin, sharedScanTicket}}; // Private constructor.
     // Let the Task know this is its QueryRunner.
     bool cancelled = qr->_task->setTaskQueryRunner(qr);
     if (cancelled) {
@@ -90,22 +132,23 @@ QueryRunner::Ptr QueryRunner::newQueryRunner(wbase::Task::Ptr const& task,
 /// and correct setup of enable_shared_from_this.
 QueryRunner::QueryRunner(wbase::Task::Ptr const& task,
                          ChunkResourceMgr::Ptr const& chunkResourceMgr,
-                         mysql::MySqlConfig const& mySqlConfig)
-    : _task(task), _chunkResourceMgr(chunkResourceMgr), _mySqlConfig(mySqlConfig) {
+                         ConnectionPool::Ptr const& connPool,
+                         SharedScanMgr::Ptr const& sharedScanMgr,
+                         bool nearNeighborJoin,
+                         SharedScanMgr::Ticket::Ptr const& sharedScanTicket)
+    : _task(task), _chunkResourceMgr(chunkResourceMgr), _connPool(connPool),
+      _sharedScanMgr(sharedScanMgr), _sharedScanTicket(sharedScanTicket),
+      _nearNeighborJoin(nearNeighborJoin) {
     int rc = mysql_thread_init();
     assert(rc == 0);
     assert(_task->msg);
 }
 
-/// Initialize the db connection
+/// Borrow a db connection for the czar-passed username.
 bool QueryRunner::_initConnection() {
-    mysql::MySqlConfig localMySqlConfig(_mySqlConfig);
-    localMySqlConfig.username = _task->user; // Override with czar-passed username.
-    _mysqlConn.reset(new mysql::MySqlConnection(localMySqlConfig));
-
-    if (not _mysqlConn->connect()) {
-        LOGS(_log, LOG_LVL_ERROR, "Unable to connect to MySQL: " << localMySqlConfig);
-        util::Error error(-1, "Unable to connect to MySQL; " + localMySqlConfig.toString());
+    _mysqlConn = _connPool->acquire(_task->user);
+    if (!_mysqlConn) {
+        util::Error error(-1, "Unable to connect to MySQL as " + _task->user);
         _multiError.push_back(error);
         return false;
     }
@@ -154,6 +197,8 @@ bool QueryRunner::runQuery() {
     if (_task->msg->has_protocol()) {
         switch(_task->msg->protocol()) {
         case 2:
+        case 3:
+            _protocol = _task->msg->protocol();
             return _dispatchChannel(); // Run the query and send the results back.
         case 1:
             throw UnsupportedError(_task->getIdStr() + " QueryRunner: Expected protocol > 1 in TaskMsg");
@@ -191,9 +236,12 @@ void QueryRunner::_initMsg() {
     }
 }
 
-void QueryRunner::_fillSchema(MYSQL_RES* result) {
-    // Build schema obj from result
-    auto s = mysql::SchemaFactory::newFromResult(result);
+void QueryRunner::_fillSchema(MYSQL_FIELD* fields, int numFields) {
+    // Build schema obj from the result fields
+    sql::Schema s;
+    for(int i=0; i < numFields; ++i) {
+        s.columns.push_back(mysql::SchemaFactory::newColSchema(fields[i]));
+    }
     // Fill _result's schema from Schema obj
     for(auto i=s.columns.begin(), e=s.columns.end(); i != e; ++i) {
         proto::ColumnSchema* cs = _result->mutable_rowschema()->add_columnschema();
@@ -211,15 +259,39 @@ void QueryRunner::_fillSchema(MYSQL_RES* result) {
     }
 }
 
-/// Fill one row in the Result msg from one row in MYSQL_RES*
-/// If the message has gotten larger than the desired message size,
-/// it will be transmitted with a flag set indicating the result
-/// continues in later messages.
+/// Set up column-major accumulation of rows with 'fields' (protocol 3).
+void QueryRunner::_initColumnBuilder(MYSQL_FIELD* fields, int numFields) {
+    std::vector<proto::ColumnBatch::Encoding> encodings;
+    for(int i=0; i < numFields; ++i) {
+        encodings.push_back(encodingFor(fields[i]));
+    }
+    _columnBuilder.reset(new proto::ColumnBatchBuilder(encodings));
+}
+
+/// Fill the Result msg with the rows in MYSQL_RES*
 bool QueryRunner::_fillRows(MYSQL_RES* result, int numFields, uint& rowCount, size_t& tSize) {
     MYSQL_ROW row;
 
     while ((row = mysql_fetch_row(result))) {
         auto lengths = mysql_fetch_lengths(result);
+        if (!_addRow(row, lengths, numFields, rowCount, tSize)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Fill one row in the Result msg from one row of a MySQL result.
+/// If the message has gotten larger than the desired message size,
+/// it will be transmitted with a flag set indicating the result
+/// continues in later messages.
+/// This may be called by the thread of another QueryRunner leading a shared scan.
+bool QueryRunner::_addRow(MYSQL_ROW row, unsigned long* lengths, int numFields,
+                          uint& rowCount, size_t& tSize) {
+    if (_columnBuilder) {
+        _columnBuilder->addRow(row, lengths);
+        tSize = _columnBuilder->getByteSize();
+    } else {
         proto::RowBundle* rawRow =_result->add_row();
         for(int i=0; i < numFields; ++i) {
             if (row[i]) {
@@ -231,32 +303,32 @@ bool QueryRunner::_fillRows(MYSQL_RES* result, int numFields, uint& rowCount, si
             }
         }
         tSize += rawRow->ByteSize();
-        ++rowCount;
+    }
+    ++rowCount;
 
-        // Each element needs to be mysql-sanitized
-        if (tSize > proto::ProtoHeaderWrap::PROTOBUFFER_DESIRED_LIMIT) {
-            if (tSize > proto::ProtoHeaderWrap::PROTOBUFFER_HARD_LIMIT) {
-                LOGS_ERROR("Message single row too large to send using protobuffer");
-                return false;
-            }
-            LOGS(_log, LOG_LVL_DEBUG, "Large message size=" << tSize
-                 << ", splitting message rowCount=" << rowCount);
-            _transmit(false, rowCount, tSize);
-            rowCount = 0;
-            tSize = 0;
-            _initMsg();
-            // This task is going to have multiple results to return to the czar and
-            // the speed this task can be completed will be limited by the czar's ability to
-            // read in results, which could be very very slow. The upshot of this is the
-            // scheduler for this worker should stop waiting for this task. leavePool()
-            // will tell the scheduler this task is finished and create a new thread in the pool
-            // to replace this one.
-            auto pet = _task->getAndNullPoolEventThread();
-            if (pet != nullptr) {
-                pet->leavePool();
-            } else {
-                LOGS(_log, LOG_LVL_DEBUG, "Large result PoolEventThread was null. Probably already moved.");
-            }
+    // Each element needs to be mysql-sanitized
+    if (tSize > proto::ProtoHeaderWrap::PROTOBUFFER_DESIRED_LIMIT) {
+        if (tSize > proto::ProtoHeaderWrap::PROTOBUFFER_HARD_LIMIT) {
+            LOGS_ERROR("Message single row too large to send using protobuffer");
+            return false;
+        }
+        LOGS(_log, LOG_LVL_DEBUG, "Large message size=" << tSize
+             << ", splitting message rowCount=" << rowCount);
+        _transmit(false, rowCount, tSize);
+        rowCount = 0;
+        tSize = 0;
+        _initMsg();
+        // This task is going to have multiple results to return to the czar and
+        // the speed this task can be completed will be limited by the czar's ability to
+        // read in results, which could be very very slow. The upshot of this is the
+        // scheduler for this worker should stop waiting for this task. leavePool()
+        // will tell the scheduler this task is finished and create a new thread in the pool
+        // to replace this one.
+        auto pet = _task->getAndNullPoolEventThread();
+        if (pet != nullptr) {
+            pet->leavePool(_task);
+        } else {
+            LOGS(_log, LOG_LVL_DEBUG, "Large result PoolEventThread was null. Probably already moved.");
         }
     }
     return true;
@@ -268,25 +340,29 @@ bool QueryRunner::_fillRows(MYSQL_RES* result, int numFields, uint& rowCount, si
 void QueryRunner::_transmit(bool last, uint rowCount, size_t tSize) {
     LOGS(_log, LOG_LVL_DEBUG, _task->getIdStr() << " _transmit last=" << last
          << " rowCount=" << rowCount << " tSize=" << tSize);
-    std::string resultString;
     _result->set_queryid(_task->getQueryId());
     _result->set_jobid(_task->getJobId());
     _result->set_continues(!last);
     _result->set_largeresult(_largeResult);
     _result->set_rowcount(rowCount);
     _result->set_transmitsize(tSize);
+    if (_columnBuilder) {
+        _columnBuilder->moveTo(*_result);
+    }
     if (!_multiError.empty()) {
         std::string chunkId = std::to_string(_task->msg->chunkid());
         std::string msg = "Error(s) in result for chunk #" + chunkId + ": " + _multiError.toOneLineString();
         _result->set_errormsg(msg);
         LOGS(_log, LOG_LVL_ERROR, msg);
     }
-    _result->SerializeToString(&resultString);
-    _transmitHeader(resultString);
+    // _resultString is handed to the channel without copying, the channel
+    // gives back a recycled buffer to serialize the next message into.
+    _result->SerializeToString(&_resultString);
+    _transmitHeader(_resultString);
     LOGS(_log, LOG_LVL_DEBUG, "_transmit last=" << last << " " << _task->getIdStr()
-         << " resultString=" << util::prettyCharList(resultString, 5));
+         << " resultString=" << util::prettyCharList(_resultString, 5));
     if (!_cancelled) {
-        bool sent = _task->sendChannel->sendStream(resultString.data(), resultString.size(), last);
+        bool sent = _task->sendChannel->sendStreamBuffer(_resultString, last);
         if (!sent) {
             LOGS(_log, LOG_LVL_ERROR, _task->getIdStr() << " Failed to transmit message!");
         }
@@ -300,9 +376,9 @@ void QueryRunner::_transmit(bool last, uint rowCount, size_t tSize) {
 void QueryRunner::_transmitHeader(std::string& msg) {
     LOGS(_log, LOG_LVL_DEBUG, "_transmitHeader");
     // Set header
-    _protoHeader->set_protocol(2); // protocol 2: row-by-row message
+    _protoHeader->set_protocol(_protocol); // protocol 2: row-by-row, 3: column-major message
     _protoHeader->set_size(msg.size());
-    _protoHeader->set_md5(util::StringHash::getMd5(msg.data(), msg.size()));
+    proto::ProtoHeaderWrap::setChecksum(*_protoHeader, _task->msg->checksumtype(), msg.data(), msg.size());
     _protoHeader->set_wname(getHostname());
     std::string protoHeaderString;
     _protoHeader->SerializeToString(&protoHeaderString);
@@ -312,7 +388,7 @@ void QueryRunner::_transmitHeader(std::string& msg) {
     assert(protoHeaderString.size() < 255);
     auto msgBuf = proto::ProtoHeaderWrap::wrap(protoHeaderString);
     if (!_cancelled) {
-        bool sent = _task->sendChannel->sendStream(msgBuf.data(), msgBuf.size(), false);
+        bool sent = _task->sendChannel->sendStreamBuffer(msgBuf, false);
         if (!sent) {
             LOGS(_log, LOG_LVL_ERROR, _task->getIdStr() << " Failed to transmit header!");
         }
@@ -369,8 +445,17 @@ bool QueryRunner::_dispatchChannel() {
     uint rowCount = 0;
     size_t tSize = 0;
 
+    // A plain select over a whole chunk table may be answered by a pass over
+    // the table that other Tasks share.
+    SharedScanQuery sharedQuery;
+    std::string sharedKey;
+    bool shared = false;
+    if (_sharedScanMgr != nullptr && sharedScanKey(*_task, sharedQuery, sharedKey)) {
+        shared = _runShared(sharedQuery, sharedKey, req, rowCount, tSize, erred);
+    }
+
     try {
-        for(int i=0; i < m.fragment_size(); ++i) {
+        for(int i=0; i < m.fragment_size() && !shared; ++i) {
             if (_cancelled) {
                 break;
             }
@@ -378,15 +463,27 @@ bool QueryRunner::_dispatchChannel() {
             ChunkResource cr(req.getResourceFragment(i));
             // Use query fragment as-is, funnel results.
             for(int qi=0, qe=fragment.query_size(); qi != qe; ++qi) {
+                // Near-neighbour joins of sub-chunk tables are done here rather
+                // than by a nested loop in MySQL, when the query allows it.
+                NearNeighborQuery nnQuery;
+                if (_nearNeighborJoin && fragment.has_subchunks()
+                    && NearNeighborQuery::parse(fragment.query(qi), nnQuery)
+                    && _runNearNeighbor(fragment.query(qi), nnQuery, firstResult, numFields,
+                                        rowCount, tSize, erred)) {
+                    continue;
+                }
                 MYSQL_RES* res = _primeResult(fragment.query(qi)); // This runs the SQL query.
                 if (!res) {
                     erred = true;
                     continue;
                 }
                 if (firstResult) {
-                    _fillSchema(res);
                     firstResult = false;
                     numFields = mysql_num_fields(res);
+                    _fillSchema(mysql_fetch_fields(res), numFields);
+                    if (_protocol == 3) {
+                        _initColumnBuilder(mysql_fetch_fields(res), numFields);
+                    }
                 } // TODO: may want to confirm (cheaply) that
                 // successive queries have the same result schema.
                 // TODO fritzm: revisit this error strategy
@@ -414,9 +511,292 @@ bool QueryRunner::_dispatchChannel() {
     return !erred;
 }
 
+bool QueryRunner::sharedScanKey(wbase::Task const& task, SharedScanQuery& query, std::string& key) {
+    proto::TaskMsg const& m = *task.msg;
+    if (m.scantable_size() == 0 || m.fragment_size() != 1 || m.fragment(0).has_subchunks()
+        || m.fragment(0).query_size() != 1 || !SharedScanQuery::parse(m.fragment(0).query(0), query)) {
+        return false;
+    }
+    key = task.user + ":" + m.db() + ":" + std::to_string(m.chunkid()) + ":" + query.from;
+    return true;
+}
+
+/// Run 'query' as a member of a shared scan.
+/// @return true if the rows of 'query' were provided by the shared scan, false if
+///         the query still needs to be run by itself.
+bool QueryRunner::_runShared(SharedScanQuery const& query, std::string const& key,
+                             ChunkResourceRequest& req, uint& rowCount, size_t& tSize, bool& erred) {
+    auto joined = _sharedScanMgr->join(key, SharedScanBatch::Member(shared_from_this(), query));
+    if (_sharedScanTicket != nullptr) {
+        _sharedScanTicket->release(); // Joined, a leader need not wait for this Task.
+    }
+    SharedScanBatch::Ptr batch = joined.first;
+    if (joined.second != 0) {
+        // Another QueryRunner leads the batch, it fills in this QueryRunner's result.
+        if (!batch->waitFinished()) {
+            return false;
+        }
+        auto member = batch->getMember(joined.second);
+        rowCount = member.rowCount;
+        tSize = member.tSize;
+        erred = member.erred;
+        return true;
+    }
+
+    auto members = _sharedScanMgr->gather(batch);
+    if (members.size() < 2) {
+        batch->finish(false);
+        return false;
+    }
+    bool started = false;
+    _sharedScanLeader.store(true);
+    try {
+        ChunkResource cr(req.getResourceFragment(0));
+        _serveBatch(members, started);
+    } catch(sql::SqlErrorObject const& e) {
+        if (started) {
+            _failMembers(members, util::Error(e.errNo(), e.errMsg()));
+        }
+    } catch(...) {
+        // Members must not wait forever.
+        if (started) {
+            _failMembers(members, util::Error(-1, "shared scan failed"));
+        }
+        _sharedScanLeader.store(false);
+        batch->finish(started, members);
+        throw;
+    }
+    _sharedScanLeader.store(false);
+    batch->finish(started, members);
+    if (!started) {
+        return false;
+    }
+    rowCount = members[0].rowCount;
+    tSize = members[0].tSize;
+    erred = members[0].erred;
+    return true;
+}
+
+/// Run the combined query of 'members' and give each of them its rows.
+/// 'started' is set once rows may have been sent, before that any failure
+/// leaves every member to run its own query.
+void QueryRunner::_serveBatch(std::vector<SharedScanBatch::Member>& members, bool& started) {
+    std::string sql = SharedScanMgr::makeQuery(members);
+    int numFields = members.size();
+    for (auto const& member : members) {
+        numFields += member.query.columnCount;
+    }
+    // Make sure the combined query is valid and has the expected columns
+    // before any rows are sent.
+    if (!_mysqlConn->queryUnbuffered(sql + " LIMIT 0")) {
+        LOGS(_log, LOG_LVL_WARN, _task->getIdStr() << " shared scan query refused, errno="
+             << _mysqlConn->getErrno() << " " << _mysqlConn->getError());
+        return;
+    }
+    int resultFields = mysql_num_fields(_mysqlConn->getResult());
+    _mysqlConn->freeResult();
+    if (resultFields != numFields) {
+        LOGS(_log, LOG_LVL_WARN, _task->getIdStr() << " shared scan query has " << resultFields
+             << " columns, expected " << numFields);
+        return;
+    }
+    if (!_mysqlConn->queryUnbuffered(sql)) {
+        LOGS(_log, LOG_LVL_WARN, _task->getIdStr() << " shared scan query failed, errno="
+             << _mysqlConn->getErrno() << " " << _mysqlConn->getError());
+        return;
+    }
+    started = true;
+    MYSQL_RES* res = _mysqlConn->getResult();
+    MYSQL_FIELD* fields = mysql_fetch_fields(res);
+    std::vector<int> offsets;
+    int offset = members.size();
+    for (auto const& member : members) {
+        auto const& runner = member.runner;
+        runner->_fillSchema(fields + offset, member.query.columnCount);
+        if (runner->_protocol == 3) {
+            runner->_initColumnBuilder(fields + offset, member.query.columnCount);
+        }
+        offsets.push_back(offset);
+        offset += member.query.columnCount;
+    }
+
+    MYSQL_ROW row;
+    bool allCancelled = false;
+    while (!allCancelled && (row = mysql_fetch_row(res))) {
+        auto lengths = mysql_fetch_lengths(res);
+        allCancelled = true;
+        for (unsigned int i=0; i < members.size(); ++i) {
+            auto& member = members[i];
+            if (member.erred || member.runner->_cancelled) continue;
+            allCancelled = false;
+            // The first columns flag the rows of each member.
+            if (row[i] == nullptr || row[i][0] != '1') continue;
+            if (!member.runner->_addRow(row + offsets[i], lengths + offsets[i],
+                                        member.query.columnCount, member.rowCount, member.tSize)) {
+                member.erred = true;
+            }
+        }
+    }
+    if (allCancelled) {
+        LOGS(_log, LOG_LVL_DEBUG, _task->getIdStr() << " shared scan cancelled by all members");
+        _mysqlConn->cancel();
+    } else if (_mysqlConn->getErrno() != 0) {
+        _failMembers(members, util::Error(_mysqlConn->getErrno(), _mysqlConn->getError()));
+    }
+    _mysqlConn->freeResult();
+}
+
+/// Run 'query', which 'nnQuery' describes, by reading the rows of both tables
+/// and joining them with NearNeighborTable::join().
+/// @return false if nothing was sent and the query still needs to be run by MySQL.
+bool QueryRunner::_runNearNeighbor(std::string const& query, NearNeighborQuery const& nnQuery,
+                                   bool& firstResult, int& numFields, uint& rowCount, size_t& tSize,
+                                   bool& erred) {
+    NearNeighborTable table0(nnQuery.sides[0].columns.size());
+    NearNeighborTable table1(nnQuery.sides[1].columns.size());
+    NearNeighborTable* const tables[2] = {&table0, &table1};
+    for (int i = 0; i < 2; ++i) {
+        std::vector<int> matchColumns;
+        for (auto const& match : nnQuery.matches) {
+            matchColumns.push_back(match.column[i]);
+        }
+        if (!_loadNearNeighborSide(nnQuery.makeSideQuery(i), matchColumns, *tables[i])) {
+            return false;
+        }
+    }
+    int const itemCount = nnQuery.items.size();
+    if (firstResult) {
+        // The result schema is the one MySQL gives the query.
+        if (!_mysqlConn->queryUnbuffered(query + " LIMIT 0")) {
+            LOGS(_log, LOG_LVL_WARN, _task->getIdStr() << " near-neighbour query refused, errno="
+                 << _mysqlConn->getErrno() << " " << _mysqlConn->getError());
+            return false;
+        }
+        MYSQL_RES* res = _mysqlConn->getResult();
+        int const resultFields = mysql_num_fields(res);
+        if (resultFields != itemCount) {
+            _mysqlConn->freeResult();
+            return false;
+        }
+        firstResult = false;
+        numFields = resultFields;
+        _fillSchema(mysql_fetch_fields(res), numFields);
+        if (_protocol == 3) {
+            _initColumnBuilder(mysql_fetch_fields(res), numFields);
+        }
+        _mysqlConn->freeResult();
+    } else if (numFields != itemCount) {
+        return false;
+    }
+
+    LOGS(_log, LOG_LVL_DEBUG, _task->getIdStr() << " near-neighbour join of "
+         << table0.getRowCount() << " and " << table1.getRowCount() << " rows");
+    std::vector<char const*> row(itemCount);
+    std::vector<unsigned long> lengths(itemCount);
+    char distance[32];
+    uint64_t count = 0;
+    bool const countOnly = nnQuery.items[0].kind == NearNeighborQuery::Item::COUNT;
+    auto addPair = [&](std::size_t r0, std::size_t r1, double sep) {
+        std::size_t const rows[2] = {r0, r1};
+        for (auto const& match : nnQuery.matches) {
+            char const* v0 = table0.getValue(r0, match.column[0]);
+            char const* v1 = table1.getValue(r1, match.column[1]);
+            if (v0 == nullptr || v1 == nullptr) return true; // NULL is neither = nor <>.
+            unsigned long const len = table0.getLength(r0, match.column[0]);
+            bool const equal = len == table1.getLength(r1, match.column[1])
+                && std::equal(v0, v0 + len, v1);
+            if (equal != match.equal) return true;
+        }
+        if (countOnly) {
+            ++count;
+            return true;
+        }
+        for (int i = 0; i < itemCount; ++i) {
+            auto const& item = nnQuery.items[i];
+            if (item.kind == NearNeighborQuery::Item::COLUMN) {
+                row[i] = tables[item.side]->getValue(rows[item.side], item.column);
+                lengths[i] = tables[item.side]->getLength(rows[item.side], item.column);
+            } else {
+                lengths[i] = snprintf(distance, sizeof(distance), "%.17g", sep);
+                row[i] = distance;
+            }
+        }
+        if (!_addRow(const_cast<MYSQL_ROW>(row.data()), lengths.data(), itemCount, rowCount, tSize)) {
+            erred = true;
+            return false;
+        }
+        return !_cancelled;
+    };
+    NearNeighborTable::join(table0, table1, nnQuery.radius, nnQuery.inclusive, addPair);
+    if (countOnly) {
+        std::string value = std::to_string(count);
+        row[0] = value.c_str();
+        lengths[0] = value.size();
+        if (!_addRow(const_cast<MYSQL_ROW>(row.data()), lengths.data(), itemCount, rowCount, tSize)) {
+            erred = true;
+        }
+    }
+    return true;
+}
+
+/// Read the rows of one table of a near-neighbour join into 'table'.
+/// @return false if the query failed, its coordinates are not DOUBLE columns
+///         or a column of 'matchColumns' is not an integer.
+bool QueryRunner::_loadNearNeighborSide(std::string const& query, std::vector<int> const& matchColumns,
+                                        NearNeighborTable& table) {
+    if (!_mysqlConn->queryUnbuffered(query)) {
+        LOGS(_log, LOG_LVL_DEBUG, _task->getIdStr() << " near-neighbour read failed, errno="
+             << _mysqlConn->getErrno() << " " << _mysqlConn->getError());
+        return false;
+    }
+    MYSQL_RES* res = _mysqlConn->getResult();
+    MYSQL_FIELD* fields = mysql_fetch_fields(res);
+    // Positions in other types would not be read back as the values MySQL uses.
+    if (mysql_num_fields(res) < 2 || fields[0].type != MYSQL_TYPE_DOUBLE
+        || fields[1].type != MYSQL_TYPE_DOUBLE) {
+        _mysqlConn->freeResult();
+        return false;
+    }
+    // Matches compare the text of values, which only gives the result of = for
+    // integers, MySQL compares strings by collation and converts mixed types.
+    for (int column : matchColumns) {
+        if (!isPlainInteger(fields[column])) {
+            LOGS(_log, LOG_LVL_DEBUG, _task->getIdStr() << " near-neighbour match on "
+                 << fields[column].name << " left to MySQL");
+            _mysqlConn->freeResult();
+            return false;
+        }
+    }
+    MYSQL_ROW row;
+    while (!_cancelled && (row = mysql_fetch_row(res))) {
+        table.addRow(row[0], row[1], row, mysql_fetch_lengths(res));
+    }
+    bool const ok = !_cancelled && _mysqlConn->getErrno() == 0;
+    if (_cancelled) {
+        _mysqlConn->cancel();
+    }
+    _mysqlConn->freeResult();
+    table.finish();
+    return ok;
+}
+
+/// Record 'error' for every member of a shared scan.
+void QueryRunner::_failMembers(std::vector<SharedScanBatch::Member>& members, util::Error const& error) {
+    for (auto& member : members) {
+        member.erred = true;
+        member.runner->_multiError.push_back(error);
+    }
+}
+
 void QueryRunner::cancel() {
     LOGS(_log, LOG_LVL_WARN, "Trying QueryRunner::cancel() call, experimental");
     _cancelled.store(true);
+    if (_sharedScanLeader) {
+        // Other queries depend on the rows of this connection, the shared scan
+        // stops sending rows to this one.
+        LOGS(_log, LOG_LVL_WARN, "QueryRunner::cancel() leading a shared scan, not killing it");
+        return;
+    }
     if (!_mysqlConn.get()) {
         LOGS(_log, LOG_LVL_WARN, "QueryRunner::cancel() no MysqlConn");
         return;
@@ -442,6 +822,11 @@ void QueryRunner::cancel() {
 }
 
 QueryRunner::~QueryRunner() {
+    if (_sharedScanTicket != nullptr) {
+        _sharedScanTicket->release();
+    }
+    // A killed query may leave the connection in an unknown state.
+    _connPool->release(std::move(_mysqlConn), !_cancelled);
 }
 
 }}} // namespace lsst::qserv::wdb
@@ -36,6 +36,8 @@
 // System headers
 #include <atomic>
 #include <memory>
+#include <string>
+#include <vector>
 
 // Qserv headers
 #include "mysql/MySqlConfig.h"
@@ -43,10 +45,14 @@
 #include "util/MultiError.h"
 #include "wbase/Task.h"
 #include "wdb/ChunkResource.h"
+#include "wdb/ConnectionPool.h"
+#include "wdb/NearNeighbor.h"
+#include "wdb/SharedScan.h"
 
 namespace lsst {
 namespace qserv {
 namespace proto {
+class ColumnBatchBuilder;
 class ProtoHeader;
 class Result;
 }}}
@@ -55,6 +61,8 @@ namespace lsst {
 namespace qserv {
 namespace wdb {
 
+class ChunkResourceRequest;
+
 /// On the worker, run a query related to a Task, writing the results to a table or supplied SendChannel.
 ///
 class QueryRunner : public wbase::TaskQueryRunner, public std::enable_shared_from_this<QueryRunner> {
@@ -62,7 +70,14 @@ public:
     using Ptr = std::shared_ptr<QueryRunner>;
     static QueryRunner::Ptr newQueryRunner(wbase::Task::Ptr const& task,
                                            ChunkResourceMgr::Ptr const& chunkResourceMgr,
-                                           mysql::MySqlConfig const& mySqlConfig);
+                                           ConnectionPool::Ptr const& connPool,
+                                           SharedScanMgr::Ptr const& sharedScanMgr=nullptr,
+                                           bool nearNeighborJoin=false,
+                                           SharedScanMgr::Ticket::Ptr const& sharedScanTicket=nullptr);
+
+    /// @return true if 'task' may share a table pass with other Tasks, with
+    ///         its query and the key of the SharedScanMgr batches it may join.
+    static bool sharedScanKey(wbase::Task const& task, SharedScanQuery& query, std::string& key);
     // Having more than one copy of this would making tracking its progress difficult.
     QueryRunner(QueryRunner const&) = delete;
     QueryRunner operator=(QueryRunner const&) = delete;
@@ -74,15 +89,31 @@ public:
 protected:
     QueryRunner(wbase::Task::Ptr const& task,
                 ChunkResourceMgr::Ptr const& chunkResourceMgr,
-                mysql::MySqlConfig const& mySqlConfig);
+                ConnectionPool::Ptr const& connPool,
+                SharedScanMgr::Ptr const& sharedScanMgr,
+                bool nearNeighborJoin,
+                SharedScanMgr::Ticket::Ptr const& sharedScanTicket);
 private:
     bool _initConnection();
     void _setDb();
     bool _dispatchChannel(); ///< Dispatch with output sent through a SendChannel
     MYSQL_RES* _primeResult(std::string const& query); ///< Obtain a result handle for a query.
 
+    bool _runShared(SharedScanQuery const& query, std::string const& key, ChunkResourceRequest& req,
+                    uint& rowCount, size_t& tSize, bool& erred);
+    void _serveBatch(std::vector<SharedScanBatch::Member>& members, bool& started);
+    void _failMembers(std::vector<SharedScanBatch::Member>& members, util::Error const& error);
+
+    bool _runNearNeighbor(std::string const& query, NearNeighborQuery const& nnQuery,
+                          bool& firstResult, int& numFields, uint& rowCount, size_t& tSize,
+                          bool& erred);
+    bool _loadNearNeighborSide(std::string const& query, std::vector<int> const& matchColumns,
+                               NearNeighborTable& table);
+
     bool _fillRows(MYSQL_RES* result, int numFields, uint& rowCount, size_t& tsize);
-    void _fillSchema(MYSQL_RES* result);
+    bool _addRow(MYSQL_ROW row, unsigned long* lengths, int numFields, uint& rowCount, size_t& tSize);
+    void _fillSchema(MYSQL_FIELD* fields, int numFields);
+    void _initColumnBuilder(MYSQL_FIELD* fields, int numFields);
     void _initMsgs();
     void _initMsg();
     void _transmit(bool last, uint rowCount, size_t size);
@@ -95,14 +126,24 @@ private:
     ChunkResourceMgr::Ptr _chunkResourceMgr;
     std::string _dbName;
     std::atomic<bool> _cancelled{false};
-    mysql::MySqlConfig const _mySqlConfig;
-    std::unique_ptr<mysql::MySqlConnection> _mysqlConn;
+    ConnectionPool::Ptr _connPool; ///< Lends _mysqlConn
+    ConnectionPool::ConnPtr _mysqlConn;
+    SharedScanMgr::Ptr _sharedScanMgr; ///< nullptr if queries never share a table pass.
+    /// Counts this Task as expected by _sharedScanMgr until it joins a batch.
+    SharedScanMgr::Ticket::Ptr _sharedScanTicket;
+    /// True while this runner reads rows for other queries, which cancel() must not kill.
+    std::atomic<bool> _sharedScanLeader{false};
+    bool _nearNeighborJoin; ///< Run near-neighbour sub-chunk joins with NearNeighborTable.
 
     util::MultiError _multiError; // Error log
 
     std::shared_ptr<proto::ProtoHeader> _protoHeader;
     std::shared_ptr<proto::Result> _result;
     bool _largeResult{false}; //< True for all transmits after the first transmit.
+    int _protocol{2}; ///< Result protocol requested by the czar, see worker.proto
+    /// Accumulates rows column-major for protocol 3, nullptr for protocol 2.
+    std::unique_ptr<proto::ColumnBatchBuilder> _columnBuilder;
+    std::string _resultString; ///< Serialized result, storage recycled by the SendChannel.
 };
 
 }}} // namespace
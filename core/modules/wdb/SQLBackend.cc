@@ -26,9 +26,13 @@
 #include "wdb/SQLBackend.h"
 
 // System headers
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <map>
 
 // Third-party headers
+#include "mysql/mysqld_error.h"
 
 // LSST headers
 #include "lsst/log/Log.h"
@@ -42,6 +46,35 @@ namespace {
 
 LOG_LOGGER _log = LOG_GET("lsst.qserv.wdb.ChunkResource");
 
+/// The subchunks wanted from one chunk table.
+struct SubChunkBatch {
+    SubChunkBatch(lsst::qserv::wdb::ScTable const& t)
+        : db(t.db), chunkId(t.chunkId), table(t.table) {}
+
+    std::string db;
+    int chunkId;
+    std::string table;
+    std::vector<int> subChunkIds;
+    lsst::qserv::wdb::ScTableVector tables; ///< The entries subChunkIds came from
+};
+
+/// Group the entries of v by chunk table, keeping the order of v.
+std::vector<SubChunkBatch> groupByTable(lsst::qserv::wdb::ScTableVector const& v) {
+    std::vector<SubChunkBatch> batches;
+    for (auto const& scTbl : v) {
+        auto iter = std::find_if(batches.begin(), batches.end(), [&scTbl](SubChunkBatch const& b) {
+            return b.chunkId == scTbl.chunkId && b.table == scTbl.table && b.db == scTbl.db;
+        });
+        if (iter == batches.end()) {
+            batches.emplace_back(scTbl);
+            iter = batches.end() - 1;
+        }
+        iter->subChunkIds.push_back(scTbl.subChunkId);
+        iter->tables.push_back(scTbl);
+    }
+    return batches;
+}
+
 } // anonymous namespace
 
 
@@ -57,22 +90,85 @@ std::ostream& operator<<(std::ostream& os, ScTable const& st) {
 
 
 bool SQLBackend::load(ScTableVector const& v, sql::SqlErrorObject& err) {
-    using namespace lsst::qserv::wbase;
     memLockRequireOwnership();
-    for(ScTableVector::const_iterator i=v.begin(), e=v.end();
-            i != e; ++i) {
-        std::string const* createScript = nullptr;
-        if (i->chunkId == DUMMY_CHUNK) {
-            createScript = &CREATE_DUMMY_SUBCHUNK_SCRIPT;
-        } else {
-            createScript = &CREATE_SUBCHUNK_SCRIPT;
+    for (auto const& batch : groupByTable(v)) {
+        if (_runLoadScripts(batch.tables, true, err)) {
+            continue;
+        }
+        // The staging table holds every wanted subchunk at once and may not
+        // fit under max_heap_table_size, retry one subchunk at a time.
+        if (err.errNo() == ER_RECORD_FILE_FULL && batch.tables.size() > 1) {
+            LOGS(_log, LOG_LVL_WARN, "subchunk staging table full for " << batch.db << "."
+                 << batch.table << "_" << batch.chunkId << ", creating subchunks one at a time");
+            err.reset();
+            if (_runLoadScripts(batch.tables, false, err)) {
+                continue;
+            }
+        }
+        _discard(v.begin(), v.end());
+        return false;
+    }
+    return true;
+}
+
+
+std::vector<std::string> SQLBackend::makeLoadScripts(ScTableVector const& v, bool batched) {
+    using namespace lsst::qserv::wbase;
+    std::vector<std::string> scripts;
+    for (auto const& batch : groupByTable(v)) {
+        if (batch.chunkId == DUMMY_CHUNK || batch.subChunkIds.size() == 1 || !batched) {
+            // Nothing to share, select each subchunk directly.
+            std::string const& createScript =
+                (batch.chunkId == DUMMY_CHUNK) ? CREATE_DUMMY_SUBCHUNK_SCRIPT : CREATE_SUBCHUNK_SCRIPT;
+            for (int subChunkId : batch.subChunkIds) {
+                scripts.push_back((boost::format(createScript)
+                                   % batch.db % batch.table % SUB_CHUNK_COLUMN
+                                   % batch.chunkId % subChunkId).str());
+            }
+            continue;
+        }
+        std::string idList;
+        for (int subChunkId : batch.subChunkIds) {
+            if (!idList.empty()) {
+                idList += ",";
+            }
+            idList += std::to_string(subChunkId);
         }
-        std::string create =
-                (boost::format(*createScript)
-        % i->db % i->table % SUB_CHUNK_COLUMN
-        % i->chunkId % i->subChunkId).str();
+        std::string script;
+        for (auto const& table : {batch.table, batch.table + "FullOverlap"}) {
+            script += (boost::format(CREATE_SUBCHUNK_BATCH_SCRIPT)
+                       % batch.db % table % SUB_CHUNK_COLUMN % batch.chunkId % idList).str();
+            for (int subChunkId : batch.subChunkIds) {
+                script += (boost::format(FILL_SUBCHUNK_FROM_BATCH_SCRIPT)
+                           % batch.db % table % SUB_CHUNK_COLUMN % batch.chunkId % subChunkId).str();
+            }
+            script += (boost::format(DROP_SUBCHUNK_BATCH_SCRIPT)
+                       % batch.db % table % batch.chunkId).str();
+        }
+        scripts.push_back(script);
+    }
+    return scripts;
+}
+
+
+std::string SQLBackend::makeLoadCleanupScript(ScTableVector const& v) {
+    using namespace lsst::qserv::wbase;
+    std::string script;
+    for (auto const& batch : groupByTable(v)) {
+        for (auto const& table : {batch.table, batch.table + "FullOverlap"}) {
+            script += (boost::format(DROP_SUBCHUNK_BATCH_SCRIPT)
+                       % batch.db % table % batch.chunkId).str();
+        }
+    }
+    return script;
+}
+
+
+bool SQLBackend::_runLoadScripts(ScTableVector const& v, bool batched, sql::SqlErrorObject& err) {
+    for (auto const& create : makeLoadScripts(v, batched)) {
         if (!_sqlConn.runQuery(create, err)) {
-            _discard(v.begin(), i);
+            sql::SqlErrorObject cleanupErr;
+            _sqlConn.runQuery(makeLoadCleanupScript(v), cleanupErr);
             return false;
         }
     }
@@ -85,6 +181,52 @@ void SQLBackend::discard(ScTableVector const& v) {
 }
 
 
+std::vector<uint64_t> SQLBackend::getTableBytes(ScTableVector const& v) {
+    std::vector<uint64_t> sizes(v.size(), 0);
+    if (v.empty()) {
+        return sizes;
+    }
+    // Names of the subchunk and overlap tables as "schema.table".
+    auto tableName = [](ScTable const& t, std::string const& suffix) {
+        return SUBCHUNKDB_PREFIX + t.db + "_" + std::to_string(t.chunkId) + "." + t.table + suffix
+               + "_" + std::to_string(t.chunkId) + "_" + std::to_string(t.subChunkId);
+    };
+    std::string nameList;
+    for (auto const& scTbl : v) {
+        for (auto const& suffix : {"", "FullOverlap"}) {
+            nameList += (nameList.empty() ? "'" : ",'") + tableName(scTbl, suffix) + "'";
+        }
+    }
+    std::string sql = "SELECT CONCAT(TABLE_SCHEMA, '.', TABLE_NAME), DATA_LENGTH + INDEX_LENGTH"
+                      " FROM information_schema.TABLES"
+                      " WHERE CONCAT(TABLE_SCHEMA, '.', TABLE_NAME) IN (" + nameList + ")";
+    sql::SqlResults results;
+    sql::SqlErrorObject err;
+    std::vector<std::string> names;
+    std::vector<std::string> bytes;
+    {
+        std::lock_guard<std::mutex> lock(_statsMutex);
+        if (!_statsConn.runQuery(sql, results, err) || !results.extractFirst2Columns(names, bytes, err)) {
+            LOGS(_log, LOG_LVL_WARN, "getTableBytes failed " << err.printErrMsg());
+            return sizes;
+        }
+    }
+    std::map<std::string, uint64_t> byName;
+    for (size_t j = 0; j < names.size(); ++j) {
+        byName[names[j]] = std::strtoull(bytes[j].c_str(), nullptr, 10);
+    }
+    for (size_t j = 0; j < v.size(); ++j) {
+        for (auto const& suffix : {"", "FullOverlap"}) {
+            auto iter = byName.find(tableName(v[j], suffix));
+            if (iter != byName.end()) {
+                sizes[j] += iter->second;
+            }
+        }
+    }
+    return sizes;
+}
+
+
 void SQLBackend::memLockRequireOwnership() {
     if (_memLockStatus() != LOCKED_OURS) {
         _exitDueToConflict("memLockRequireOwnership could not verify this program owned the memory table lock, Exiting.");
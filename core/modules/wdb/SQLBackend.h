@@ -27,10 +27,13 @@
 
 // System headers
 #include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <set>
 #include <string>
 #include <sys/types.h>
 #include <unistd.h>
+#include <vector>
 
 // Qserv headers
 #include "sql/SqlConnection.h"
@@ -76,7 +79,7 @@ public:
     using Ptr=std::shared_ptr<SQLBackend>;
 
     SQLBackend(mysql::MySqlConfig const& mc)
-        : _sqlConn(mc), _uid(getpid()) {
+        : _sqlConn(mc), _statsConn(mc), _uid(getpid()) {
         _memLockAcquire();
     }
 
@@ -88,10 +91,26 @@ public:
 
     virtual void discard(ScTableVector const& v);
 
+    /// @return the memory used by each subchunk table in v, including its
+    /// overlap table, in bytes. Sizes that cannot be determined are 0.
+    /// Runs on a connection of its own, so that callers need not serialize
+    /// it with load() and discard().
+    virtual std::vector<uint64_t> getTableBytes(ScTableVector const& v);
+
     enum LockStatus {UNLOCKED, LOCKED_OTHER, LOCKED_OURS};
 
     virtual void memLockRequireOwnership();
 
+    /// @return the scripts that create the subchunk tables in v, to be run
+    /// in order. If batched, subchunks of the same chunk table are created
+    /// together from a single read of the chunk and overlap tables, otherwise
+    /// each subchunk is selected from the chunk tables on its own.
+    static std::vector<std::string> makeLoadScripts(ScTableVector const& v, bool batched=true);
+
+    /// @return a script dropping any staging tables left by a failed
+    /// makeLoadScripts(v) script.
+    static std::string makeLoadCleanupScript(ScTableVector const& v);
+
 protected:
     SQLBackend() : _uid(getpid()) {};
 
@@ -100,6 +119,9 @@ protected:
 
     virtual void _discard(ScTableVector::const_iterator begin, ScTableVector::const_iterator end);
 
+    /// Run the makeLoadScripts(v, batched) scripts, cleaning up staging tables on failure.
+    bool _runLoadScripts(ScTableVector const& v, bool batched, sql::SqlErrorObject& err);
+
     /// Run the 'query'. If it fails, terminate the program.
     void _execLockSql(std::string const& query);
 
@@ -116,6 +138,8 @@ protected:
     void _exitDueToConflict(const std::string& msg);
 
     sql::SqlConnection _sqlConn;
+    sql::SqlConnection _statsConn; ///< Used by getTableBytes() only
+    std::mutex _statsMutex; ///< Protects _statsConn
 
     // Memory lock table members.
     std::atomic<bool> _lockConflict{false};
@@ -140,6 +164,10 @@ public:
 
     void discard(ScTableVector const& v) override;
 
+    std::vector<uint64_t> getTableBytes(ScTableVector const& v) override {
+        return std::vector<uint64_t>(v.size(), fakeTableBytes);
+    }
+
     void memLockRequireOwnership() override {}; ///< Do nothing for fake version.
 
     /// For unit tests only.
@@ -149,6 +177,7 @@ public:
         return str;
     }
     std::set<std::string> fakeSet; // set of strings for tracking unique tables.
+    uint64_t fakeTableBytes{1000}; ///< Size reported for every table.
 
 private:
     void _discard(ScTableVector::const_iterator begin, ScTableVector::const_iterator end) override;
@@ -0,0 +1,267 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "wdb/SharedScan.h"
+
+// System headers
+#include <set>
+
+// LSST headers
+#include "lsst/log/Log.h"
+
+// Qserv headers
+#include "wdb/SqlWords.h"
+
+namespace {
+
+LOG_LOGGER _log = LOG_GET("lsst.qserv.wdb.SharedScan");
+
+/// Functions that combine rows, their value would depend on the other queries.
+std::set<std::string> const aggregates = {
+    "AVG", "BIT_AND", "BIT_OR", "BIT_XOR", "COUNT", "GROUP_CONCAT", "MAX", "MIN",
+    "STD", "STDDEV", "STDDEV_POP", "STDDEV_SAMP", "SUM", "VARIANCE", "VAR_POP", "VAR_SAMP"
+};
+
+} // anonymous namespace
+
+namespace lsst {
+namespace qserv {
+namespace wdb {
+
+using namespace sqlwords;
+
+bool SharedScanQuery::parse(std::string const& sql, SharedScanQuery& out) {
+    std::string query = trimStatement(sql);
+    std::string unquoted;
+    std::string topLevel;
+    if (!blankOut(query, unquoted, topLevel)) return false;
+
+    // Find SELECT, FROM and WHERE, refuse anything else that changes which
+    // rows are returned.
+    auto topWords = words(topLevel);
+    if (topWords.empty() || topWords[0].text != "SELECT") return false;
+    std::size_t fromPos = std::string::npos;
+    std::size_t wherePos = std::string::npos;
+    for (std::size_t j = 1; j < topWords.size(); ++j) {
+        auto const& word = topWords[j];
+        if (rowChangingWords.count(word.text) != 0 || word.text == "SELECT") return false;
+        if (word.text == "FROM") {
+            if (fromPos != std::string::npos) return false;
+            fromPos = word.pos;
+        } else if (word.text == "WHERE") {
+            if (fromPos == std::string::npos || wherePos != std::string::npos) return false;
+            wherePos = word.pos;
+        }
+    }
+    if (fromPos == std::string::npos) return false;
+
+    auto unquotedWords = words(unquoted);
+    for (auto const& word : unquotedWords) {
+        if (aggregates.count(word.text) != 0) {
+            auto next = unquoted.find_first_not_of(" \t\r\n", word.pos + word.text.size());
+            if (next != std::string::npos && unquoted[next] == '(') return false;
+        }
+    }
+
+    // The table must be a single table, optionally with an alias.
+    std::size_t fromStart = fromPos + 4;
+    std::size_t fromEnd = (wherePos == std::string::npos) ? query.size() : wherePos;
+    std::string fromTop = topLevel.substr(fromStart, fromEnd - fromStart);
+    if (fromTop.find_first_of(",(") != std::string::npos) return false;
+    std::string from = trim(query.substr(fromStart, fromEnd - fromStart));
+    if (from.empty()) return false;
+
+    std::string where;
+    if (wherePos != std::string::npos) {
+        where = trim(query.substr(wherePos + 5));
+        if (where.empty()) return false;
+    }
+
+    // Split the columns on commas outside of parentheses.
+    std::size_t selectStart = topWords[0].pos + 6;
+    int columnCount = 0;
+    std::size_t itemStart = selectStart;
+    for (std::size_t i = selectStart; i <= fromPos; ++i) {
+        if (i == fromPos || topLevel[i] == ',') {
+            std::string item = trim(query.substr(itemStart, i - itemStart));
+            if (item.empty() || item.back() == '*') return false;
+            ++columnCount;
+            itemStart = i + 1;
+        }
+    }
+
+    out.selectList = trim(query.substr(selectStart, fromPos - selectStart));
+    out.columnCount = columnCount;
+    out.from = from;
+    out.where = where;
+    return true;
+}
+
+
+void SharedScanBatch::finish(bool served, std::vector<Member> const& members) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _finished = true;
+    _served = served;
+    if (served) {
+        _members = members;
+    }
+    _cv.notify_all();
+}
+
+
+bool SharedScanBatch::waitFinished() {
+    std::unique_lock<std::mutex> lock(_mtx);
+    _cv.wait(lock, [this](){ return _finished; });
+    return _served;
+}
+
+
+SharedScanBatch::Member SharedScanBatch::getMember(int index) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _members.at(index);
+}
+
+
+void SharedScanMgr::Ticket::release() {
+    if (!_released.exchange(true)) {
+        _mgr->_unexpect(_key);
+    }
+}
+
+
+SharedScanMgr::Ticket::Ptr SharedScanMgr::expect(std::string const& key) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    ++_expected[key];
+    auto batchIter = _openBatches.find(key);
+    if (batchIter != _openBatches.end()) {
+        auto const& batch = batchIter->second;
+        std::lock_guard<std::mutex> batchLock(batch->_mtx);
+        batch->_othersExpected = true;
+    }
+    return std::make_shared<Ticket>(shared_from_this(), key);
+}
+
+
+void SharedScanMgr::_unexpect(std::string const& key) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    auto iter = _expected.find(key);
+    if (iter == _expected.end() || --iter->second > 0) {
+        return;
+    }
+    _expected.erase(iter);
+    // Nothing else will join, let a waiting leader go ahead.
+    auto batchIter = _openBatches.find(key);
+    if (batchIter != _openBatches.end()) {
+        auto const& batch = batchIter->second;
+        std::lock_guard<std::mutex> batchLock(batch->_mtx);
+        batch->_othersExpected = false;
+        batch->_cv.notify_all();
+    }
+}
+
+
+std::pair<SharedScanBatch::Ptr, int> SharedScanMgr::join(std::string const& key,
+                                                         SharedScanBatch::Member const& member) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    auto iter = _openBatches.find(key);
+    if (iter != _openBatches.end()) {
+        auto const& batch = iter->second;
+        std::lock_guard<std::mutex> batchLock(batch->_mtx);
+        if (batch->_members.size() < _maxQueries) {
+            batch->_members.push_back(member);
+            int index = batch->_members.size() - 1;
+            if (batch->_members.size() >= _maxQueries) {
+                batch->_cv.notify_all();
+            }
+            return std::make_pair(batch, index);
+        }
+    }
+    // Start a new batch, replacing a full one that its leader has not closed yet.
+    auto batch = std::make_shared<SharedScanBatch>(key);
+    batch->_members.push_back(member);
+    _openBatches[key] = batch;
+    return std::make_pair(batch, 0);
+}
+
+
+std::vector<SharedScanBatch::Member> SharedScanMgr::gather(SharedScanBatch::Ptr const& batch) {
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        bool expected = _expected.count(batch->getKey()) != 0;
+        std::lock_guard<std::mutex> batchLock(batch->_mtx);
+        batch->_othersExpected = expected;
+    }
+    {
+        std::unique_lock<std::mutex> batchLock(batch->_mtx);
+        batch->_cv.wait_for(batchLock, _window, [this, &batch](){
+            return batch->_members.size() >= _maxQueries || !batch->_othersExpected;
+        });
+    }
+    std::lock_guard<std::mutex> lock(_mtx);
+    auto iter = _openBatches.find(batch->getKey());
+    if (iter != _openBatches.end() && iter->second == batch) {
+        _openBatches.erase(iter);
+    }
+    std::lock_guard<std::mutex> batchLock(batch->_mtx);
+    batch->_open = false;
+    if (batch->_members.size() > 1) {
+        ++_stats.batches;
+        _stats.queries += batch->_members.size();
+        LOGS(_log, LOG_LVL_DEBUG, "shared scan of " << batch->_members.size()
+             << " queries on " << batch->_members[0].query.from);
+    }
+    return batch->_members;
+}
+
+
+std::string SharedScanMgr::makeQuery(std::vector<SharedScanBatch::Member> const& members) {
+    std::string flags;
+    std::string columns;
+    std::string where;
+    bool allRows = false;
+    for (auto const& member : members) {
+        auto const& q = member.query;
+        if (q.where.empty()) {
+            allRows = true;
+            flags += "1, ";
+        } else {
+            flags += "(" + q.where + ") IS TRUE, ";
+            where += (where.empty() ? "(" : " OR (") + q.where + ")";
+        }
+        columns += (columns.empty() ? "" : ", ") + q.selectList;
+    }
+    std::string sql = "SELECT " + flags + columns + " FROM " + members.front().query.from;
+    if (!allRows) {
+        sql += " WHERE " + where;
+    }
+    return sql;
+}
+
+
+SharedScanMgr::Stats SharedScanMgr::getStats() {
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _stats;
+}
+
+}}} // namespace lsst::qserv::wdb
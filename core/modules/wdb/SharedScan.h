@@ -0,0 +1,186 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_QSERV_WDB_SHAREDSCAN_H
+#define LSST_QSERV_WDB_SHAREDSCAN_H
+
+// System headers
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lsst {
+namespace qserv {
+namespace wdb {
+
+class QueryRunner;
+
+/// The parts of a single-table select that can share one pass over its table
+/// with other such selects, see SharedScanMgr.
+struct SharedScanQuery {
+    std::string selectList;  ///< Text between SELECT and FROM.
+    int columnCount{0};      ///< Number of items in selectList.
+    std::string from;        ///< Table expression, with its alias if any.
+    std::string where;       ///< Predicate, empty when there is no WHERE.
+
+    /// Split 'sql' into its parts when it is of the form
+    /// "SELECT <columns> FROM <table> [WHERE <predicate>]" and running it as
+    /// part of a shared pass gives the same rows as running it alone. Queries
+    /// with aggregates, grouping, ordering, limits, joins, subqueries in FROM,
+    /// '*' columns or user variables are refused.
+    /// @return true if 'sql' was split into 'out'.
+    static bool parse(std::string const& sql, SharedScanQuery& out);
+};
+
+/// The queries taking part in one pass over a table. The first member is the
+/// leader, it runs the combined query and hands every other member its rows.
+class SharedScanBatch {
+public:
+    using Ptr = std::shared_ptr<SharedScanBatch>;
+
+    struct Member {
+        Member(std::shared_ptr<QueryRunner> const& runner_, SharedScanQuery const& query_)
+            : runner(runner_), query(query_) {}
+        std::shared_ptr<QueryRunner> runner;
+        SharedScanQuery query;
+        unsigned int rowCount{0}; ///< Rows not yet transmitted, set by the leader.
+        std::size_t tSize{0};     ///< Bytes not yet transmitted, set by the leader.
+        bool erred{false};        ///< Set by the leader if this member's rows failed.
+    };
+
+    explicit SharedScanBatch(std::string const& key) : _key(key) {}
+    SharedScanBatch(SharedScanBatch const&) = delete;
+    SharedScanBatch& operator=(SharedScanBatch const&) = delete;
+
+    std::string const& getKey() const { return _key; }
+
+    /// Called by the leader when it is done. Members that were served read
+    /// their results with getMember(), the others run their own query.
+    /// @param served true if the leader provided the rows of all members.
+    /// @param members the members as returned by SharedScanMgr::gather() with
+    ///                their results filled in, only used when served.
+    void finish(bool served, std::vector<Member> const& members=std::vector<Member>());
+
+    /// Called by members other than the leader.
+    /// @return true if the leader provided this member's rows.
+    bool waitFinished();
+
+    /// @return a copy of member 'index', only valid after finish().
+    Member getMember(int index);
+
+    friend class SharedScanMgr;
+
+private:
+    std::string const _key;
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    std::vector<Member> _members; ///< Protected by _mtx.
+    bool _open{true};             ///< True while other queries may join.
+    bool _othersExpected{true};   ///< True while queued queries may still join.
+    bool _finished{false};
+    bool _served{false};
+};
+
+/// SharedScanMgr lets Tasks running simple selects on the same chunk table at
+/// about the same time read the table once. Each Task joins the batch for its
+/// table. The first one to join waits up to 'window' for others, or until
+/// 'maxQueries' have joined, and then runs one query that evaluates every
+/// member's predicate and columns for each row of the table and hands each row
+/// to the members whose predicate it satisfies. The first one only waits while
+/// Tasks that may join the batch are queued, see expect().
+class SharedScanMgr : public std::enable_shared_from_this<SharedScanMgr> {
+public:
+    using Ptr = std::shared_ptr<SharedScanMgr>;
+
+    /// A queued Task that may join a batch for 'key'. It stops being expected
+    /// once release() is called or the Ticket is destroyed.
+    class Ticket {
+    public:
+        using Ptr = std::shared_ptr<Ticket>;
+
+        Ticket(SharedScanMgr::Ptr const& mgr, std::string const& key) : _mgr(mgr), _key(key) {}
+        Ticket(Ticket const&) = delete;
+        Ticket& operator=(Ticket const&) = delete;
+        ~Ticket() { release(); }
+
+        void release();
+
+    private:
+        SharedScanMgr::Ptr const _mgr;
+        std::string const _key;
+        std::atomic<bool> _released{false};
+    };
+
+    struct Stats {
+        uint64_t batches{0}; ///< Batches gathered with more than one query.
+        uint64_t queries{0}; ///< Queries in those batches.
+    };
+
+    SharedScanMgr(std::chrono::milliseconds window, unsigned int maxQueries)
+        : _window(window), _maxQueries(maxQueries) {}
+    SharedScanMgr(SharedScanMgr const&) = delete;
+    SharedScanMgr& operator=(SharedScanMgr const&) = delete;
+
+    /// Count a queued Task that may join a batch for 'key' until the returned
+    /// Ticket is released, so that leaders know whether waiting may pay off.
+    Ticket::Ptr expect(std::string const& key);
+
+    /// Join the open batch for 'key', or start one.
+    /// @return the batch and the index of the new member, 0 for the leader.
+    std::pair<SharedScanBatch::Ptr, int> join(std::string const& key,
+                                              SharedScanBatch::Member const& member);
+
+    /// Called by the leader. Wait for other members, while any are expected,
+    /// and close the batch.
+    /// @return all members of the batch, the leader first.
+    std::vector<SharedScanBatch::Member> gather(SharedScanBatch::Ptr const& batch);
+
+    /// Build the query evaluating every member of 'members' in one pass.
+    /// Its first members.size() columns are 1 for rows of the corresponding
+    /// member and 0 for other rows, followed by the columns of each member.
+    static std::string makeQuery(std::vector<SharedScanBatch::Member> const& members);
+
+    Stats getStats();
+
+private:
+    void _unexpect(std::string const& key);
+
+    std::chrono::milliseconds const _window;
+    unsigned int const _maxQueries;
+    std::mutex _mtx;
+    std::map<std::string, SharedScanBatch::Ptr> _openBatches; ///< Protected by _mtx.
+    std::map<std::string, unsigned int> _expected; ///< Unreleased Tickets by key, protected by _mtx.
+    Stats _stats; ///< Protected by _mtx.
+};
+
+}}} // namespace lsst::qserv::wdb
+
+#endif // LSST_QSERV_WDB_SHAREDSCAN_H
@@ -0,0 +1,126 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+// Class header
+#include "wdb/SqlWords.h"
+
+// System headers
+#include <cctype>
+
+namespace lsst {
+namespace qserv {
+namespace wdb {
+namespace sqlwords {
+
+std::set<std::string> const rowChangingWords = {
+    "DISTINCT", "DISTINCTROW", "GROUP", "ORDER", "LIMIT", "HAVING", "JOIN",
+    "STRAIGHT_JOIN", "UNION", "INTO", "PROCEDURE", "FOR", "LOCK", "SQL_CALC_FOUND_ROWS"
+};
+
+
+bool isWordChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+}
+
+
+bool isIdentifierStart(char c) {
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+}
+
+
+std::string trim(std::string const& str) {
+    auto first = str.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return std::string();
+    auto last = str.find_last_not_of(" \t\r\n");
+    return str.substr(first, last - first + 1);
+}
+
+
+std::string upper(std::string str) {
+    for (auto& c : str) c = std::toupper(static_cast<unsigned char>(c));
+    return str;
+}
+
+
+std::string trimStatement(std::string const& sql) {
+    std::string statement = trim(sql);
+    if (!statement.empty() && statement.back() == ';') {
+        statement = trim(statement.substr(0, statement.size() - 1));
+    }
+    return statement;
+}
+
+
+std::vector<Word> words(std::string const& str) {
+    std::vector<Word> result;
+    std::size_t i = 0;
+    while (i < str.size()) {
+        if (!isWordChar(str[i])) { ++i; continue; }
+        std::size_t start = i;
+        while (i < str.size() && isWordChar(str[i])) ++i;
+        result.push_back(Word{upper(str.substr(start, i - start)), start});
+    }
+    return result;
+}
+
+
+bool blankOut(std::string const& query, std::string& unquoted, std::string& topLevel) {
+    unquoted = query;
+    topLevel = query;
+    char quote = 0;
+    int depth = 0;
+    for (std::size_t i = 0; i < query.size(); ++i) {
+        char c = query[i];
+        if (quote != 0) {
+            if (c == '\\' && quote != '`' && i + 1 < query.size()) {
+                unquoted[i] = unquoted[i+1] = topLevel[i] = topLevel[i+1] = ' ';
+                ++i;
+            } else if (c == quote) {
+                quote = 0;
+            } else {
+                unquoted[i] = topLevel[i] = ' ';
+            }
+            continue;
+        }
+        switch (c) {
+        case '\'': case '"': case '`':
+            quote = c;
+            break;
+        case '@': case ';':
+            return false;
+        case '(':
+            if (depth++ > 0) topLevel[i] = ' ';
+            continue;
+        case ')':
+            if (--depth < 0) return false;
+            if (depth > 0) topLevel[i] = ' ';
+            continue;
+        default:
+            break;
+        }
+        if (depth > 0) topLevel[i] = ' ';
+    }
+    return quote == 0 && depth == 0;
+}
+
+}}}} // namespace lsst::qserv::wdb::sqlwords
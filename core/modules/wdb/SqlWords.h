@@ -0,0 +1,72 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_QSERV_WDB_SQLWORDS_H
+#define LSST_QSERV_WDB_SQLWORDS_H
+
+// System headers
+#include <cstddef>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace lsst {
+namespace qserv {
+namespace wdb {
+
+/// Helpers to look at the words of the SQL text of a Task, for the parsers
+/// that decide whether a query may run outside of a plain MySQL query, see
+/// SharedScanQuery and NearNeighborQuery.
+namespace sqlwords {
+
+/// A word of the query and where it starts.
+struct Word {
+    std::string text; ///< Upper case.
+    std::size_t pos;
+};
+
+/// Words that change which rows a select returns, or where they go, when
+/// they appear outside of parentheses.
+extern std::set<std::string> const rowChangingWords;
+
+bool isWordChar(char c);
+bool isIdentifierStart(char c);
+std::string trim(std::string const& str);
+std::string upper(std::string str);
+
+/// @return 'sql' without surrounding white space and a trailing ';'.
+std::string trimStatement(std::string const& sql);
+
+/// @return the words of 'str', upper case.
+std::vector<Word> words(std::string const& str);
+
+/// Make 'unquoted', a copy of 'query' with the contents of quoted strings
+/// and identifiers blanked out, and 'topLevel', which also has everything
+/// between parentheses blanked out. Parentheses at the top level are kept.
+/// @return false if quotes or parentheses are unbalanced, or the query has
+///         user variables or several statements.
+bool blankOut(std::string const& query, std::string& unquoted, std::string& topLevel);
+
+}}}} // namespace lsst::qserv::wdb::sqlwords
+
+#endif // LSST_QSERV_WDB_SQLWORDS_H
@@ -27,7 +27,9 @@
   */
 
 // System headers
+#include <chrono>
 #include <memory>
+#include <thread>
 
 // Qserv headers
 #include "wdb/ChunkResource.h"
@@ -41,6 +43,9 @@ namespace test = boost::test_tools;
 using lsst::qserv::wdb::FakeBackend;
 using lsst::qserv::wdb::ChunkResource;
 using lsst::qserv::wdb::ChunkResourceMgr;
+using lsst::qserv::wdb::ScTable;
+using lsst::qserv::wdb::ScTableVector;
+using lsst::qserv::wdb::SQLBackend;
 
 struct Fixture {
 
@@ -140,4 +145,91 @@ BOOST_AUTO_TEST_CASE(TwoChunk) {
     BOOST_CHECK(backend->fakeSet.size() == 0);
 }
 
+BOOST_AUTO_TEST_CASE(Cache) {
+    auto backend = std::make_shared<FakeBackend>();
+    backend->fakeTableBytes = 100;
+    // Room for 3 released tables.
+    std::shared_ptr<ChunkResourceMgr> crm = ChunkResourceMgr::newMgr(backend, 350);
+    std::vector<std::string> oneTable{"hello"};
+    {
+        ChunkResource cr(crm->acquire(thedb, 7, oneTable, {1, 2}));
+        BOOST_CHECK_EQUAL(backend->fakeSet.size(), 2U);
+    }
+    // Released tables stay loaded.
+    BOOST_CHECK_EQUAL(crm->getRefCount(thedb, 7), 0);
+    BOOST_CHECK_EQUAL(backend->fakeSet.size(), 2U);
+    auto stats = crm->getCacheStats();
+    BOOST_CHECK_EQUAL(stats.misses, 2U);
+    BOOST_CHECK_EQUAL(stats.hits, 0U);
+    BOOST_CHECK_EQUAL(stats.tables, 2U);
+    BOOST_CHECK_EQUAL(stats.bytes, 200U);
+    {
+        ChunkResource cr(crm->acquire(thedb, 7, oneTable, {2, 3}));
+        stats = crm->getCacheStats();
+        BOOST_CHECK_EQUAL(stats.hits, 1U);
+        BOOST_CHECK_EQUAL(stats.misses, 3U);
+        BOOST_CHECK_EQUAL(stats.tables, 1U); // subchunk 2 is in use again
+        BOOST_CHECK_EQUAL(backend->fakeSet.size(), 3U);
+    }
+    BOOST_CHECK_EQUAL(crm->getCacheStats().tables, 3U);
+    {
+        // Loading subchunk 4 pushes out subchunk 1, released first.
+        ChunkResource cr(crm->acquire(thedb, 7, oneTable, {4}));
+    }
+    stats = crm->getCacheStats();
+    BOOST_CHECK_EQUAL(stats.evictions, 1U);
+    BOOST_CHECK_EQUAL(stats.tables, 3U);
+    BOOST_CHECK_EQUAL(stats.bytes, 300U);
+    BOOST_CHECK(backend->fakeSet.count(FakeBackend::makeFakeKey(ScTable(thedb, 7, "hello", 1))) == 0);
+    BOOST_CHECK_EQUAL(backend->fakeSet.size(), 3U);
+
+    // Tables older than the maximum age are dropped.
+    auto aged = ChunkResourceMgr::newMgr(backend, 350, std::chrono::seconds(0));
+    backend->fakeSet.clear();
+    {
+        ChunkResource cr(aged->acquire(thedb, 8, oneTable, {1}));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    {
+        ChunkResource cr(aged->acquire(thedb, 8, oneTable, {2}));
+        BOOST_CHECK_EQUAL(backend->fakeSet.size(), 1U);
+    }
+    BOOST_CHECK_EQUAL(aged->getCacheStats().evictions, 2U);
+}
+
+BOOST_AUTO_TEST_CASE(LoadScripts) {
+    ScTableVector v;
+    for (auto sc : subchunks) {
+        v.push_back(ScTable(thedb, 100, "hello", sc));
+    }
+    v.push_back(ScTable(thedb, 100, "goodbye", 11));
+    auto scripts = SQLBackend::makeLoadScripts(v);
+    BOOST_REQUIRE_EQUAL(scripts.size(), 2U);
+
+    // All subchunks of "hello" come from one read of each chunk table.
+    std::string const& batch = scripts[0];
+    BOOST_CHECK(batch.find("FROM Snowden.hello_100 WHERE subChunkId IN (11,12,13,14,15)") != std::string::npos);
+    BOOST_CHECK(batch.find("FROM Snowden.helloFullOverlap_100 WHERE subChunkId IN (11,12,13,14,15)")
+                != std::string::npos);
+    BOOST_CHECK(batch.find("Subchunks_Snowden_100.hello_100_13 ENGINE = MEMORY "
+                           "AS SELECT * FROM Subchunks_Snowden_100.hello_100_batch WHERE subChunkId = 13")
+                != std::string::npos);
+    BOOST_CHECK(batch.find("DROP TEMPORARY TABLE IF EXISTS Subchunks_Snowden_100.helloFullOverlap_100_batch")
+                != std::string::npos);
+    BOOST_CHECK(batch.find("Snowden.hello_100 WHERE subChunkId = ") == std::string::npos);
+
+    // A single subchunk is selected directly.
+    BOOST_CHECK(scripts[1].find("FROM Snowden.goodbye_100 WHERE subChunkId = 11") != std::string::npos);
+    BOOST_CHECK(scripts[1].find("_batch") == std::string::npos);
+
+    // Unbatched, as used when the staging table does not fit in memory.
+    auto unbatched = SQLBackend::makeLoadScripts(v, false);
+    BOOST_REQUIRE_EQUAL(unbatched.size(), v.size());
+    BOOST_CHECK(unbatched[2].find("FROM Snowden.hello_100 WHERE subChunkId = 13") != std::string::npos);
+    BOOST_CHECK(unbatched[2].find("_batch") == std::string::npos);
+
+    std::string cleanup = SQLBackend::makeLoadCleanupScript(v);
+    BOOST_CHECK(cleanup.find("Subchunks_Snowden_100.goodbye_100_batch") != std::string::npos);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+ /**
+  * @file
+  *
+  * @brief Simple testing for class ConnectionPool
+  */
+
+// System headers
+#include <memory>
+#include <string>
+
+// Qserv headers
+#include "wdb/ConnectionPool.h"
+
+// Boost unit test header
+#define BOOST_TEST_MODULE ConnectionPool_1
+#include "boost/test/included/unit_test.hpp"
+
+namespace test = boost::test_tools;
+
+using lsst::qserv::mysql::MySqlConfig;
+using lsst::qserv::mysql::MySqlConnection;
+using lsst::qserv::wdb::ConnectionPool;
+
+namespace {
+
+/// Hands out unconnected connections, with checks and resets that succeed
+/// or fail on demand.
+class FakePool : public ConnectionPool {
+public:
+    FakePool(unsigned int maxIdle) : ConnectionPool(MySqlConfig(), maxIdle) {}
+
+    bool checkOk{true};
+    bool resetOk{true};
+    int resets{0};
+
+protected:
+    ConnPtr _connect(MySqlConfig const& config) override {
+        return ConnPtr(new MySqlConnection(config));
+    }
+    bool _check(MySqlConnection&) override { return checkOk; }
+    bool _reset(MySqlConnection&) override { ++resets; return resetOk; }
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(Suite)
+
+BOOST_AUTO_TEST_CASE(Reuse) {
+    FakePool pool(2);
+    auto a = pool.acquire("alice");
+    BOOST_REQUIRE(a);
+    BOOST_CHECK_EQUAL(a->getConfig().username, "alice");
+    MySqlConnection* aRaw = a.get();
+    pool.release(std::move(a), true);
+    BOOST_CHECK_EQUAL(pool.resets, 1);
+    BOOST_CHECK_EQUAL(pool.getStats().idle, 1U);
+
+    // Connections are only lent to the user they are logged in as.
+    auto b = pool.acquire("bob");
+    BOOST_CHECK(b.get() != aRaw);
+    auto a2 = pool.acquire("alice");
+    BOOST_CHECK(a2.get() == aRaw);
+
+    auto stats = pool.getStats();
+    BOOST_CHECK_EQUAL(stats.created, 2U);
+    BOOST_CHECK_EQUAL(stats.reused, 1U);
+    BOOST_CHECK_EQUAL(stats.inUse, 2U);
+    BOOST_CHECK_EQUAL(stats.idle, 0U);
+
+    // Connections left in an unknown state are closed.
+    pool.release(std::move(b), false);
+    BOOST_CHECK_EQUAL(pool.getStats().idle, 0U);
+    BOOST_CHECK_EQUAL(pool.resets, 1);
+}
+
+BOOST_AUTO_TEST_CASE(Limits) {
+    FakePool pool(1);
+    auto a = pool.acquire("alice");
+    auto b = pool.acquire("alice");
+    pool.release(std::move(a), true);
+    pool.release(std::move(b), true); // Pool is full.
+    auto stats = pool.getStats();
+    BOOST_CHECK_EQUAL(stats.idle, 1U);
+    BOOST_CHECK_EQUAL(stats.inUse, 0U);
+    BOOST_CHECK_EQUAL(pool.resets, 1);
+
+    // Stale idle connections are replaced by new ones.
+    pool.checkOk = false;
+    auto c = pool.acquire("alice");
+    BOOST_CHECK(c);
+    stats = pool.getStats();
+    BOOST_CHECK_EQUAL(stats.discarded, 1U);
+    BOOST_CHECK_EQUAL(stats.created, 3U);
+    BOOST_CHECK_EQUAL(stats.idle, 0U);
+
+    // Connections whose session cannot be reset are closed.
+    pool.resetOk = false;
+    pool.release(std::move(c), true);
+    stats = pool.getStats();
+    BOOST_CHECK_EQUAL(stats.discarded, 2U);
+    BOOST_CHECK_EQUAL(stats.idle, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(Disabled) {
+    FakePool pool(0);
+    auto a = pool.acquire("alice");
+    pool.release(std::move(a), true);
+    BOOST_CHECK_EQUAL(pool.getStats().idle, 0U);
+    BOOST_CHECK_EQUAL(pool.resets, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,210 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+ /**
+  * @file
+  *
+  * @brief Simple testing for the near-neighbour join classes
+  */
+
+// System headers
+#include <cmath>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Qserv headers
+#include "wdb/NearNeighbor.h"
+
+// Boost unit test header
+#define BOOST_TEST_MODULE NearNeighbor_1
+#include "boost/test/included/unit_test.hpp"
+
+namespace test = boost::test_tools;
+
+using lsst::qserv::wdb::NearNeighborQuery;
+using lsst::qserv::wdb::NearNeighborTable;
+
+namespace {
+
+bool parses(std::string const& sql) {
+    NearNeighborQuery q;
+    return NearNeighborQuery::parse(sql, q);
+}
+
+typedef std::set<std::pair<std::size_t, std::size_t>> PairSet;
+
+PairSet joinPairs(NearNeighborTable const& a, NearNeighborTable const& b,
+                  double radius, bool inclusive) {
+    PairSet pairs;
+    NearNeighborTable::join(a, b, radius, inclusive,
+                            [&pairs](std::size_t i, std::size_t j, double) {
+                                pairs.insert(std::make_pair(i, j));
+                                return true;
+                            });
+    return pairs;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(Suite)
+
+BOOST_AUTO_TEST_CASE(Parse) {
+    NearNeighborQuery q;
+    BOOST_REQUIRE(NearNeighborQuery::parse(
+        "SELECT o1.objectId,o2.objectId AS objectId2,"
+        "scisql_angSep(o1.ra_Test,o1.decl_Test,o2.ra_Test,o2.decl_Test) AS `distance` "
+        "FROM Subchunks_LSST_100.Object_100_100000 AS o1,"
+        "Subchunks_LSST_100.ObjectFullOverlap_100_100000 AS o2 "
+        "WHERE scisql_s2PtInBox(o1.ra_Test,o1.decl_Test,5.5,5.5,6.1,6.1)=1 "
+        "AND scisql_angSep(o1.ra_Test,o1.decl_Test,o2.ra_Test,o2.decl_Test)<0.02 "
+        "AND o1.objectId<>o2.objectId AND (o2.name = 'x AND y' OR o2.name IS NULL)", q));
+    BOOST_CHECK_EQUAL(q.sides[0].table, "Subchunks_LSST_100.Object_100_100000");
+    BOOST_CHECK_EQUAL(q.sides[1].table, "Subchunks_LSST_100.ObjectFullOverlap_100_100000");
+    BOOST_CHECK_EQUAL(q.radius, 0.02);
+    BOOST_CHECK(!q.inclusive);
+    BOOST_REQUIRE_EQUAL(q.items.size(), 3U);
+    BOOST_CHECK(q.items[0].kind == NearNeighborQuery::Item::COLUMN);
+    BOOST_CHECK_EQUAL(q.items[0].side, 0);
+    BOOST_CHECK_EQUAL(q.items[0].column, 2);
+    BOOST_CHECK_EQUAL(q.items[1].side, 1);
+    BOOST_CHECK_EQUAL(q.items[1].column, 2);
+    BOOST_CHECK(q.items[2].kind == NearNeighborQuery::Item::DISTANCE);
+    BOOST_REQUIRE_EQUAL(q.matches.size(), 1U);
+    BOOST_CHECK(!q.matches[0].equal);
+    BOOST_CHECK_EQUAL(q.makeSideQuery(0),
+        "SELECT o1.ra_Test,o1.decl_Test,o1.objectId "
+        "FROM Subchunks_LSST_100.Object_100_100000 AS o1 "
+        "WHERE (scisql_s2PtInBox(o1.ra_Test,o1.decl_Test,5.5,5.5,6.1,6.1)=1)");
+    BOOST_CHECK_EQUAL(q.makeSideQuery(1),
+        "SELECT o2.ra_Test,o2.decl_Test,o2.objectId "
+        "FROM Subchunks_LSST_100.ObjectFullOverlap_100_100000 AS o2 "
+        "WHERE ((o2.name = 'x AND y' OR o2.name IS NULL))");
+
+    // The mirror image of the join condition, and COUNT(*).
+    BOOST_REQUIRE(NearNeighborQuery::parse(
+        "SELECT count(*) AS QS1_COUNT FROM Object_1_2 AS o1,Object_1_2 AS o2 "
+        "WHERE 0.024 >= scisql_angSep(o2.ra, o2.decl, o1.ra, o1.decl)", q));
+    BOOST_CHECK(q.inclusive);
+    BOOST_CHECK_EQUAL(q.radius, 0.024);
+    BOOST_CHECK(q.items[0].kind == NearNeighborQuery::Item::COUNT);
+    BOOST_CHECK_EQUAL(q.makeSideQuery(0), "SELECT o1.ra,o1.decl FROM Object_1_2 AS o1");
+
+    // Anything else is left to MySQL.
+    BOOST_CHECK(!parses("SELECT o1.a FROM T AS o1,T AS o2 WHERE o1.a=o2.a"));
+    BOOST_CHECK(!parses("SELECT o1.a FROM T AS o1,T AS o2 "
+                        "WHERE scisql_angSep(o1.ra,o1.decl,o2.ra,o2.decl)<0.1 OR o1.a=1"));
+    BOOST_CHECK(!parses("SELECT o1.a FROM T AS o1,T AS o2 "
+                        "WHERE scisql_angSep(o1.ra,o1.decl,o2.ra,o2.decl)>0.1"));
+    BOOST_CHECK(!parses("SELECT o1.a FROM T AS o1,T AS o2 "
+                        "WHERE scisql_angSep(o1.ra,o1.decl,o1.ra,o1.decl)<0.1"));
+    BOOST_CHECK(!parses("SELECT o1.a FROM T AS o1,T AS o2 "
+                        "WHERE scisql_angSep(o1.ra,o1.decl,o2.ra,o2.decl)<0.1 AND rFlux<0.005"));
+    BOOST_CHECK(!parses("SELECT o1.a FROM T AS o1,T AS o2 "
+                        "WHERE scisql_angSep(o1.ra,o1.decl,o2.ra,o2.decl)<0.1 AND o1.a<o2.a"));
+    BOOST_CHECK(!parses("SELECT o1.a FROM T AS o1,T AS o2 "
+                        "WHERE scisql_angSep(o1.ra,o1.decl,o2.ra,o2.decl)<0.1 AND o1.a=o2.b"));
+    BOOST_CHECK(!parses("SELECT o1.a+1 FROM T AS o1,T AS o2 "
+                        "WHERE scisql_angSep(o1.ra,o1.decl,o2.ra,o2.decl)<0.1"));
+    BOOST_CHECK(!parses("SELECT o1.a,COUNT(*) FROM T AS o1,T AS o2 "
+                        "WHERE scisql_angSep(o1.ra,o1.decl,o2.ra,o2.decl)<0.1"));
+    BOOST_CHECK(!parses("SELECT o1.a FROM T AS o1,T AS o2 "
+                        "WHERE scisql_angSep(o1.ra,o1.decl,o2.ra,o2.decl)<0.1 ORDER BY o1.a"));
+    BOOST_CHECK(!parses("SELECT o1.a FROM T AS o1,T AS o2,U AS u "
+                        "WHERE scisql_angSep(o1.ra,o1.decl,o2.ra,o2.decl)<0.1"));
+    BOOST_CHECK(!parses("SELECT o1.a FROM T AS o1,T AS o2 "
+                        "WHERE scisql_angSep(o1.ra,o1.decl,o2.ra,o2.decl)<0.1 "
+                        "AND o1.a IN (SELECT a FROM U)"));
+}
+
+BOOST_AUTO_TEST_CASE(AngSep) {
+    BOOST_CHECK_CLOSE(NearNeighborTable::angSep(0, 0, 90, 0), 90.0, 1e-12);
+    BOOST_CHECK_CLOSE(NearNeighborTable::angSep(10, 89, 190, 89), 2.0, 1e-9);
+    BOOST_CHECK_EQUAL(NearNeighborTable::angSep(5, 5, 5, 5), 0.0);
+    BOOST_CHECK(std::isnan(NearNeighborTable::angSep(0, 91, 0, 0)));
+}
+
+BOOST_AUTO_TEST_CASE(Join) {
+    // Compare with all pairs, points are in a small area so that many pairs
+    // are close to the radius.
+    std::mt19937 gen(12345);
+    std::uniform_real_distribution<double> ra(359.9, 360.1);
+    std::uniform_real_distribution<double> decl(-0.1, 0.1);
+    int const n = 600;
+    NearNeighborTable a(1);
+    NearNeighborTable b(0);
+    std::vector<std::pair<double, double>> posA, posB;
+    for (int i = 0; i < n; ++i) {
+        posA.emplace_back(std::fmod(ra(gen), 360.0), decl(gen));
+        posB.emplace_back(std::fmod(ra(gen), 360.0), decl(gen));
+        std::string value = std::to_string(i);
+        char const* values[] = {value.c_str()};
+        unsigned long lengths[] = {value.size()};
+        a.addRow(posA.back().first, posA.back().second, values, lengths);
+        b.addRow(posB.back().first, posB.back().second, nullptr, nullptr);
+    }
+    // Rows with NULL or invalid positions are skipped.
+    char const* values[] = {nullptr};
+    unsigned long lengths[] = {0};
+    a.addRow(nullptr, "1", values, lengths);
+    a.addRow(0.0, 95.0, values, lengths);
+    BOOST_CHECK_EQUAL(a.getRowCount(), static_cast<std::size_t>(n));
+    a.finish();
+    b.finish();
+    BOOST_CHECK_EQUAL(std::string(a.getValue(17, 0)), "17");
+    BOOST_CHECK_EQUAL(a.getLength(17, 0), 2U);
+
+    double const radius = 0.01;
+    PairSet expected;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            double sep = NearNeighborTable::angSep(posA[i].first, posA[i].second,
+                                                   posB[j].first, posB[j].second);
+            if (sep < radius) expected.insert(std::make_pair(i, j));
+        }
+    }
+    BOOST_CHECK(expected.size() > 0);
+    PairSet pairs = joinPairs(a, b, radius, false);
+    BOOST_CHECK(pairs == expected);
+
+    // A pair exactly at the radius is only found by <=.
+    double const sep = NearNeighborTable::angSep(posA[0].first, posA[0].second,
+                                                 posB[0].first, posB[0].second);
+    BOOST_CHECK(joinPairs(a, b, sep, false).count(std::make_pair(0, 0)) == 0);
+    BOOST_CHECK(joinPairs(a, b, sep, true).count(std::make_pair(0, 0)) == 1);
+
+    // Everything, and nothing.
+    BOOST_CHECK_EQUAL(joinPairs(a, b, 200.0, false).size(), static_cast<std::size_t>(n * n));
+    BOOST_CHECK(joinPairs(a, b, -1.0, true).empty());
+
+    // The join stops when asked to.
+    int calls = 0;
+    BOOST_CHECK(!NearNeighborTable::join(a, b, radius, false,
+                                         [&calls](std::size_t, std::size_t, double) {
+                                             return ++calls < 3;
+                                         }));
+    BOOST_CHECK_EQUAL(calls, 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -37,6 +37,7 @@
 #include "wbase/SendChannel.h"
 #include "wbase/Task.h"
 #include "wdb/ChunkResource.h"
+#include "wdb/ConnectionPool.h"
 #include "wdb/QueryRunner.h"
 
 // Boost unit test header
@@ -61,6 +62,7 @@ using lsst::qserv::wbase::SendChannel;
 using lsst::qserv::wbase::Task;
 using lsst::qserv::wdb::ChunkResource;
 using lsst::qserv::wdb::ChunkResourceMgr;
+using lsst::qserv::wdb::ConnectionPool;
 using lsst::qserv::wdb::FakeBackend;
 using lsst::qserv::wdb::QueryRunner;
 
@@ -106,7 +108,8 @@ BOOST_AUTO_TEST_CASE(Simple) {
     std::shared_ptr<Task> task = std::make_shared<Task>(msg, sc);
     FakeBackend::Ptr backend = std::make_shared<FakeBackend>();
     std::shared_ptr<ChunkResourceMgr> crm = ChunkResourceMgr::newMgr(backend);
-    QueryRunner::Ptr a{QueryRunner::newQueryRunner(task, crm, newMySqlConfig())};
+    auto connPool = std::make_shared<ConnectionPool>(newMySqlConfig(), 1);
+    QueryRunner::Ptr a{QueryRunner::newQueryRunner(task, crm, connPool)};
     BOOST_CHECK(a->runQuery());
 }
 
@@ -117,7 +120,8 @@ BOOST_AUTO_TEST_CASE(Output) {
     std::shared_ptr<Task> task = std::make_shared<Task>(msg, sc);
     FakeBackend::Ptr backend = std::make_shared<FakeBackend>();
     std::shared_ptr<ChunkResourceMgr> crm = ChunkResourceMgr::newMgr(backend);
-    QueryRunner::Ptr a{QueryRunner::newQueryRunner(task, crm, newMySqlConfig())};
+    auto connPool = std::make_shared<ConnectionPool>(newMySqlConfig(), 1);
+    QueryRunner::Ptr a{QueryRunner::newQueryRunner(task, crm, connPool)};
     BOOST_CHECK(a->runQuery());
 
     unsigned char phSize = *reinterpret_cast<unsigned char const*>(out.data());
@@ -0,0 +1,178 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+ /**
+  * @file
+  *
+  * @brief Simple testing for the shared scan classes
+  */
+
+// System headers
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Qserv headers
+#include "wdb/SharedScan.h"
+
+// Boost unit test header
+#define BOOST_TEST_MODULE SharedScan_1
+#include "boost/test/included/unit_test.hpp"
+
+namespace test = boost::test_tools;
+
+using lsst::qserv::wdb::SharedScanBatch;
+using lsst::qserv::wdb::SharedScanMgr;
+using lsst::qserv::wdb::SharedScanQuery;
+
+namespace {
+
+bool parses(std::string const& sql) {
+    SharedScanQuery q;
+    return SharedScanQuery::parse(sql, q);
+}
+
+SharedScanBatch::Member makeMember(std::string const& sql) {
+    SharedScanQuery q;
+    BOOST_REQUIRE(SharedScanQuery::parse(sql, q));
+    return SharedScanBatch::Member(nullptr, q);
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(Suite)
+
+BOOST_AUTO_TEST_CASE(Parse) {
+    SharedScanQuery q;
+    BOOST_REQUIRE(SharedScanQuery::parse(
+        "SELECT o.objectId, scisql_fluxToAbMag(o.gFlux_PS) AS g FROM LSST.Object_100 AS o "
+        "WHERE o.ra_PS BETWEEN 1 AND 2 AND o.name='x,y FROM z GROUP BY'", q));
+    BOOST_CHECK_EQUAL(q.selectList, "o.objectId, scisql_fluxToAbMag(o.gFlux_PS) AS g");
+    BOOST_CHECK_EQUAL(q.columnCount, 2);
+    BOOST_CHECK_EQUAL(q.from, "LSST.Object_100 AS o");
+    BOOST_CHECK_EQUAL(q.where, "o.ra_PS BETWEEN 1 AND 2 AND o.name='x,y FROM z GROUP BY'");
+
+    BOOST_REQUIRE(SharedScanQuery::parse("select a,b,c from T;", q));
+    BOOST_CHECK_EQUAL(q.columnCount, 3);
+    BOOST_CHECK_EQUAL(q.from, "T");
+    BOOST_CHECK_EQUAL(q.where, "");
+
+    BOOST_CHECK(parses("SELECT a FROM T WHERE b IN (SELECT b FROM U)"));
+    BOOST_CHECK(parses("SELECT `order` FROM T"));
+
+    // Anything that depends on rows of other queries, or is not a plain scan.
+    BOOST_CHECK(!parses("SELECT COUNT(*) FROM T"));
+    BOOST_CHECK(!parses("SELECT a, sum (b) FROM T"));
+    BOOST_CHECK(!parses("SELECT * FROM T"));
+    BOOST_CHECK(!parses("SELECT o.* FROM T o"));
+    BOOST_CHECK(!parses("SELECT DISTINCT a FROM T"));
+    BOOST_CHECK(!parses("SELECT a FROM T GROUP BY a"));
+    BOOST_CHECK(!parses("SELECT a FROM T ORDER BY a"));
+    BOOST_CHECK(!parses("SELECT a FROM T LIMIT 5"));
+    BOOST_CHECK(!parses("SELECT a FROM T, U"));
+    BOOST_CHECK(!parses("SELECT a FROM T JOIN U ON T.a=U.a"));
+    BOOST_CHECK(!parses("SELECT a FROM (SELECT a FROM T) t"));
+    BOOST_CHECK(!parses("SELECT @x := a FROM T"));
+    BOOST_CHECK(!parses("SELECT a FROM T; DROP TABLE T"));
+    BOOST_CHECK(!parses("SELECT a FROM T WHERE"));
+    BOOST_CHECK(!parses("SELECT a FROM T WHERE (b = 1"));
+    BOOST_CHECK(!parses("SELECT a FROM T WHERE b = 'x"));
+    BOOST_CHECK(!parses("INSERT INTO T VALUES (1)"));
+}
+
+BOOST_AUTO_TEST_CASE(MakeQuery) {
+    std::vector<SharedScanBatch::Member> members;
+    members.push_back(makeMember("SELECT a FROM T AS t WHERE a > 1"));
+    members.push_back(makeMember("SELECT b, c FROM T AS t WHERE b < 2 OR c = 3"));
+    BOOST_CHECK_EQUAL(SharedScanMgr::makeQuery(members),
+                      "SELECT (a > 1) IS TRUE, (b < 2 OR c = 3) IS TRUE, a, b, c FROM T AS t "
+                      "WHERE (a > 1) OR (b < 2 OR c = 3)");
+
+    // A member without a predicate needs every row.
+    members.push_back(makeMember("SELECT d FROM T AS t"));
+    BOOST_CHECK_EQUAL(SharedScanMgr::makeQuery(members),
+                      "SELECT (a > 1) IS TRUE, (b < 2 OR c = 3) IS TRUE, 1, a, b, c, d FROM T AS t");
+}
+
+BOOST_AUTO_TEST_CASE(JoinAndGather) {
+    auto mgrPtr = std::make_shared<SharedScanMgr>(std::chrono::milliseconds(1000), 3);
+    SharedScanMgr& mgr = *mgrPtr;
+    auto leader = mgr.join("k", makeMember("SELECT a FROM T"));
+    BOOST_CHECK_EQUAL(leader.second, 0);
+    auto other = mgr.join("other", makeMember("SELECT a FROM U"));
+    BOOST_CHECK(other.first != leader.first);
+
+    // The batch is gathered as soon as it is full, well before the window ends.
+    auto secondTicket = mgr.expect("k");
+    auto thirdTicket = mgr.expect("k");
+    auto secondMember = makeMember("SELECT b FROM T");
+    auto thirdMember = makeMember("SELECT c FROM T");
+    std::pair<SharedScanBatch::Ptr, int> second, third;
+    std::thread joiner([&]() {
+        second = mgr.join("k", secondMember);
+        secondTicket->release();
+        third = mgr.join("k", thirdMember);
+        thirdTicket->release();
+    });
+    auto start = std::chrono::steady_clock::now();
+    auto members = mgr.gather(leader.first);
+    joiner.join();
+    BOOST_CHECK(second.first == leader.first);
+    BOOST_CHECK_EQUAL(third.second, 2);
+    BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(900));
+    BOOST_REQUIRE_EQUAL(members.size(), 3U);
+    BOOST_CHECK_EQUAL(members[2].query.selectList, "c");
+    BOOST_CHECK_EQUAL(mgr.getStats().batches, 1U);
+    BOOST_CHECK_EQUAL(mgr.getStats().queries, 3U);
+
+    // A closed batch takes no new members.
+    auto late = mgr.join("k", makeMember("SELECT d FROM T"));
+    BOOST_CHECK(late.first != leader.first);
+    BOOST_CHECK_EQUAL(late.second, 0);
+
+    // Members get the results the leader recorded for them.
+    members[1].rowCount = 7;
+    members[2].erred = true;
+    bool served = false;
+    std::thread waiter([&leader, &served]() { served = leader.first->waitFinished(); });
+    leader.first->finish(true, members);
+    waiter.join();
+    BOOST_CHECK(served);
+    BOOST_CHECK_EQUAL(leader.first->getMember(1).rowCount, 7U);
+    BOOST_CHECK(leader.first->getMember(2).erred);
+
+    // With no other Task expected, the leader does not wait out the window.
+    start = std::chrono::steady_clock::now();
+    auto lone = mgr.gather(late.first);
+    BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(900));
+    BOOST_CHECK_EQUAL(lone.size(), 1U);
+
+    // A batch that was not served leaves its members to run alone.
+    late.first->finish(false);
+    BOOST_CHECK(!late.first->waitFinished());
+    BOOST_CHECK_EQUAL(mgr.getStats().batches, 1U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -94,6 +94,9 @@ bool ChunkTasksQueue::_ready(bool useFlexibleLock) {
         _activeChunk->second->setActive(); // Flag tasks on active so new Tasks added wont be run.
     }
 
+    // Read the next chunks while the active chunk is being scanned.
+    _prefetchAhead();
+
     // Check the active chunk for valid Tasks
     if (_activeChunk->second->ready(useFlexibleLock) == ChunkTasks::ReadyState::READY) {
         _readyChunk = _activeChunk->second;
@@ -125,6 +128,7 @@ bool ChunkTasksQueue::_ready(bool useFlexibleLock) {
         }
         newActive->second->movePendingToActive();
         newActive->second->setActive();
+        _prefetchAhead();
     }
 
     // Advance through chunks until READY or NO_RESOURCES found, or until entire list scanned.
@@ -159,6 +163,25 @@ bool ChunkTasksQueue::_ready(bool useFlexibleLock) {
 }
 
 
+/// Precondition: _mapMx must be locked and _activeChunk valid.
+/// Start reading the tables for the chunks following _activeChunk, so their
+/// Tasks do not wait on the disk when the active chunk advances to them.
+/// Each chunk is only prefetched once, MemMan drops requests that would not fit.
+void ChunkTasksQueue::_prefetchAhead() {
+    auto iter = _activeChunk;
+    for (int j = 0; j < _prefetchChunks; ++j) {
+        ++iter;
+        if (iter == _chunkMap.end()) {
+            iter = _chunkMap.begin();
+        }
+        if (iter == _activeChunk) {
+            return;
+        }
+        iter->second->prefetch();
+    }
+}
+
+
 wbase::Task::Ptr ChunkTasksQueue::getTask(bool useFlexibleLock) {
     std::lock_guard<std::mutex> lock(_mapMx);
     // Attempt to set _readyChunk.
@@ -256,11 +279,14 @@ wbase::Task::Ptr ChunkTasks::removeTask(wbase::Task::Ptr const& task) {
     result = eraseFunc(_activeTasks._tasks);
     if (result != nullptr) {
         _activeTasks.heapify();
-        return result;
+    } else {
+        // Is it in _pendingTasks?
+        result = eraseFunc(_pendingTasks);
     }
-
-    // Is it in _pendingTasks?
-    return eraseFunc(_pendingTasks);
+    if (result != nullptr && empty()) {
+        _prefetched = false; // Tasks queued later need their tables read again.
+    }
+    return result;
 }
 
 
@@ -318,6 +344,9 @@ void ChunkTasks::setActive(bool active) {
     if (_active != active) {
         LOGS(_log, LOG_LVL_DEBUG, "ChunkTasks " << _chunkId << " active changed to " << active);
         if (_active && !active) {
+            // The scan of the active Tasks is over, pending Tasks will want
+            // the tables read again when this chunk comes up next.
+            _prefetched = false;
             movePendingToActive();
         }
     }
@@ -325,6 +354,32 @@ void ChunkTasks::setActive(bool active) {
 }
 
 
+/// Ask _memMan to read the tables used by the queued Tasks, once until the
+/// queued Tasks drain.
+/// This relies on ChunkTasks owner for thread safety.
+void ChunkTasks::prefetch() {
+    if (_prefetched) return;
+    _prefetched = true;
+    std::set<std::string> tables;
+    auto addTables = [&tables](wbase::Task::Ptr const& task) {
+        for (auto const& tbl : task->getScanInfo().infoTables) {
+            tables.insert(tbl.db + "/" + tbl.table);
+        }
+    };
+    for (auto const& t : _activeTasks._tasks) addTables(t);
+    for (auto const& t : _pendingTasks) addTables(t);
+    if (tables.empty()) return;
+
+    std::vector<memman::TableInfo> tblVect;
+    for (auto const& tbl : tables) {
+        tblVect.emplace_back(tbl, memman::TableInfo::LockType::FLEXIBLE,
+                             memman::TableInfo::LockType::NOLOCK);
+    }
+    LOGS(_log, LOG_LVL_DEBUG, "ChunkTasks " << _chunkId << " prefetch tables=" << tables.size());
+    _memMan->prefetch(tblVect, _chunkId);
+}
+
+
 /// Move all pending Tasks to the active heap.
 void ChunkTasks::movePendingToActive() {
     for (auto const& t:_pendingTasks) {
@@ -420,6 +475,9 @@ ChunkTasks::ReadyState ChunkTasks::ready(bool useFlexibleLock) {
     // There is a Task to run at this point, pull it off the heap to avoid confusion.
     _activeTasks.pop();
     _readyTask = task;
+    if (empty()) {
+        _prefetched = false; // Tasks queued later need their tables read again.
+    }
     return ChunkTasks::ReadyState::READY;
 }
 
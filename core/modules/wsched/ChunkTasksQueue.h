@@ -28,6 +28,7 @@
 #include <list>
 #include <map>
 #include <mutex>
+#include <set>
 
 // Qserv headers
 #include "memman/MemMan.h"
@@ -62,6 +63,7 @@ public:
     ReadyState ready(bool useFlexibleLock);
     void taskComplete(wbase::Task::Ptr const& task);
 
+    void prefetch(); ///< Have _memMan start reading the tables of queued Tasks.
     void movePendingToActive(); ///< Move all pending Tasks to _activeTasks.
     bool readyToAdvance(); ///< @return true if active Tasks for this chunk are done.
     void setActive(bool active=true); ///< Flag current requests so new requests will be pending.
@@ -100,6 +102,7 @@ private:
     int _chunkId;                    ///< Chunk Id for all Tasks in this instance.
     bool _active{false};            ///< True when this is the active chunk.
     bool _resourceStarved{false};   ///< True when advancement is prevented by lack of memory.
+    bool _prefetched{false};        ///< True when prefetch() was called since the Tasks last drained.
     wbase::Task::Ptr              _readyTask{nullptr}; ///< Task that is ready to run with memory reserved.
     SlowTableHeap                 _activeTasks;        ///< All Tasks must be put on this before they can run.
     std::vector<wbase::Task::Ptr> _pendingTasks;       ///< Task that should not be run until later.
@@ -132,8 +135,11 @@ public:
 
     enum {READY, NOT_READY, NO_RESOURCES};
 
-    ChunkTasksQueue(SchedulerBase *scheduler, memman::MemMan::Ptr const& memMan) :
-        _memMan{memMan}, _scheduler{scheduler} {}
+    /// @param prefetchChunks number of chunks after the active chunk whose tables are
+    ///                       read ahead while the active chunk is scanned.
+    ChunkTasksQueue(SchedulerBase *scheduler, memman::MemMan::Ptr const& memMan,
+                    int prefetchChunks=1) :
+        _memMan{memMan}, _scheduler{scheduler}, _prefetchChunks{prefetchChunks} {}
     ChunkTasksQueue(ChunkTasksQueue const&) = delete;
     ChunkTasksQueue& operator=(ChunkTasksQueue const&) = delete;
 
@@ -153,6 +159,7 @@ public:
 private:
     bool _ready(bool useFlexibleLock);
     bool _empty() const { return _chunkMap.empty(); }
+    void _prefetchAhead();
 
     mutable std::mutex _mapMx; ///< Protects _chunkMap, _activeChunk, and _readyChunk.
     ChunkMap _chunkMap; ///< map by chunk Id.
@@ -163,6 +170,7 @@ private:
     std::atomic<int> _taskCount{0}; ///< Count of all tasks currently in _chunkMap.
     bool _resourceStarved{false};
     SchedulerBase* _scheduler; ///< Pointer to scheduler that owns this. This can be nullptr.
+    int _prefetchChunks; ///< Number of chunks after _activeChunk to prefetch.
 };
 
 }}} // namespace lsst::qserv::wsched
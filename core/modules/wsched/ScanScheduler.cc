@@ -261,7 +261,11 @@ void ScanScheduler::logMemManStats() {
          << " FlxF=" << s.numFlexFiles
          << " FlxLck=" << s.numFlexLock
          << " lckCalls=" << s.numLocks
-         << " errs=" << s.numErrors);
+         << " errs=" << s.numErrors
+         << " bFromCache=" << s.bytesFromCache
+         << " bFromDisk=" << s.bytesFromDisk
+         << " bPrefetched=" << s.bytesPrefetched
+         << " prefetches=" << s.numPrefetches);
 }
 
 }}} // namespace lsst::qserv::wsched
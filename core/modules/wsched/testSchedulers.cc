@@ -65,6 +65,18 @@ double const oneHr = 60.0;
 Task::Ptr makeTask(std::shared_ptr<TaskMsg> tm) {
     return std::make_shared<Task>(tm, std::shared_ptr<SendChannel>());
 }
+
+/// Records the chunks a ChunkTasksQueue asks to have read ahead.
+struct MemManPrefetch : public lsst::qserv::memman::MemManNone {
+    MemManPrefetch() : MemManNone(1, true) {}
+    void prefetch(std::vector<lsst::qserv::memman::TableInfo> const& tables, int chunk) override {
+        chunks.push_back(chunk);
+        tableCount += tables.size();
+    }
+    std::vector<int> chunks;
+    std::size_t tableCount{0};
+};
+
 struct SchedulerFixture {
     typedef std::shared_ptr<TaskMsg> TaskMsgPtr;
 
@@ -1099,4 +1111,59 @@ BOOST_AUTO_TEST_CASE(ChunkTasksQueueTest) {
     BOOST_CHECK(ctl.getActiveChunkId() == -1);
 }
 
+BOOST_AUTO_TEST_CASE(ChunkTasksQueuePrefetchTest) {
+    auto memMan = std::make_shared<MemManPrefetch>();
+    wsched::ChunkTasksQueue ctl{nullptr, memMan, 1};
+    lsst::qserv::QueryId qIdInc = 1;
+
+    Task::Ptr a1 = makeTask(newTaskMsgScan(100, 3, qIdInc++, 0, "charlie"));
+    Task::Ptr b1 = makeTask(newTaskMsgScan(150, 3, qIdInc++, 0, "charlie"));
+    Task::Ptr b2 = makeTask(newTaskMsgScan(150, 3, qIdInc++, 0, "delta"));
+    Task::Ptr c1 = makeTask(newTaskMsgScan(200, 3, qIdInc++, 0, "charlie"));
+    ctl.queueTask(a1);
+    ctl.queueTask(b1);
+    ctl.queueTask(b2);
+    ctl.queueTask(c1);
+
+    // While chunk 100 is active, only the chunk after it is read ahead, once.
+    BOOST_CHECK(ctl.getTask(true).get() == a1.get());
+    BOOST_CHECK(ctl.ready(true) == true);
+    BOOST_REQUIRE_EQUAL(memMan->chunks.size(), 1U);
+    BOOST_CHECK_EQUAL(memMan->chunks[0], 150);
+    BOOST_CHECK_EQUAL(memMan->tableCount, 2U);
+
+    // Once chunk 150 becomes active, chunk 200 is next.
+    ctl.taskComplete(a1);
+    auto t = ctl.getTask(true);
+    BOOST_CHECK(t.get() == b1.get() || t.get() == b2.get());
+    BOOST_CHECK(ctl.ready(true) == true);
+    BOOST_CHECK_EQUAL(ctl.getActiveChunkId(), 150);
+    BOOST_REQUIRE_EQUAL(memMan->chunks.size(), 2U);
+    BOOST_CHECK_EQUAL(memMan->chunks[1], 200);
+}
+
+BOOST_AUTO_TEST_CASE(ChunkTasksQueuePrefetchRequeueTest) {
+    // A chunk whose Tasks drained is read ahead again when new Tasks arrive.
+    auto memMan = std::make_shared<MemManPrefetch>();
+    wsched::ChunkTasksQueue ctl{nullptr, memMan, 1};
+    lsst::qserv::QueryId qIdInc = 1;
+
+    Task::Ptr a1 = makeTask(newTaskMsgScan(100, 3, qIdInc++, 0, "charlie"));
+    Task::Ptr b1 = makeTask(newTaskMsgScan(150, 3, qIdInc++, 0, "charlie"));
+    ctl.queueTask(a1);
+    ctl.queueTask(b1);
+    BOOST_CHECK(ctl.getTask(true).get() == a1.get());
+    BOOST_REQUIRE_EQUAL(memMan->chunks.size(), 1U);
+    BOOST_CHECK_EQUAL(memMan->chunks[0], 150);
+
+    // Chunk 150 drains while it waits, then gets a new Task.
+    BOOST_CHECK(ctl.removeTask(b1).get() == b1.get());
+    Task::Ptr b2 = makeTask(newTaskMsgScan(150, 3, qIdInc++, 0, "delta"));
+    ctl.queueTask(b2);
+    BOOST_CHECK(ctl.ready(true) == true);
+    BOOST_REQUIRE_EQUAL(memMan->chunks.size(), 2U);
+    BOOST_CHECK_EQUAL(memMan->chunks[1], 150);
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -24,6 +24,11 @@
 // Class header
 #include "xrdsvc/ChannelStream.h"
 
+// System headers
+#include <chrono>
+#include <ostream>
+#include <vector>
+
 // Third-party headers
 #include "boost/utility.hpp"
 
@@ -37,6 +42,57 @@
 
 namespace {
 LOG_LOGGER _log = LOG_GET("lsst.qserv.xrdsvc.ChannelStream");
+
+std::atomic<std::uint64_t> queuedBytesTotal{0};
+std::atomic<std::uint64_t> queuedBuffersTotal{0};
+std::atomic<std::uint64_t> stallsTotal{0};
+std::atomic<std::uint64_t> stallMicrosTotal{0};
+
+/// BufferPool keeps the storage of recycled message buffers so that result
+/// serialization does not have to grow a fresh string for every message.
+class BufferPool : boost::noncopyable {
+public:
+    static BufferPool& instance() {
+        static BufferPool pool;
+        return pool;
+    }
+
+    std::string acquire() {
+        std::string buf;
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_buffers.empty()) {
+            buf.swap(_buffers.back());
+            _buffers.pop_back();
+        }
+        return buf;
+    }
+
+    void release(std::string& buf) {
+        buf.clear();
+        // Buffers that grew past the hard message limit are not worth keeping.
+        if (buf.capacity() == 0 || buf.capacity() > MAX_KEPT_CAPACITY) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_buffers.size() < MAX_KEPT_BUFFERS) {
+            _buffers.emplace_back();
+            _buffers.back().swap(buf);
+        }
+    }
+
+    std::uint64_t size() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _buffers.size();
+    }
+
+private:
+    static const size_t MAX_KEPT_BUFFERS = 64;
+    static const size_t MAX_KEPT_CAPACITY = 64*1024*1024;
+
+    std::mutex _mutex;
+    std::vector<std::string> _buffers;
+};
+
 }
 
 
@@ -44,41 +100,45 @@ namespace lsst {
 namespace qserv {
 namespace xrdsvc {
 
-/// SimpleBuffer is a really simple buffer for transferring data packets to
-/// XrdSsi
-class SimpleBuffer : public XrdSsiStream::Buffer, boost::noncopyable {
+/// StreamBuffer hands a queued message to XrdSsi without copying it. The
+/// message storage goes back to the BufferPool when XrdSsi recycles it.
+class StreamBuffer : public XrdSsiStream::Buffer, boost::noncopyable {
 public:
-    SimpleBuffer(std::string const& input) {
-        data = new char[input.size()];
-        memcpy(data, input.data(), input.size());
+    StreamBuffer(std::string& msg) {
+        _msg.swap(msg);
+        data = &_msg[0];
         next = 0;
     }
 
     //!> Call to recycle the buffer when finished
     virtual void Recycle() {
-        delete this; // Self-destruct. FIXME: Not sure this is right.
+        BufferPool::instance().release(_msg);
+        delete this;
     }
 
     // Inherited from XrdSsiStream:
     // char  *data; //!> -> Buffer containing the data
     // Buffer *next; //!> For chaining by buffer receiver
 
-    virtual ~SimpleBuffer() {
-        delete[] data;
-    }
+private:
+    std::string _msg;
 };
 
 ////////////////////////////////////////////////////////////////////////
 // ChannelStream implementation
 ////////////////////////////////////////////////////////////////////////
 
+std::atomic<std::uint64_t> ChannelStream::_highWaterMark{16*1024*1024};
+
 /// Constructor
 ChannelStream::ChannelStream()
-    : XrdSsiStream(isActive),
-      _closed(false) {}
+    : XrdSsiStream(isActive) {}
 
 /// Destructor
 ChannelStream::~ChannelStream() {
+    // Anything left in the queue no longer counts against the worker.
+    queuedBytesTotal -= _queuedBytes;
+    queuedBuffersTotal -= _msgs.size();
 #if 0 // Enable to debug ChannelStream lifetime
     try {
         LOGS(_log, LOG_LVL_DEBUG, "Stream (" << (void *) this << ") deleted");
@@ -87,20 +147,65 @@ ChannelStream::~ChannelStream() {
 }
 
 /// Push in a data packet
-void
+bool
 ChannelStream::append(char const* buf, int bufLen, bool last) {
-    if (_closed) {
-        throw Bug("ChannelStream::append: Stream closed, append(...,last=true) already received");
+    std::string msg = acquireBuffer();
+    msg.assign(buf, bufLen);
+    return _push(msg, last);
+}
+
+/// Push in a data packet, taking over its storage.
+bool
+ChannelStream::append(std::string& buf, bool last) {
+    if (!_push(buf, last)) {
+        return false;
     }
-    LOGS(_log, LOG_LVL_DEBUG, "last=" << last << " " << util::prettyCharBuf(buf, bufLen, 10));
+    buf = acquireBuffer();
+    return true;
+}
+
+/// Queue buf, blocking while the stream is above its high-water mark.
+bool
+ChannelStream::_push(std::string& buf, bool last) {
+    LOGS(_log, LOG_LVL_DEBUG, "last=" << last << " " << util::prettyCharBuf(buf.data(), buf.size(), 10));
+    std::uint64_t const bufLen = buf.size();
     {
         std::unique_lock<std::mutex> lock(_mutex);
-        LOGS(_log, LOG_LVL_DEBUG, "Trying to append message (flowing)");
-
-        _msgs.push_back(std::string(buf, bufLen));
+        if (_cancelled) {
+            LOGS(_log, LOG_LVL_DEBUG, "append on cancelled stream");
+            return false;
+        }
+        if (_closed) {
+            throw Bug("ChannelStream::append: Stream closed, append(...,last=true) already received");
+        }
+        auto hasRoom = [this, bufLen]() {
+            return _cancelled || _queuedBytes == 0 || _queuedBytes + bufLen <= _highWaterMark;
+        };
+        if (!hasRoom()) {
+            LOGS(_log, LOG_LVL_DEBUG, "Waiting, queue full queuedBytes=" << _queuedBytes);
+            auto start = std::chrono::steady_clock::now();
+            _hasRoomCondition.wait(lock, hasRoom);
+            auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            _stallMicros += micros;
+            ++stallsTotal;
+            stallMicrosTotal += micros;
+            if (micros > 1000000) {
+                LOGS(_log, LOG_LVL_INFO, "append stalled " << micros/1000 << "ms, " << getStats());
+            }
+            if (_cancelled) {
+                return false;
+            }
+        }
+        _msgs.emplace_back();
+        _msgs.back().swap(buf);
+        _queuedBytes += bufLen;
+        queuedBytesTotal += bufLen;
+        ++queuedBuffersTotal;
         _closed = last; // if last is true, then we are closed.
         _hasDataCondition.notify_one();
     }
+    return true;
 }
 
 /// Pull out a data packet as a Buffer object (called by XrdSsi code)
@@ -112,6 +217,12 @@ ChannelStream::GetBuff(XrdSsiErrInfo &eInfo, int &dlen, bool &last) {
         LOGS(_log, LOG_LVL_DEBUG, "Waiting, no data ready");
         _hasDataCondition.wait(lock);
     }
+    if (_cancelled) {
+        LOGS(_log, LOG_LVL_DEBUG, "Not waiting, cancelled");
+        dlen = 0;
+        eInfo.Set("Stream cancelled", ECANCELED);
+        return 0;
+    }
     if (_msgs.empty() && _closed) { // We are closed and no more
         // msgs are available.
         LOGS(_log, LOG_LVL_DEBUG, "Not waiting, but closed");
@@ -119,12 +230,70 @@ ChannelStream::GetBuff(XrdSsiErrInfo &eInfo, int &dlen, bool &last) {
         eInfo.Set("Not an active stream", EOPNOTSUPP);
         return 0;
     }
-    SimpleBuffer* sb = new SimpleBuffer(_msgs.front());
     dlen = _msgs.front().size();
+    StreamBuffer* sb = new StreamBuffer(_msgs.front());
     _msgs.pop_front();
+    _queuedBytes -= dlen;
+    queuedBytesTotal -= dlen;
+    --queuedBuffersTotal;
+    _hasRoomCondition.notify_all();
     last = _closed && _msgs.empty();
     LOGS(_log, LOG_LVL_DEBUG, "returning buffer (" << dlen << ", " << (last ? "(last)" : "(more)") << ")");
+    if (last && _stallMicros > 0) {
+        LOGS(_log, LOG_LVL_DEBUG, "stream stalled " << _stallMicros/1000 << "ms in total");
+    }
     return sb;
 }
 
+/// Discard queued data and release any writer blocked in append().
+void
+ChannelStream::cancel() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_cancelled) {
+        return;
+    }
+    _cancelled = true;
+    _closed = true;
+    for (auto& msg : _msgs) {
+        BufferPool::instance().release(msg);
+    }
+    queuedBytesTotal -= _queuedBytes;
+    queuedBuffersTotal -= _msgs.size();
+    _msgs.clear();
+    _queuedBytes = 0;
+    _hasRoomCondition.notify_all();
+    _hasDataCondition.notify_all();
+}
+
+void
+ChannelStream::setHighWaterMark(std::uint64_t bytes) {
+    LOGS(_log, LOG_LVL_INFO, "stream high-water mark=" << bytes);
+    _highWaterMark = bytes;
+}
+
+std::string
+ChannelStream::acquireBuffer() {
+    return BufferPool::instance().acquire();
+}
+
+ChannelStream::Stats
+ChannelStream::getStats() {
+    Stats stats;
+    stats.queuedBytes = queuedBytesTotal;
+    stats.queuedBuffers = queuedBuffersTotal;
+    stats.stalls = stallsTotal;
+    stats.stallMicros = stallMicrosTotal;
+    stats.pooledBuffers = BufferPool::instance().size();
+    return stats;
+}
+
+std::ostream& operator<<(std::ostream& os, ChannelStream::Stats const& stats) {
+    os << "queuedBytes=" << stats.queuedBytes
+       << " queuedBuffers=" << stats.queuedBuffers
+       << " stalls=" << stats.stalls
+       << " stallMs=" << stats.stallMicros/1000
+       << " pooledBuffers=" << stats.pooledBuffers;
+    return os;
+}
+
 }}} // lsst::qserv::xrdsvc
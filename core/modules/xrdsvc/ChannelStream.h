@@ -24,8 +24,11 @@
 #define LSST_QSERV_XRDSVC_CHANNELSTREAM_H
 
 // System headers
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
+#include <iosfwd>
 #include <mutex>
 #include <string>
 
@@ -36,29 +39,74 @@
 namespace lsst {
 namespace qserv {
 namespace xrdsvc {
+
 /// ChannelStream is an implementation of an XrdSsiStream that accepts
 /// SendChannel streamed data.
+///
+/// The stream is bounded: once the bytes queued and not yet pulled by XrdSsi
+/// reach the high-water mark, append() blocks until GetBuff() drains the
+/// queue or the stream is cancelled. A message is always admitted into an
+/// empty queue, so a single message larger than the mark cannot deadlock.
+/// Message buffers are moved in and out of the stream without copying, and
+/// are returned to a process-wide pool when XrdSsi recycles them.
 class ChannelStream : public XrdSsiStream {
 public:
+    /// Worker-wide streaming counters.
+    struct Stats {
+        std::uint64_t queuedBytes;   ///< Bytes waiting in all streams
+        std::uint64_t queuedBuffers; ///< Messages waiting in all streams
+        std::uint64_t stalls;        ///< append() calls that had to wait
+        std::uint64_t stallMicros;   ///< Total time spent waiting in append()
+        std::uint64_t pooledBuffers; ///< Buffers available for reuse
+    };
+
     ChannelStream();
     virtual ~ChannelStream();
 
-    /// Push in a data packet
-    void append(char const* buf, int bufLen, bool last);
+    /// Push in a data packet, copying it.
+    /// @return false if the stream was cancelled.
+    bool append(char const* buf, int bufLen, bool last);
+
+    /// Push in a data packet, taking over the contents of buf. On return buf
+    /// holds an empty recycled buffer that the caller may fill again.
+    /// @return false if the stream was cancelled.
+    bool append(std::string& buf, bool last);
 
     /// Pull out a data packet as a Buffer object (called by XrdSsi code)
     virtual Buffer *GetBuff(XrdSsiErrInfo &eInfo, int &dlen, bool &last);
 
+    /// Discard queued data and wake up any append() waiting for room.
+    void cancel();
+
     bool closed() const { return _closed; }
 
+    /// Set the number of queued bytes at which append() starts blocking.
+    static void setHighWaterMark(std::uint64_t bytes);
+    static std::uint64_t getHighWaterMark() { return _highWaterMark; }
+
+    /// @return an empty buffer, reusing storage from recycled buffers when
+    ///         possible.
+    static std::string acquireBuffer();
+
+    static Stats getStats();
+
 private:
-    bool _closed; ///< Closed to new append() calls?
-    // Can keep a deque of (buf, bufsize) to reduce copying, if needed.
+    bool _push(std::string& buf, bool last);
+
+    std::atomic<bool> _closed{false}; ///< Closed to new append() calls?
+    bool _cancelled{false}; ///< Set by cancel(), protected by _mutex
     std::deque<std::string> _msgs; ///< Message queue
+    std::uint64_t _queuedBytes{0}; ///< Bytes in _msgs
+    std::uint64_t _stallMicros{0}; ///< Time this stream spent blocked in append()
     std::mutex _mutex; ///< _msgs protection
     std::condition_variable _hasDataCondition; ///< _msgs condition
+    std::condition_variable _hasRoomCondition; ///< _queuedBytes below high-water mark
+
+    static std::atomic<std::uint64_t> _highWaterMark;
 };
 
+std::ostream& operator<<(std::ostream& os, ChannelStream::Stats const& stats);
+
 }}} // namespace lsst::qserv::xrdsvc
 
 #endif // LSST_QSERV_XRDSVC_CHANNELSTREAM_H
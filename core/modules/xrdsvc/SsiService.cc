@@ -25,7 +25,9 @@
 #include "xrdsvc/SsiService.h"
 
 // System headers
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <iostream>
 #include <string>
 #include <stdlib.h>
@@ -52,6 +54,7 @@
 #include "wsched/FifoScheduler.h"
 #include "wsched/GroupScheduler.h"
 #include "wsched/ScanScheduler.h"
+#include "xrdsvc/ChannelStream.h"
 #include "xrdsvc/SsiSession.h"
 #include "xrdsvc/XrdName.h"
 
@@ -85,13 +88,19 @@ SsiService::SsiService(XrdSsiLogger* log, wconfig::WorkerConfig const& workerCon
     _initInventory();
 
     std::string cfgMemMan = workerConfig.getMemManClass();
+    uint64_t subChunkCacheBytes = workerConfig.getSubChunkCacheMb()*1000000;
     memman::MemMan::Ptr memMan;
     if (cfgMemMan  == "MemManReal") {
         // Default to 1 gigabyte
         uint64_t memManSize = workerConfig.getMemManSizeMb()*1000000;
+        // Cached subchunk tables are charged to the memory manager's budget.
+        memManSize -= std::min(subChunkCacheBytes, memManSize);
         LOGS(_log, LOG_LVL_DEBUG, "Using MemManReal with memManSizeMb=" << workerConfig.getMemManSizeMb() 
-            << " location=" <<  workerConfig.getMemManLocation());
-        memMan = std::shared_ptr<memman::MemMan>(memman::MemMan::create(memManSize, workerConfig.getMemManLocation()));
+            << " subChunkCacheMb=" << workerConfig.getSubChunkCacheMb()
+            << " location=" <<  workerConfig.getMemManLocation()
+            << " prefetchThreads=" << workerConfig.getMemManPrefetchThreads());
+        memMan = std::shared_ptr<memman::MemMan>(memman::MemMan::create(memManSize, workerConfig.getMemManLocation(),
+                                                                        workerConfig.getMemManPrefetchThreads()));
     } else if (cfgMemMan == "MemManNone"){
         memMan = std::make_shared<memman::MemManNone>(1, false);
     } else {
@@ -99,6 +108,9 @@ SsiService::SsiService(XrdSsiLogger* log, wconfig::WorkerConfig const& workerCon
         throw wconfig::WorkerConfigError("Unrecognized memory manager.");
     }
 
+    // Bound the result data each query may queue while the czar catches up.
+    ChannelStream::setHighWaterMark(workerConfig.getResultStreamHighWaterMb()*1024*1024ULL);
+
     // Set thread pool size.
     uint poolSize = std::max(workerConfig.getThreadPoolSize(), std::thread::hardware_concurrency());
 
@@ -147,7 +159,12 @@ SsiService::SsiService(XrdSsiLogger* log, wconfig::WorkerConfig const& workerCon
     queries->setRequiredTasksCompleted(requiredTasksCompleted);
 
     _foreman = std::make_shared<wcontrol::Foreman>(
-            blendSched, poolSize, workerConfig.getMySqlConfig(), queries);
+            blendSched, poolSize, workerConfig.getMySqlConfig(), queries, subChunkCacheBytes,
+            std::chrono::seconds(workerConfig.getSubChunkCacheSeconds()),
+            workerConfig.getMySqlPoolSize(),
+            std::chrono::milliseconds(workerConfig.getSharedScanWindowMs()),
+            workerConfig.getSharedScanMaxQueries(),
+            workerConfig.getNearNeighborJoin());
 }
 
 SsiService::~SsiService() {
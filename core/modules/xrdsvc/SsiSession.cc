@@ -72,6 +72,7 @@ void SsiSession::ProcessRequest(XrdSsiRequest* req, unsigned short timeout) {
     LOGS(_log, LOG_LVL_DEBUG, "GetRequest took " << t.getElapsed() << " seconds");
 
     auto replyChannel = std::make_shared<ReplyChannel>(*this);
+    _replyChannel = replyChannel;
 
     auto errorFunc = [this, &req, &replyChannel](std::string const& errStr) {
         replyChannel->sendError(errStr, EINVAL);
@@ -153,6 +154,10 @@ void SsiSession::RequestFinished(XrdSsiRequest* req, XrdSsiRespInfo const& rinfo
             }
         }
     }
+    // XrdSsi may free a response stream from here on.
+    if (_replyChannel) {
+        _replyChannel->releaseStream();
+    }
     // No buffers allocated, so don't need to free.
     // We can release/unlink the file now
     const char* type = "";
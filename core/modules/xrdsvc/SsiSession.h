@@ -76,6 +76,8 @@ private:
     class ReplyChannel;
     friend class ReplyChannel;
 
+    std::shared_ptr<ReplyChannel> _replyChannel; ///< set by ProcessRequest()
+
     ValidatorPtr _validator; ///< validates request against what's available
     std::shared_ptr<wbase::MsgProcessor> _processor; ///< actual msg processor
 
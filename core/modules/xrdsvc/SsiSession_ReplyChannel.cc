@@ -84,23 +84,74 @@ SsiSession::ReplyChannel::sendFile(int fd, Size fSize) {
 
 bool
 SsiSession::ReplyChannel::sendStream(char const* buf, int bufLen, bool last) {
-    // Initialize streaming object if not initialized.
-    LOGS(_log, LOG_LVL_DEBUG, "sendStream, checking stream " << (void *) _stream
-         << " len=" << bufLen << " last=" << last);
-    if (!_stream) {
-        _initStream();
-    } else if (_stream->closed()) {
+    LOGS(_log, LOG_LVL_DEBUG, "sendStream len=" << bufLen << " last=" << last);
+    ChannelStream* stream = _acquireStream();
+    if (!stream) {
         return false;
     }
-    _stream->append(buf, bufLen, last);
-    return true;
+    bool sent = !stream->closed() && stream->append(buf, bufLen, last);
+    _doneWithStream();
+    return sent;
+}
+
+bool
+SsiSession::ReplyChannel::sendStreamBuffer(std::string& buf, bool last) {
+    LOGS(_log, LOG_LVL_DEBUG, "sendStreamBuffer len=" << buf.size() << " last=" << last);
+    ChannelStream* stream = _acquireStream();
+    if (!stream) {
+        return false;
+    }
+    // append() blocks while the czar is behind, until it catches up or the
+    // stream is cancelled.
+    bool sent = !stream->closed() && stream->append(buf, last);
+    _doneWithStream();
+    return sent;
+}
+
+void
+SsiSession::ReplyChannel::cancel() {
+    std::lock_guard<std::mutex> lock(_streamMutex);
+    _cancelled = true;
+    if (_stream) {
+        _stream->cancel();
+    }
 }
 
 void
-SsiSession::ReplyChannel::_initStream() {
-    //_stream.reset(new Stream);
-    _stream = new ChannelStream();
-    _ssiSession.SetResponse(_stream);
+SsiSession::ReplyChannel::releaseStream() {
+    std::unique_lock<std::mutex> lock(_streamMutex);
+    _cancelled = true;
+    if (!_stream) {
+        return;
+    }
+    // wake up a sender blocked on a czar that will never read again
+    _stream->cancel();
+    _streamIdle.wait(lock, [this]() { return _streamUsers == 0; });
+    _stream = nullptr;
+}
+
+/// @return the stream, creating it on first use, or nullptr if cancelled
+///         or released. A non-null stream stays valid until _doneWithStream().
+ChannelStream*
+SsiSession::ReplyChannel::_acquireStream() {
+    std::lock_guard<std::mutex> lock(_streamMutex);
+    if (_cancelled) {
+        return nullptr;
+    }
+    if (!_stream) {
+        _stream = new ChannelStream();
+        _ssiSession.SetResponse(_stream);
+    }
+    ++_streamUsers;
+    return _stream;
+}
+
+void
+SsiSession::ReplyChannel::_doneWithStream() {
+    std::lock_guard<std::mutex> lock(_streamMutex);
+    if (--_streamUsers == 0) {
+        _streamIdle.notify_all();
+    }
 }
 
 }}} // lsst::qserv::xrdsvc
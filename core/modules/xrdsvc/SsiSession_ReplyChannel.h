@@ -23,6 +23,11 @@
 #ifndef LSST_QSERV_XRDSVC_SSISESSION_REPLYCHANNEL_H
 #define LSST_QSERV_XRDSVC_SSISESSION_REPLYCHANNEL_H
 
+// System headers
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
 // Third-party headers
 #include "XrdSsi/XrdSsiResponder.hh"
 
@@ -51,12 +56,23 @@ public:
     virtual bool sendError(std::string const& msg, int code);
     virtual bool sendFile(int fd, Size fSize);
     virtual bool sendStream(char const* buf, int bufLen, bool last);
+    virtual bool sendStreamBuffer(std::string& buf, bool last);
+    virtual void cancel();
+
+    /// Forget the stream once XrdSsi is finished with the response and may
+    /// free it. Waits for senders still using the stream to return.
+    void releaseStream();
 
 private:
-    void _initStream();
+    ChannelStream* _acquireStream();
+    void _doneWithStream();
 
     SsiSession& _ssiSession;
-    ChannelStream* _stream;
+    std::mutex _streamMutex; ///< protects _stream, _streamUsers and _cancelled
+    std::condition_variable _streamIdle; ///< signalled when _streamUsers drops to 0
+    ChannelStream* _stream; ///< owned by XrdSsi once handed to SetResponse()
+    int _streamUsers{0}; ///< senders between _acquireStream() and _doneWithStream()
+    bool _cancelled{false};
 };
 
 }}} // namespace lsst::qserv::xrdsvc